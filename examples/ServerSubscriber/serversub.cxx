@@ -40,6 +40,7 @@ int main(int argc, char* argv[])
   //   worker:REGISTER
   //   worker:ASKING_FOR_JOB
   //   job:ASSIGNED_TO_WORKER
+  //   summary:server
 
   for (int arg = 1; arg < argc; ++arg)
     zmq_setsockopt (subscriber, ZMQ_SUBSCRIBE,
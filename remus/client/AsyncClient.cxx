@@ -0,0 +1,485 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/AsyncClient.h>
+
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
+#include <remus/proto/zmqHelper.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace
+{
+//------------------------------------------------------------------------------
+//convert the contents of a response into the type the caller is waiting on
+template<typename T>
+T from_Response(const remus::proto::Response& response)
+{
+  std::istringstream buffer(std::string(response.data(), response.dataSize()));
+  T value;
+  buffer >> value;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+template<>
+bool from_Response<bool>(const remus::proto::Response& response)
+{
+  std::istringstream buffer(std::string(response.data(), response.dataSize()));
+  bool value = false;
+  buffer >> value;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+template<>
+remus::proto::Job
+from_Response<remus::proto::Job>(const remus::proto::Response& response)
+{
+  return remus::proto::to_Job(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+template<>
+remus::proto::JobStatus
+from_Response<remus::proto::JobStatus>(const remus::proto::Response& response)
+{
+  const std::string status(response.data(), response.dataSize());
+  return remus::proto::to_JobStatus(status);
+}
+
+//------------------------------------------------------------------------------
+template<>
+remus::proto::JobResult
+from_Response<remus::proto::JobResult>(const remus::proto::Response& response)
+{
+  const std::string result(response.data(), response.dataSize());
+  return remus::proto::to_JobResult(result);
+}
+
+//------------------------------------------------------------------------------
+template<>
+remus::proto::JobArray
+from_Response<remus::proto::JobArray>(const remus::proto::Response& response)
+{
+  return remus::proto::to_JobArray(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+template<>
+remus::proto::JobArrayStatus
+from_Response<remus::proto::JobArrayStatus>(const remus::proto::Response& response)
+{
+  return remus::proto::to_JobArrayStatus(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+//a request that has been sent to the server and is waiting on a response
+class PendingRequest
+{
+public:
+  virtual ~PendingRequest() {}
+  virtual void fulfill(const remus::proto::Response& response) = 0;
+};
+
+//------------------------------------------------------------------------------
+template<typename T>
+class TypedPendingRequest : public PendingRequest
+{
+public:
+  TypedPendingRequest(): Promise() {}
+
+  std::future<T> future() { return this->Promise.get_future(); }
+
+  virtual void fulfill(const remus::proto::Response& response)
+  {
+    try
+      {
+      this->Promise.set_value( from_Response<T>(response) );
+      }
+    catch(...)
+      {
+      this->Promise.set_exception( std::current_exception() );
+      }
+  }
+
+private:
+  std::promise<T> Promise;
+};
+
+}
+
+namespace remus{
+namespace client{
+
+//-----------------------------------------------------------------------------
+class AsyncClient::AsyncClientImplementation
+{
+  typedef std::map< std::string, boost::shared_ptr<PendingRequest> > PendingMap;
+
+  boost::shared_ptr<zmq::context_t> Context;
+
+  //the socket that the calling threads use to hand requests to the
+  //I/O thread. Guarded by RequestsMutex
+  zmq::socket_t Requests;
+  boost::mutex RequestsMutex;
+  boost::uint64_t NextRequestId;
+  boost::uuids::random_generator JobIdGenerator;
+
+  //all the requests that are waiting on a response from the server
+  mutable boost::mutex PendingMutex;
+  PendingMap Pending;
+
+  //state to tell when we should stop polling
+  bool ContinuePolling;
+
+  boost::scoped_ptr<boost::thread> PollingThread;
+
+public:
+//-----------------------------------------------------------------------------
+AsyncClientImplementation(const remus::client::ServerConnection& conn):
+  Context(conn.context()),
+  Requests(*Context, ZMQ_PAIR),
+  RequestsMutex(),
+  NextRequestId(0),
+  JobIdGenerator(),
+  PendingMutex(),
+  Pending(),
+  ContinuePolling(true),
+  PollingThread()
+{
+  //use an auto generated channel name, this allows multiple clients to share
+  //the same context. We have to bind before the I/O thread connects
+  boost::uuids::random_generator generator;
+  const zmq::socketInfo<zmq::proto::inproc> channel(
+                                    boost::uuids::to_string(generator()));
+  zmq::bindToAddress(this->Requests, channel);
+
+  this->PollingThread.reset(
+      new boost::thread( &AsyncClientImplementation::pollForResponses,
+                         this,
+                         conn.endpoint(),
+                         channel) );
+}
+
+//-----------------------------------------------------------------------------
+~AsyncClientImplementation()
+{
+  //stop the thread, any request still pending will be abandoned when
+  //the Pending map is destroyed, which breaks the promises
+  this->ContinuePolling = false;
+  this->PollingThread->join();
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+std::future<T> send(const remus::common::MeshIOType& mtype,
+                    remus::SERVICE_TYPE stype,
+                    const std::string& data)
+{
+  boost::shared_ptr< TypedPendingRequest<T> > request =
+    boost::make_shared< TypedPendingRequest<T> >();
+  std::future<T> result = request->future();
+
+  boost::lock_guard<boost::mutex> lock(this->RequestsMutex);
+  const std::string requestId =
+    boost::lexical_cast<std::string>(++this->NextRequestId);
+
+  //register the request before it is sent, so that the I/O thread
+  //can't see the response before we know about the request
+  {
+  boost::lock_guard<boost::mutex> pendingLock(this->PendingMutex);
+  this->Pending[requestId] = request;
+  }
+
+  remus::proto::send_Message(mtype, stype, data, requestId, &this->Requests);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+boost::uuids::uuid generateJobId()
+{
+  boost::lock_guard<boost::mutex> lock(this->RequestsMutex);
+  return this->JobIdGenerator();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t numberOfPendingRequests() const
+{
+  boost::lock_guard<boost::mutex> lock(this->PendingMutex);
+  return this->Pending.size();
+}
+
+private:
+//-----------------------------------------------------------------------------
+void pollForResponses(std::string endpoint,
+                      zmq::socketInfo<zmq::proto::inproc> channel)
+{
+  //since this is threaded, we need to make sure that zmq_socket and
+  //zmq_close will execute from inside the thread address space so that
+  //when the thread is joined everything cleans up in the correct order
+  zmq::socket_t server(*this->Context, ZMQ_DEALER);
+  zmq::socket_t requests(*this->Context, ZMQ_PAIR);
+
+  zmq::connectToAddress(server, endpoint);
+  zmq::connectToAddress(requests, channel);
+
+  zmq::pollitem_t items[2] = { { requests,  0, ZMQ_POLLIN, 0 },
+                               { server,  0, ZMQ_POLLIN, 0 } };
+  while( this->ContinuePolling )
+    {
+    zmq::poll_safely(items,2,250);
+    if(items[0].revents & ZMQ_POLLIN)
+      {
+      //forward the request to the server, the request id is preserved
+      remus::proto::Message msg = remus::proto::receive_Message(&requests);
+      if(msg.isValid())
+        {
+        remus::proto::forward_Message(msg, &server);
+        }
+      }
+    if(items[1].revents & ZMQ_POLLIN)
+      {
+      remus::proto::Response response =
+          remus::proto::receive_Response(&server);
+      this->dispatch(response);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void dispatch(const remus::proto::Response& response)
+{
+  boost::shared_ptr<PendingRequest> request;
+  {
+  boost::lock_guard<boost::mutex> lock(this->PendingMutex);
+  PendingMap::iterator i = this->Pending.find(response.requestId());
+  if(i == this->Pending.end())
+    { //ignore responses to requests we don't know about
+    return;
+    }
+  request = i->second;
+  this->Pending.erase(i);
+  }
+
+  //fulfill the promise outside the lock, as it can wake up other threads
+  request->fulfill(response);
+}
+
+};
+
+//------------------------------------------------------------------------------
+AsyncClient::AsyncClient(const remus::client::ServerConnection &conn):
+  ConnectionInfo(conn),
+  Implementation( new AsyncClientImplementation(conn) )
+{
+}
+
+//------------------------------------------------------------------------------
+AsyncClient::~AsyncClient()
+{
+}
+
+//------------------------------------------------------------------------------
+const remus::client::ServerConnection& AsyncClient::connection() const
+{
+  return this->ConnectionInfo;
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::common::MeshIOTypeSet> AsyncClient::supportedIOTypes()
+{
+  return this->Implementation->send<remus::common::MeshIOTypeSet>(
+                                              remus::common::MeshIOType(),
+                                              remus::SUPPORTED_IO_TYPES,
+                                              std::string());
+}
+
+//------------------------------------------------------------------------------
+std::future<bool>
+AsyncClient::canMesh(const remus::common::MeshIOType& meshtypes)
+{
+  return this->Implementation->send<bool>(meshtypes,
+                                          remus::CAN_MESH_IO_TYPE,
+                                          std::string());
+}
+
+//------------------------------------------------------------------------------
+std::future<bool>
+AsyncClient::canMesh(const remus::proto::JobRequirements& reqs)
+{
+  std::ostringstream buffer;
+  buffer << reqs;
+  return this->Implementation->send<bool>(reqs.meshTypes(),
+                                          remus::CAN_MESH_REQUIREMENTS,
+                                          buffer.str());
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobRequirementsSet>
+AsyncClient::retrieveRequirements( const remus::common::MeshIOType& meshtypes)
+{
+  return this->Implementation->send<remus::proto::JobRequirementsSet>(
+                                          meshtypes,
+                                          remus::MESH_REQUIREMENTS_FOR_IO_TYPE,
+                                          std::string());
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::Job>
+AsyncClient::submitJob(const remus::proto::JobSubmission& submission)
+{
+  std::ostringstream buffer;
+  buffer << submission;
+  return this->Implementation->send<remus::proto::Job>(submission.type(),
+                                                       remus::MAKE_MESH,
+                                                       buffer.str());
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job
+AsyncClient::submitJobWithClientId(const remus::proto::JobSubmission& submission,
+                                   std::future<remus::proto::Job>* ack)
+{
+  return this->submitJobWithClientId(this->Implementation->generateJobId(),
+                                     submission, ack);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job
+AsyncClient::submitJobWithClientId(const boost::uuids::uuid& id,
+                                   const remus::proto::JobSubmission& submission,
+                                   std::future<remus::proto::Job>* ack)
+{
+  const remus::proto::Job job(id, submission.type());
+
+  //the job is sent in front of the submission so the server knows
+  //what id to use
+  std::ostringstream buffer;
+  buffer << job;
+  buffer << submission;
+
+  std::future<remus::proto::Job> result =
+    this->Implementation->send<remus::proto::Job>(submission.type(),
+                                                  remus::MAKE_MESH_WITH_ID,
+                                                  buffer.str());
+  if(ack)
+    {
+    *ack = std::move(result);
+    }
+  return job;
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobStatus>
+AsyncClient::jobStatus(const remus::proto::Job& job)
+{
+  return this->Implementation->send<remus::proto::JobStatus>(job.type(),
+                                              remus::MESH_STATUS,
+                                              remus::proto::to_string(job));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobStatus>
+AsyncClient::waitForStatusChange(const remus::proto::Job& job,
+                                 const remus::proto::JobStatus& lastSeen,
+                                 boost::int64_t timeoutInMillisec)
+{
+  std::ostringstream buffer;
+  buffer << job;
+  buffer << lastSeen;
+  buffer << timeoutInMillisec << '\n';
+  return this->Implementation->send<remus::proto::JobStatus>(job.type(),
+                                              remus::WAIT_FOR_STATUS_CHANGE,
+                                              buffer.str());
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobResult>
+AsyncClient::retrieveResults(const remus::proto::Job& job)
+{
+  return this->Implementation->send<remus::proto::JobResult>(job.type(),
+                                              remus::RETRIEVE_RESULT,
+                                              remus::proto::to_string(job));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobStatus>
+AsyncClient::terminate(const remus::proto::Job& job)
+{
+  return this->Implementation->send<remus::proto::JobStatus>(job.type(),
+                                              remus::TERMINATE_JOB,
+                                              remus::proto::to_string(job));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobArray>
+AsyncClient::submitJobArray(const remus::proto::JobArraySubmission& submission)
+{
+  return this->Implementation->send<remus::proto::JobArray>(
+                                          submission.type(),
+                                          remus::MAKE_MESH_ARRAY,
+                                          remus::proto::to_string(submission));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobArrayStatus>
+AsyncClient::jobArrayStatus(const remus::proto::JobArray& array)
+{
+  return this->Implementation->send<remus::proto::JobArrayStatus>(
+                                          array.type(),
+                                          remus::JOB_ARRAY_STATUS,
+                                          remus::proto::to_string(array));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobArrayStatus>
+AsyncClient::terminate(const remus::proto::JobArray& array)
+{
+  return this->Implementation->send<remus::proto::JobArrayStatus>(
+                                          array.type(),
+                                          remus::TERMINATE_JOB_ARRAY,
+                                          remus::proto::to_string(array));
+}
+
+//------------------------------------------------------------------------------
+std::future<remus::proto::JobListing>
+AsyncClient::listJobs(const remus::proto::JobListingRequest& request)
+{
+  return this->Implementation->send<remus::proto::JobListing>(
+                                          remus::common::MeshIOType(),
+                                          remus::LIST_JOBS,
+                                          remus::proto::to_string(request));
+}
+
+//------------------------------------------------------------------------------
+std::size_t AsyncClient::numberOfPendingRequests() const
+{
+  return this->Implementation->numberOfPendingRequests();
+}
+
+}
+}
@@ -0,0 +1,178 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_client_AsyncClient_h
+#define remus_client_AsyncClient_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/client/ServerConnection.h>
+
+#include <remus/common/MeshIOType.h>
+
+//Clients include everything from proto, so that
+//users don't need as many includes
+#include <remus/proto/Job.h>
+#include <remus/proto/JobArray.h>
+#include <remus/proto/JobListing.h>
+#include <remus/proto/JobRequirements.h>
+#include <remus/proto/JobResult.h>
+#include <remus/proto/JobStatus.h>
+#include <remus/proto/JobSubmission.h>
+
+//included for export symbols
+#include <remus/client/ClientExports.h>
+
+#include <future>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+//The AsyncClient class is the pipelined version of remus::client::Client.
+//Instead of a REQ socket that only allows a single request to be outstanding,
+//the AsyncClient uses a DEALER socket that is owned by a dedicated I/O thread.
+//Every request is tagged with a request id that the server echoes back, so
+//any number of requests can be in flight at once, and each call returns
+//a std::future that is fulfilled when the matching response arrives.
+//
+//All methods are safe to call from multiple threads.
+//
+//If the AsyncClient is destroyed while requests are still in flight, the
+//futures of those requests will throw std::future_error with the
+//broken_promise error code.
+namespace remus{
+namespace client{
+
+class REMUSCLIENT_EXPORT AsyncClient
+{
+public:
+  //connect to a given host on a given port with tcp
+  explicit AsyncClient(const remus::client::ServerConnection& conn);
+
+  //stops the I/O thread, and abandons all requests that are in flight
+  ~AsyncClient();
+
+  //return the connection info that was used to connect to the
+  //remus server
+  const remus::client::ServerConnection& connection() const;
+
+  //Submit a request to the server to see what MeshIOTypes are supported
+  std::future<remus::common::MeshIOTypeSet> supportedIOTypes();
+
+  //Submit a request to the server to see if the server supports
+  //the requested input and output mesh types
+  std::future<bool> canMesh(const remus::common::MeshIOType& meshtypes);
+
+  //Submit a request to the server to see if the server supports
+  //the exact requested requirements
+  std::future<bool> canMesh(const remus::proto::JobRequirements& requirements);
+
+  //submit a request to the server to see if the server supports
+  //the request input and output mesh types. If the server does support
+  //the given types, return a collection of JobRequirements
+  std::future<remus::proto::JobRequirementsSet>
+  retrieveRequirements( const remus::common::MeshIOType& meshtypes );
+
+  //Submit a job to the server. The server will generate the id for
+  //the job, and the returned future will hold the job once the server
+  //has queued it.
+  std::future<remus::proto::Job>
+  submitJob(const remus::proto::JobSubmission& submission);
+
+  //Submit a job to the server using a job id that is generated by the client.
+  //The returned job can be used right away without waiting on the server.
+  //If ack isn't NULL it will be filled with a future that holds the job once
+  //the server has queued it, or an invalid job if the server rejected the id.
+  remus::proto::Job
+  submitJobWithClientId(const remus::proto::JobSubmission& submission,
+                        std::future<remus::proto::Job>* ack = NULL);
+
+  //Submit a job to the server using a job id that the caller picked. The
+  //id needs to be unique, see submitJobWithClientId above for the details
+  remus::proto::Job
+  submitJobWithClientId(const boost::uuids::uuid& id,
+                        const remus::proto::JobSubmission& submission,
+                        std::future<remus::proto::Job>* ack = NULL);
+
+  //Given a remus Job object returns the status of the job
+  std::future<remus::proto::JobStatus> jobStatus(const remus::proto::Job& job);
+
+  //The returned future is fulfilled once the status of the job differs
+  //from lastSeen, or timeoutInMillisec has passed.
+  //See Client::waitForStatusChange for more details
+  std::future<remus::proto::JobStatus>
+  waitForStatusChange(const remus::proto::Job& job,
+                      const remus::proto::JobStatus& lastSeen,
+                      boost::int64_t timeoutInMillisec);
+
+  //Return job result of of a give job
+  std::future<remus::proto::JobResult>
+  retrieveResults(const remus::proto::Job& job);
+
+  //attempts to terminate a given job, will kill the job if the job hasn't
+  //started. If the job has been finished and the results
+  //are on the server the results will be deleted. If the job is in process
+  //this will be unable to kill the job.
+  std::future<remus::proto::JobStatus> terminate(const remus::proto::Job& job);
+
+  //Submit a job array to the server.
+  //See Client::submitJobArray for more details
+  std::future<remus::proto::JobArray>
+  submitJobArray(const remus::proto::JobArraySubmission& submission);
+
+  //returns the status of every element of a job array
+  std::future<remus::proto::JobArrayStatus>
+  jobArrayStatus(const remus::proto::JobArray& array);
+
+  //attempts to terminate every element of a job array.
+  //See Client::terminate for more details
+  std::future<remus::proto::JobArrayStatus>
+  terminate(const remus::proto::JobArray& array);
+
+  //returns a single page of the jobs the server holds.
+  //See Client::listJobs for more details
+  std::future<remus::proto::JobListing>
+  listJobs(const remus::proto::JobListingRequest& request);
+
+  //returns the number of requests that are waiting on a response
+  std::size_t numberOfPendingRequests() const;
+
+private:
+  //explicitly state the client doesn't support copy or move semantics
+  AsyncClient(const AsyncClient&);
+  void operator=(const AsyncClient&);
+
+  remus::client::ServerConnection ConnectionInfo;
+
+  class AsyncClientImplementation;
+  boost::scoped_ptr<AsyncClientImplementation> Implementation;
+};
+
+}
+
+typedef remus::client::AsyncClient AsyncClient;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
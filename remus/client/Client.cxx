@@ -11,8 +11,10 @@
 //=============================================================================
 
 #include <remus/client/Client.h>
+#include <remus/client/detail/WaitForResult.h>
 
 #include <remus/proto/Message.h>
+#include <remus/proto/ModelSession.h>
 #include <remus/proto/Response.h>
 
 #include <remus/proto/zmqHelper.h>
@@ -152,6 +154,35 @@ remus::proto::JobStatus Client::jobStatus(const remus::proto::Job& job)
   return remus::proto::to_JobStatus(status);
 }
 
+//------------------------------------------------------------------------------
+remus::proto::JobStatus
+Client::waitForStatusChange(const remus::proto::Job& job,
+                            const remus::proto::JobStatus& lastSeen,
+                            boost::int64_t timeoutInMillisec)
+{
+  std::ostringstream buffer;
+  buffer << job;
+  buffer << lastSeen;
+  buffer << timeoutInMillisec << '\n';
+
+  remus::proto::send_Message(job.type(),
+                             remus::WAIT_FOR_STATUS_CHANGE,
+                             buffer.str(),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  const std::string status(response.data(), response.dataSize());
+  return remus::proto::to_JobStatus(status);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobResult Client::waitForResult(const remus::proto::Job& job,
+                                              boost::int64_t timeoutInMillisec)
+{
+  return remus::client::detail::waitForResult(*this, job, timeoutInMillisec);
+}
+
 //------------------------------------------------------------------------------
 remus::proto::JobResult Client::retrieveResults(const remus::proto::Job& job)
 {
@@ -180,5 +211,99 @@ remus::proto::JobStatus Client::terminate(const remus::proto::Job& job)
   return remus::proto::to_JobStatus(status);
 }
 
+//------------------------------------------------------------------------------
+remus::proto::JobArray
+Client::submitJobArray(const remus::proto::JobArraySubmission& submission)
+{
+  remus::proto::send_Message(submission.type(),
+                             remus::MAKE_MESH_ARRAY,
+                             remus::proto::to_string(submission),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  return remus::proto::to_JobArray(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArrayStatus
+Client::jobArrayStatus(const remus::proto::JobArray& array)
+{
+  remus::proto::send_Message(array.type(),
+                             remus::JOB_ARRAY_STATUS,
+                             remus::proto::to_string(array),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  return remus::proto::to_JobArrayStatus(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArrayStatus
+Client::terminate(const remus::proto::JobArray& array)
+{
+  remus::proto::send_Message(array.type(),
+                             remus::TERMINATE_JOB_ARRAY,
+                             remus::proto::to_string(array),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  return remus::proto::to_JobArrayStatus(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobListing
+Client::listJobs(const remus::proto::JobListingRequest& request)
+{
+  remus::proto::send_Message(remus::common::MeshIOType(),
+                             remus::LIST_JOBS,
+                             remus::proto::to_string(request),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  return remus::proto::to_JobListing(response.data(), response.dataSize());
+}
+
+//------------------------------------------------------------------------------
+std::string Client::openModelSession(const remus::proto::JobSubmission& contents,
+                                     std::size_t maxWorkers)
+{
+  remus::proto::send_Message(contents.type(),
+                             remus::OPEN_MODEL_SESSION,
+                             remus::proto::to_ModelSessionRequest(contents,
+                                                                  maxWorkers),
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  const std::string session(response.data(), response.dataSize());
+  if(response.serviceType() != remus::OPEN_MODEL_SESSION ||
+     session == remus::INVALID_MSG)
+    {
+    return std::string();
+    }
+  return session;
+}
+
+//------------------------------------------------------------------------------
+bool Client::closeModelSession(const std::string& session)
+{
+  remus::proto::send_Message(remus::common::MeshIOType(),
+                             remus::CLOSE_MODEL_SESSION,
+                             session,
+                             &this->Zmq->Server);
+
+  remus::proto::Response response =
+      remus::proto::receive_Response(&this->Zmq->Server);
+  std::istringstream buffer(std::string(response.data(), response.dataSize()));
+
+  bool closed = false;
+  buffer >> closed;
+  return closed;
+}
+
 }
 }
@@ -16,6 +16,7 @@
 #include <remus/common/CompilerInformation.h>
 
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
 #include <boost/scoped_ptr.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
@@ -26,6 +27,8 @@ REMUS_THIRDPARTY_POST_INCLUDE
 //Clients include everything from proto, so that
 //users don't need as many includes
 #include <remus/proto/Job.h>
+#include <remus/proto/JobArray.h>
+#include <remus/proto/JobListing.h>
 #include <remus/proto/JobRequirements.h>
 #include <remus/proto/JobResult.h>
 #include <remus/proto/JobStatus.h>
@@ -86,15 +89,68 @@ public:
   //Given a remus Job object returns the status of the job
   remus::proto::JobStatus jobStatus(const remus::proto::Job& job);
 
+  //Blocks until the status of the job differs from lastSeen, or until
+  //timeoutInMillisec has passed. The server holds on to the request
+  //instead of the client polling with jobStatus. If the timeout passes
+  //the current status of the job is returned, which can be equal to lastSeen.
+  //Only the status type and progress value are compared against lastSeen.
+  //The server waits at most a minute, no matter how long the timeout is.
+  remus::proto::JobStatus waitForStatusChange(const remus::proto::Job& job,
+                                              const remus::proto::JobStatus& lastSeen,
+                                              boost::int64_t timeoutInMillisec);
+
   //Return job result of of a give job
   remus::proto::JobResult retrieveResults(const remus::proto::Job& job);
 
+  //Blocks until the job has finished and returns the result, using
+  //waitForStatusChange to track the job. If the job fails, or doesn't
+  //finish before timeoutInMillisec passes, an invalid result is returned
+  remus::proto::JobResult waitForResult(const remus::proto::Job& job,
+                                        boost::int64_t timeoutInMillisec);
+
   //attempts to terminate a given job, will kill the job if the job hasn't
   //started. If the job has been finished and the results
   //are on the server the results will be deleted. If the job is in process
   //this will be unable to kill the job.
   remus::proto::JobStatus terminate(const remus::proto::Job& job);
 
+  //Submit a job array to the server. The base submission is sent and stored
+  //once, and each element only adds the contents that differ. Use
+  //JobArray::job to get the job of a single element, which works with
+  //all the other calls that take a job
+  remus::proto::JobArray
+  submitJobArray(const remus::proto::JobArraySubmission& submission);
+
+  //returns the status of every element of a job array
+  remus::proto::JobArrayStatus jobArrayStatus(const remus::proto::JobArray& array);
+
+  //attempts to terminate every element of a job array, see terminate for
+  //what happens to each element. Terminated elements are marked as FAILED
+  //in the returned status
+  remus::proto::JobArrayStatus terminate(const remus::proto::JobArray& array);
+
+  //returns a single page of the jobs the server holds that pass the
+  //filters of the request. Pass the cursor of the returned listing to the
+  //next request to get the next page. This is meant for tools that need to
+  //look at what a server holds, without subscribing to the status channel
+  remus::proto::JobListing listJobs(const remus::proto::JobListingRequest& request);
+
+  //Opens a model session that holds the contents of the submission on the
+  //server, such as the model of a SMTKMeshSubmission. Later submissions
+  //that refer to the session only need to hold what differs from job to
+  //job, see SMTKMeshSubmission::session. The jobs of a session are sent
+  //to the same maxWorkers workers where possible, so that those workers
+  //can keep the parsed model around.
+  //Returns the id of the session, or an empty string if it couldn't be
+  //opened. Sessions that no job has used for 30 minutes are closed
+  std::string openModelSession(const remus::proto::JobSubmission& contents,
+                               std::size_t maxWorkers = 1);
+
+  //closes a model session, after which submissions that refer to it are
+  //refused. Jobs of the session that were already submitted still run.
+  //Returns false if the session wasn't open
+  bool closeModelSession(const std::string& session);
+
 protected:
   remus::client::ServerConnection ConnectionInfo;
 private:
@@ -0,0 +1,441 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/ShardedClient.h>
+
+#include <remus/client/AsyncClient.h>
+#include <remus/client/Subscriber.h>
+#include <remus/client/detail/WaitForResult.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/uuid/random_generator.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+//the number of points each server has on the consistent hash ring. More
+//points spread the requirements more evenly over the servers
+static const int points_per_shard = 64;
+
+//we encode the shard in two bytes of the job id
+static const std::size_t max_shards = 0xFFFF;
+
+//------------------------------------------------------------------------------
+//FNV-1a, we need a hash that is the same for every process and platform
+//so that all clients agree on where requirements are placed
+boost::uint64_t stable_hash(const std::string& str)
+{
+  boost::uint64_t hash = 14695981039346656037ULL;
+  for(std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    {
+    hash ^= static_cast<unsigned char>(*i);
+    hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+//only hash what identifies the kind of job, not the requirements contents
+//which can be large
+std::string requirements_key(const remus::proto::JobRequirements& reqs)
+{
+  std::ostringstream buffer;
+  buffer << reqs.meshTypes() << "|" << reqs.workerName() << "|" << reqs.tag();
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+boost::uuids::uuid encode_shard(boost::uuids::uuid id, std::size_t shard)
+{
+  id.data[14] = static_cast<boost::uint8_t>((shard >> 8) & 0xFF);
+  id.data[15] = static_cast<boost::uint8_t>(shard & 0xFF);
+  return id;
+}
+
+//------------------------------------------------------------------------------
+std::size_t decode_shard(const boost::uuids::uuid& id)
+{
+  return (static_cast<std::size_t>(id.data[14]) << 8) |
+          static_cast<std::size_t>(id.data[15]);
+}
+
+}
+
+namespace remus{
+namespace client{
+
+//------------------------------------------------------------------------------
+class ShardedClient::ShardedClientImplementation
+{
+public:
+  typedef boost::shared_ptr<remus::client::AsyncClient> ClientPtr;
+  typedef boost::shared_ptr<remus::client::Subscriber> SubscriberPtr;
+
+  ShardedClientImplementation(const std::vector<remus::client::ServerConnection>& servers,
+                              const std::vector<remus::client::ServerConnection>& status,
+                              ShardedClient::Policy policy):
+    PlacementPolicy(policy),
+    Connections(servers),
+    Shards(),
+    Ring(),
+    Next(0),
+    IdMutex(),
+    IdGenerator(),
+    LoadMutex(),
+    Queued(servers.size(), 0),
+    SubmittedSinceSummary(servers.size(), 0),
+    Subscribers()
+  {
+    const std::size_t numShards = std::min(servers.size(), max_shards);
+    this->Connections.resize(numShards);
+    for(std::size_t i=0; i < numShards; ++i)
+      {
+      this->Shards.push_back( ClientPtr(new AsyncClient(servers[i])) );
+
+      //the ring is keyed on the endpoint so that the placement doesn't
+      //depend on the order of the servers
+      for(int p=0; p < points_per_shard; ++p)
+        {
+        std::ostringstream point;
+        point << servers[i].endpoint() << "#" << p;
+        this->Ring[stable_hash(point.str())] = i;
+        }
+      }
+
+    //only LEAST_QUEUED needs to know what the servers are doing
+    if(policy == ShardedClient::LEAST_QUEUED)
+      {
+      for(std::size_t i=0; i < numShards && i < status.size(); ++i)
+        {
+        SubscriberPtr sub(new remus::client::Subscriber(status[i]));
+        sub->onSummary( std::bind(&ShardedClientImplementation::summaryArrived,
+                                  this, i, std::placeholders::_1) );
+        sub->watchSummaries();
+        this->Subscribers.push_back(sub);
+        }
+      }
+  }
+
+  ~ShardedClientImplementation()
+  {
+    //stop the subscribers before anything they call back into is destroyed
+    this->Subscribers.clear();
+  }
+
+  std::size_t size() const { return this->Shards.size(); }
+
+  const remus::client::ServerConnection& connection(std::size_t shard) const
+    { return this->Connections[shard]; }
+
+  remus::client::AsyncClient& client(std::size_t shard)
+    { return *(this->Shards[shard]); }
+
+  ShardedClient::Policy policy() const { return this->PlacementPolicy; }
+
+  //-----------------------------------------------------------------------------
+  std::size_t place(const remus::proto::JobRequirements& reqs)
+  {
+    switch(this->PlacementPolicy)
+      {
+      case ShardedClient::CONSISTENT_HASH:
+        {
+        typedef std::map<boost::uint64_t, std::size_t>::const_iterator it;
+        it point = this->Ring.lower_bound(stable_hash(requirements_key(reqs)));
+        if(point == this->Ring.end())
+          {
+          point = this->Ring.begin();
+          }
+        return point->second;
+        }
+      case ShardedClient::LEAST_QUEUED:
+        {
+        //start at a different server each time so that ties are
+        //spread over the servers
+        const std::size_t start = this->Next.fetch_add(1);
+        boost::lock_guard<boost::mutex> lock(this->LoadMutex);
+        std::size_t best = start % this->size();
+        std::size_t bestLoad = this->load(best);
+        for(std::size_t i=1; i < this->size(); ++i)
+          {
+          const std::size_t shard = (start + i) % this->size();
+          if(this->load(shard) < bestLoad)
+            {
+            best = shard;
+            bestLoad = this->load(shard);
+            }
+          }
+        ++this->SubmittedSinceSummary[best];
+        return best;
+        }
+      case ShardedClient::ROUND_ROBIN:
+      default:
+        return this->Next.fetch_add(1) % this->size();
+      }
+  }
+
+  //-----------------------------------------------------------------------------
+  boost::uuids::uuid generateJobId(std::size_t shard)
+  {
+    boost::lock_guard<boost::mutex> lock(this->IdMutex);
+    return encode_shard(this->IdGenerator(), shard);
+  }
+
+private:
+  //-----------------------------------------------------------------------------
+  //called with the LoadMutex held
+  std::size_t load(std::size_t shard) const
+  {
+    return this->Queued[shard] + this->SubmittedSinceSummary[shard];
+  }
+
+  //-----------------------------------------------------------------------------
+  //called from the subscriber threads
+  void summaryArrived(std::size_t shard, const remus::client::SummaryEvent& e)
+  {
+    boost::lock_guard<boost::mutex> lock(this->LoadMutex);
+    this->Queued[shard] = e.QueuedJobs + e.WaitingForWorkerJobs;
+    this->SubmittedSinceSummary[shard] = 0;
+  }
+
+  ShardedClient::Policy PlacementPolicy;
+  std::vector<remus::client::ServerConnection> Connections;
+  std::vector<ClientPtr> Shards;
+  std::map<boost::uint64_t, std::size_t> Ring;
+  std::atomic<std::size_t> Next;
+
+  boost::mutex IdMutex;
+  boost::uuids::random_generator IdGenerator;
+
+  //the load of each server, guarded by LoadMutex
+  boost::mutex LoadMutex;
+  std::vector<std::size_t> Queued;
+  std::vector<std::size_t> SubmittedSinceSummary;
+
+  std::vector<SubscriberPtr> Subscribers;
+};
+
+//------------------------------------------------------------------------------
+ShardedClient::ShardedClient(
+          const std::vector<remus::client::ServerConnection>& servers,
+          Policy policy):
+  Implementation( new ShardedClientImplementation(servers,
+                            std::vector<remus::client::ServerConnection>(),
+                            policy) )
+{
+}
+
+//------------------------------------------------------------------------------
+ShardedClient::ShardedClient(
+          const std::vector<remus::client::ServerConnection>& servers,
+          const std::vector<remus::client::ServerConnection>& statusChannels,
+          Policy policy):
+  Implementation( new ShardedClientImplementation(servers,
+                                                  statusChannels,
+                                                  policy) )
+{
+}
+
+//------------------------------------------------------------------------------
+ShardedClient::~ShardedClient()
+{
+}
+
+//------------------------------------------------------------------------------
+ShardedClient::Policy ShardedClient::policy() const
+{
+  return this->Implementation->policy();
+}
+
+//------------------------------------------------------------------------------
+std::size_t ShardedClient::numberOfShards() const
+{
+  return this->Implementation->size();
+}
+
+//------------------------------------------------------------------------------
+const remus::client::ServerConnection&
+ShardedClient::connection(std::size_t shard) const
+{
+  return this->Implementation->connection(shard);
+}
+
+//------------------------------------------------------------------------------
+std::size_t ShardedClient::shard(const remus::proto::Job& job) const
+{
+  const std::size_t index = decode_shard(job.id());
+  return (index < this->numberOfShards()) ? index : this->numberOfShards();
+}
+
+//------------------------------------------------------------------------------
+remus::common::MeshIOTypeSet ShardedClient::supportedIOTypes()
+{
+  //send all the requests before waiting on any of them
+  std::vector< std::future<remus::common::MeshIOTypeSet> > requests;
+  for(std::size_t i=0; i < this->numberOfShards(); ++i)
+    {
+    requests.push_back( this->Implementation->client(i).supportedIOTypes() );
+    }
+
+  remus::common::MeshIOTypeSet types;
+  for(std::size_t i=0; i < requests.size(); ++i)
+    {
+    const remus::common::MeshIOTypeSet shardTypes = requests[i].get();
+    types.insert(shardTypes.begin(), shardTypes.end());
+    }
+  return types;
+}
+
+//------------------------------------------------------------------------------
+bool ShardedClient::canMesh(const remus::common::MeshIOType& meshtypes)
+{
+  std::vector< std::future<bool> > requests;
+  for(std::size_t i=0; i < this->numberOfShards(); ++i)
+    {
+    requests.push_back( this->Implementation->client(i).canMesh(meshtypes) );
+    }
+
+  bool result = false;
+  for(std::size_t i=0; i < requests.size(); ++i)
+    {
+    //wait on every request, so no response arrives after we return
+    result = requests[i].get() || result;
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+bool ShardedClient::canMesh(const remus::proto::JobRequirements& reqs)
+{
+  std::vector< std::future<bool> > requests;
+  for(std::size_t i=0; i < this->numberOfShards(); ++i)
+    {
+    requests.push_back( this->Implementation->client(i).canMesh(reqs) );
+    }
+
+  bool result = false;
+  for(std::size_t i=0; i < requests.size(); ++i)
+    {
+    result = requests[i].get() || result;
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobRequirementsSet
+ShardedClient::retrieveRequirements( const remus::common::MeshIOType& meshtypes)
+{
+  std::vector< std::future<remus::proto::JobRequirementsSet> > requests;
+  for(std::size_t i=0; i < this->numberOfShards(); ++i)
+    {
+    requests.push_back(
+          this->Implementation->client(i).retrieveRequirements(meshtypes) );
+    }
+
+  remus::proto::JobRequirementsSet reqs;
+  for(std::size_t i=0; i < requests.size(); ++i)
+    {
+    const remus::proto::JobRequirementsSet shardReqs = requests[i].get();
+    reqs.insert(shardReqs.begin(), shardReqs.end());
+    }
+  return reqs;
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job
+ShardedClient::submitJob(const remus::proto::JobSubmission& submission)
+{
+  if(this->numberOfShards() == 0)
+    {
+    return remus::proto::make_invalidJob();
+    }
+
+  const std::size_t shard = this->Implementation->place(submission.requirements());
+  std::future<remus::proto::Job> ack;
+  this->Implementation->client(shard).submitJobWithClientId(
+                  this->Implementation->generateJobId(shard), submission, &ack);
+
+  //the server returns an invalid job if it rejected the submission
+  return ack.get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus ShardedClient::jobStatus(const remus::proto::Job& job)
+{
+  const std::size_t index = this->shard(job);
+  if(index == this->numberOfShards())
+    {
+    return remus::proto::JobStatus(job.id(),remus::INVALID_STATUS);
+    }
+  return this->Implementation->client(index).jobStatus(job).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus
+ShardedClient::waitForStatusChange(const remus::proto::Job& job,
+                                   const remus::proto::JobStatus& lastSeen,
+                                   boost::int64_t timeoutInMillisec)
+{
+  const std::size_t index = this->shard(job);
+  if(index == this->numberOfShards())
+    {
+    return remus::proto::JobStatus(job.id(),remus::INVALID_STATUS);
+    }
+  return this->Implementation->client(index).waitForStatusChange(job,
+                                                  lastSeen,
+                                                  timeoutInMillisec).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobResult
+ShardedClient::retrieveResults(const remus::proto::Job& job)
+{
+  const std::size_t index = this->shard(job);
+  if(index == this->numberOfShards())
+    {
+    return remus::proto::JobResult(job.id());
+    }
+  return this->Implementation->client(index).retrieveResults(job).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobResult
+ShardedClient::waitForResult(const remus::proto::Job& job,
+                             boost::int64_t timeoutInMillisec)
+{
+  return remus::client::detail::waitForResult(*this, job, timeoutInMillisec);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus ShardedClient::terminate(const remus::proto::Job& job)
+{
+  const std::size_t index = this->shard(job);
+  if(index == this->numberOfShards())
+    {
+    return remus::proto::JobStatus(job.id(),remus::INVALID_STATUS);
+    }
+  return this->Implementation->client(index).terminate(job).get();
+}
+
+}
+}
@@ -0,0 +1,163 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_client_ShardedClient_h
+#define remus_client_ShardedClient_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/client/ServerConnection.h>
+
+#include <remus/common/MeshIOType.h>
+
+//Clients include everything from proto, so that
+//users don't need as many includes
+#include <remus/proto/Job.h>
+#include <remus/proto/JobRequirements.h>
+#include <remus/proto/JobResult.h>
+#include <remus/proto/JobStatus.h>
+#include <remus/proto/JobSubmission.h>
+
+//included for export symbols
+#include <remus/client/ClientExports.h>
+
+#include <vector>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+//The ShardedClient class spreads job submissions over multiple remus
+//servers, and has the same blocking interface as remus::client::Client.
+//
+//Each submission is placed on a server ( a shard ) by the placement policy.
+//The job id is generated by the ShardedClient, and the index of the shard
+//is encoded in the last two bytes of the id. This allows the status, result
+//and terminate calls to be routed to the right server with nothing but the
+//job, so jobs can be handed to any other ShardedClient that was constructed
+//with the same list of servers in the same order.
+//
+//All the servers are expected to be able to mesh the jobs that are submitted
+//to them. When the servers have different workers, use CONSISTENT_HASH so
+//that each set of requirements always goes to the same server.
+//
+//All methods are safe to call from multiple threads.
+namespace remus{
+namespace client{
+
+class REMUSCLIENT_EXPORT ShardedClient
+{
+public:
+  enum Policy
+  {
+    //submissions go to each server in turn
+    ROUND_ROBIN,
+    //submissions with the same requirements always go to the same server,
+    //and adding a server only moves a small portion of the requirements
+    CONSISTENT_HASH,
+    //submissions go to the server with the fewest queued jobs, based on the
+    //summaries the servers publish on their status channel
+    LEAST_QUEUED
+  };
+
+  //connect to all the given servers. The servers are numbered by the
+  //order they are given in. LEAST_QUEUED without the status connections
+  //only knows about the jobs that this client has submitted.
+  explicit ShardedClient(const std::vector<remus::client::ServerConnection>& servers,
+                         Policy policy = ROUND_ROBIN);
+
+  //connect to all the given servers, and the status channel of each
+  //server, which is used to track the queue depth of the servers
+  ShardedClient(const std::vector<remus::client::ServerConnection>& servers,
+                const std::vector<remus::client::ServerConnection>& statusChannels,
+                Policy policy = LEAST_QUEUED);
+
+  ~ShardedClient();
+
+  Policy policy() const;
+
+  //returns the number of servers that jobs are spread over
+  std::size_t numberOfShards() const;
+
+  //return the connection info of a shard
+  const remus::client::ServerConnection& connection(std::size_t shard) const;
+
+  //returns the shard that a job was submitted to. Returns numberOfShards()
+  //if the job doesn't map to a shard of this client
+  std::size_t shard(const remus::proto::Job& job) const;
+
+  //Submit a request to all the servers to see what MeshIOTypes are supported
+  remus::common::MeshIOTypeSet supportedIOTypes();
+
+  //Submit a request to all the servers to see if any of them supports
+  //the requested input and output mesh types
+  bool canMesh(const remus::common::MeshIOType& meshtypes);
+
+  //Submit a request to all the servers to see if any of them supports
+  //the exact requested requirements
+  bool canMesh(const remus::proto::JobRequirements& requirements);
+
+  //returns the requirements of all servers that support the given types
+  remus::proto::JobRequirementsSet
+  retrieveRequirements( const remus::common::MeshIOType& meshtypes );
+
+  //Submit a job to the server picked by the placement policy.
+  remus::proto::Job submitJob(const remus::proto::JobSubmission& submission);
+
+  //Given a remus Job object returns the status of the job
+  remus::proto::JobStatus jobStatus(const remus::proto::Job& job);
+
+  //Blocks until the status of the job differs from lastSeen, or until
+  //timeoutInMillisec has passed.
+  //See Client::waitForStatusChange for more details
+  remus::proto::JobStatus waitForStatusChange(const remus::proto::Job& job,
+                                              const remus::proto::JobStatus& lastSeen,
+                                              boost::int64_t timeoutInMillisec);
+
+  //Return job result of of a give job
+  remus::proto::JobResult retrieveResults(const remus::proto::Job& job);
+
+  //Blocks until the job has finished and returns the result.
+  //See Client::waitForResult for more details
+  remus::proto::JobResult waitForResult(const remus::proto::Job& job,
+                                        boost::int64_t timeoutInMillisec);
+
+  //attempts to terminate a given job on the server it was submitted to.
+  //See Client::terminate for more details
+  remus::proto::JobStatus terminate(const remus::proto::Job& job);
+
+private:
+  //explicitly state the client doesn't support copy or move semantics
+  ShardedClient(const ShardedClient&);
+  void operator=(const ShardedClient&);
+
+  class ShardedClientImplementation;
+  boost::scoped_ptr<ShardedClientImplementation> Implementation;
+};
+
+}
+
+typedef remus::client::ShardedClient ShardedClient;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
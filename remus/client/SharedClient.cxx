@@ -0,0 +1,186 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/SharedClient.h>
+
+#include <remus/client/AsyncClient.h>
+#include <remus/client/detail/WaitForResult.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/shared_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace remus{
+namespace client{
+
+//------------------------------------------------------------------------------
+class SharedClient::SharedClientImplementation
+{
+public:
+  SharedClientImplementation(const remus::client::ServerConnection& conn,
+                             std::size_t numberOfConnections):
+    Connections(),
+    Next(0)
+  {
+    numberOfConnections = std::max<std::size_t>(1, numberOfConnections);
+    for(std::size_t i=0; i < numberOfConnections; ++i)
+      {
+      this->Connections.push_back(
+          boost::shared_ptr<remus::client::AsyncClient>(new AsyncClient(conn)));
+      }
+  }
+
+  //the AsyncClient is thread safe, so all we need to do is spread
+  //the calling threads over the connections
+  remus::client::AsyncClient& connection()
+  {
+    const std::size_t index = this->Next.fetch_add(1, std::memory_order_relaxed);
+    return *(this->Connections[index % this->Connections.size()]);
+  }
+
+  std::size_t size() const { return this->Connections.size(); }
+
+private:
+  std::vector< boost::shared_ptr<remus::client::AsyncClient> > Connections;
+  std::atomic<std::size_t> Next;
+};
+
+//------------------------------------------------------------------------------
+SharedClient::SharedClient(const remus::client::ServerConnection &conn,
+                           std::size_t numberOfConnections):
+  ConnectionInfo(conn),
+  Implementation( new SharedClientImplementation(conn, numberOfConnections) )
+{
+}
+
+//------------------------------------------------------------------------------
+SharedClient::~SharedClient()
+{
+}
+
+//------------------------------------------------------------------------------
+const remus::client::ServerConnection& SharedClient::connection() const
+{
+  return this->ConnectionInfo;
+}
+
+//------------------------------------------------------------------------------
+std::size_t SharedClient::numberOfConnections() const
+{
+  return this->Implementation->size();
+}
+
+//------------------------------------------------------------------------------
+remus::common::MeshIOTypeSet SharedClient::supportedIOTypes()
+{
+  return this->Implementation->connection().supportedIOTypes().get();
+}
+
+//------------------------------------------------------------------------------
+bool SharedClient::canMesh(const remus::common::MeshIOType& meshtypes)
+{
+  return this->Implementation->connection().canMesh(meshtypes).get();
+}
+
+//------------------------------------------------------------------------------
+bool SharedClient::canMesh(const remus::proto::JobRequirements& reqs)
+{
+  return this->Implementation->connection().canMesh(reqs).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobRequirementsSet
+SharedClient::retrieveRequirements( const remus::common::MeshIOType& meshtypes)
+{
+  return this->Implementation->connection().retrieveRequirements(meshtypes).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job
+SharedClient::submitJob(const remus::proto::JobSubmission& submission)
+{
+  return this->Implementation->connection().submitJob(submission).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus SharedClient::jobStatus(const remus::proto::Job& job)
+{
+  return this->Implementation->connection().jobStatus(job).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus
+SharedClient::waitForStatusChange(const remus::proto::Job& job,
+                                  const remus::proto::JobStatus& lastSeen,
+                                  boost::int64_t timeoutInMillisec)
+{
+  return this->Implementation->connection().waitForStatusChange(job,
+                                                  lastSeen,
+                                                  timeoutInMillisec).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobResult
+SharedClient::retrieveResults(const remus::proto::Job& job)
+{
+  return this->Implementation->connection().retrieveResults(job).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobResult
+SharedClient::waitForResult(const remus::proto::Job& job,
+                            boost::int64_t timeoutInMillisec)
+{
+  return remus::client::detail::waitForResult(*this, job, timeoutInMillisec);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus SharedClient::terminate(const remus::proto::Job& job)
+{
+  return this->Implementation->connection().terminate(job).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArray
+SharedClient::submitJobArray(const remus::proto::JobArraySubmission& submission)
+{
+  return this->Implementation->connection().submitJobArray(submission).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArrayStatus
+SharedClient::jobArrayStatus(const remus::proto::JobArray& array)
+{
+  return this->Implementation->connection().jobArrayStatus(array).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArrayStatus
+SharedClient::terminate(const remus::proto::JobArray& array)
+{
+  return this->Implementation->connection().terminate(array).get();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobListing
+SharedClient::listJobs(const remus::proto::JobListingRequest& request)
+{
+  return this->Implementation->connection().listJobs(request).get();
+}
+
+}
+}
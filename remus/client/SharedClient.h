@@ -0,0 +1,161 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_client_SharedClient_h
+#define remus_client_SharedClient_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/client/ServerConnection.h>
+
+#include <remus/common/MeshIOType.h>
+
+//Clients include everything from proto, so that
+//users don't need as many includes
+#include <remus/proto/Job.h>
+#include <remus/proto/JobArray.h>
+#include <remus/proto/JobListing.h>
+#include <remus/proto/JobRequirements.h>
+#include <remus/proto/JobResult.h>
+#include <remus/proto/JobStatus.h>
+#include <remus/proto/JobSubmission.h>
+
+//included for export symbols
+#include <remus/client/ClientExports.h>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+//The SharedClient class has the same blocking interface as
+//remus::client::Client, but a single instance can be used by any number of
+//threads at once without external locking.
+//
+//Requests are sent over a small pool of AsyncClient connections, each of
+//which is a DEALER socket that pipelines requests from every calling thread.
+//A calling thread only blocks on its own response, so the request throughput
+//grows with the number of calling threads instead of being serialized
+//behind a single REQ socket. Calling threads are spread over the
+//connections round robin.
+namespace remus{
+namespace client{
+
+class REMUSCLIENT_EXPORT SharedClient
+{
+public:
+  //connect to a given host on a given port with tcp, using the given number
+  //of connections. A single connection is enough for most applications,
+  //more connections only help when the I/O thread of a connection becomes
+  //the bottleneck.
+  explicit SharedClient(const remus::client::ServerConnection& conn,
+                        std::size_t numberOfConnections = 1);
+
+  //closes all connections. No thread can be inside a call
+  //of the SharedClient when it is destroyed
+  ~SharedClient();
+
+  //return the connection info that was used to connect to the
+  //remus server
+  const remus::client::ServerConnection& connection() const;
+
+  //returns the number of connections to the server
+  std::size_t numberOfConnections() const;
+
+  //Submit a request to the server to see what MeshIOTypes are supported
+  remus::common::MeshIOTypeSet supportedIOTypes();
+
+  //Submit a request to the server to see if the server supports
+  //the requested input and output mesh types
+  bool canMesh(const remus::common::MeshIOType& meshtypes);
+
+  //Submit a request to the server to see if the server supports
+  //the exact requested requirements
+  bool canMesh(const remus::proto::JobRequirements& requirements);
+
+  //submit a request to the server to see if the server supports
+  //the request input and output mesh types. If the server does support
+  //the given types, return a collection of JobRequirements
+  remus::proto::JobRequirementsSet
+  retrieveRequirements( const remus::common::MeshIOType& meshtypes );
+
+  //Submit a job to the server. The job submission has a JobData and
+  //a JobRequirements component
+  remus::proto::Job submitJob(const remus::proto::JobSubmission& submission);
+
+  //Given a remus Job object returns the status of the job
+  remus::proto::JobStatus jobStatus(const remus::proto::Job& job);
+
+  //Blocks until the status of the job differs from lastSeen, or until
+  //timeoutInMillisec has passed.
+  //See Client::waitForStatusChange for more details
+  remus::proto::JobStatus waitForStatusChange(const remus::proto::Job& job,
+                                              const remus::proto::JobStatus& lastSeen,
+                                              boost::int64_t timeoutInMillisec);
+
+  //Return job result of of a give job
+  remus::proto::JobResult retrieveResults(const remus::proto::Job& job);
+
+  //Blocks until the job has finished and returns the result.
+  //See Client::waitForResult for more details
+  remus::proto::JobResult waitForResult(const remus::proto::Job& job,
+                                        boost::int64_t timeoutInMillisec);
+
+  //attempts to terminate a given job, will kill the job if the job hasn't
+  //started. If the job has been finished and the results
+  //are on the server the results will be deleted. If the job is in process
+  //this will be unable to kill the job.
+  remus::proto::JobStatus terminate(const remus::proto::Job& job);
+
+  //Submit a job array to the server.
+  //See Client::submitJobArray for more details
+  remus::proto::JobArray
+  submitJobArray(const remus::proto::JobArraySubmission& submission);
+
+  //returns the status of every element of a job array
+  remus::proto::JobArrayStatus jobArrayStatus(const remus::proto::JobArray& array);
+
+  //attempts to terminate every element of a job array.
+  //See Client::terminate for more details
+  remus::proto::JobArrayStatus terminate(const remus::proto::JobArray& array);
+
+  //returns a single page of the jobs the server holds.
+  //See Client::listJobs for more details
+  remus::proto::JobListing listJobs(const remus::proto::JobListingRequest& request);
+
+private:
+  //explicitly state the client doesn't support copy or move semantics
+  SharedClient(const SharedClient&);
+  void operator=(const SharedClient&);
+
+  remus::client::ServerConnection ConnectionInfo;
+
+  class SharedClientImplementation;
+  boost::scoped_ptr<SharedClientImplementation> Implementation;
+};
+
+}
+
+typedef remus::client::SharedClient SharedClient;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
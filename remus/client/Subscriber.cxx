@@ -0,0 +1,658 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/Subscriber.h>
+
+#include <remus/common/ServiceTypes.h>
+#include <remus/proto/BinaryEvent.h>
+#include <remus/proto/zmqHelper.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include "cJSON.h"
+
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+//the keys the server publishes errors and shutdown under
+static const std::string error_key = "error:server";
+static const std::string stop_key = "stop";
+static const std::string summary_key = "summary:server";
+
+//------------------------------------------------------------------------------
+//the worker terminated event is published using the service type name,
+//not the event type name
+std::string worker_event_name(remus::proto::workevents::EVENT_TYPE type)
+{
+  if(type == remus::proto::workevents::TERMINATED_WORKER)
+    {
+    return remus::to_string(remus::TERMINATE_WORKER);
+    }
+  return remus::proto::workevents::to_string(type);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::jobevents::EVENT_TYPE to_jobEventType(const std::string& name)
+{
+  using namespace remus::proto::jobevents;
+  for(int i=1; i <= static_cast<int>(ASSIGNED_TO_WORKER); ++i)
+    {
+    EVENT_TYPE type = static_cast<EVENT_TYPE>(i);
+    if(to_string(type) == name)
+      {
+      return type;
+      }
+    }
+  return remus::proto::jobevents::INVALID;
+}
+
+//------------------------------------------------------------------------------
+remus::proto::workevents::EVENT_TYPE to_workerEventType(const std::string& name)
+{
+  using namespace remus::proto::workevents;
+  for(int i=1; i <= static_cast<int>(TERMINATED_WORKER); ++i)
+    {
+    EVENT_TYPE type = static_cast<EVENT_TYPE>(i);
+    if(worker_event_name(type) == name)
+      {
+      return type;
+      }
+    }
+  return remus::proto::workevents::INVALID;
+}
+
+//------------------------------------------------------------------------------
+std::string json_string(remus::cJSON* root, const char* name)
+{
+  remus::cJSON* item = remus::cJSON_GetObjectItem(root, name);
+  if(item && item->valuestring)
+    {
+    return std::string(item->valuestring);
+    }
+  return std::string();
+}
+
+//------------------------------------------------------------------------------
+double json_number(remus::cJSON* root, const char* name)
+{
+  remus::cJSON* item = remus::cJSON_GetObjectItem(root, name);
+  return item ? item->valuedouble : 0.0;
+}
+
+//------------------------------------------------------------------------------
+std::size_t json_count(remus::cJSON* root, const char* name)
+{
+  const double value = json_number(root, name);
+  return value > 0 ? static_cast<std::size_t>(value) : 0;
+}
+
+//------------------------------------------------------------------------------
+boost::uuids::uuid to_uuid(const std::string& str)
+{
+  boost::uuids::uuid id = boost::uuids::nil_uuid();
+  if(!str.empty())
+    {
+    std::istringstream buffer(str);
+    buffer >> id;
+    }
+  return id;
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobProgress to_progress(const std::string& str)
+{
+  remus::proto::JobProgress progress;
+  if(!str.empty())
+    {
+    std::istringstream buffer(str);
+    buffer >> progress;
+    }
+  return progress;
+}
+
+//------------------------------------------------------------------------------
+//build the progress through the serialized form, as the JobProgress
+//constructors clamp the value
+remus::proto::JobProgress to_progress(int value, const std::string& message)
+{
+  std::ostringstream buffer;
+  buffer << value << '\n' << message.size() << '\n' << message << '\n';
+  return to_progress(buffer.str());
+}
+
+//------------------------------------------------------------------------------
+//split a published key of the form category:type:id
+bool split_key(const std::string& key, std::string& category,
+               std::string& type, std::string& id)
+{
+  const std::string::size_type first = key.find(':');
+  if(first == std::string::npos)
+    {
+    return false;
+    }
+  const std::string::size_type second = key.find(':', first+1);
+  if(second == std::string::npos)
+    {
+    return false;
+    }
+  category = key.substr(0, first);
+  type = key.substr(first+1, second-first-1);
+  id = key.substr(second+1);
+  return true;
+}
+
+}
+
+namespace remus{
+namespace client{
+
+//-----------------------------------------------------------------------------
+class Subscriber::SubscriberImplementation
+{
+  boost::shared_ptr<zmq::context_t> Context;
+
+  //the socket that the calling threads use to hand subscription changes
+  //to the background thread, as the SUB socket is owned by that thread.
+  //Guarded by ControlMutex
+  zmq::socket_t Control;
+  boost::mutex ControlMutex;
+
+  //all the callbacks, guarded by CallbackMutex
+  boost::mutex CallbackMutex;
+  Subscriber::JobCallback JobFunc;
+  Subscriber::WorkerCallback WorkerFunc;
+  Subscriber::SummaryCallback SummaryFunc;
+  Subscriber::ErrorCallback ErrorFunc;
+  Subscriber::StopCallback StopFunc;
+
+  //state to tell when we should stop polling
+  bool ContinuePolling;
+
+  boost::scoped_ptr<boost::thread> PollingThread;
+
+public:
+//-----------------------------------------------------------------------------
+SubscriberImplementation(const remus::client::ServerConnection& conn):
+  Context(conn.context()),
+  Control(*Context, ZMQ_PAIR),
+  ControlMutex(),
+  CallbackMutex(),
+  JobFunc(),
+  WorkerFunc(),
+  SummaryFunc(),
+  ErrorFunc(),
+  StopFunc(),
+  ContinuePolling(true),
+  PollingThread()
+{
+  //use an auto generated channel name, this allows multiple subscribers to
+  //share the same context. We have to bind before the thread connects
+  boost::uuids::random_generator generator;
+  const zmq::socketInfo<zmq::proto::inproc> channel(
+                                    boost::uuids::to_string(generator()));
+  zmq::bindToAddress(this->Control, channel);
+
+  this->PollingThread.reset(
+      new boost::thread( &SubscriberImplementation::pollForEvents,
+                         this,
+                         conn.endpoint(),
+                         channel) );
+}
+
+//-----------------------------------------------------------------------------
+~SubscriberImplementation()
+{
+  this->ContinuePolling = false;
+  this->PollingThread->join();
+}
+
+//-----------------------------------------------------------------------------
+void subscribe(const std::string& prefix)
+{
+  this->sendControl('+', prefix);
+}
+
+//-----------------------------------------------------------------------------
+void unsubscribe(const std::string& prefix)
+{
+  this->sendControl('-', prefix);
+}
+
+//-----------------------------------------------------------------------------
+void onJobEvent(const Subscriber::JobCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  this->JobFunc = callback;
+}
+
+//-----------------------------------------------------------------------------
+void onWorkerEvent(const Subscriber::WorkerCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  this->WorkerFunc = callback;
+}
+
+//-----------------------------------------------------------------------------
+void onSummary(const Subscriber::SummaryCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  this->SummaryFunc = callback;
+}
+
+//-----------------------------------------------------------------------------
+void onError(const Subscriber::ErrorCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  this->ErrorFunc = callback;
+}
+
+//-----------------------------------------------------------------------------
+void onStop(const Subscriber::StopCallback& callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  this->StopFunc = callback;
+}
+
+private:
+//-----------------------------------------------------------------------------
+void sendControl(char action, const std::string& prefix)
+{
+  zmq::message_t msg(prefix.size()+1);
+  char* data = static_cast<char*>(msg.data());
+  data[0] = action;
+  std::memcpy(data+1, prefix.data(), prefix.size());
+
+  boost::lock_guard<boost::mutex> lock(this->ControlMutex);
+  zmq::send_harder(this->Control, msg);
+}
+
+//-----------------------------------------------------------------------------
+void pollForEvents(std::string endpoint,
+                   zmq::socketInfo<zmq::proto::inproc> channel)
+{
+  //since this is threaded, we need to make sure that zmq_socket and
+  //zmq_close will execute from inside the thread address space so that
+  //when the thread is joined everything cleans up in the correct order
+  zmq::socket_t events(*this->Context, ZMQ_SUB);
+  zmq::socket_t control(*this->Context, ZMQ_PAIR);
+
+  zmq::connectToAddress(events, endpoint);
+  zmq::connectToAddress(control, channel);
+
+  //we always want to know when the server has an error or is stopping
+  events.setsockopt(ZMQ_SUBSCRIBE, error_key.data(), error_key.size());
+  events.setsockopt(ZMQ_SUBSCRIBE, stop_key.data(), stop_key.size());
+
+  zmq::pollitem_t items[2] = { { control,  0, ZMQ_POLLIN, 0 },
+                               { events,  0, ZMQ_POLLIN, 0 } };
+  while( this->ContinuePolling )
+    {
+    zmq::poll_safely(items,2,250);
+    if(items[0].revents & ZMQ_POLLIN)
+      {
+      zmq::message_t msg;
+      zmq::recv_harder(control, &msg);
+      if(msg.size() > 0)
+        {
+        const char* data = static_cast<const char*>(msg.data());
+        const int option = (data[0] == '+') ? ZMQ_SUBSCRIBE : ZMQ_UNSUBSCRIBE;
+        events.setsockopt(option, data+1, msg.size()-1);
+        }
+      }
+    if(items[1].revents & ZMQ_POLLIN)
+      {
+      //every event is a key frame followed by the data frame
+      zmq::message_t keyMsg, dataMsg;
+      zmq::recv_harder(events, &keyMsg);
+      zmq::recv_harder(events, &dataMsg);
+
+      const std::string key(static_cast<const char*>(keyMsg.data()),
+                            keyMsg.size());
+      const std::string data(static_cast<const char*>(dataMsg.data()),
+                             dataMsg.size());
+      this->dispatch(key, data);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void dispatch(const std::string& key, const std::string& data)
+{
+  //copy the callbacks so that we don't hold the lock while calling them,
+  //which allows callbacks to change the subscriptions and callbacks
+  Subscriber::JobCallback jobFunc;
+  Subscriber::WorkerCallback workerFunc;
+  Subscriber::SummaryCallback summaryFunc;
+  Subscriber::ErrorCallback errorFunc;
+  Subscriber::StopCallback stopFunc;
+  {
+  boost::lock_guard<boost::mutex> lock(this->CallbackMutex);
+  jobFunc = this->JobFunc;
+  workerFunc = this->WorkerFunc;
+  summaryFunc = this->SummaryFunc;
+  errorFunc = this->ErrorFunc;
+  stopFunc = this->StopFunc;
+  }
+
+  if(key == stop_key)
+    {
+    if(stopFunc) { stopFunc(); }
+    return;
+    }
+  else if(key == error_key)
+    {
+    if(errorFunc) { errorFunc(data); }
+    return;
+    }
+  else if(key == summary_key)
+    {
+    if(summaryFunc) { this->dispatchSummary(data, summaryFunc); }
+    return;
+    }
+
+  const std::string& binary = remus::proto::binary_event_prefix;
+  if(key.compare(0, binary.size(), binary) == 0)
+    {
+    this->dispatchBinary(data, jobFunc, workerFunc);
+    return;
+    }
+
+  std::string category, type, id;
+  if(!split_key(key, category, type, id))
+    {
+    return;
+    }
+
+  remus::cJSON *root = remus::cJSON_Parse(data.c_str());
+  if(!root)
+    {
+    return;
+    }
+
+  if(category == "job" && jobFunc)
+    {
+    JobEvent event;
+    event.Type = to_jobEventType(type);
+    event.JobId = to_uuid(id);
+    event.WorkerId = json_string(root, "worker_id");
+    event.Status = remus::INVALID_STATUS;
+    if(event.Type == remus::proto::jobevents::TERMINATED)
+      {
+      event.Status = remus::to_statusType(json_string(root, "last_status_type"));
+      event.Progress = to_progress(json_string(root, "last_progress"));
+      }
+    else if(event.Type == remus::proto::jobevents::JOB_STATUS)
+      {
+      event.Status = remus::to_statusType(json_string(root, "status_type"));
+      event.Progress = to_progress(json_string(root, "progress"));
+      }
+    else if(event.Type == remus::proto::jobevents::EXPIRED)
+      {
+      event.Status = remus::EXPIRED;
+      }
+    jobFunc(event);
+    }
+  else if(category == "worker" && workerFunc)
+    {
+    WorkerEvent event;
+    event.Type = to_workerEventType(type);
+    event.WorkerId = id;
+    event.JobId = to_uuid(json_string(root, "job_id"));
+    event.Responsive = json_string(root, "state") == "Responsive";
+    workerFunc(event);
+    }
+
+  remus::cJSON_Delete(root);
+}
+
+//-----------------------------------------------------------------------------
+void dispatchSummary(const std::string& data,
+                     const Subscriber::SummaryCallback& summaryFunc)
+{
+  remus::cJSON *root = remus::cJSON_Parse(data.c_str());
+  if(!root)
+    {
+    return;
+    }
+
+  SummaryEvent event;
+  event.IntervalMillisec =
+              static_cast<boost::int64_t>(json_number(root, "interval_ms"));
+  event.QueuedJobs = json_count(root, "queued");
+  event.WaitingForWorkerJobs = json_count(root, "waiting_for_worker");
+  event.ActiveJobs = 0;
+  remus::cJSON* workers = remus::cJSON_GetObjectItem(root, "workers");
+  const int numWorkers = workers ? remus::cJSON_GetArraySize(workers) : 0;
+  for(int i=0; i < numWorkers; ++i)
+    {
+    event.ActiveJobs += json_count(remus::cJSON_GetArrayItem(workers, i),
+                                   "active_jobs");
+    }
+  event.Dispatched = json_count(root, "dispatched");
+  event.Finished = json_count(root, "finished");
+  event.Failed = json_count(root, "failed");
+  event.Expired = json_count(root, "expired");
+  event.DispatchRate = json_number(root, "dispatch_rate");
+  event.FinishRate = json_number(root, "finish_rate");
+  remus::cJSON_Delete(root);
+
+  summaryFunc(event);
+}
+
+//-----------------------------------------------------------------------------
+void dispatchBinary(const std::string& data,
+                    const Subscriber::JobCallback& jobFunc,
+                    const Subscriber::WorkerCallback& workerFunc)
+{
+  remus::proto::BinaryEvent binary;
+  if(!remus::proto::from_binary(data.data(), data.size(), binary))
+    {
+    return;
+    }
+
+  if(binary.EventCategory == remus::proto::BinaryEvent::JOB && jobFunc)
+    {
+    JobEvent event;
+    event.Type = static_cast<remus::proto::jobevents::EVENT_TYPE>(binary.Type);
+    event.JobId = binary.JobId;
+    event.WorkerId = binary.WorkerId;
+    event.Status = binary.Status;
+    event.Progress = to_progress(binary.ProgressValue, binary.ProgressMessage);
+    jobFunc(event);
+    }
+  else if(binary.EventCategory == remus::proto::BinaryEvent::WORKER && workerFunc)
+    {
+    WorkerEvent event;
+    event.Type = static_cast<remus::proto::workevents::EVENT_TYPE>(binary.Type);
+    event.WorkerId = binary.WorkerId;
+    event.JobId = binary.JobId;
+    event.Responsive = binary.Responsive;
+    workerFunc(event);
+    }
+}
+
+};
+
+//------------------------------------------------------------------------------
+Subscriber::Subscriber(const remus::client::ServerConnection &statusConn,
+                       Encoding encoding):
+  ConnectionInfo(statusConn),
+  EventEncoding(encoding),
+  Implementation( new SubscriberImplementation(statusConn) )
+{
+}
+
+//------------------------------------------------------------------------------
+Subscriber::~Subscriber()
+{
+}
+
+//------------------------------------------------------------------------------
+const remus::client::ServerConnection& Subscriber::connection() const
+{
+  return this->ConnectionInfo;
+}
+
+//------------------------------------------------------------------------------
+std::string Subscriber::topic(const std::string& key) const
+{
+  if(this->EventEncoding == BINARY)
+    {
+    return remus::proto::binary_event_prefix + key;
+    }
+  return key;
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::onJobEvent(const JobCallback& callback)
+{
+  this->Implementation->onJobEvent(callback);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::onWorkerEvent(const WorkerCallback& callback)
+{
+  this->Implementation->onWorkerEvent(callback);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::onSummary(const SummaryCallback& callback)
+{
+  this->Implementation->onSummary(callback);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::onError(const ErrorCallback& callback)
+{
+  this->Implementation->onError(callback);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::onStop(const StopCallback& callback)
+{
+  this->Implementation->onStop(callback);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchJob(const remus::proto::Job& job)
+{
+  using namespace remus::proto::jobevents;
+  for(int i=1; i <= static_cast<int>(ASSIGNED_TO_WORKER); ++i)
+    {
+    this->watchJob(job, static_cast<EVENT_TYPE>(i));
+    }
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchJob(const remus::proto::Job& job,
+                          remus::proto::jobevents::EVENT_TYPE type)
+{
+  const std::string prefix = "job:" +
+                             remus::proto::jobevents::to_string(type) + ":" +
+                             boost::uuids::to_string(job.id());
+  this->Implementation->subscribe(this->topic(prefix));
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::unwatchJob(const remus::proto::Job& job)
+{
+  using namespace remus::proto::jobevents;
+  for(int i=1; i <= static_cast<int>(ASSIGNED_TO_WORKER); ++i)
+    {
+    const std::string prefix = "job:" +
+                               to_string(static_cast<EVENT_TYPE>(i)) + ":" +
+                               boost::uuids::to_string(job.id());
+    this->Implementation->unsubscribe(this->topic(prefix));
+    }
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchJobEvents(remus::proto::jobevents::EVENT_TYPE type)
+{
+  //the trailing separator makes sure we don't match event types
+  //that share a common prefix
+  const std::string prefix = "job:" +
+                             remus::proto::jobevents::to_string(type) + ":";
+  this->Implementation->subscribe(this->topic(prefix));
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchWorker(const std::string& workerId)
+{
+  using namespace remus::proto::workevents;
+  for(int i=1; i <= static_cast<int>(TERMINATED_WORKER); ++i)
+    {
+    const EVENT_TYPE type = static_cast<EVENT_TYPE>(i);
+    if(type != NOT_USED_1 && type != NOT_USED_4)
+      {
+      this->Implementation->subscribe(
+          this->topic("worker:" + worker_event_name(type) + ":" + workerId));
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::unwatchWorker(const std::string& workerId)
+{
+  using namespace remus::proto::workevents;
+  for(int i=1; i <= static_cast<int>(TERMINATED_WORKER); ++i)
+    {
+    const EVENT_TYPE type = static_cast<EVENT_TYPE>(i);
+    if(type != NOT_USED_1 && type != NOT_USED_4)
+      {
+      this->Implementation->unsubscribe(
+          this->topic("worker:" + worker_event_name(type) + ":" + workerId));
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchWorkerEvents(remus::proto::workevents::EVENT_TYPE type)
+{
+  this->Implementation->subscribe(
+      this->topic("worker:" + worker_event_name(type) + ":"));
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchSummaries()
+{
+  //summaries only come in the JSON form
+  this->Implementation->subscribe(summary_key);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::unwatchSummaries()
+{
+  this->Implementation->unsubscribe(summary_key);
+}
+
+//------------------------------------------------------------------------------
+void Subscriber::watchEverything()
+{
+  //we don't subscribe to the empty prefix, as that would give us
+  //every event in both the JSON and binary form
+  this->Implementation->subscribe(this->topic("job:"));
+  this->Implementation->subscribe(this->topic("worker:"));
+  this->watchSummaries();
+}
+
+}
+}
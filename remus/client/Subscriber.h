@@ -0,0 +1,197 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_client_Subscriber_h
+#define remus_client_Subscriber_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/client/ServerConnection.h>
+
+#include <remus/common/StatusTypes.h>
+#include <remus/proto/EventTypes.h>
+#include <remus/proto/Job.h>
+#include <remus/proto/JobProgress.h>
+
+//included for export symbols
+#include <remus/client/ClientExports.h>
+
+#include <functional>
+#include <string>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus{
+namespace client{
+
+//An event about a job that the server published on the status channel
+struct JobEvent
+{
+  remus::proto::jobevents::EVENT_TYPE Type;
+  boost::uuids::uuid JobId;
+
+  //empty when the job isn't assigned to a worker
+  std::string WorkerId;
+
+  //only filled in for JOB_STATUS, TERMINATED and EXPIRED events. For
+  //TERMINATED events this is the last status before the job was terminated
+  remus::STATUS_TYPE Status;
+  remus::proto::JobProgress Progress;
+};
+
+//An event about a worker that the server published on the status channel
+struct WorkerEvent
+{
+  remus::proto::workevents::EVENT_TYPE Type;
+  std::string WorkerId;
+
+  //nil unless the event is about a job the worker has
+  boost::uuids::uuid JobId;
+
+  //only meaningful for WORKER_STATE events
+  bool Responsive;
+};
+
+//A periodic summary of the whole server, see Server::summaryInterval
+struct SummaryEvent
+{
+  //length of the interval the interval counts and rates cover
+  boost::int64_t IntervalMillisec;
+
+  //jobs waiting in the queue, and jobs that a worker has been started for
+  std::size_t QueuedJobs;
+  std::size_t WaitingForWorkerJobs;
+
+  //QUEUED or IN_PROGRESS jobs that have been given to a worker
+  std::size_t ActiveJobs;
+
+  //counts for the interval
+  std::size_t Dispatched;
+  std::size_t Finished;
+  std::size_t Failed;
+  std::size_t Expired;
+
+  //jobs per second for the interval
+  double DispatchRate;
+  double FinishRate;
+};
+
+//The Subscriber class listens to the status channel of a remus server, and
+//decodes the published events into JobEvent and WorkerEvent structs.
+//
+//The server publishes every event under a key of the form
+//job:<event type>:<job id> or worker:<event type>:<worker id>. All the watch
+//methods translate into zmq subscriptions on those key prefixes, so events
+//that nobody is watching are filtered out before they reach the subscriber.
+//
+//Events can be received either in the JSON form, or in the compact
+//binary form ( see remus::proto::BinaryEvent ) which is cheaper for both
+//the server and the subscriber. Summaries are always received in the
+//JSON form, as they are only published every so often.
+//
+//Callbacks are invoked from a background thread that the Subscriber owns,
+//so they must be thread safe with respect to the rest of the application.
+//All methods are safe to call from multiple threads.
+class REMUSCLIENT_EXPORT Subscriber
+{
+public:
+  typedef std::function<void(const remus::client::JobEvent&)> JobCallback;
+  typedef std::function<void(const remus::client::WorkerEvent&)> WorkerCallback;
+  typedef std::function<void(const remus::client::SummaryEvent&)> SummaryCallback;
+  typedef std::function<void(const std::string&)> ErrorCallback;
+  typedef std::function<void()> StopCallback;
+
+  enum Encoding { JSON, BINARY };
+
+  //connect to the status channel of a server. The connection needs to
+  //be to the status port of the server, not the client port.
+  explicit Subscriber(const remus::client::ServerConnection& statusConn,
+                      Encoding encoding = JSON);
+
+  //stops the background thread, no callbacks will be invoked after
+  //the destructor returns
+  ~Subscriber();
+
+  //return the connection info that was used to connect to the
+  //remus server status channel
+  const remus::client::ServerConnection& connection() const;
+
+  //set the function to call when a job or worker event arrives. Passing
+  //an empty function will stop events of that kind from being delivered
+  void onJobEvent(const JobCallback& callback);
+  void onWorkerEvent(const WorkerCallback& callback);
+  void onSummary(const SummaryCallback& callback);
+
+  //set the function to call when the server publishes an error, or
+  //tells subscribers that it is shutting down
+  void onError(const ErrorCallback& callback);
+  void onStop(const StopCallback& callback);
+
+  //watch every event of a single job, or a single event type of a job
+  void watchJob(const remus::proto::Job& job);
+  void watchJob(const remus::proto::Job& job,
+                remus::proto::jobevents::EVENT_TYPE type);
+  void unwatchJob(const remus::proto::Job& job);
+
+  //watch an event type for all jobs
+  void watchJobEvents(remus::proto::jobevents::EVENT_TYPE type);
+
+  //watch every event of a single worker, using the worker id
+  //that is reported in WorkerEvent::WorkerId
+  void watchWorker(const std::string& workerId);
+  void unwatchWorker(const std::string& workerId);
+
+  //watch an event type for all workers
+  void watchWorkerEvents(remus::proto::workevents::EVENT_TYPE type);
+
+  //watch the periodic summaries of the server
+  void watchSummaries();
+  void unwatchSummaries();
+
+  //receive every event the server publishes
+  void watchEverything();
+
+private:
+  //explicitly state the subscriber doesn't support copy or move semantics
+  Subscriber(const Subscriber&);
+  void operator=(const Subscriber&);
+
+  //returns the subscription topic for a key, based on the encoding
+  std::string topic(const std::string& key) const;
+
+  remus::client::ServerConnection ConnectionInfo;
+  Encoding EventEncoding;
+
+  class SubscriberImplementation;
+  boost::scoped_ptr<SubscriberImplementation> Implementation;
+};
+
+}
+
+typedef remus::client::Subscriber Subscriber;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_client_detail_WaitForResult_h
+#define remus_client_detail_WaitForResult_h
+
+#include <remus/common/CompilerInformation.h>
+#include <remus/common/Timer.h>
+#include <remus/proto/Job.h>
+#include <remus/proto/JobResult.h>
+#include <remus/proto/JobStatus.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+namespace remus{
+namespace client{
+namespace detail{
+
+//------------------------------------------------------------------------------
+//Blocks until the job has finished and returns the result, using the
+//waitForStatusChange of the client to track the job. If the job fails, or
+//doesn't finish before timeoutInMillisec passes, an invalid result is
+//returned. Shared by every client that has waitForStatusChange and
+//retrieveResults.
+template<typename ClientType>
+remus::proto::JobResult waitForResult(ClientType& client,
+                                      const remus::proto::Job& job,
+                                      boost::int64_t timeoutInMillisec)
+{
+  remus::common::Timer timer;
+  remus::proto::JobStatus lastSeen(job.id(),remus::INVALID_STATUS);
+
+  boost::int64_t remaining = timeoutInMillisec;
+  while(remaining > 0)
+    {
+    lastSeen = client.waitForStatusChange(job, lastSeen, remaining);
+    if(lastSeen.finished())
+      {
+      return client.retrieveResults(job);
+      }
+    else if(lastSeen.failed())
+      {
+      break;
+      }
+    remaining = timeoutInMillisec - timer.elapsed();
+    }
+  return remus::proto::JobResult(job.id());
+}
+
+}
+}
+}
+
+#endif
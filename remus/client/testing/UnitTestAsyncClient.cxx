@@ -0,0 +1,148 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/AsyncClient.h>
+#include <remus/client/ServerConnection.h>
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
+#include <remus/testing/Testing.h>
+
+#include <remus/proto/zmqHelper.h>
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+using namespace remus::meshtypes;
+
+//------------------------------------------------------------------------------
+remus::common::MeshIOType make_type()
+{
+  return remus::common::make_MeshIOType(Edges(),Mesh2D());
+}
+
+//------------------------------------------------------------------------------
+//the fake server sends back responses in the reverse order it receives the
+//requests, which verifies that the responses are matched on request id
+void verify_out_of_order_responses()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("async_client_reorder");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_ROUTER );
+  zmq::bindToAddress(fake_server, info);
+
+  remus::client::AsyncClient client(conn);
+  std::future<bool> first = client.canMesh(make_type());
+  std::future<bool> second = client.canMesh(make_type());
+
+  zmq::SocketIdentity firstAddress = zmq::address_recv(fake_server);
+  remus::proto::Message firstMsg = remus::proto::receive_Message(&fake_server);
+  zmq::SocketIdentity secondAddress = zmq::address_recv(fake_server);
+  remus::proto::Message secondMsg = remus::proto::receive_Message(&fake_server);
+
+  REMUS_ASSERT( firstMsg.isValid() );
+  REMUS_ASSERT( secondMsg.isValid() );
+  REMUS_ASSERT( (firstMsg.serviceType() == remus::CAN_MESH_IO_TYPE) );
+  REMUS_ASSERT( (firstMsg.requestId().size() > 0) );
+  REMUS_ASSERT( (firstMsg.requestId() != secondMsg.requestId()) );
+  REMUS_ASSERT( (client.numberOfPendingRequests() == 2) );
+
+  remus::proto::send_NonBlockingResponse(remus::CAN_MESH_IO_TYPE, "0",
+                                         &fake_server, secondAddress,
+                                         secondMsg.requestId());
+  remus::proto::send_NonBlockingResponse(remus::CAN_MESH_IO_TYPE, "1",
+                                         &fake_server, firstAddress,
+                                         firstMsg.requestId());
+
+  REMUS_ASSERT( (second.get() == false) );
+  REMUS_ASSERT( (first.get() == true) );
+  REMUS_ASSERT( (client.numberOfPendingRequests() == 0) );
+}
+
+//------------------------------------------------------------------------------
+void verify_client_generated_job_ids()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("async_client_job_ids");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_ROUTER );
+  zmq::bindToAddress(fake_server, info);
+
+  remus::client::AsyncClient client(conn);
+
+  remus::proto::JobRequirements reqs =
+              remus::proto::make_JobRequirements(make_type(), "worker", "");
+  remus::proto::JobSubmission sub(reqs);
+
+  std::future<remus::proto::Job> ack;
+  remus::proto::Job job = client.submitJobWithClientId(sub, &ack);
+  REMUS_ASSERT( job.valid() );
+  REMUS_ASSERT( (job.type() == make_type()) );
+
+  //verify the server is sent the job and then the submission
+  zmq::SocketIdentity address = zmq::address_recv(fake_server);
+  remus::proto::Message msg = remus::proto::receive_Message(&fake_server);
+  REMUS_ASSERT( msg.isValid() );
+  REMUS_ASSERT( (msg.serviceType() == remus::MAKE_MESH_WITH_ID) );
+
+  std::istringstream buffer(std::string(msg.data(),msg.dataSize()));
+  remus::proto::Job sentJob = remus::proto::make_invalidJob();
+  remus::proto::JobSubmission sentSub;
+  buffer >> sentJob;
+  buffer >> sentSub;
+  REMUS_ASSERT( (sentJob == job) );
+  REMUS_ASSERT( (sentSub == sub) );
+
+  remus::proto::send_NonBlockingResponse(remus::MAKE_MESH_WITH_ID,
+                                         remus::proto::to_string(sentJob),
+                                         &fake_server, address,
+                                         msg.requestId());
+  REMUS_ASSERT( (ack.get() == job) );
+}
+
+//------------------------------------------------------------------------------
+void verify_abandoned_requests()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("async_client_abandoned");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_ROUTER );
+  zmq::bindToAddress(fake_server, info);
+
+  std::future<remus::common::MeshIOTypeSet> types;
+  {
+  remus::client::AsyncClient client(conn);
+  types = client.supportedIOTypes();
+  }
+
+  //the client was destroyed before a response came back
+  bool threw = false;
+  try { types.get(); }
+  catch(std::future_error&) { threw = true; }
+  REMUS_ASSERT( threw );
+}
+
+} //namespace
+
+
+int UnitTestAsyncClient(int, char *[])
+{
+  verify_out_of_order_responses();
+  verify_client_generated_job_ids();
+  verify_abandoned_requests();
+  return 0;
+}
@@ -0,0 +1,232 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/ShardedClient.h>
+#include <remus/client/ServerConnection.h>
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
+#include <remus/testing/Testing.h>
+
+#include <remus/proto/zmqHelper.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/uuid/nil_generator.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace remus::meshtypes;
+
+//------------------------------------------------------------------------------
+remus::proto::JobSubmission make_submission(const std::string& workerName)
+{
+  remus::common::MeshIOType type =
+                        remus::common::make_MeshIOType(Edges(),Mesh2D());
+  return remus::proto::JobSubmission(
+            remus::proto::make_JobRequirements(type, workerName, ""));
+}
+
+//------------------------------------------------------------------------------
+//a fake server that accepts every submission, and reports every job
+//it has accepted as QUEUED. The jobs it has accepted are recorded
+struct FakeServer
+{
+  FakeServer(const remus::client::ServerConnection& conn,
+             const zmq::socketInfo<zmq::proto::inproc>& info):
+    Socket( *(conn.context()), ZMQ_ROUTER ),
+    Jobs()
+  {
+    zmq::bindToAddress(this->Socket, info);
+  }
+
+  //answer a single request
+  void answerOne()
+  {
+    zmq::SocketIdentity address = zmq::address_recv(this->Socket);
+    remus::proto::Message msg = remus::proto::receive_Message(&this->Socket);
+
+    std::string response;
+    if(msg.serviceType() == remus::MAKE_MESH_WITH_ID)
+      {
+      std::istringstream buffer(std::string(msg.data(),msg.dataSize()));
+      remus::proto::Job job = remus::proto::make_invalidJob();
+      buffer >> job;
+      this->Jobs.insert(job.id());
+      response = remus::proto::to_string(job);
+      }
+    else
+      {
+      remus::proto::Job job = remus::proto::to_Job(msg.data(),msg.dataSize());
+      const remus::STATUS_TYPE status = this->Jobs.count(job.id()) ?
+                                    remus::QUEUED : remus::INVALID_STATUS;
+      response = remus::proto::to_string(
+                              remus::proto::JobStatus(job.id(),status));
+      }
+    remus::proto::send_NonBlockingResponse(msg.serviceType(), response,
+                                           &this->Socket, address,
+                                           msg.requestId());
+  }
+
+  zmq::socket_t Socket;
+  std::set<boost::uuids::uuid> Jobs;
+};
+
+typedef boost::shared_ptr<FakeServer> FakeServerPtr;
+
+//------------------------------------------------------------------------------
+//answer the given number of requests, from whichever fake server they
+//are sent to
+void answer_requests(std::vector<FakeServerPtr>* fakes, int numberOfRequests)
+{
+  std::vector<zmq::pollitem_t> items;
+  for(std::size_t i=0; i < fakes->size(); ++i)
+    {
+    zmq::pollitem_t item = { (*fakes)[i]->Socket, 0, ZMQ_POLLIN, 0 };
+    items.push_back(item);
+    }
+
+  int answered = 0;
+  while(answered < numberOfRequests)
+    {
+    zmq::poll_safely(&items[0], static_cast<int>(items.size()), 250);
+    for(std::size_t i=0; i < items.size(); ++i)
+      {
+      if(items[i].revents & ZMQ_POLLIN)
+        {
+        (*fakes)[i]->answerOne();
+        ++answered;
+        }
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+std::vector<remus::client::ServerConnection>
+make_servers(const std::string& name, std::size_t count,
+             std::vector<FakeServerPtr>& fakes)
+{
+  std::vector<remus::client::ServerConnection> servers;
+  for(std::size_t i=0; i < count; ++i)
+    {
+    zmq::socketInfo<zmq::proto::inproc> info(name +
+                                        boost::lexical_cast<std::string>(i));
+    remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+    fakes.push_back( FakeServerPtr(new FakeServer(conn, info)) );
+    servers.push_back(conn);
+    }
+  return servers;
+}
+
+//------------------------------------------------------------------------------
+void verify_round_robin()
+{
+  std::vector<FakeServerPtr> fakes;
+  std::vector<remus::client::ServerConnection> servers =
+                                  make_servers("sharded_rr", 3, fakes);
+
+  remus::client::ShardedClient client(servers);
+  REMUS_ASSERT( (client.policy() == remus::client::ShardedClient::ROUND_ROBIN) );
+  REMUS_ASSERT( (client.numberOfShards() == 3) );
+
+  //every job is submitted, and has its status checked
+  boost::thread server(answer_requests, &fakes, 6);
+
+  std::vector<remus::proto::Job> jobs;
+  for(int i=0; i < 3; ++i)
+    {
+    jobs.push_back( client.submitJob(make_submission("worker")) );
+    REMUS_ASSERT( jobs.back().valid() );
+    }
+
+  //the status has to come from the server the job was submitted to
+  for(std::size_t i=0; i < jobs.size(); ++i)
+    {
+    const std::size_t shard = client.shard(jobs[i]);
+    REMUS_ASSERT( (shard < client.numberOfShards()) );
+    REMUS_ASSERT( (client.jobStatus(jobs[i]).status() == remus::QUEUED) );
+    }
+  server.join();
+
+  for(std::size_t i=0; i < fakes.size(); ++i)
+    {
+    REMUS_ASSERT( (fakes[i]->Jobs.size() == 1) );
+    }
+  for(std::size_t i=0; i < jobs.size(); ++i)
+    {
+    REMUS_ASSERT( (fakes[client.shard(jobs[i])]->Jobs.count(jobs[i].id()) == 1) );
+    }
+
+  //jobs whose id doesn't hold one of our shards aren't sent anywhere
+  boost::uuids::uuid otherId = boost::uuids::nil_uuid();
+  otherId.data[14] = 0xFF;
+  otherId.data[15] = 0xFF;
+  const remus::proto::Job other(otherId, jobs[0].type());
+  REMUS_ASSERT( (client.shard(other) == client.numberOfShards()) );
+  REMUS_ASSERT( (client.jobStatus(other).status() == remus::INVALID_STATUS) );
+}
+
+//------------------------------------------------------------------------------
+void verify_consistent_hash()
+{
+  std::vector<FakeServerPtr> fakes;
+  std::vector<remus::client::ServerConnection> servers =
+                                  make_servers("sharded_hash", 4, fakes);
+
+  remus::client::ShardedClient client(servers,
+                              remus::client::ShardedClient::CONSISTENT_HASH);
+
+  const int submissions = 6;
+  boost::thread server(answer_requests, &fakes, submissions);
+
+  std::vector<remus::proto::Job> jobs;
+  for(int i=0; i < submissions; ++i)
+    {
+    const std::string name = (i % 2 == 0) ? "even" : "odd";
+    jobs.push_back( client.submitJob(make_submission(name)) );
+    REMUS_ASSERT( jobs.back().valid() );
+    }
+  server.join();
+
+  //the same requirements always land on the same server
+  for(int i=2; i < submissions; ++i)
+    {
+    REMUS_ASSERT( (client.shard(jobs[i]) == client.shard(jobs[i-2])) );
+    }
+
+  //a second client with the same servers agrees on the placement
+  remus::client::ShardedClient other(servers,
+                              remus::client::ShardedClient::CONSISTENT_HASH);
+  boost::thread otherServer(answer_requests, &fakes, 1);
+  remus::proto::Job otherJob = other.submitJob(make_submission("even"));
+  otherServer.join();
+  REMUS_ASSERT( (other.shard(otherJob) == client.shard(jobs[0])) );
+  REMUS_ASSERT( (fakes[client.shard(jobs[0])]->Jobs.count(otherJob.id()) == 1) );
+}
+
+} //namespace
+
+
+int UnitTestShardedClient(int, char *[])
+{
+  verify_round_robin();
+  verify_consistent_hash();
+  return 0;
+}
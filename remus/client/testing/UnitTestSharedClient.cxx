@@ -0,0 +1,115 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/SharedClient.h>
+#include <remus/client/ServerConnection.h>
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
+#include <remus/testing/Testing.h>
+
+#include <remus/proto/zmqHelper.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <atomic>
+#include <set>
+#include <string>
+
+namespace {
+
+using namespace remus::meshtypes;
+
+const int number_of_threads = 8;
+const int requests_per_thread = 25;
+
+//------------------------------------------------------------------------------
+remus::common::MeshIOType make_type()
+{
+  return remus::common::make_MeshIOType(Edges(),Mesh2D());
+}
+
+//------------------------------------------------------------------------------
+//answers every CAN_MESH_IO_TYPE request with true, and records
+//which connections the requests came in on
+void fake_server(zmq::socket_t* server, int numberOfRequests,
+                 std::set<std::string>* connectionsUsed)
+{
+  for(int i=0; i < numberOfRequests; ++i)
+    {
+    zmq::SocketIdentity address = zmq::address_recv(*server);
+    remus::proto::Message msg = remus::proto::receive_Message(server);
+    connectionsUsed->insert( std::string(address.data(), address.size()) );
+
+    remus::proto::send_NonBlockingResponse(msg.serviceType(), "1",
+                                           server, address, msg.requestId());
+    }
+}
+
+//------------------------------------------------------------------------------
+void make_requests(remus::client::SharedClient* client,
+                   std::atomic<int>* answered)
+{
+  for(int i=0; i < requests_per_thread; ++i)
+    {
+    if(client->canMesh(make_type()))
+      {
+      ++(*answered);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void verify_concurrent_callers(std::size_t numberOfConnections)
+{
+  zmq::socketInfo<zmq::proto::inproc> info("shared_client_" +
+                      boost::lexical_cast<std::string>(numberOfConnections));
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t server( *(conn.context()), ZMQ_ROUTER );
+  zmq::bindToAddress(server, info);
+
+  remus::client::SharedClient client(conn, numberOfConnections);
+  REMUS_ASSERT( (client.numberOfConnections() == numberOfConnections) );
+
+  std::set<std::string> connectionsUsed;
+  boost::thread serverThread(fake_server, &server,
+                             number_of_threads * requests_per_thread,
+                             &connectionsUsed);
+
+  //every thread shares the same client without any locking
+  std::atomic<int> answered(0);
+  boost::thread_group callers;
+  for(int i=0; i < number_of_threads; ++i)
+    {
+    callers.create_thread( boost::bind(make_requests, &client, &answered) );
+    }
+  callers.join_all();
+  serverThread.join();
+
+  REMUS_ASSERT( (answered.load() == number_of_threads * requests_per_thread) );
+  REMUS_ASSERT( (connectionsUsed.size() == numberOfConnections) );
+}
+
+} //namespace
+
+
+int UnitTestSharedClient(int, char *[])
+{
+  verify_concurrent_callers(1);
+  verify_concurrent_callers(3);
+  return 0;
+}
@@ -0,0 +1,243 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/client/Subscriber.h>
+#include <remus/client/ServerConnection.h>
+#include <remus/common/SleepFor.h>
+#include <remus/testing/Testing.h>
+
+#include <remus/proto/zmqHelper.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+//------------------------------------------------------------------------------
+//collects the events that the subscriber delivers on its thread
+struct EventCollector
+{
+  boost::mutex Mutex;
+  std::vector<remus::client::JobEvent> JobEvents;
+  std::vector<remus::client::WorkerEvent> WorkerEvents;
+  std::vector<remus::client::SummaryEvent> SummaryEvents;
+
+  void addJob(const remus::client::JobEvent& e)
+  {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    this->JobEvents.push_back(e);
+  }
+
+  void addWorker(const remus::client::WorkerEvent& e)
+  {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    this->WorkerEvents.push_back(e);
+  }
+
+  void addSummary(const remus::client::SummaryEvent& e)
+  {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    this->SummaryEvents.push_back(e);
+  }
+
+  std::size_t numberOfEvents()
+  {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    return this->JobEvents.size() + this->WorkerEvents.size() +
+           this->SummaryEvents.size();
+  }
+};
+
+//------------------------------------------------------------------------------
+void publish(zmq::socket_t& socket, const std::string& key,
+             const std::string& value)
+{
+  zmq::message_t keyMsg(key.size());
+  std::memcpy(keyMsg.data(), key.data(), key.size());
+  socket.send(keyMsg, ZMQ_SNDMORE);
+
+  zmq::message_t valueMsg(value.size());
+  std::memcpy(valueMsg.data(), value.data(), value.size());
+  socket.send(valueMsg);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job make_job()
+{
+  return remus::proto::Job( remus::testing::UUIDGenerator(),
+                            remus::common::MeshIOType() );
+}
+
+//------------------------------------------------------------------------------
+//subscriptions propagate asynchronously, so keep publishing the same
+//events until the collector has seen the expected number of events
+void publish_until(zmq::socket_t& socket,
+                   const std::vector< std::pair<std::string,std::string> >& events,
+                   EventCollector& collector,
+                   std::size_t expected)
+{
+  for(int attempt=0; attempt < 500 && collector.numberOfEvents() < expected;
+      ++attempt)
+    {
+    for(std::size_t i=0; i < events.size(); ++i)
+      {
+      publish(socket, events[i].first, events[i].second);
+      }
+    remus::common::SleepForMillisec(10);
+    }
+}
+
+//------------------------------------------------------------------------------
+void verify_job_filtering()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("subscriber_jobs");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_PUB );
+  zmq::bindToAddress(fake_server, info);
+
+  EventCollector collector;
+  remus::client::Subscriber subscriber(conn);
+  subscriber.onJobEvent(
+    [&collector](const remus::client::JobEvent& e){ collector.addJob(e); });
+
+  remus::proto::Job watched = make_job();
+  remus::proto::Job ignored = make_job();
+  subscriber.watchJob(watched, remus::proto::jobevents::JOB_STATUS);
+
+  const std::string watchedId = boost::uuids::to_string(watched.id());
+  const std::string ignoredId = boost::uuids::to_string(ignored.id());
+
+  //the ignored job is published first, so if filtering was broken
+  //we would see it before the watched job
+  std::vector< std::pair<std::string,std::string> > events;
+  events.push_back( std::make_pair(
+    "job:CURRENT JOB STATUS:" + ignoredId,
+    "{\"job_id\":\"" + ignoredId + "\",\"status_type\":\"QUEUED\"}") );
+  events.push_back( std::make_pair(
+    "job:CURRENT JOB STATUS:" + watchedId,
+    "{\"job_id\":\"" + watchedId + "\",\"worker_id\":\"w1\","
+    "\"status_type\":\"IN PROGRESS\",\"progress\":\"50\\n0\\n\"}") );
+
+  publish_until(fake_server, events, collector, 1);
+
+  boost::lock_guard<boost::mutex> lock(collector.Mutex);
+  REMUS_ASSERT( (collector.JobEvents.size() >= 1) );
+  for(std::size_t i=0; i < collector.JobEvents.size(); ++i)
+    {
+    const remus::client::JobEvent& e = collector.JobEvents[i];
+    REMUS_ASSERT( (e.JobId == watched.id()) );
+    REMUS_ASSERT( (e.Type == remus::proto::jobevents::JOB_STATUS) );
+    REMUS_ASSERT( (e.WorkerId == "w1") );
+    REMUS_ASSERT( (e.Status == remus::IN_PROGRESS) );
+    REMUS_ASSERT( (e.Progress.value() == 50) );
+    }
+  REMUS_ASSERT( (collector.WorkerEvents.size() == 0) );
+}
+
+//------------------------------------------------------------------------------
+void verify_worker_events()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("subscriber_workers");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_PUB );
+  zmq::bindToAddress(fake_server, info);
+
+  EventCollector collector;
+  remus::client::Subscriber subscriber(conn);
+  subscriber.onWorkerEvent(
+    [&collector](const remus::client::WorkerEvent& e){ collector.addWorker(e); });
+  subscriber.watchWorkerEvents(remus::proto::workevents::WORKER_STATE);
+
+  std::vector< std::pair<std::string,std::string> > events;
+  events.push_back( std::make_pair(
+    "worker:HEARTBEAT:w2", "{\"worker_id\":\"w2\"}") );
+  events.push_back( std::make_pair(
+    "worker:WORKER STATE:w1",
+    "{\"worker_id\":\"w1\",\"state\":\"Unresponsive\"}") );
+
+  publish_until(fake_server, events, collector, 1);
+
+  boost::lock_guard<boost::mutex> lock(collector.Mutex);
+  REMUS_ASSERT( (collector.WorkerEvents.size() >= 1) );
+  for(std::size_t i=0; i < collector.WorkerEvents.size(); ++i)
+    {
+    const remus::client::WorkerEvent& e = collector.WorkerEvents[i];
+    REMUS_ASSERT( (e.Type == remus::proto::workevents::WORKER_STATE) );
+    REMUS_ASSERT( (e.WorkerId == "w1") );
+    REMUS_ASSERT( (e.Responsive == false) );
+    REMUS_ASSERT( (e.JobId.is_nil()) );
+    }
+}
+
+//------------------------------------------------------------------------------
+void verify_summaries()
+{
+  zmq::socketInfo<zmq::proto::inproc> info("subscriber_summaries");
+  remus::client::ServerConnection conn =
+                remus::client::make_ServerConnection(info.endpoint());
+
+  zmq::socket_t fake_server( *(conn.context()), ZMQ_PUB );
+  zmq::bindToAddress(fake_server, info);
+
+  //summaries are always JSON, even for binary subscribers
+  EventCollector collector;
+  remus::client::Subscriber subscriber(conn, remus::client::Subscriber::BINARY);
+  subscriber.onSummary(
+    [&collector](const remus::client::SummaryEvent& e){ collector.addSummary(e); });
+  subscriber.watchSummaries();
+
+  std::vector< std::pair<std::string,std::string> > events;
+  events.push_back( std::make_pair(
+    "summary:server",
+    "{\"msg_type\":\"SUMMARY\",\"interval_ms\":1000,\"queued\":4,"
+    "\"waiting_for_worker\":2,\"requirements\":[],"
+    "\"workers\":[{\"worker_id\":\"w1\",\"active_jobs\":3},"
+    "{\"worker_id\":\"w2\",\"active_jobs\":1}],"
+    "\"dispatched\":5,\"finished\":6,\"failed\":1,\"expired\":0,"
+    "\"dispatch_rate\":5,\"finish_rate\":6}") );
+
+  publish_until(fake_server, events, collector, 1);
+
+  boost::lock_guard<boost::mutex> lock(collector.Mutex);
+  REMUS_ASSERT( (collector.SummaryEvents.size() >= 1) );
+  const remus::client::SummaryEvent& e = collector.SummaryEvents[0];
+  REMUS_ASSERT( (e.IntervalMillisec == 1000) );
+  REMUS_ASSERT( (e.QueuedJobs == 4) );
+  REMUS_ASSERT( (e.WaitingForWorkerJobs == 2) );
+  REMUS_ASSERT( (e.ActiveJobs == 4) );
+  REMUS_ASSERT( (e.Dispatched == 5) );
+  REMUS_ASSERT( (e.Finished == 6) );
+  REMUS_ASSERT( (e.Failed == 1) );
+  REMUS_ASSERT( (e.FinishRate == 6.0) );
+}
+
+} //namespace
+
+
+int UnitTestSubscriber(int, char *[])
+{
+  verify_job_filtering();
+  verify_worker_events();
+  verify_summaries();
+  return 0;
+}
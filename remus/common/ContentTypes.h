@@ -17,7 +17,9 @@ namespace remus{
 namespace common{
 
 struct ContentFormat{ enum Type{User=0, XML=1, JSON=2, BSON=3}; };
-struct ContentSource{ enum Type{File=0, Memory=1}; };
+//Reference is only used on the wire, for content that the server knows a
+//worker has cached. See JobContent::reference
+struct ContentSource{ enum Type{File=0, Memory=1, Reference=2}; };
 
 } }
 
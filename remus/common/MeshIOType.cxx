@@ -16,11 +16,19 @@
 //remus proto or not
 #include <remus/common/ConversionHelper.h>
 
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
 namespace remus {
 namespace common {
 
 //------------------------------------------------------------------------------
 MeshIOType::MeshIOType():
+  InputId(MeshRegistrar::InvalidId),
+  OutputId(MeshRegistrar::InvalidId),
   InputName(),
   OutputName()
 {
@@ -28,42 +36,47 @@ MeshIOType::MeshIOType():
 
 //------------------------------------------------------------------------------
 MeshIOType::MeshIOType(const std::string& in, const std::string& out):
-  InputName(in),
-  OutputName(out)
+  InputId(MeshRegistrar::InvalidId),
+  OutputId(MeshRegistrar::InvalidId),
+  InputName(),
+  OutputName()
 {
+  this->setTypes(in, out);
 }
 
 //------------------------------------------------------------------------------
 MeshIOType::MeshIOType(const boost::shared_ptr<remus::meshtypes::MeshTypeBase>& in,
              const boost::shared_ptr<remus::meshtypes::MeshTypeBase>& out):
-  InputName(in->name()),
-  OutputName(out->name())
+  InputId(MeshRegistrar::InvalidId),
+  OutputId(MeshRegistrar::InvalidId),
+  InputName(),
+  OutputName()
 {
+  this->setTypes(in->name(), out->name());
 }
 
 //------------------------------------------------------------------------------
 MeshIOType::MeshIOType(const remus::meshtypes::MeshTypeBase& in,
                        const remus::meshtypes::MeshTypeBase& out):
-  InputName(in.name()),
-  OutputName(out.name())
+  InputId(MeshRegistrar::InvalidId),
+  OutputId(MeshRegistrar::InvalidId),
+  InputName(),
+  OutputName()
 {
+  this->setTypes(in.name(), out.name());
 }
 
 //------------------------------------------------------------------------------
-bool MeshIOType::operator ==(const MeshIOType& b) const
+void MeshIOType::setTypes(const std::string& in, const std::string& out)
 {
-  return (this->inputType() == b.inputType() &&
-          this->outputType() == b.outputType());
-}
+  this->InputId = MeshRegistrar::id(in);
+  if(this->InputId == MeshRegistrar::UnregisteredId)
+    { this->InputName = in; }
 
-//------------------------------------------------------------------------------
-bool MeshIOType::operator <(const MeshIOType& b) const
-  {
-  if( this->inputType() == b.inputType() )
-    { return ( this->outputType() < b.outputType() ); }
-  else
-    { return ( this->inputType() < b.inputType() ); }
-  }
+  this->OutputId = MeshRegistrar::id(out);
+  if(this->OutputId == MeshRegistrar::UnregisteredId)
+    { this->OutputName = out; }
+}
 
 //------------------------------------------------------------------------------
 void MeshIOType::serialize(std::ostream& buffer) const
@@ -80,6 +93,8 @@ void MeshIOType::serialize(std::ostream& buffer) const
 
 //------------------------------------------------------------------------------
 MeshIOType::MeshIOType(std::istream& buffer):
+  InputId(MeshRegistrar::InvalidId),
+  OutputId(MeshRegistrar::InvalidId),
   InputName(),
   OutputName()
 {
@@ -87,9 +102,10 @@ MeshIOType::MeshIOType(std::istream& buffer):
   std::size_t outputSize=0;
 
   buffer >> inputSize;
-  this->InputName = remus::internal::extractString(buffer,inputSize);
+  const std::string in = remus::internal::extractString(buffer,inputSize);
   buffer >> outputSize;
-  this->OutputName = remus::internal::extractString(buffer,outputSize);
+  const std::string out = remus::internal::extractString(buffer,outputSize);
+  this->setTypes(in, out);
 }
 
 //------------------------------------------------------------------------------
@@ -129,5 +145,39 @@ MeshIOTypeSet::MeshIOTypeSet(std::istream& buffer)
     }
 }
 
+//------------------------------------------------------------------------------
+std::set< MeshIOType > generateAllIOTypes()
+{
+  //the cross product only changes when a type is registered, so it is
+  //built once per registration version
+  static boost::mutex cacheLock;
+  static boost::uint64_t cachedVersion = 0;
+  static bool cached = false;
+  static std::set< MeshIOType > allIOTypes;
+
+  boost::lock_guard<boost::mutex> lock(cacheLock);
+  const boost::uint64_t version = MeshRegistrar::registrationVersion();
+  if(cached && cachedVersion == version)
+    {
+    return allIOTypes;
+    }
+
+  typedef boost::shared_ptr<remus::meshtypes::MeshTypeBase> MeshType;
+  const std::set<MeshType> all_types = MeshRegistrar::allRegisteredTypes();
+
+  allIOTypes.clear();
+  typedef std::set<MeshType>::const_iterator cit;
+  for(cit i=all_types.begin(); i!=all_types.end(); ++i)
+    {
+    for(cit j=all_types.begin(); j!=all_types.end(); ++j)
+      {
+      allIOTypes.insert( MeshIOType(*i,*j) );
+      }
+    }
+  cachedVersion = version;
+  cached = true;
+  return allIOTypes;
+}
+
 }
 }
@@ -19,6 +19,14 @@
 
 #include <remus/common/CommonExports.h>
 
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <set>
+#include <string>
+
 #ifdef REMUS_MSVC
  #pragma warning(push)
  #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
@@ -32,7 +40,13 @@ namespace common {
 //These are used to describe worker types at a high level. For example
 //this allows a server to state that it can transform Model into 3D Meshes
 //
-//
+//The input and output names are held as ids from the MeshRegistrar, so
+//comparing and hashing a MeshIOType of registered types only compares
+//integers. Names that aren't registered are held by the MeshIOType itself,
+//and a MeshIOType holding one compares by name, so it still equals a
+//MeshIOType made after its names were registered.
+//The names are still what is serialized, as ids are only valid inside a
+//process.
 class REMUSCOMMON_EXPORT MeshIOType
 {
 public:
@@ -47,18 +61,72 @@ public:
   MeshIOType(const remus::meshtypes::MeshTypeBase& in,
              const remus::meshtypes::MeshTypeBase& out);
 
-  const std::string& inputType() const { return this->InputName; }
-  const std::string& outputType() const { return this->OutputName; }
+  const std::string& inputType() const
+    { return (this->InputId == MeshRegistrar::UnregisteredId) ?
+             this->InputName : MeshRegistrar::name(this->InputId); }
+  const std::string& outputType() const
+    { return (this->OutputId == MeshRegistrar::UnregisteredId) ?
+             this->OutputName : MeshRegistrar::name(this->OutputId); }
+
+  //the MeshRegistrar ids of the input and output names
+  boost::uint32_t inputId() const { return this->InputId; }
+  boost::uint32_t outputId() const { return this->OutputId; }
+
+  //the input and output ids packed into a single integer
+  boost::uint64_t packedId() const
+    { return (static_cast<boost::uint64_t>(this->InputId) << 32) | this->OutputId; }
 
   //If either the input or output is invalid we need say we are invalid.
   //If we just check the combined type we only see if both are invalid.
-  bool valid() const { return !inputType().empty() && !outputType().empty(); }
+  bool valid() const
+    { return this->InputId != MeshRegistrar::InvalidId &&
+             this->OutputId != MeshRegistrar::InvalidId; }
 
-  //needed to see if a client request type and a workers type are equal
-  bool operator ==(const MeshIOType& b) const;
+  //needed to see if a client request type and a workers type are equal.
+  //Only compares integers when both sides are registered
+  bool operator ==(const MeshIOType& b) const
+    {
+    if(this->registered() && b.registered())
+      { return this->packedId() == b.packedId(); }
+    return this->inputType() == b.inputType() &&
+           this->outputType() == b.outputType();
+    }
 
-  //needed to properly store mesh types into stl containers
-  bool operator <(const MeshIOType& b) const;
+  bool operator !=(const MeshIOType& b) const
+    { return !(*this == b); }
+
+  //needed to properly store mesh types into stl containers. The order is
+  //the order the names were registered in, not alphabetical. Unregistered
+  //names come after all registered ones. A name that was registered after
+  //the MeshIOType was made is looked up again, so that the order agrees
+  //with operator==, mixing the registration and alphabetical order of
+  //the same names wouldn't be a strict weak ordering
+  bool operator <(const MeshIOType& b) const
+    {
+    if(this->registered() && b.registered())
+      { return this->packedId() < b.packedId(); }
+    const boost::uint64_t aId = this->currentPackedId();
+    const boost::uint64_t bId = b.currentPackedId();
+    if(aId != bId)
+      { return aId < bId; }
+    if(this->inputType() != b.inputType())
+      { return this->inputType() < b.inputType(); }
+    return this->outputType() < b.outputType();
+    }
+
+  //needed to store mesh types in boost unordered containers. Like
+  //operator<, names registered after the MeshIOType was made are looked
+  //up again, so equal types have equal hashes
+  friend std::size_t hash_value(const MeshIOType& types)
+    {
+    const boost::uint64_t packed = types.currentPackedId();
+    std::size_t seed = boost::hash<boost::uint64_t>()(packed);
+    if((packed >> 32) == MeshRegistrar::UnregisteredId)
+      { boost::hash_combine(seed, types.InputName); }
+    if((packed & 0xFFFFFFFF) == MeshRegistrar::UnregisteredId)
+      { boost::hash_combine(seed, types.OutputName); }
+    return seed;
+    }
 
   friend std::ostream& operator<<(std::ostream &os,
                                   const MeshIOType &types)
@@ -72,6 +140,29 @@ private:
   void serialize(std::ostream& buffer) const;
   explicit MeshIOType(std::istream& buffer);
 
+  void setTypes(const std::string& in, const std::string& out);
+
+  //true when both the input and output names were registered when
+  //this MeshIOType was made
+  bool registered() const
+    { return this->InputId != MeshRegistrar::UnregisteredId &&
+             this->OutputId != MeshRegistrar::UnregisteredId; }
+
+  //the packed ids of the names as they are registered right now
+  boost::uint64_t currentPackedId() const
+    {
+    const boost::uint32_t in = (this->InputId == MeshRegistrar::UnregisteredId) ?
+                               MeshRegistrar::id(this->InputName) : this->InputId;
+    const boost::uint32_t out = (this->OutputId == MeshRegistrar::UnregisteredId) ?
+                               MeshRegistrar::id(this->OutputName) : this->OutputId;
+    return (static_cast<boost::uint64_t>(in) << 32) | out;
+    }
+
+  boost::uint32_t InputId;
+  boost::uint32_t OutputId;
+
+  //only hold the names that aren't registered, the names of registered
+  //types are owned by the MeshRegistrar
   std::string InputName;
   std::string OutputName;
 };
@@ -133,26 +224,8 @@ inline remus::common::MeshIOType make_MeshIOType(
 }
 
 //helper method to generate the cross product of all known mesh io types
-inline std::set< remus::common::MeshIOType > generateAllIOTypes()
-{
-  using namespace remus::common;
-  using namespace remus::meshtypes;
-  typedef boost::shared_ptr<remus::meshtypes::MeshTypeBase> MeshType;
-  std::set<MeshType> all_types = remus::common::MeshRegistrar::allRegisteredTypes();
-
-  std::set< MeshIOType > allIOTypes;
-
-  typedef std::set<MeshType>::const_iterator cit;
-  for(cit i=all_types.begin(); i!=all_types.end(); ++i)
-    {
-    for(cit j=all_types.begin(); j!=all_types.end(); ++j)
-      {
-      allIOTypes.insert( MeshIOType(*i,*j) );
-      }
-    }
-
-  return allIOTypes;
-}
+REMUSCOMMON_EXPORT
+std::set< remus::common::MeshIOType > generateAllIOTypes();
 
 
 }
@@ -14,45 +14,190 @@
 //include the default mesh types
 #include <remus/common/MeshTypes.h>
 
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <atomic>
+#include <vector>
+
 namespace
 {
-  //a work around so that we always have the default types added to the
-  //mesh registry, no matter what. This does have a small performance
-  //overhead
-  void add_default_types()
+  typedef boost::shared_ptr<remus::meshtypes::MeshTypeBase> MeshType;
+  typedef MeshType (*create_function_ptr)();
+
+  //an immutable snapshot of the registered types. Lookups only ever read
+  //a table, registering a type builds a new table and publishes it.
+  struct Table
+  {
+    //indexed by id
+    std::vector<std::string> Names;
+    boost::unordered_map<std::string, boost::uint32_t> Ids;
+
+    boost::unordered_map<std::string, MeshType> Types;
+    std::set<MeshType> AllTypes;
+    boost::uint64_t Version;
+  };
+
+  //all the state of the registry. Built the first time it is used, which
+  //is also when the default types are added. This way we always have the
+  //default types, no matter what order static constructors run in.
+  struct Registry
+  {
+    Registry():
+      WriteLock(),
+      Tables(),
+      Current(NULL)
+    {
+      Table* first = new Table();
+      first->Version = 0;
+
+      //the empty name is the name of all invalid types, and gets id 0
+      first->Names.push_back(std::string());
+      first->Ids[std::string()] = remus::common::MeshRegistrar::InvalidId;
+      this->publish(first);
+
+      this->add<remus::meshtypes::Mesh1D>();
+      this->add<remus::meshtypes::Mesh2D>();
+      this->add<remus::meshtypes::Mesh3D>();
+      this->add<remus::meshtypes::Mesh3DSurface>();
+      this->add<remus::meshtypes::SceneFile>();
+      this->add<remus::meshtypes::Model>();
+      this->add<remus::meshtypes::DiscreteModel>();
+      this->add<remus::meshtypes::DiscreteModel1D>();
+      this->add<remus::meshtypes::DiscreteModel2D>();
+      this->add<remus::meshtypes::DiscreteModel3D>();
+      this->add<remus::meshtypes::Edges>();
+      this->add<remus::meshtypes::PiecewiseLinearComplex>();
+    }
+
+    template<typename D>
+    void add()
+    {
+      this->record(D().name(), &D::create);
+    }
+
+    const Table& table() const
+    {
+      return *this->Current.load(std::memory_order_acquire);
+    }
+
+    void record(const std::string& name, create_function_ptr fp)
+    {
+      boost::lock_guard<boost::mutex> lock(this->WriteLock);
+      Table* next = new Table(this->table());
+
+      if(next->Ids.find(name) == next->Ids.end())
+        {
+        next->Ids[name] = static_cast<boost::uint32_t>(next->Names.size());
+        next->Names.push_back(name);
+        }
+
+      //registering a name again replaces the type
+      next->Types[name] = (*fp)();
+
+      next->AllTypes.clear();
+      boost::unordered_map<std::string, MeshType>::const_iterator it;
+      for(it = next->Types.begin(); it != next->Types.end(); ++it)
+        { next->AllTypes.insert(it->second); }
+      ++next->Version;
+
+      this->publish(next);
+    }
+
+    //the caller needs to hold the write lock, or be the constructor.
+    //Old tables are never freed, so that readers that are still looking
+    //at them and the names handed out stay valid. Types are only
+    //registered a handful of times, so this is cheap
+    void publish(Table* next)
+    {
+      this->Tables.push_back(boost::shared_ptr<const Table>(next));
+      this->Current.store(next, std::memory_order_release);
+    }
+
+    boost::mutex WriteLock;
+    std::vector< boost::shared_ptr<const Table> > Tables;
+    std::atomic<const Table*> Current;
+  };
+
+  Registry& registry()
+  {
+    static Registry r;
+    return r;
+  }
+
+  //the instance returned when looking up a name that isn't registered
+  const MeshType& unknown_type()
   {
-    static bool defaults_added  = false;
-    if(!defaults_added)
-      {
-      //this needs to be set before we add any of the default types or
-      //we will start an endless loop of calling this function.
-      defaults_added = true;
-
-      remus::common::MeshRegistrar a( (remus::meshtypes::Mesh1D()) );
-      remus::common::MeshRegistrar b( (remus::meshtypes::Mesh2D()) );
-      remus::common::MeshRegistrar c( (remus::meshtypes::Mesh3D()) );
-      remus::common::MeshRegistrar d( (remus::meshtypes::Mesh3DSurface()) );
-      remus::common::MeshRegistrar e( (remus::meshtypes::SceneFile()) );
-      remus::common::MeshRegistrar f( (remus::meshtypes::Model()) );
-      remus::common::MeshRegistrar g( (remus::meshtypes::DiscreteModel()) );
-      remus::common::MeshRegistrar h( (remus::meshtypes::DiscreteModel1D()) );
-      remus::common::MeshRegistrar i( (remus::meshtypes::DiscreteModel2D()) );
-      remus::common::MeshRegistrar j( (remus::meshtypes::DiscreteModel3D()) );
-      remus::common::MeshRegistrar k( (remus::meshtypes::Edges()) );
-      remus::common::MeshRegistrar l( (remus::meshtypes::PiecewiseLinearComplex()) );
-
-      }
+    static const MeshType unknown(new remus::meshtypes::MeshTypeBase());
+    return unknown;
+  }
+
+  const std::string& empty_name()
+  {
+    static const std::string empty;
+    return empty;
   }
 }
 
 namespace remus {
 namespace common {
 
-MeshRegistrar::NameRegisteredMeshMapType & MeshRegistrar::NameRegistry()
+//------------------------------------------------------------------------------
+std::size_t MeshRegistrar::numberOfRegisteredTypes()
+{
+  return registry().table().Types.size();
+}
+
+//------------------------------------------------------------------------------
+std::set<MeshType> MeshRegistrar::allRegisteredTypes()
+{
+  return registry().table().AllTypes;
+}
+
+//------------------------------------------------------------------------------
+MeshType MeshRegistrar::instantiate(std::string const & name)
+{
+  const Table& t = registry().table();
+  boost::unordered_map<std::string, MeshType>::const_iterator it =
+                                                        t.Types.find(name);
+  return (it == t.Types.end()) ? unknown_type() : it->second;
+}
+
+//------------------------------------------------------------------------------
+boost::uint32_t MeshRegistrar::id(std::string const & name)
+{
+  if(name.empty())
+    { return MeshRegistrar::InvalidId; }
+
+  const Table& t = registry().table();
+  boost::unordered_map<std::string, boost::uint32_t>::const_iterator it =
+                                                        t.Ids.find(name);
+  if(it == t.Ids.end())
+    { return MeshRegistrar::UnregisteredId; }
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+const std::string& MeshRegistrar::name(boost::uint32_t id)
+{
+  const Table& t = registry().table();
+  return (id < t.Names.size()) ? t.Names[id] : empty_name();
+}
+
+//------------------------------------------------------------------------------
+boost::uint64_t MeshRegistrar::registrationVersion()
+{
+  return registry().table().Version;
+}
+
+//------------------------------------------------------------------------------
+void MeshRegistrar::record(std::string const & name, create_function_ptr fp)
 {
-  add_default_types();
-  static MeshRegistrar::NameRegisteredMeshMapType NameImplementation;
-  return NameImplementation;
+  registry().record(name, fp);
 }
 
 }
@@ -22,7 +22,6 @@
 //as clang supports pragma GCC diagnostic
 REMUS_THIRDPARTY_PRE_INCLUDE
 #include <boost/cstdint.hpp>
-#include <boost/unordered_map.hpp>
 #include <boost/shared_ptr.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
@@ -51,6 +50,21 @@ struct REMUSCOMMON_EXPORT MeshTypeBase
 namespace remus {
 namespace common {
 
+//The MeshRegistrar holds every mesh type that has been registered, and
+//hands out a dense integer id for every registered mesh type name.
+//
+//Registered types are created once when they are registered, and the same
+//immutable instance is returned by every lookup after that. The ids allow
+//MeshIOType to compare and hash with integers instead of strings. Names
+//that have never been registered, such as the types of a worker that this
+//process doesn't know about, are not remembered and all have the
+//UnregisteredId.
+//
+//Lookups read an immutable table and don't take a lock, registering a
+//type publishes a new table. Types should be registered before mesh io
+//types using them are made. A name that was unregistered when a MeshIOType
+//was made doesn't gain an id afterwards, so comparing that MeshIOType
+//needs string compares and lookups.
 struct REMUSCOMMON_EXPORT MeshRegistrar
 {
 private:
@@ -58,6 +72,11 @@ private:
   typedef boost::shared_ptr<remus::meshtypes::MeshTypeBase> ReturnType;
   typedef ReturnType (*create_function_ptr)();
 public:
+  //the id of the empty name, which all invalid mesh types have
+  static const boost::uint32_t InvalidId = 0;
+
+  //the id of every non empty name that isn't registered
+  static const boost::uint32_t UnregisteredId = 0xFFFFFFFF;
 
   template <typename D>
   explicit MeshRegistrar(D d)
@@ -65,37 +84,30 @@ public:
     MeshRegistrar::record(d.name(), &D::create);
     }
 
-  static std::size_t numberOfRegisteredTypes() {
-    return NameRegistry().size();
-  }
+  static std::size_t numberOfRegisteredTypes();
 
-  static std::set<ReturnType> allRegisteredTypes()
-  {
-    std::set<ReturnType> result;
-    boost::unordered_map<std::string, create_function_ptr>::const_iterator it;
-    for(it = NameRegistry().begin(); it != NameRegistry().end(); ++it)
-        { result.insert( (it->second)() ); }
-    return result;
-  }
+  //returns a snapshot of the cached instance of each registered type
+  static std::set<ReturnType> allRegisteredTypes();
 
-  static ReturnType instantiate(std::string const & name)
-    {
-    boost::unordered_map<std::string,
-        create_function_ptr>::const_iterator it = NameRegistry().find(name);
-    return (it == NameRegistry().end()) ?
-            ReturnType(new remus::meshtypes::MeshTypeBase()) : (it->second)();
-    }
+  //returns the cached instance of the type with the given name, or
+  //an instance of MeshTypeBase if no type with that name is registered
+  static ReturnType instantiate(std::string const & name);
 
-private:
-  static void record(std::string const & name, create_function_ptr fp)
-    {
-    NameRegistry()[name] = fp;
-    }
+  //returns the id of a name, or UnregisteredId if no type with that name
+  //is registered. A registered name has the same id for the life of the
+  //process, ids are handed out in the order types are registered in
+  static boost::uint32_t id(std::string const & name);
 
+  //returns the name of an id, the reference is valid for the life of the
+  //process. Unknown ids and UnregisteredId return the empty name
+  static const std::string& name(boost::uint32_t id);
 
-  typedef boost::unordered_map<std::string, create_function_ptr>
-                                            NameRegisteredMeshMapType;
-  static NameRegisteredMeshMapType& NameRegistry();
+  //returns a number that changes each time a type is registered, so
+  //that tables built from the registered types know when to be rebuilt
+  static boost::uint64_t registrationVersion();
+
+private:
+  static void record(std::string const & name, create_function_ptr fp);
 
   MeshRegistrar( const MeshRegistrar& other ); // non construction-copyable
   MeshRegistrar& operator=( const MeshRegistrar& ); // non copyable
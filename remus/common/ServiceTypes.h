@@ -31,7 +31,19 @@ namespace remus {
      ServiceTypeMacro(RETRIEVE_RESULT, 7, "RETRIEVE RESULT"), \
      ServiceTypeMacro(HEARTBEAT, 8, "HEARTBEAT"), \
      ServiceTypeMacro(TERMINATE_JOB, 9, "TERMINATE JOB"), \
-     ServiceTypeMacro(TERMINATE_WORKER, 10, "TERMINATE WORKER")
+     ServiceTypeMacro(TERMINATE_WORKER, 10, "TERMINATE WORKER"), \
+     ServiceTypeMacro(MAKE_MESH_WITH_ID, 11, "MAKE MESH WITH ID"), \
+     ServiceTypeMacro(WAIT_FOR_STATUS_CHANGE, 12, "WAIT FOR STATUS CHANGE"), \
+     ServiceTypeMacro(LIST_JOBS, 13, "LIST JOBS"), \
+     ServiceTypeMacro(MAKE_MESH_ARRAY, 14, "MAKE MESH ARRAY"), \
+     ServiceTypeMacro(JOB_ARRAY_STATUS, 15, "JOB ARRAY STATUS"), \
+     ServiceTypeMacro(TERMINATE_JOB_ARRAY, 16, "TERMINATE JOB ARRAY"), \
+     ServiceTypeMacro(JOB_CREDITS, 17, "JOB CREDITS"), \
+     ServiceTypeMacro(MAKE_MESH_BATCH, 18, "MAKE MESH BATCH"), \
+     ServiceTypeMacro(CLAIM_RESERVED_JOB, 19, "CLAIM RESERVED JOB"), \
+     ServiceTypeMacro(CONTENT_CACHE, 20, "CONTENT CACHE"), \
+     ServiceTypeMacro(OPEN_MODEL_SESSION, 21, "OPEN MODEL SESSION"), \
+     ServiceTypeMacro(CLOSE_MODEL_SESSION, 22, "CLOSE MODEL SESSION")
 
 
 //------------------------------------------------------------------------------
@@ -62,7 +74,7 @@ inline std::string to_string(remus::SERVICE_TYPE t)
 //------------------------------------------------------------------------------
 inline remus::SERVICE_TYPE to_serviceType(const std::string& t)
 {
-  for(int i=1; i<=10; i++)
+  for(int i=1; i<=22; i++)
     {
     remus::SERVICE_TYPE mt=static_cast<remus::SERVICE_TYPE>(i);
     if (remus::to_string(mt) == t)
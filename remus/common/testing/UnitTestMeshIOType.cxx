@@ -34,6 +34,13 @@ void RegisterTextMeshType()
   remus::common::MeshRegistrar a( (TextMeshType()) );
 }
 
+struct LateMeshType : remus::meshtypes::MeshTypeBase
+{
+  static boost::shared_ptr<MeshTypeBase> create() {
+          return boost::shared_ptr<LateMeshType>(new LateMeshType()); }
+  std::string name() const { return "LateMeshType"; }
+};
+
 template<typename T, typename U, typename V>
 void VerifyValid(T t, U u, V v)
 {
@@ -142,6 +149,123 @@ void verify_serialization()
   REMUS_ASSERT( same );
 }
 
+
+void verify_packed_ids()
+{
+  remus::common::MeshIOType a("Model","Mesh2D");
+  remus::common::MeshIOType b( (remus::meshtypes::Model()),
+                               (remus::meshtypes::Mesh2D()) );
+  remus::common::MeshIOType c("Mesh2D","Model");
+
+  //the same names always have the same ids
+  REMUS_ASSERT( (a.packedId() == b.packedId()) );
+  REMUS_ASSERT( (a.inputId() == c.outputId()) );
+  REMUS_ASSERT( (a.outputId() == c.inputId()) );
+  REMUS_ASSERT( (a == b) );
+  REMUS_ASSERT( (a != c) );
+  REMUS_ASSERT( ((a < c) != (c < a)) );
+
+  boost::hash<remus::common::MeshIOType> hasher;
+  REMUS_ASSERT( (hasher(a) == hasher(b)) );
+
+  //ids don't go over the wire, the names do
+  std::stringstream buffer;
+  buffer << a;
+  remus::common::MeshIOType from_wire;
+  buffer >> from_wire;
+  REMUS_ASSERT( (from_wire == a) );
+  REMUS_ASSERT( (from_wire.inputType() == "Model") );
+  REMUS_ASSERT( (from_wire.outputType() == "Mesh2D") );
+
+  //the all io types table is the cross product of the registered types
+  const std::size_t numTypes =
+                  remus::common::MeshRegistrar::numberOfRegisteredTypes();
+  REMUS_ASSERT( (remus::common::generateAllIOTypes().size() ==
+                 numTypes * numTypes) );
+  REMUS_ASSERT( (remus::common::generateAllIOTypes().count(a) == 1) );
+}
+
+void verify_unregistered_names()
+{
+  using remus::common::MeshRegistrar;
+
+  remus::common::MeshIOType a("NotRegisteredIn","Mesh2D");
+  remus::common::MeshIOType b("NotRegisteredIn","Mesh2D");
+  remus::common::MeshIOType c("OtherNotRegisteredIn","Mesh2D");
+
+  //unregistered names are held by the type, not by the registrar
+  REMUS_ASSERT( (a.valid()) );
+  REMUS_ASSERT( (a.inputId() == MeshRegistrar::UnregisteredId) );
+  REMUS_ASSERT( (a.inputType() == "NotRegisteredIn") );
+  REMUS_ASSERT( (a.outputType() == "Mesh2D") );
+  REMUS_ASSERT( (MeshRegistrar::name(a.inputId()).empty()) );
+
+  //they still compare by name
+  REMUS_ASSERT( (a == b) );
+  REMUS_ASSERT( (a != c) );
+  REMUS_ASSERT( ((a < c) != (c < a)) );
+  REMUS_ASSERT( (!(a < b) && !(b < a)) );
+
+  boost::hash<remus::common::MeshIOType> hasher;
+  REMUS_ASSERT( (hasher(a) == hasher(b)) );
+
+  std::set<remus::common::MeshIOType> types;
+  types.insert(a);
+  types.insert(b);
+  types.insert(c);
+  REMUS_ASSERT( (types.size() == 2) );
+
+  std::stringstream buffer;
+  buffer << c;
+  remus::common::MeshIOType from_wire;
+  buffer >> from_wire;
+  REMUS_ASSERT( (from_wire == c) );
+  REMUS_ASSERT( (from_wire.inputType() == "OtherNotRegisteredIn") );
+}
+
+
+void verify_registered_after_construction()
+{
+  using remus::common::MeshRegistrar;
+
+  const std::size_t numTypes = MeshRegistrar::numberOfRegisteredTypes();
+  REMUS_ASSERT( (remus::common::generateAllIOTypes().size() ==
+                 numTypes * numTypes) );
+
+  //made while LateMeshType isn't registered
+  remus::common::MeshIOType early("LateMeshType","Mesh2D");
+  remus::common::MeshIOType other("Model","Mesh2D");
+  REMUS_ASSERT( (early.inputId() == MeshRegistrar::UnregisteredId) );
+
+  remus::common::MeshRegistrar registrar( (LateMeshType()) );
+
+  //made after, so it holds the id
+  remus::common::MeshIOType late("LateMeshType","Mesh2D");
+  REMUS_ASSERT( (late.inputId() != MeshRegistrar::UnregisteredId) );
+  REMUS_ASSERT( (early.inputId() == MeshRegistrar::UnregisteredId) );
+
+  //they still are the same type
+  REMUS_ASSERT( (early == late) );
+  REMUS_ASSERT( (late == early) );
+  REMUS_ASSERT( (!(early < late) && !(late < early)) );
+  REMUS_ASSERT( (early != other) );
+  REMUS_ASSERT( ((early < other) != (other < early)) );
+  REMUS_ASSERT( ((early < other) == (late < other)) );
+
+  boost::hash<remus::common::MeshIOType> hasher;
+  REMUS_ASSERT( (hasher(early) == hasher(late)) );
+
+  std::set<remus::common::MeshIOType> types;
+  types.insert(late);
+  types.insert(other);
+  REMUS_ASSERT( (types.count(early) == 1) );
+
+  //the cross product is rebuilt once a type is registered
+  REMUS_ASSERT( (remus::common::generateAllIOTypes().size() ==
+                 (numTypes+1) * (numTypes+1)) );
+  REMUS_ASSERT( (remus::common::generateAllIOTypes().count(early) == 1) );
+}
+
 }
 
 
@@ -151,5 +275,8 @@ int UnitTestMeshIOType(int, char *[])
   verify_custom_type();
   verify_set();
   verify_serialization();
+  verify_packed_ids();
+  verify_unregistered_names();
+  verify_registered_after_construction();
   return 0;
 }
@@ -92,6 +92,49 @@ namespace
     VerifySame(base, TextMeshType::create() );
     VerifySame(base, remus::meshtypes::to_meshType("TextMeshType"));
   }
+
+  void verify_cached_instances_and_ids()
+  {
+    using remus::common::MeshRegistrar;
+    typedef boost::shared_ptr<remus::meshtypes::MeshTypeBase> MeshType;
+
+    //lookups return the same instance instead of creating a new one
+    MeshType first = MeshRegistrar::instantiate("Mesh2D");
+    MeshType second = MeshRegistrar::instantiate("Mesh2D");
+    REMUS_ASSERT( (first.get() == second.get()) );
+    REMUS_ASSERT( (MeshRegistrar::allRegisteredTypes().count(first) == 1) );
+
+    //the empty name is always the invalid id
+    REMUS_ASSERT( (MeshRegistrar::id("") == MeshRegistrar::InvalidId) );
+    REMUS_ASSERT( (MeshRegistrar::name(MeshRegistrar::InvalidId).empty()) );
+
+    //registered types have small dense ids
+    const boost::uint32_t mesh2D = MeshRegistrar::id("Mesh2D");
+    REMUS_ASSERT( (mesh2D != MeshRegistrar::InvalidId) );
+    REMUS_ASSERT( (mesh2D <= MeshRegistrar::numberOfRegisteredTypes()) );
+    REMUS_ASSERT( (MeshRegistrar::id("Mesh2D") == mesh2D) );
+    REMUS_ASSERT( (MeshRegistrar::name(mesh2D) == "Mesh2D") );
+
+    //names that aren't registered aren't given an id or remembered
+    const std::size_t numTypes = MeshRegistrar::numberOfRegisteredTypes();
+    const boost::uint32_t unknown = MeshRegistrar::id("NotARegisteredType");
+    REMUS_ASSERT( (unknown == MeshRegistrar::UnregisteredId) );
+    REMUS_ASSERT( (MeshRegistrar::id("AnotherUnregisteredType") == unknown) );
+    REMUS_ASSERT( (MeshRegistrar::name(unknown).empty()) );
+    REMUS_ASSERT( (MeshRegistrar::numberOfRegisteredTypes() == numTypes) );
+    REMUS_ASSERT( (MeshRegistrar::instantiate("NotARegisteredType")->name().empty()) );
+
+    //registering a type again doesn't add a new type
+    const boost::uint64_t version = MeshRegistrar::registrationVersion();
+    const std::set<MeshType> before = MeshRegistrar::allRegisteredTypes();
+    RegisterTextMeshType();
+    REMUS_ASSERT( (MeshRegistrar::numberOfRegisteredTypes() == numTypes) );
+    REMUS_ASSERT( (MeshRegistrar::registrationVersion() != version) );
+
+    //snapshots taken before a registration aren't changed by it
+    REMUS_ASSERT( (before.size() == numTypes) );
+    REMUS_ASSERT( (before.count(MeshRegistrar::instantiate("TextMeshType")) == 0) );
+  }
 }
 
 
@@ -101,6 +144,7 @@ int UnitTestMeshRegistry(int, char *[])
   verify_create();
   no_conflicting_ids_or_names();
   can_add_custom_type();
+  verify_cached_instances_and_ids();
 
   return 0;
 }
@@ -0,0 +1,144 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/BinaryEvent.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+
+namespace
+{
+//bump this when the layout changes
+static const boost::uint8_t binary_event_version = 1;
+
+//size of everything before the variable length sections
+static const std::size_t fixed_size = 5 + 4 + 16;
+
+//------------------------------------------------------------------------------
+template<typename T>
+void write_le(std::string& buffer, T value)
+{
+  for(std::size_t i=0; i < sizeof(T); ++i)
+    {
+    buffer.push_back( static_cast<char>( (value >> (8*i)) & 0xFF ) );
+    }
+}
+
+//------------------------------------------------------------------------------
+template<typename T>
+bool read_le(const unsigned char*& pos, const unsigned char* end, T& value)
+{
+  if(static_cast<std::size_t>(end - pos) < sizeof(T))
+    {
+    return false;
+    }
+  value = 0;
+  for(std::size_t i=0; i < sizeof(T); ++i)
+    {
+    value |= static_cast<T>( static_cast<T>(pos[i]) << (8*i) );
+    }
+  pos += sizeof(T);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool read_string(const unsigned char*& pos, const unsigned char* end,
+                 std::size_t length, std::string& value)
+{
+  if(static_cast<std::size_t>(end - pos) < length)
+    {
+    return false;
+    }
+  value.assign(reinterpret_cast<const char*>(pos), length);
+  pos += length;
+  return true;
+}
+
+}
+
+namespace remus {
+namespace proto {
+
+//------------------------------------------------------------------------------
+std::string to_binary(const remus::proto::BinaryEvent& event)
+{
+  const std::size_t workerLength =
+              std::min<std::size_t>(event.WorkerId.size(), 0xFFFF);
+
+  std::string buffer;
+  buffer.reserve(fixed_size + 2 + workerLength +
+                 4 + event.ProgressMessage.size() +
+                 4 + event.Requirements.size());
+
+  write_le<boost::uint8_t>(buffer, binary_event_version);
+  write_le<boost::uint8_t>(buffer, static_cast<boost::uint8_t>(event.EventCategory));
+  write_le<boost::uint8_t>(buffer, static_cast<boost::uint8_t>(event.Type));
+  write_le<boost::uint8_t>(buffer, static_cast<boost::uint8_t>(event.Status));
+  write_le<boost::uint8_t>(buffer, event.Responsive ? 1 : 0);
+  write_le<boost::uint32_t>(buffer, static_cast<boost::uint32_t>(event.ProgressValue));
+  buffer.append(reinterpret_cast<const char*>(event.JobId.begin()), 16);
+
+  write_le<boost::uint16_t>(buffer, static_cast<boost::uint16_t>(workerLength));
+  buffer.append(event.WorkerId, 0, workerLength);
+
+  write_le<boost::uint32_t>(buffer,
+                    static_cast<boost::uint32_t>(event.ProgressMessage.size()));
+  buffer.append(event.ProgressMessage);
+
+  write_le<boost::uint32_t>(buffer,
+                    static_cast<boost::uint32_t>(event.Requirements.size()));
+  buffer.append(event.Requirements);
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+bool from_binary(const char* data, std::size_t size,
+                 remus::proto::BinaryEvent& event)
+{
+  const unsigned char* pos = reinterpret_cast<const unsigned char*>(data);
+  const unsigned char* end = pos + size;
+
+  boost::uint8_t version=0, category=0, type=0, status=0, flags=0;
+  boost::uint32_t progress=0;
+  if(!read_le(pos, end, version) || version != binary_event_version ||
+     !read_le(pos, end, category) || !read_le(pos, end, type) ||
+     !read_le(pos, end, status) || !read_le(pos, end, flags) ||
+     !read_le(pos, end, progress) ||
+     static_cast<std::size_t>(end - pos) < 16)
+    {
+    return false;
+    }
+
+  event.EventCategory = (category == BinaryEvent::WORKER) ? BinaryEvent::WORKER
+                                                          : BinaryEvent::JOB;
+  event.Type = type;
+  event.Status = static_cast<remus::STATUS_TYPE>(status);
+  event.Responsive = (flags & 1) != 0;
+  event.ProgressValue = static_cast<int>(progress);
+  std::copy(pos, pos+16, event.JobId.begin());
+  pos += 16;
+
+  boost::uint16_t workerLength = 0;
+  boost::uint32_t messageLength = 0, reqsLength = 0;
+  return read_le(pos, end, workerLength) &&
+         read_string(pos, end, workerLength, event.WorkerId) &&
+         read_le(pos, end, messageLength) &&
+         read_string(pos, end, messageLength, event.ProgressMessage) &&
+         read_le(pos, end, reqsLength) &&
+         read_string(pos, end, reqsLength, event.Requirements);
+}
+
+}
+}
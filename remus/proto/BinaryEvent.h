@@ -0,0 +1,105 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_BinaryEvent_h
+#define remus_proto_BinaryEvent_h
+
+#include <remus/common/CompilerInformation.h>
+#include <remus/common/StatusTypes.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <string>
+
+//included for export symbols
+#include <remus/proto/ProtoExports.h>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus {
+namespace proto {
+
+//The compact binary form of an event published on the server status channel.
+//The server publishes binary events under the same keys as the JSON events,
+//prefixed with binary_event_prefix. So "job:QUEUED:<id>" becomes
+//"bin:job:QUEUED:<id>".
+//
+//The encoded layout is little endian:
+//  u8 version, u8 category, u8 type, u8 status, u8 flags, i32 progress value,
+//  16 byte job id, u16 length + worker id, u32 length + progress message,
+//  u32 length + serialized JobRequirements
+struct BinaryEvent
+{
+  enum Category { JOB = 0, WORKER = 1 };
+
+  BinaryEvent():
+    EventCategory(JOB),
+    Type(0),
+    JobId(boost::uuids::nil_uuid()),
+    WorkerId(),
+    Status(remus::INVALID_STATUS),
+    ProgressValue(0),
+    ProgressMessage(),
+    Responsive(false),
+    Requirements()
+    {}
+
+  Category EventCategory;
+
+  //either a jobevents::EVENT_TYPE or workevents::EVENT_TYPE
+  //depending on the category
+  int Type;
+
+  boost::uuids::uuid JobId;
+  std::string WorkerId;
+
+  remus::STATUS_TYPE Status;
+  int ProgressValue;
+  std::string ProgressMessage;
+
+  //only meaningful for worker state events
+  bool Responsive;
+
+  //the proto serialized form of the JobRequirements, only
+  //filled in for queued jobs and registering workers. The requirements
+  //content is left out
+  std::string Requirements;
+};
+
+//the prefix that the binary form of an event key starts with. Binary
+//events are only sent to subscriptions that start with this prefix
+static const std::string binary_event_prefix = "bin:";
+
+//encode an event into the compact binary form
+REMUSPROTO_EXPORT
+std::string to_binary(const remus::proto::BinaryEvent& event);
+
+//decode an event from the compact binary form. Returns false
+//if the data isn't a valid binary event
+REMUSPROTO_EXPORT
+bool from_binary(const char* data, std::size_t size,
+                 remus::proto::BinaryEvent& event);
+
+}
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
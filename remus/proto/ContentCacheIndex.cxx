@@ -0,0 +1,130 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/ContentCacheIndex.h>
+
+#include <sstream>
+
+namespace remus{
+namespace proto{
+
+//------------------------------------------------------------------------------
+ContentCacheIndex::ContentCacheIndex():
+  MaxBytes(0),
+  MinContentSize(0),
+  Bytes(0),
+  NextUse(0),
+  Entries(),
+  UseOrder()
+{
+}
+
+//------------------------------------------------------------------------------
+ContentCacheIndex::ContentCacheIndex(std::size_t maxBytes,
+                                     std::size_t minContentSize):
+  MaxBytes(maxBytes),
+  MinContentSize(minContentSize),
+  Bytes(0),
+  NextUse(0),
+  Entries(),
+  UseOrder()
+{
+}
+
+//------------------------------------------------------------------------------
+std::size_t ContentCacheIndex::contentSize(const std::string& hash) const
+{
+  std::map<std::string, Entry>::const_iterator i = this->Entries.find(hash);
+  return (i != this->Entries.end()) ? i->second.Size : 0;
+}
+
+//------------------------------------------------------------------------------
+bool ContentCacheIndex::touch(const std::string& hash)
+{
+  std::map<std::string, Entry>::iterator i = this->Entries.find(hash);
+  if(i == this->Entries.end())
+    {
+    return false;
+    }
+  this->UseOrder.erase(i->second.Use);
+  i->second.Use = this->NextUse++;
+  this->UseOrder[i->second.Use] = hash;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ContentCacheIndex::insert(const std::string& hash,
+                               std::size_t contentSize,
+                               std::vector<std::string>& evicted)
+{
+  if(!this->cacheable(contentSize) || this->touch(hash))
+    {
+    return;
+    }
+
+  //evict the least recently used entries until the new entry fits
+  while(this->Bytes + contentSize > this->MaxBytes && !this->UseOrder.empty())
+    {
+    std::map<unsigned long long, std::string>::iterator oldest =
+                                                        this->UseOrder.begin();
+    std::map<std::string, Entry>::iterator entry =
+                                        this->Entries.find(oldest->second);
+    this->Bytes -= entry->second.Size;
+    evicted.push_back(oldest->second);
+    this->Entries.erase(entry);
+    this->UseOrder.erase(oldest);
+    }
+
+  const Entry entry(contentSize, this->NextUse++);
+  this->Entries[hash] = entry;
+  this->UseOrder[entry.Use] = hash;
+  this->Bytes += contentSize;
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::string> ContentCacheIndex::hashes() const
+{
+  std::vector<std::string> result;
+  result.reserve(this->UseOrder.size());
+  typedef std::map<unsigned long long, std::string>::const_iterator iter;
+  for(iter i = this->UseOrder.begin(); i != this->UseOrder.end(); ++i)
+    {
+    result.push_back(i->second);
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::ContentCacheIndex& index)
+{
+  std::ostringstream buffer;
+  buffer << index.maxBytes() << '\n' << index.minContentSize() << '\n';
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::ContentCacheIndex to_ContentCacheIndex(const char* data,
+                                                     std::size_t size)
+{
+  std::istringstream buffer(std::string(data,size));
+  std::size_t maxBytes = 0;
+  std::size_t minContentSize = 0;
+  buffer >> maxBytes >> minContentSize;
+  if(!buffer)
+    {
+    return remus::proto::ContentCacheIndex();
+    }
+  return remus::proto::ContentCacheIndex(maxBytes, minContentSize);
+}
+
+}
+}
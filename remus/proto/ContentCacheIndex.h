@@ -0,0 +1,120 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_ContentCacheIndex_h
+#define remus_proto_ContentCacheIndex_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+//included for export symbols
+#include <remus/proto/ProtoExports.h>
+
+#include <remus/common/CompilerInformation.h>
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus {
+namespace proto {
+
+//The index of a least recently used cache of job content, keyed by the hash
+//of the content, that holds at most maxBytes of content. Only content that
+//is at least minContentSize bytes is worth caching.
+//
+//A worker with a content cache and the server both keep an index of the
+//cache. They start out empty when the server acknowledges the cache, and
+//as both sides see the same content in the same order, they evict the
+//same entries. That way the server always knows what the worker holds,
+//without the worker listing its hashes after every job.
+class REMUSPROTO_EXPORT ContentCacheIndex
+{
+public:
+  //construct a disabled index, that can't hold anything
+  ContentCacheIndex();
+
+  ContentCacheIndex(std::size_t maxBytes, std::size_t minContentSize);
+
+  bool enabled() const { return this->MaxBytes > 0; }
+
+  std::size_t maxBytes() const { return this->MaxBytes; }
+  std::size_t minContentSize() const { return this->MinContentSize; }
+
+  //returns the number of entries and the bytes they hold
+  std::size_t size() const { return this->Entries.size(); }
+  std::size_t sizeInBytes() const { return this->Bytes; }
+
+  //returns true if content of the given size is cached
+  bool cacheable(std::size_t contentSize) const
+    { return this->enabled() && contentSize >= this->MinContentSize &&
+             contentSize <= this->MaxBytes; }
+
+  bool contains(const std::string& hash) const
+    { return this->Entries.count(hash) != 0; }
+
+  //returns the size of the content with the given hash, or zero
+  std::size_t contentSize(const std::string& hash) const;
+
+  //marks the entry as the most recently used. Returns false if the
+  //entry isn't held
+  bool touch(const std::string& hash);
+
+  //adds an entry as the most recently used, and adds the hashes of the
+  //entries that had to be evicted to make room for it to evicted. Content
+  //that isn't cacheable isn't added
+  void insert(const std::string& hash, std::size_t contentSize,
+              std::vector<std::string>& evicted);
+
+  //returns the hashes from least to most recently used
+  std::vector<std::string> hashes() const;
+
+private:
+  struct Entry
+  {
+    Entry(): Size(0), Use(0) {}
+    Entry(std::size_t size, unsigned long long use): Size(size), Use(use) {}
+    std::size_t Size;
+    unsigned long long Use;
+  };
+
+  std::size_t MaxBytes;
+  std::size_t MinContentSize;
+  std::size_t Bytes;
+  unsigned long long NextUse;
+
+  std::map<std::string, Entry> Entries;
+  //the hash of every entry, ordered by when it was last used
+  std::map<unsigned long long, std::string> UseOrder;
+};
+
+//------------------------------------------------------------------------------
+//the payload of a CONTENT_CACHE message, which holds the size of the
+//cache that the worker keeps
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::ContentCacheIndex& index);
+
+//------------------------------------------------------------------------------
+//returns an empty index with the size of the cache of the message
+REMUSPROTO_EXPORT
+remus::proto::ContentCacheIndex to_ContentCacheIndex(const char* data,
+                                                     std::size_t size);
+
+}
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -25,7 +25,8 @@ namespace jobevents {
      JobEventTypeMacro(JOB_STATUS, 2, "CURRENT JOB STATUS"), \
      JobEventTypeMacro(TERMINATED, 3, "TERMINATED"), \
      JobEventTypeMacro(EXPIRED, 4, "EXPIRED"), \
-     JobEventTypeMacro(COMPLETED, 5, "COMPLETED")
+     JobEventTypeMacro(COMPLETED, 5, "COMPLETED"), \
+     JobEventTypeMacro(ASSIGNED_TO_WORKER, 6, "ASSIGNED TO WORKER")
 
 //------------------------------------------------------------------------------
 enum EVENT_TYPE
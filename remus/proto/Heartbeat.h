@@ -0,0 +1,76 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_Heartbeat_h
+#define remus_proto_Heartbeat_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <cstddef>
+#include <string>
+
+namespace remus {
+namespace proto {
+
+//The payload of a HEARTBEAT message is the number of milliseconds until
+//the worker will send its next message.
+//
+//The encoded layout is a null byte followed by the interval as a
+//little endian i64. Older workers send the interval as a decimal string,
+//which never starts with a null byte, so both forms can be decoded.
+
+//------------------------------------------------------------------------------
+inline std::string to_HeartbeatPayload(boost::int64_t intervalInMillisec)
+{
+  std::string payload(9, '\0');
+  const boost::uint64_t value = static_cast<boost::uint64_t>(intervalInMillisec);
+  for(std::size_t i=0; i < 8; ++i)
+    {
+    payload[i+1] = static_cast<char>( (value >> (8*i)) & 0xff );
+    }
+  return payload;
+}
+
+//------------------------------------------------------------------------------
+//returns -1 when the payload can't be decoded
+inline boost::int64_t to_HeartbeatInterval(const char* data, std::size_t size)
+{
+  if(size == 9 && data[0] == '\0')
+    {
+    boost::uint64_t value = 0;
+    for(std::size_t i=0; i < 8; ++i)
+      {
+      value |= static_cast<boost::uint64_t>(
+                 static_cast<unsigned char>(data[i+1])) << (8*i);
+      }
+    return static_cast<boost::int64_t>(value);
+    }
+
+  try
+    {
+    return boost::lexical_cast<boost::int64_t>(std::string(data,size));
+    }
+  catch(boost::bad_lexical_cast&)
+    {
+    return -1;
+    }
+}
+
+}
+}
+
+#endif
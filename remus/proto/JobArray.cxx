@@ -0,0 +1,317 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/JobArray.h>
+
+#include <remus/common/ConversionHelper.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+  //the element index is stored in these bytes of an element id. The
+  //last two bytes are left alone, as they are used by the ShardedClient
+  const std::size_t IndexByte = 10;
+
+  //------------------------------------------------------------------------------
+  void write_overrides(std::ostream& buffer,
+                       const remus::proto::JobArraySubmission::Overrides& o)
+  {
+    typedef remus::proto::JobArraySubmission::Overrides::const_iterator It;
+    buffer << o.size() << '\n';
+    for(It i = o.begin(); i != o.end(); ++i)
+      {
+      buffer << i->first.size() << '\n';
+      remus::internal::writeString(buffer,i->first);
+      buffer << i->second << '\n';
+      }
+  }
+
+  //------------------------------------------------------------------------------
+  void read_overrides(std::istream& buffer,
+                      remus::proto::JobArraySubmission::Overrides& o)
+  {
+    std::size_t count = 0;
+    buffer >> count;
+    for(std::size_t i = 0; i < count; ++i)
+      {
+      std::size_t keySize = 0;
+      buffer >> keySize;
+      const std::string key = remus::internal::extractString(buffer,keySize);
+
+      remus::proto::JobContent value;
+      buffer >> value;
+      o[key] = value;
+      }
+  }
+}
+
+namespace remus{
+namespace proto{
+
+//------------------------------------------------------------------------------
+JobArraySubmission::JobArraySubmission():
+  Base(),
+  Elements()
+{
+}
+
+//------------------------------------------------------------------------------
+JobArraySubmission::JobArraySubmission(const remus::proto::JobSubmission& base):
+  Base(base),
+  Elements()
+{
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobArraySubmission::addElement(const Overrides& overrides)
+{
+  this->Elements.push_back(overrides);
+  return this->Elements.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobArraySubmission::addElement(const std::string& key,
+                                       const remus::proto::JobContent& content)
+{
+  Overrides overrides;
+  overrides[key] = content;
+  return this->addElement(overrides);
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobSubmission JobArraySubmission::element(std::size_t index) const
+{
+  //JobContent shares its data between copies, so this only copies
+  //the keys of the base submission
+  remus::proto::JobSubmission sub(this->Base);
+  const Overrides& overrides = this->Elements[index];
+  for(Overrides::const_iterator i = overrides.begin();
+      i != overrides.end(); ++i)
+    {
+    sub[i->first] = i->second;
+    }
+  return sub;
+}
+
+//------------------------------------------------------------------------------
+void JobArraySubmission::serialize(std::ostream& buffer) const
+{ //note don't use std::endl as it flushes stream and decrease performance
+  buffer << this->Base << '\n';
+  buffer << this->Elements.size() << '\n';
+  for(std::vector<Overrides>::const_iterator i = this->Elements.begin();
+      i != this->Elements.end(); ++i)
+    {
+    write_overrides(buffer, *i);
+    }
+}
+
+//------------------------------------------------------------------------------
+JobArraySubmission::JobArraySubmission(std::istream& buffer):
+  Base(),
+  Elements()
+{
+  std::size_t count = 0;
+  buffer >> this->Base;
+  buffer >> count;
+  this->Elements.resize(count);
+  for(std::size_t i = 0; i < count; ++i)
+    {
+    read_overrides(buffer, this->Elements[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+JobArray::JobArray(const boost::uuids::uuid& id,
+                   const remus::common::MeshIOType& type,
+                   std::size_t size):
+  Id(id),
+  Type(type),
+  Size(size)
+{
+}
+
+//------------------------------------------------------------------------------
+remus::proto::Job JobArray::job(std::size_t index) const
+{
+  return remus::proto::Job(make_JobArrayElementId(this->Id, index),
+                           this->Type);
+}
+
+//------------------------------------------------------------------------------
+void JobArray::serialize(std::ostream& buffer) const
+{
+  buffer << this->Id << '\n';
+  buffer << this->Type << '\n';
+  buffer << this->Size << '\n';
+}
+
+//------------------------------------------------------------------------------
+JobArray::JobArray(std::istream& buffer):
+  Id(boost::uuids::nil_uuid()),
+  Type(),
+  Size(0)
+{
+  buffer >> this->Id;
+  buffer >> this->Type;
+  buffer >> this->Size;
+}
+
+//------------------------------------------------------------------------------
+JobArrayStatus::JobArrayStatus(const boost::uuids::uuid& id, std::size_t size):
+  Id(id),
+  Statuses(size, static_cast<char>(remus::INVALID_STATUS))
+{
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobArrayStatus::count(remus::STATUS_TYPE s) const
+{
+  return static_cast<std::size_t>(
+    std::count(this->Statuses.begin(), this->Statuses.end(),
+               static_cast<char>(s)));
+}
+
+//------------------------------------------------------------------------------
+void JobArrayStatus::serialize(std::ostream& buffer) const
+{
+  //statuses are written as a single digit per element
+  std::string digits(this->Statuses.size(), '0');
+  for(std::size_t i = 0; i < this->Statuses.size(); ++i)
+    {
+    digits[i] = static_cast<char>('0' + this->Statuses[i]);
+    }
+
+  buffer << this->Id << '\n';
+  buffer << digits.size() << '\n';
+  remus::internal::writeString(buffer, digits);
+}
+
+//------------------------------------------------------------------------------
+JobArrayStatus::JobArrayStatus(std::istream& buffer):
+  Id(boost::uuids::nil_uuid()),
+  Statuses()
+{
+  std::size_t size = 0;
+  buffer >> this->Id;
+  buffer >> size;
+  const std::string digits = remus::internal::extractString(buffer, size);
+
+  this->Statuses.resize(digits.size());
+  for(std::size_t i = 0; i < digits.size(); ++i)
+    {
+    this->Statuses[i] = static_cast<char>(digits[i] - '0');
+    }
+}
+
+//------------------------------------------------------------------------------
+boost::uuids::uuid make_JobArrayElementId(const boost::uuids::uuid& arrayId,
+                                          std::size_t index)
+{
+  //store index + 1, so that no element id is equal to the array id
+  const boost::uint32_t value = static_cast<boost::uint32_t>(index + 1);
+  boost::uuids::uuid id = arrayId;
+  id.data[IndexByte]     = static_cast<boost::uint8_t>((value >> 24) & 0xFF);
+  id.data[IndexByte + 1] = static_cast<boost::uint8_t>((value >> 16) & 0xFF);
+  id.data[IndexByte + 2] = static_cast<boost::uint8_t>((value >> 8) & 0xFF);
+  id.data[IndexByte + 3] = static_cast<boost::uint8_t>(value & 0xFF);
+  return id;
+}
+
+//------------------------------------------------------------------------------
+boost::uuids::uuid make_JobArrayId(const boost::uuids::uuid& randomId)
+{
+  boost::uuids::uuid id = randomId;
+  std::fill(id.data + IndexByte, id.data + IndexByte + 4, 0);
+  return id;
+}
+
+//------------------------------------------------------------------------------
+bool split_JobArrayElementId(const boost::uuids::uuid& id,
+                             boost::uuids::uuid& arrayId,
+                             std::size_t& index)
+{
+  const boost::uint32_t value =
+                    (static_cast<boost::uint32_t>(id.data[IndexByte]) << 24) |
+                    (static_cast<boost::uint32_t>(id.data[IndexByte + 1]) << 16) |
+                    (static_cast<boost::uint32_t>(id.data[IndexByte + 2]) << 8) |
+                     static_cast<boost::uint32_t>(id.data[IndexByte + 3]);
+  if(value == 0)
+    {
+    return false;
+    }
+  arrayId = make_JobArrayId(id);
+  index = static_cast<std::size_t>(value - 1);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::JobArraySubmission& submission)
+{
+  std::ostringstream buffer;
+  buffer << submission;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArraySubmission
+to_JobArraySubmission(const char* data, std::size_t size)
+{
+  std::stringstream buffer;
+  remus::internal::writeString(buffer, data, size);
+  remus::proto::JobArraySubmission submission;
+  buffer >> submission;
+  return submission;
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::JobArray& array)
+{
+  std::ostringstream buffer;
+  buffer << array;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArray to_JobArray(const std::string& msg)
+{
+  std::istringstream buffer(msg);
+  remus::proto::JobArray array = remus::proto::make_invalidJobArray();
+  buffer >> array;
+  return array;
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::JobArrayStatus& status)
+{
+  std::ostringstream buffer;
+  buffer << status;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobArrayStatus to_JobArrayStatus(const std::string& msg)
+{
+  std::istringstream buffer(msg);
+  remus::proto::JobArrayStatus status(boost::uuids::nil_uuid(), 0);
+  buffer >> status;
+  return status;
+}
+
+}
+}
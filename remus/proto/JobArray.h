@@ -0,0 +1,293 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_JobArray_h
+#define remus_proto_JobArray_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/common/MeshIOType.h>
+#include <remus/common/StatusTypes.h>
+
+#include <remus/proto/Job.h>
+#include <remus/proto/JobSubmission.h>
+
+//included for export symbols
+#include <remus/proto/ProtoExports.h>
+
+#include <string>
+#include <vector>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus{
+namespace proto{
+
+//The remus::proto::JobArraySubmission class
+// A set of jobs that share a single base JobSubmission and only differ
+// in a few JobContent entries, like the jobs of a parameter sweep.
+//
+// Each element of the array only holds the contents that replace or are
+// added to the base submission. The server keeps a single copy of the base
+// submission, and only builds the JobSubmission of an element when the
+// element is handed to a worker.
+class REMUSPROTO_EXPORT JobArraySubmission
+{
+public:
+  typedef remus::proto::JobSubmission::ContainerType Overrides;
+
+  //the most elements a single array can hold
+  static const std::size_t MaxElements = 0xFFFFFFFE;
+
+  //construct an invalid JobArraySubmission. This constructor is designed
+  //to allows this class to be stored in containers.
+  JobArraySubmission();
+
+  //construct an array without elements, that shares the given submission
+  explicit JobArraySubmission(const remus::proto::JobSubmission& base);
+
+  //get the submission that is shared by all the elements
+  const remus::proto::JobSubmission& base() const { return this->Base; }
+
+  //get the mesh types for all the elements
+  const remus::common::MeshIOType& type() const { return this->Base.type(); }
+
+  //get the requirements for all the elements
+  const remus::proto::JobRequirements& requirements() const
+    { return this->Base.requirements(); }
+
+  //add an element that replaces or adds the given contents to the base
+  //submission. Returns the index of the new element
+  std::size_t addElement(const Overrides& overrides);
+
+  //add an element that replaces or adds a single content entry to the
+  //base submission. Returns the index of the new element
+  std::size_t addElement(const std::string& key,
+                         const remus::proto::JobContent& content);
+
+  //returns the number of elements in the array
+  std::size_t size() const { return this->Elements.size(); }
+
+  //returns the contents that an element replaces or adds to the base
+  const Overrides& overrides(std::size_t index) const
+    { return this->Elements[index]; }
+
+  //build the complete submission of a single element. The contents
+  //are shared with the array, and aren't copied
+  remus::proto::JobSubmission element(std::size_t index) const;
+
+  friend std::ostream& operator<<(std::ostream &os,
+                                  const JobArraySubmission &submission)
+    { submission.serialize(os); return os; }
+
+  friend std::istream& operator>>(std::istream &is,
+                                  JobArraySubmission &submission)
+    { submission = JobArraySubmission(is); return is; }
+
+private:
+  void serialize(std::ostream& buffer) const;
+  explicit JobArraySubmission(std::istream& buffer);
+
+  remus::proto::JobSubmission Base;
+  std::vector<Overrides> Elements;
+};
+
+//The remus::proto::JobArray class
+// Holds the Id, Type and number of elements of a submitted job array.
+//
+// Every element of the array is a normal job that can be used with the
+// status, result and terminate calls of a client. The id of an element is
+// the id of the array with the element index stored in bytes 10 to 13,
+// so the element jobs can be made without asking the server.
+class REMUSPROTO_EXPORT JobArray
+{
+public:
+  //construct a job array object with an Id, Type and number of elements
+  JobArray(const boost::uuids::uuid& id,
+           const remus::common::MeshIOType& type,
+           std::size_t size);
+
+  //get if the current array is a valid array
+  bool valid() const { return this->Type.valid() && this->Size > 0; }
+
+  //get the id of the array
+  const boost::uuids::uuid& id() const { return this->Id; }
+
+  //get the mesh type of all the elements
+  const remus::common::MeshIOType& type() const { return this->Type; }
+
+  //returns the number of elements in the array
+  std::size_t size() const { return this->Size; }
+
+  //returns the job of a single element
+  remus::proto::Job job(std::size_t index) const;
+
+  bool operator <(const JobArray& b) const
+    { return this->Id < b.Id; }
+
+  bool operator ==(const JobArray& b) const
+    { return this->Id == b.Id; }
+
+  bool operator !=(const JobArray& b) const
+    { return !(this->operator ==(b)); }
+
+  friend std::ostream& operator<<(std::ostream &os, const JobArray &array)
+    { array.serialize(os); return os; }
+
+  friend std::istream& operator>>(std::istream &is, JobArray &array)
+    { array = JobArray(is); return is; }
+
+private:
+  void serialize(std::ostream& buffer) const;
+  explicit JobArray(std::istream& buffer);
+
+  boost::uuids::uuid Id;
+  remus::common::MeshIOType Type;
+  std::size_t Size;
+};
+
+//The remus::proto::JobArrayStatus class
+// The status of every element of a job array. Elements that the server
+// doesn't hold anymore, because the results have been retrieved or the
+// element was terminated while queued, are INVALID_STATUS.
+class REMUSPROTO_EXPORT JobArrayStatus
+{
+public:
+  //construct a status where every element is INVALID_STATUS
+  JobArrayStatus(const boost::uuids::uuid& id, std::size_t size);
+
+  //returns the id of the array that this status is for
+  const boost::uuids::uuid& id() const { return this->Id; }
+
+  //returns the number of elements in the array
+  std::size_t size() const { return this->Statuses.size(); }
+
+  void status(std::size_t index, remus::STATUS_TYPE s)
+    { this->Statuses[index] = static_cast<char>(s); }
+  remus::STATUS_TYPE status(std::size_t index) const
+    { return static_cast<remus::STATUS_TYPE>(this->Statuses[index]); }
+
+  //returns the number of elements with the given status
+  std::size_t count(remus::STATUS_TYPE s) const;
+
+  //returns true if no element is queued or in progress
+  bool complete() const
+    { return this->count(remus::QUEUED) + this->count(remus::IN_PROGRESS) == 0; }
+
+  friend std::ostream& operator<<(std::ostream &os,
+                                  const JobArrayStatus &status)
+    { status.serialize(os); return os; }
+
+  friend std::istream& operator>>(std::istream &is,
+                                  JobArrayStatus &status)
+    { status = JobArrayStatus(is); return is; }
+
+private:
+  void serialize(std::ostream& buffer) const;
+  explicit JobArrayStatus(std::istream& buffer);
+
+  boost::uuids::uuid Id;
+  //a single char per element, which keeps large arrays compact
+  std::vector<char> Statuses;
+};
+
+//------------------------------------------------------------------------------
+//returns the id of the element of an array with the given id
+REMUSPROTO_EXPORT
+boost::uuids::uuid make_JobArrayElementId(const boost::uuids::uuid& arrayId,
+                                          std::size_t index);
+
+//------------------------------------------------------------------------------
+//turns a random id into an id that can be used for a job array, by
+//clearing the bytes that hold the element index
+REMUSPROTO_EXPORT
+boost::uuids::uuid make_JobArrayId(const boost::uuids::uuid& randomId);
+
+//------------------------------------------------------------------------------
+//splits the id of an array element into the array id and the element
+//index. Returns false if the id can't be the id of an array element
+REMUSPROTO_EXPORT
+bool split_JobArrayElementId(const boost::uuids::uuid& id,
+                             boost::uuids::uuid& arrayId,
+                             std::size_t& index);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobArray make_invalidJobArray()
+{
+  //use empty strings to signify invalid mesh io type
+  const remus::common::MeshIOType badIOType( (std::string()), (std::string()) );
+  return remus::proto::JobArray(boost::uuids::uuid(),badIOType,0);
+}
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::JobArraySubmission& submission);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+remus::proto::JobArraySubmission
+to_JobArraySubmission(const char* data, std::size_t size);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobArraySubmission
+to_JobArraySubmission(const std::string& msg)
+{
+  return to_JobArraySubmission(msg.c_str(), msg.size());
+}
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::JobArray& array);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+remus::proto::JobArray to_JobArray(const std::string& msg);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobArray to_JobArray(const char* data, std::size_t size)
+{
+  const std::string temp(data,size);
+  return to_JobArray( temp );
+}
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::JobArrayStatus& status);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+remus::proto::JobArrayStatus to_JobArrayStatus(const std::string& msg);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobArrayStatus
+to_JobArrayStatus(const char* data, std::size_t size)
+{
+  const std::string temp(data,size);
+  return to_JobArrayStatus( temp );
+}
+
+}
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -202,6 +202,51 @@ std::size_t JobContent::dataSize() const
   return this->Implementation->size();
 }
 
+//------------------------------------------------------------------------------
+const std::string& JobContent::hash() const
+{
+  return this->Implementation->fullHash();
+}
+
+//------------------------------------------------------------------------------
+JobContent JobContent::reference() const
+{
+  //the source type of the referenced content travels with the hash,
+  //so that it can be restored when the reference is resolved
+  std::ostringstream buffer;
+  buffer << this->sourceType() << '\n' << this->hash();
+
+  JobContent ref(this->formatType(), buffer.str());
+  ref.SourceType = remus::common::ContentSource::Reference;
+  ref.Tag = this->Tag;
+  return ref;
+}
+
+//------------------------------------------------------------------------------
+std::string JobContent::referencedHash() const
+{
+  if(!this->isReference())
+    {
+    return std::string();
+    }
+  const std::string ref(this->data(), this->dataSize());
+  const std::size_t split = ref.find('\n');
+  return (split == std::string::npos) ? std::string() : ref.substr(split+1);
+}
+
+//------------------------------------------------------------------------------
+JobContent JobContent::resolve(const JobContent& referenced) const
+{
+  JobContent content(referenced);
+  int stype = 0;
+  std::istringstream buffer(std::string(this->data(), this->dataSize()));
+  buffer >> stype;
+  content.SourceType = static_cast<remus::common::ContentSource::Type>(stype);
+  content.FormatType = this->FormatType;
+  content.Tag = this->Tag;
+  return content;
+}
+
 //------------------------------------------------------------------------------
 bool JobContent::operator<(const JobContent& other) const
 {
@@ -85,6 +85,25 @@ public:
   const char* data() const;
   std::size_t dataSize() const;
 
+  //returns the md5 hash of the data, which is only computed once
+  const std::string& hash() const;
+
+  //returns a small JobContent that refers to this content by its hash.
+  //The server sends these instead of content that a worker has cached
+  JobContent reference() const;
+
+  //returns true if this was made by reference()
+  bool isReference() const
+    { return this->SourceType == remus::common::ContentSource::Reference; }
+
+  //returns the hash of the content that a reference refers to, or an
+  //empty string if this isn't a reference
+  std::string referencedHash() const;
+
+  //returns the content that a reference refers to, given the content
+  //that has the referenced hash. The data is shared, not copied
+  JobContent resolve(const JobContent& referenced) const;
+
   ///implement a less than operator and equal operator so you
   //can use the class in containers and algorithms
   bool operator<(const JobContent& other) const;
@@ -0,0 +1,216 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/JobListing.h>
+
+#include <remus/common/ConversionHelper.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <sstream>
+
+namespace
+{
+  //------------------------------------------------------------------------------
+  void write_string(std::ostream& buffer, const std::string& str)
+  {
+    buffer << str.size() << '\n';
+    remus::internal::writeString(buffer, str);
+  }
+
+  //------------------------------------------------------------------------------
+  std::string read_string(std::istream& buffer)
+  {
+    std::size_t size = 0;
+    buffer >> size;
+    return remus::internal::extractString(buffer, size);
+  }
+}
+
+namespace remus{
+namespace proto{
+
+//------------------------------------------------------------------------------
+JobListingRequest::JobListingRequest(std::size_t maxEntries):
+  Locations(JobListingRequest::ALL_JOBS),
+  MeshTypes(),
+  WorkerName(),
+  Worker(),
+  Status(remus::INVALID_STATUS),
+  MinimumAge(0),
+  MaxEntries(maxEntries),
+  Cursor()
+{
+}
+
+//------------------------------------------------------------------------------
+bool JobListingRequest::accepts(JobLocation location,
+                                const remus::common::MeshIOType& types,
+                                const std::string& workerName,
+                                remus::STATUS_TYPE status,
+                                const std::string& worker,
+                                boost::int64_t ageInMillisec) const
+{
+  //cheapest checks first, as this is called for every job the
+  //server holds
+  return ((this->Locations & location) != 0) &&
+         (this->Status == remus::INVALID_STATUS || this->Status == status) &&
+         (ageInMillisec >= this->MinimumAge) &&
+         (!this->MeshTypes.valid() || this->MeshTypes == types) &&
+         (this->WorkerName.empty() || this->WorkerName == workerName) &&
+         (this->Worker.empty() || this->Worker == worker);
+}
+
+//------------------------------------------------------------------------------
+void JobListingRequest::serialize(std::ostream& buffer) const
+{ //note don't use std::endl as it flushes stream and decrease performance
+  buffer << this->Locations << '\n';
+  buffer << this->MeshTypes << '\n';
+  write_string(buffer, this->WorkerName);
+  write_string(buffer, this->Worker);
+  buffer << static_cast<int>(this->Status) << '\n';
+  buffer << this->MinimumAge << '\n';
+  buffer << this->MaxEntries << '\n';
+  write_string(buffer, this->Cursor);
+}
+
+//------------------------------------------------------------------------------
+JobListingRequest::JobListingRequest(std::istream& buffer):
+  Locations(JobListingRequest::ALL_JOBS),
+  MeshTypes(),
+  WorkerName(),
+  Worker(),
+  Status(remus::INVALID_STATUS),
+  MinimumAge(0),
+  MaxEntries(0),
+  Cursor()
+{
+  int status = 0;
+  buffer >> this->Locations;
+  buffer >> this->MeshTypes;
+  this->WorkerName = read_string(buffer);
+  this->Worker = read_string(buffer);
+  buffer >> status;
+  buffer >> this->MinimumAge;
+  buffer >> this->MaxEntries;
+  this->Cursor = read_string(buffer);
+  this->Status = static_cast<remus::STATUS_TYPE>(status);
+}
+
+//------------------------------------------------------------------------------
+JobListingEntry::JobListingEntry():
+  Id(boost::uuids::nil_uuid()),
+  Location(JobListingRequest::QUEUED_JOBS),
+  MeshTypes(),
+  WorkerName(),
+  Tag(),
+  Status(remus::INVALID_STATUS),
+  Progress(0),
+  Worker(),
+  AgeInMillisec(0)
+{
+}
+
+//------------------------------------------------------------------------------
+JobListing::JobListing():
+  Entries(),
+  NextCursor()
+{
+}
+
+//------------------------------------------------------------------------------
+void JobListing::serialize(std::ostream& buffer) const
+{ //note don't use std::endl as it flushes stream and decrease performance
+  buffer << this->Entries.size() << '\n';
+  for(const_iterator i = this->Entries.begin(); i != this->Entries.end(); ++i)
+    {
+    buffer << i->Id << '\n';
+    buffer << static_cast<int>(i->Location) << '\n';
+    buffer << i->MeshTypes << '\n';
+    write_string(buffer, i->WorkerName);
+    write_string(buffer, i->Tag);
+    buffer << static_cast<int>(i->Status) << '\n';
+    buffer << i->Progress << '\n';
+    write_string(buffer, i->Worker);
+    buffer << i->AgeInMillisec << '\n';
+    }
+  write_string(buffer, this->NextCursor);
+}
+
+//------------------------------------------------------------------------------
+JobListing::JobListing(std::istream& buffer):
+  Entries(),
+  NextCursor()
+{
+  std::size_t count = 0;
+  buffer >> count;
+  this->Entries.reserve(count);
+  for(std::size_t i=0; i < count; ++i)
+    {
+    JobListingEntry entry;
+    int location = 0, status = 0;
+    buffer >> entry.Id;
+    buffer >> location;
+    buffer >> entry.MeshTypes;
+    entry.WorkerName = read_string(buffer);
+    entry.Tag = read_string(buffer);
+    buffer >> status;
+    buffer >> entry.Progress;
+    entry.Worker = read_string(buffer);
+    buffer >> entry.AgeInMillisec;
+
+    entry.Location = static_cast<JobListingRequest::JobLocation>(location);
+    entry.Status = static_cast<remus::STATUS_TYPE>(status);
+    this->Entries.push_back(entry);
+    }
+  this->NextCursor = read_string(buffer);
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::JobListingRequest& request)
+{
+  std::ostringstream buffer;
+  buffer << request;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobListingRequest to_JobListingRequest(const std::string& msg)
+{
+  std::istringstream buffer(msg);
+  remus::proto::JobListingRequest request;
+  buffer >> request;
+  return request;
+}
+
+//------------------------------------------------------------------------------
+std::string to_string(const remus::proto::JobListing& listing)
+{
+  std::ostringstream buffer;
+  buffer << listing;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobListing to_JobListing(const std::string& msg)
+{
+  std::istringstream buffer(msg);
+  remus::proto::JobListing listing;
+  buffer >> listing;
+  return listing;
+}
+
+}
+}
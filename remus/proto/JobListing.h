@@ -0,0 +1,233 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_JobListing_h
+#define remus_proto_JobListing_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/common/MeshIOType.h>
+#include <remus/common/StatusTypes.h>
+
+//included for export symbols
+#include <remus/proto/ProtoExports.h>
+
+#include <string>
+#include <vector>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus{
+namespace proto{
+
+//The remus::proto::JobListingRequest class
+// Describes which of the jobs the server holds should be listed, and where
+// in the listing to continue from. All the filters are optional, and a job
+// has to pass every filter that is set to be listed.
+//
+// A listing is returned a page at a time. To get the next page pass the
+// cursor of the previous JobListing to the request.
+class REMUSPROTO_EXPORT JobListingRequest
+{
+public:
+  //where a job is on the server. Listings are ordered by location,
+  //and by job id inside a location
+  enum JobLocation
+  {
+    //queued and no worker has been asked to take the job
+    QUEUED_JOBS = 1,
+    //queued and a worker is being started for the job
+    WAITING_FOR_WORKER_JOBS = 2,
+    //given to a worker, including finished and failed jobs whose
+    //results haven't been retrieved
+    ACTIVE_JOBS = 4,
+    ALL_JOBS = QUEUED_JOBS | WAITING_FOR_WORKER_JOBS | ACTIVE_JOBS
+  };
+
+  //list every job the server holds, maxEntries jobs at a time
+  explicit JobListingRequest(std::size_t maxEntries = 100);
+
+  //only list jobs at the given locations, which are or'ed JobLocations
+  void locations(int locs) { this->Locations = locs; }
+  int locations() const { return this->Locations; }
+
+  //only list jobs with the given mesh types. An invalid
+  //MeshIOType lists all mesh types
+  void meshTypes(const remus::common::MeshIOType& types) { this->MeshTypes = types; }
+  const remus::common::MeshIOType& meshTypes() const { return this->MeshTypes; }
+
+  //only list jobs whose requirements have the given worker name.
+  //An empty name lists all jobs
+  void workerName(const std::string& name) { this->WorkerName = name; }
+  const std::string& workerName() const { return this->WorkerName; }
+
+  //only list jobs that the worker with the given id is working on, this is
+  //the same worker id that is used on the status channel. An empty id
+  //lists all jobs
+  void worker(const std::string& id) { this->Worker = id; }
+  const std::string& worker() const { return this->Worker; }
+
+  //only list jobs with the given status. INVALID_STATUS lists all jobs
+  void status(remus::STATUS_TYPE s) { this->Status = s; }
+  remus::STATUS_TYPE status() const { return this->Status; }
+
+  //only list jobs that have been at their location for at least
+  //the given number of milliseconds
+  void minimumAge(boost::int64_t millisec) { this->MinimumAge = millisec; }
+  boost::int64_t minimumAge() const { return this->MinimumAge; }
+
+  //the most jobs to return in a single listing. The server can
+  //return fewer jobs than this
+  void maxEntries(std::size_t count) { this->MaxEntries = count; }
+  std::size_t maxEntries() const { return this->MaxEntries; }
+
+  //where to continue the listing from, this is the cursor of the
+  //previous JobListing. An empty cursor starts from the beginning
+  void cursor(const std::string& c) { this->Cursor = c; }
+  const std::string& cursor() const { return this->Cursor; }
+
+  //returns true if a job passes all the filters
+  bool accepts(JobLocation location,
+               const remus::common::MeshIOType& types,
+               const std::string& workerName,
+               remus::STATUS_TYPE status,
+               const std::string& worker,
+               boost::int64_t ageInMillisec) const;
+
+  friend std::ostream& operator<<(std::ostream &os,
+                                  const JobListingRequest &request)
+    { request.serialize(os); return os; }
+
+  friend std::istream& operator>>(std::istream &is,
+                                  JobListingRequest &request)
+    { request = JobListingRequest(is); return is; }
+
+private:
+  void serialize(std::ostream& buffer) const;
+  explicit JobListingRequest(std::istream& buffer);
+
+  int Locations;
+  remus::common::MeshIOType MeshTypes;
+  std::string WorkerName;
+  std::string Worker;
+  remus::STATUS_TYPE Status;
+  boost::int64_t MinimumAge;
+  std::size_t MaxEntries;
+  std::string Cursor;
+};
+
+//A single job of a JobListing. Only the small parts of a job are listed,
+//the submission contents and results have to be asked for separately
+struct REMUSPROTO_EXPORT JobListingEntry
+{
+  JobListingEntry();
+
+  boost::uuids::uuid Id;
+  JobListingRequest::JobLocation Location;
+  remus::common::MeshIOType MeshTypes;
+  std::string WorkerName;
+  std::string Tag;
+  remus::STATUS_TYPE Status;
+  int Progress;
+  //id of the worker the job was given to, empty for queued jobs
+  std::string Worker;
+  //milliseconds the job has been at its location
+  boost::int64_t AgeInMillisec;
+};
+
+//The remus::proto::JobListing class
+// A single page of jobs returned for a JobListingRequest
+class REMUSPROTO_EXPORT JobListing
+{
+public:
+  typedef std::vector<JobListingEntry>::const_iterator const_iterator;
+
+  JobListing();
+
+  void add(const JobListingEntry& entry) { this->Entries.push_back(entry); }
+
+  const std::vector<JobListingEntry>& entries() const { return this->Entries; }
+  const_iterator begin() const { return this->Entries.begin(); }
+  const_iterator end() const { return this->Entries.end(); }
+  std::size_t size() const { return this->Entries.size(); }
+
+  //the cursor to pass to the next JobListingRequest to get the
+  //next page. Empty when there are no more jobs to list
+  void nextCursor(const std::string& c) { this->NextCursor = c; }
+  const std::string& nextCursor() const { return this->NextCursor; }
+
+  //returns true if this is the last page of the listing
+  bool complete() const { return this->NextCursor.empty(); }
+
+  friend std::ostream& operator<<(std::ostream &os,
+                                  const JobListing &listing)
+    { listing.serialize(os); return os; }
+
+  friend std::istream& operator>>(std::istream &is,
+                                  JobListing &listing)
+    { listing = JobListing(is); return is; }
+
+private:
+  void serialize(std::ostream& buffer) const;
+  explicit JobListing(std::istream& buffer);
+
+  std::vector<JobListingEntry> Entries;
+  std::string NextCursor;
+};
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::JobListingRequest& request);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+remus::proto::JobListingRequest to_JobListingRequest(const std::string& msg);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobListingRequest
+to_JobListingRequest(const char* data, std::size_t size)
+{
+  const std::string temp(data,size);
+  return to_JobListingRequest( temp );
+}
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::string to_string(const remus::proto::JobListing& listing);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+remus::proto::JobListing to_JobListing(const std::string& msg);
+
+//------------------------------------------------------------------------------
+inline remus::proto::JobListing to_JobListing(const char* data, std::size_t size)
+{
+  const std::string temp(data,size);
+  return to_JobListing( temp );
+}
+
+}
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_JobReservation_h
+#define remus_proto_JobReservation_h
+
+#include <remus/proto/JobRequirements.h>
+
+#include <cstddef>
+#include <string>
+
+namespace remus {
+namespace proto {
+
+//When the server asks a factory to launch a worker for a queued job, it can
+//reserve that job for the new process. The factory hands the reservation
+//token to the process through this environment variable, and the first job
+//request of the worker is a CLAIM_RESERVED_JOB message that carries the
+//token, which the server answers with the reserved job. That saves the
+//worker from waiting in line with every other worker for its first job.
+inline const char* reservationEnvironmentVariable()
+  { return "REMUS_WORKER_RESERVATION"; }
+
+//The payload of a CLAIM_RESERVED_JOB message is the token followed by
+//the requirements that the worker would have sent with MAKE_MESH
+
+//------------------------------------------------------------------------------
+inline std::string to_ReservationClaim(const std::string& token,
+                                       const std::string& requirements)
+{
+  std::string payload;
+  payload.reserve(token.size() + 1 + requirements.size());
+  payload += token;
+  payload += '\n';
+  payload += requirements;
+  return payload;
+}
+
+//------------------------------------------------------------------------------
+//returns false when the payload has no token
+inline bool from_ReservationClaim(const char* data, std::size_t size,
+                                  std::string& token,
+                                  remus::proto::JobRequirements& reqs)
+{
+  std::size_t split = 0;
+  while(split < size && data[split] != '\n')
+    {
+    ++split;
+    }
+  if(split == size || split == 0)
+    {
+    return false;
+    }
+  token.assign(data,split);
+  reqs = remus::proto::to_JobRequirements(data + split + 1, size - split - 1);
+  return true;
+}
+
+}
+}
+
+#endif
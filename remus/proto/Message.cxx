@@ -59,6 +59,26 @@ Message send_Message(remus::common::MeshIOType mtype,
   return Message(mtype,stype,socket,Message::Blocking);
 }
 
+//----------------------------------------------------------------------------
+Message send_Message(remus::common::MeshIOType mtype,
+                     remus::SERVICE_TYPE stype,
+                     const std::string& data,
+                     const std::string& requestId,
+                     zmq::socket_t* socket)
+{
+  return Message(mtype,stype,data,socket,Message::Blocking,requestId);
+}
+
+//----------------------------------------------------------------------------
+Message send_NonBlockingMessage(remus::common::MeshIOType mtype,
+                                remus::SERVICE_TYPE stype,
+                                const std::string& data,
+                                const std::string& requestId,
+                                zmq::socket_t* socket)
+{
+  return Message(mtype,stype,data,socket,Message::NonBlocking,requestId);
+}
+
 //----------------------------------------------------------------------------
 //parse a message from a socket
 Message receive_Message( zmq::socket_t* socket )
@@ -74,16 +94,29 @@ bool forward_Message(const remus::proto::Message& message,
   return message.send_impl(socket,Message::Blocking);
 }
 
+//----------------------------------------------------------------------------
+bool forward_Message(const remus::proto::Message& message,
+                     const std::string& requestId,
+                     zmq::socket_t* socket)
+{
+  //copying only copies the reference to the data
+  remus::proto::Message tagged(message);
+  tagged.RequestId = requestId;
+  return tagged.send_impl(socket,Message::Blocking);
+}
+
 
 //----------------------------------------------------------------------------
 Message::Message(remus::common::MeshIOType mtype,
                  remus::SERVICE_TYPE stype,
                  const std::string& mdata,
                  zmq::socket_t* socket,
-                 Message::SendMode mode):
+                 Message::SendMode mode,
+                 const std::string& requestId):
   MType(mtype),
   SType(stype),
   Valid(true), //need to be initially valid to be sent
+  RequestId(requestId),
   Storage( boost::make_shared<zmq::message_t>(mdata.size()) )
 {
   std::memcpy(Storage->data(),mdata.data(),mdata.size());
@@ -103,6 +136,7 @@ Message::Message(remus::common::MeshIOType mtype,
   MType(mtype),
   SType(stype),
   Valid(true), //need to be initially valid to be sent
+  RequestId(),
   Storage()
 {
   //send_impl wants us to be valid before we are sent, that way it knows
@@ -117,10 +151,11 @@ Message::Message(zmq::socket_t* socket):
   MType(),
   SType(),
   Valid(false),
+  RequestId(),
   Storage( boost::make_shared<zmq::message_t>() )
   {
   //we are receiving a multi part message
-  //frame 0: REQ header / attachReqHeader does this
+  //frame 0: REQ header / attachReqHeader does this, holds the request id
   //frame 1: Mesh Type
   //frame 2: Service Type
   //frame 3: Job Data //optional
@@ -129,7 +164,8 @@ Message::Message(zmq::socket_t* socket):
   socket->getsockopt(ZMQ_RCVMORE, &more, &more_size);
 
   //construct a job message from the socket
-  const bool removedHeader = zmq::removeReqHeader(*socket, ZMQ_DONTWAIT);
+  const bool removedHeader = zmq::removeReqHeader(*socket, this->RequestId,
+                                                  ZMQ_DONTWAIT);
   bool readMeshType = false;
   bool readServiceType = false;
   bool readStorageData = false;
@@ -202,6 +238,7 @@ Message& Message::operator=(Message&& other)
     this->MType = other.MType;
     this->SType = other.SType;
     this->Valid = other.Valid;
+    this->RequestId.swap(other.RequestId);
     this->Storage = other.Storage;
     other.Storage.reset();
   }
@@ -230,7 +267,7 @@ bool Message::send_impl(zmq::socket_t *socket, SendMode mode) const
     }
 
   //we are sending our selves as a multi part message
-  //frame 0: REQ header / attachReqHeader does this
+  //frame 0: REQ header / attachReqHeader does this, holds the request id
   //frame 1: Mesh Type
   //frame 2: Service Type
   //frame 3: Job Data //optional
@@ -241,7 +278,9 @@ bool Message::send_impl(zmq::socket_t *socket, SendMode mode) const
     return false;
     }
 
-  const bool attached_header = zmq::attachReqHeader(*socket,flags);
+  const bool attached_header = zmq::attachReqHeader(*socket,
+                                                    this->RequestId,
+                                                    flags);
 
   bool valid = attached_header;
 
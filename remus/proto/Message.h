@@ -78,6 +78,28 @@ Message send_NonBlockingMessage(remus::common::MeshIOType mtype,
                                 remus::SERVICE_TYPE stype,
                                 zmq::socket_t* socket);
 
+//----------------------------------------------------------------------------
+//pass in a std::string that we will copy and send, along with a request id.
+//The request id is carried in the REQ header frame and is echoed back by the
+//server in the response, which allows a DEALER socket to have multiple
+//requests in flight at once.
+REMUSPROTO_EXPORT
+Message send_Message(remus::common::MeshIOType mtype,
+                     remus::SERVICE_TYPE stype,
+                     const std::string& data,
+                     const std::string& requestId,
+                     zmq::socket_t* socket);
+
+//----------------------------------------------------------------------------
+//pass in a std::string that we will copy and send, along with a request id.
+//The message returned will have a copy of the data given to it.
+REMUSPROTO_EXPORT
+Message send_NonBlockingMessage(remus::common::MeshIOType mtype,
+                                remus::SERVICE_TYPE stype,
+                                const std::string& data,
+                                const std::string& requestId,
+                                zmq::socket_t* socket);
+
 //----------------------------------------------------------------------------
 //parse a message from a socket
 //The message returned will have data associated with if it is valid
@@ -91,6 +113,14 @@ REMUSPROTO_EXPORT
 bool forward_Message(const remus::proto::Message& message,
                      zmq::socket_t* socket);
 
+//----------------------------------------------------------------------------
+//forward a message that has been received to another socket, tagged
+//with a different request id
+REMUSPROTO_EXPORT
+bool forward_Message(const remus::proto::Message& message,
+                     const std::string& requestId,
+                     zmq::socket_t* socket);
+
 
 //All creation of this class needs to happen through the make_Message
 //set of functions
@@ -109,6 +139,10 @@ public:
   //is true if all the message was sent, or all of the message was received.
   bool isValid() const { return Valid; }
 
+  //the request id that the message was tagged with. Messages sent
+  //from REQ sockets will always have an empty request id
+  const std::string& requestId() const { return RequestId; }
+
   Message(const Message&) = default;
   Message& operator=(Message&& other);
   Message& operator=(const Message&) = default;
@@ -123,6 +157,12 @@ private:
                                                 remus::SERVICE_TYPE stype,
                                                 zmq::socket_t* socket);
 
+  friend REMUSPROTO_EXPORT Message send_Message(remus::common::MeshIOType mtype,
+                                                remus::SERVICE_TYPE stype,
+                                                const std::string& data,
+                                                const std::string& requestId,
+                                                zmq::socket_t* socket);
+
   friend REMUSPROTO_EXPORT Message send_NonBlockingMessage(remus::common::MeshIOType mtype,
                                                            remus::SERVICE_TYPE stype,
                                                            const std::string& data,
@@ -132,8 +172,18 @@ private:
                                                            remus::SERVICE_TYPE stype,
                                                            zmq::socket_t* socket);
 
+  friend REMUSPROTO_EXPORT Message send_NonBlockingMessage(remus::common::MeshIOType mtype,
+                                                           remus::SERVICE_TYPE stype,
+                                                           const std::string& data,
+                                                           const std::string& requestId,
+                                                           zmq::socket_t* socket);
+
   friend REMUSPROTO_EXPORT Message receive_Message( zmq::socket_t* socket );
 
+  friend REMUSPROTO_EXPORT bool forward_Message(const remus::proto::Message& message,
+                                                const std::string& requestId,
+                                                zmq::socket_t* socket);
+
   friend REMUSPROTO_EXPORT bool forward_Message(const remus::proto::Message& message,
                                                 zmq::socket_t* socket);
 
@@ -144,7 +194,8 @@ private:
           remus::SERVICE_TYPE stype,
           const std::string& data,
           zmq::socket_t* socket,
-          SendMode mode);
+          SendMode mode,
+          const std::string& requestId = std::string());
 
   //----------------------------------------------------------------------------
   //creates a Message with no data
@@ -162,6 +213,7 @@ private:
   remus::common::MeshIOType MType;
   remus::SERVICE_TYPE SType;
   bool Valid; //tells if the message is valid
+  std::string RequestId;
 
   boost::shared_ptr<zmq::message_t> Storage;
 };
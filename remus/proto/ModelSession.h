@@ -0,0 +1,123 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_proto_ModelSession_h
+#define remus_proto_ModelSession_h
+
+#include <remus/proto/JobSubmission.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace remus {
+namespace proto {
+
+//A model session holds job contents on the server that many submissions
+//share, such as the model of a SMTKMeshSubmission. A submission refers to
+//the session with the id under this key, and the server adds the contents
+//of the session that the submission doesn't hold itself. Jobs of a session
+//are sent to the workers that the session is pinned to, so that a worker
+//can keep the parsed model around between the jobs of a session.
+inline const char* modelSessionKey()
+  { return "model_session"; }
+
+//------------------------------------------------------------------------------
+//returns the id of the session that a submission refers to, or an empty
+//string if it doesn't refer to one
+inline std::string to_ModelSessionId(const remus::proto::JobSubmission& submission)
+{
+  remus::proto::JobSubmission::const_iterator i =
+                                        submission.find(modelSessionKey());
+  if(i == submission.end())
+    {
+    return std::string();
+    }
+  return std::string(i->second.data(), i->second.dataSize());
+}
+
+//The payload of an OPEN_MODEL_SESSION message is the number of workers the
+//session can be pinned to, followed by the contents of the session
+
+//------------------------------------------------------------------------------
+inline std::string to_ModelSessionRequest(
+                              const remus::proto::JobSubmission& contents,
+                              std::size_t maxWorkers)
+{
+  std::ostringstream buffer;
+  buffer << maxWorkers << '\n' << contents;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+//returns false when the payload can't be parsed
+inline bool from_ModelSessionRequest(const char* data, std::size_t size,
+                                     remus::proto::JobSubmission& contents,
+                                     std::size_t& maxWorkers)
+{
+  std::size_t split = 0;
+  while(split < size && data[split] != '\n')
+    {
+    ++split;
+    }
+  if(split == size || split == 0)
+    {
+    return false;
+    }
+  std::istringstream count(std::string(data, split));
+  if(!(count >> maxWorkers))
+    {
+    return false;
+    }
+  contents = remus::proto::to_JobSubmission(data + split + 1, size - split - 1);
+  return true;
+}
+
+//The server sends the contents of a session to a worker once, as the payload
+//of an OPEN_MODEL_SESSION response holding the session id followed by the
+//contents. The jobs of the session that follow don't hold the contents, and
+//the worker adds them back. A CLOSE_MODEL_SESSION response only holds the
+//id of the session the worker can drop
+
+//------------------------------------------------------------------------------
+inline std::string to_ModelSessionContents(const std::string& id,
+                               const remus::proto::JobSubmission& contents)
+{
+  std::ostringstream buffer;
+  buffer << id << '\n' << contents;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+//returns false when the payload can't be parsed
+inline bool from_ModelSessionContents(const char* data, std::size_t size,
+                                      std::string& id,
+                                      remus::proto::JobSubmission& contents)
+{
+  std::size_t split = 0;
+  while(split < size && data[split] != '\n')
+    {
+    ++split;
+    }
+  if(split == size || split == 0)
+    {
+    return false;
+    }
+  id.assign(data, split);
+  contents = remus::proto::to_JobSubmission(data + split + 1, size - split - 1);
+  return true;
+}
+
+}
+}
+
+#endif
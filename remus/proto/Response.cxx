@@ -41,6 +41,16 @@ Response send_NonBlockingResponse(remus::SERVICE_TYPE stype,
   return Response(stype,data,socket,client,Response::NonBlocking);
 }
 
+//----------------------------------------------------------------------------
+Response send_NonBlockingResponse(remus::SERVICE_TYPE stype,
+                                  const std::string& data,
+                                  zmq::socket_t* socket,
+                                  const zmq::SocketIdentity& client,
+                                  const std::string& requestId)
+{
+  return Response(stype,data,socket,client,Response::NonBlocking,requestId);
+}
+
 //----------------------------------------------------------------------------
 //parse a response from a socket
 Response receive_Response( zmq::socket_t* socket )
@@ -62,9 +72,11 @@ Response::Response(remus::SERVICE_TYPE stype,
                    const std::string& rdata,
                    zmq::socket_t* socket,
                    const zmq::SocketIdentity& client,
-                   Response::SendMode mode):
+                   Response::SendMode mode,
+                   const std::string& requestId):
   SType(stype),
   Valid(true), //need to be initially valid to be sent
+  RequestId(requestId),
   Storage( boost::make_shared<zmq::message_t>(rdata.size()) )
 {
   std::memcpy(this->Storage->data(),rdata.data(),rdata.size());
@@ -79,10 +91,11 @@ Response::Response(remus::SERVICE_TYPE stype,
 Response::Response(zmq::socket_t* socket):
   SType(remus::INVALID_SERVICE),
   Valid(false), //need to be initially valid to be sent
+  RequestId(),
   Storage( boost::make_shared<zmq::message_t>() )
 {
 
-  const bool removedHeader = zmq::removeReqHeader(*socket);
+  const bool removedHeader = zmq::removeReqHeader(*socket, this->RequestId);
   if(removedHeader)
     {
     zmq::message_t servType;
@@ -106,6 +119,7 @@ Response& Response::operator=(Response&& other)
   {
     this->SType = other.SType;
     this->Valid = other.Valid;
+    this->RequestId.swap(other.RequestId);
     this->Storage = other.Storage;
     other.Storage.reset();
   }
@@ -137,23 +151,31 @@ bool Response::send_impl(zmq::socket_t* socket,
 
   //we are sending our selves as a multi part response
   //frame 0: client address we need to route too [Optional]
-  //frame 1: fake rep spacer
+  //frame 1: fake rep spacer, holds the request id
   //frame 2: Service Type we are responding too
   //frame 3: data
 
   bool responseSent = false;
 
+  //a virtual client is routed to the socket it sits behind, and is
+  //told apart from its siblings by the request id
+  const zmq::SocketIdentity route = client.route();
+  const std::string& requestId = client.isVirtual() ? client.virtualId() :
+                                                      this->RequestId;
+
   bool clientSent = true; //true on purpose to handle optional client
-  if(client.size()>0)
+  if(route.size()>0)
     {
-    zmq::message_t cAddress(client.size());
-    std::memcpy(cAddress.data(),client.data(),client.size());
+    zmq::message_t cAddress(route.size());
+    std::memcpy(cAddress.data(),route.data(),route.size());
     clientSent = zmq::send_harder( *socket, cAddress, flags|ZMQ_SNDMORE );
     }
 
   if(clientSent)
     {
-    const bool sentFakeReq = zmq::attachReqHeader(*socket,flags);
+    const bool sentFakeReq = zmq::attachReqHeader(*socket,
+                                                  requestId,
+                                                  flags);
     if(sentFakeReq)
       {
       zmq::message_t service(sizeof(this->SType));
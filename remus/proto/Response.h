@@ -63,6 +63,17 @@ Response send_NonBlockingResponse(remus::SERVICE_TYPE stype,
                                   zmq::socket_t* socket,
                                   const zmq::SocketIdentity& client);
 
+//----------------------------------------------------------------------------
+//pass in a std::string that we will copy and send, tagged with the request
+//id of the message we are responding too.
+//The response returned will have a copy of the data given to it.
+REMUSPROTO_EXPORT
+Response send_NonBlockingResponse(remus::SERVICE_TYPE stype,
+                                  const std::string& data,
+                                  zmq::socket_t* socket,
+                                  const zmq::SocketIdentity& client,
+                                  const std::string& requestId);
+
 //----------------------------------------------------------------------------
 //parse a response from a socket
 //The response returned will have data associated with if it is valid
@@ -93,6 +104,10 @@ public:
   //is true if all the response was sent, or all of the response was received.
   bool isValid() const { return Valid; }
 
+  //the request id of the message this is a response too. Responses
+  //received on REQ sockets will always have an empty request id
+  const std::string& requestId() const { return RequestId; }
+
   Response(const Response&) = default;
   Response& operator=(Response&& other);
   Response& operator=(const Response&) = default;
@@ -110,6 +125,12 @@ private:
                                                              zmq::socket_t* socket,
                                                              const zmq::SocketIdentity& client);
 
+  friend REMUSPROTO_EXPORT Response send_NonBlockingResponse(remus::SERVICE_TYPE stype,
+                                                             const std::string& data,
+                                                             zmq::socket_t* socket,
+                                                             const zmq::SocketIdentity& client,
+                                                             const std::string& requestId);
+
   friend REMUSPROTO_EXPORT Response receive_Response( zmq::socket_t* socket );
 
   friend REMUSPROTO_EXPORT bool forward_Response(const remus::proto::Response& response,
@@ -122,7 +143,8 @@ private:
            const std::string& data,
            zmq::socket_t* socket,
            const zmq::SocketIdentity& client,
-           SendMode mode);
+           SendMode mode,
+           const std::string& requestId = std::string());
 
   //----------------------------------------------------------------------------
   //create a response from reading from the socket
@@ -132,6 +154,7 @@ private:
 
   remus::SERVICE_TYPE SType;
   bool Valid; //tells if the response is valid
+  std::string RequestId;
 
   boost::shared_ptr<zmq::message_t> Storage;
 };
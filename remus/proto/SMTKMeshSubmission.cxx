@@ -11,6 +11,7 @@
 //=============================================================================
 
 #include <remus/proto/SMTKMeshSubmission.h>
+#include <remus/proto/ModelSession.h>
 #include <remus/proto/JobContent.h>
 #include <remus/proto/JobRequirements.h>
 
@@ -35,7 +36,8 @@ SMTKMeshSubmission::SMTKMeshSubmission():
   remus::proto::JobSubmission(),
   ModelKey("model"),
   AttributeKey("meshing_attributes"),
-  ModelItemKey("modelUUIDS")
+  ModelItemKey("modelUUIDS"),
+  SessionKey(remus::proto::modelSessionKey())
 {
 
 }
@@ -45,7 +47,8 @@ SMTKMeshSubmission::SMTKMeshSubmission( const remus::proto::JobRequirements& req
   remus::proto::JobSubmission( reqs ),
   ModelKey("model"),
   AttributeKey("meshing_attributes"),
-  ModelItemKey("modelUUIDS")
+  ModelItemKey("modelUUIDS"),
+  SessionKey(remus::proto::modelSessionKey())
 {
 
 }
@@ -55,7 +58,8 @@ SMTKMeshSubmission::SMTKMeshSubmission(const remus::proto::JobSubmission& submis
   remus::proto::JobSubmission( submission ),
   ModelKey("model"),
   AttributeKey("meshing_attributes"),
-  ModelItemKey("modelUUIDS")
+  ModelItemKey("modelUUIDS"),
+  SessionKey(remus::proto::modelSessionKey())
 {
 
 }
@@ -63,7 +67,8 @@ SMTKMeshSubmission::SMTKMeshSubmission(const remus::proto::JobSubmission& submis
 //-----------------------------------------------------------------------------
 bool SMTKMeshSubmission::hasAllComponents() const
 {
-  const bool has_model = this->find(this->ModelKey) != this->end();
+  const bool has_model = this->find(this->ModelKey) != this->end() ||
+                         this->find(this->SessionKey) != this->end();
   const bool has_attr = this->find(this->AttributeKey) != this->end();
   const bool has_mids = this->find(this->ModelItemKey) != this->end();
   return has_model && has_attr && has_mids;
@@ -135,6 +140,13 @@ void SMTKMeshSubmission::modelItemsToMesh(const remus::proto::JobContent& conten
   add_keyvalue(this, this->ModelItemKey, content);
 }
 
+//-----------------------------------------------------------------------------
+void SMTKMeshSubmission::session(const std::string& sessionId)
+{
+  add_keyvalue(this, this->SessionKey,
+               remus::proto::make_JobContent(sessionId));
+}
+
 //-----------------------------------------------------------------------------
 remus::proto::JobContent SMTKMeshSubmission::model() const
 {
@@ -171,12 +183,19 @@ remus::proto::JobContent SMTKMeshSubmission::modelItemsToMesh() const
   return item->second;
 }
 
+//-----------------------------------------------------------------------------
+std::string SMTKMeshSubmission::session() const
+{
+  return remus::proto::to_ModelSessionId(*this);
+}
+
 //------------------------------------------------------------------------------
 SMTKMeshSubmission::SMTKMeshSubmission(std::istream& buffer):
   remus::proto::JobSubmission(buffer),
   ModelKey("model"),
   AttributeKey("meshing_attributes"),
-  ModelItemKey("modelUUIDS")
+  ModelItemKey("modelUUIDS"),
+  SessionKey(remus::proto::modelSessionKey())
 {
 }
 
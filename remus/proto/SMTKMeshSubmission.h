@@ -118,6 +118,26 @@ namespace proto{
     }
 * ```
 *
+* session:
+*   Instead of the model, a submission can refer to a model session that the
+*   client opened with the model, see remus::client::Client::openModelSession.
+*   The server sends the model of the session to a worker only once, and the
+*   worker adds it back to the jobs of the session, so smtkSubmission.model()
+*   works as usual. The jobs of a session go to the workers the session is
+*   pinned to, so workers can keep the model manager of a session around,
+*   instead of parsing the model for every job:
+*
+* ```
+  smtk::model::ManagerPtr mgr = parsedModels[smtkSubmission.session()];
+  if(!mgr)
+    {
+    mgr = parse_model(smtkSubmission.model());
+    parsedModels[smtkSubmission.session()] = mgr;
+    }
+* ```
+*   The server tells the workers when a session is closed, or hasn't been used
+*   for a while, at which point the worker drops the model it was sent. Workers
+*   should still only keep the most recently used parsed models.
 *
 */
 
@@ -135,12 +155,13 @@ public:
 
   //returns if this SMTKMeshSubmission has all the required fields
   //we require all three keys (model, attribute, modelItems) be filled in
-  //currently
+  //currently. A session can stand in for the model
   bool hasAllComponents() const;
 
   const std::string& model_key( ) const { return this->ModelKey; }
   const std::string& attribute_key( ) const { return this->AttributeKey; }
   const std::string& modelItems_key( ) const { return this->ModelItemKey; }
+  const std::string& session_key( ) const { return this->SessionKey; }
 
   //Zero copy creation, content needs to exist while this instance
   //of SMTKMeshSubmission exists
@@ -169,12 +190,20 @@ public:
   void modelItemsToMesh(const std::string& content, remus::common::ContentFormat::Type);
   void modelItemsToMesh(const remus::proto::JobContent& content);
 
+  //refer to a model session that holds the model, instead of sending
+  //the model with every submission
+  void session(const std::string& sessionId);
+
   //Getters if this isn't a valid SMTKMeshSubmission they will return empty
   //JobContents
   remus::proto::JobContent model() const;
   remus::proto::JobContent attributes() const;
   remus::proto::JobContent modelItemsToMesh() const;
 
+  //returns the id of the model session, or an empty string if the
+  //submission doesn't refer to one
+  std::string session() const;
+
   //needed to decode the object from the wire
   friend std::istream& operator>>(std::istream &is,
                                   SMTKMeshSubmission &submission)
@@ -188,6 +217,7 @@ private:
   std::string ModelKey;
   std::string AttributeKey;
   std::string ModelItemKey;
+  std::string SessionKey;
 };
 
 //------------------------------------------------------------------------------
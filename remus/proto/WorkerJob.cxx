@@ -98,6 +98,44 @@ remus::proto::WorkerJob to_WorkerJob(const std::string& msg)
   return remus::proto::WorkerJob(id,submission);
 }
 
+//------------------------------------------------------------------------------
+std::string to_string(const std::vector<remus::proto::WorkerJob>& jobs)
+{
+  //the submissions know their own length, so the jobs can be
+  //written one after another
+  std::ostringstream buffer;
+  buffer << jobs.size() << '\n';
+  typedef std::vector<remus::proto::WorkerJob>::const_iterator iter;
+  for(iter i = jobs.begin(); i != jobs.end(); ++i)
+    {
+    buffer << i->id() << '\n';
+    buffer << i->submission() << '\n';
+    }
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+std::vector<remus::proto::WorkerJob> to_WorkerJobs(const char* data,
+                                                   std::size_t size)
+{
+  std::istringstream buffer(std::string(data,size));
+
+  std::size_t count = 0;
+  buffer >> count;
+
+  std::vector<remus::proto::WorkerJob> jobs;
+  for(std::size_t i=0; i < count && buffer.good(); ++i)
+    {
+    boost::uuids::uuid id;
+    remus::proto::JobSubmission submission;
+
+    buffer >> id;
+    buffer >> submission;
+    jobs.push_back( remus::proto::WorkerJob(id,submission) );
+    }
+  return jobs;
+}
+
 }
 }
 
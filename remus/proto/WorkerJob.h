@@ -14,6 +14,7 @@
 #define remus_proto_WorkerJob_h
 
 #include <string>
+#include <vector>
 
 #include <remus/common/MeshIOType.h>
 #include <remus/proto/JobSubmission.h>
@@ -87,6 +88,17 @@ REMUSPROTO_EXPORT std::string to_string(const remus::proto::WorkerJob& job);
 //------------------------------------------------------------------------------
 REMUSPROTO_EXPORT remus::proto::WorkerJob to_WorkerJob(const std::string& msg);
 
+//------------------------------------------------------------------------------
+//pack multiple jobs into a single message, this is used by the server to
+//hand a worker several jobs at once
+REMUSPROTO_EXPORT
+std::string to_string(const std::vector<remus::proto::WorkerJob>& jobs);
+
+//------------------------------------------------------------------------------
+REMUSPROTO_EXPORT
+std::vector<remus::proto::WorkerJob> to_WorkerJobs(const char* data,
+                                                   std::size_t size);
+
 }
 }
 
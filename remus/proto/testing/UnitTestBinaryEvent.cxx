@@ -0,0 +1,92 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/BinaryEvent.h>
+#include <remus/proto/EventTypes.h>
+#include <remus/testing/Testing.h>
+
+namespace
+{
+using namespace remus::proto;
+
+void round_trip_test()
+{
+  BinaryEvent event;
+  event.EventCategory = BinaryEvent::JOB;
+  event.Type = jobevents::JOB_STATUS;
+  event.JobId = remus::testing::UUIDGenerator();
+  event.WorkerId = "worker_id";
+  event.Status = remus::IN_PROGRESS;
+  event.ProgressValue = -1;
+  event.ProgressMessage = "a message\nwith new lines";
+  event.Responsive = true;
+  event.Requirements = "serialized requirements";
+
+  const std::string encoded = to_binary(event);
+
+  BinaryEvent decoded;
+  REMUS_ASSERT( from_binary(encoded.data(), encoded.size(), decoded) );
+  REMUS_ASSERT( (decoded.EventCategory == BinaryEvent::JOB) );
+  REMUS_ASSERT( (decoded.Type == jobevents::JOB_STATUS) );
+  REMUS_ASSERT( (decoded.JobId == event.JobId) );
+  REMUS_ASSERT( (decoded.WorkerId == event.WorkerId) );
+  REMUS_ASSERT( (decoded.Status == remus::IN_PROGRESS) );
+  REMUS_ASSERT( (decoded.ProgressValue == -1) );
+  REMUS_ASSERT( (decoded.ProgressMessage == event.ProgressMessage) );
+  REMUS_ASSERT( (decoded.Responsive == true) );
+  REMUS_ASSERT( (decoded.Requirements == event.Requirements) );
+}
+
+void compact_test()
+{
+  //a heartbeat is just the fixed header and the worker id
+  BinaryEvent event;
+  event.EventCategory = BinaryEvent::WORKER;
+  event.Type = workevents::HEARTBEAT;
+  event.WorkerId = "1234";
+
+  const std::string encoded = to_binary(event);
+  REMUS_ASSERT( (encoded.size() == 25 + 2 + 4 + 4 + 4) );
+
+  BinaryEvent decoded;
+  REMUS_ASSERT( from_binary(encoded.data(), encoded.size(), decoded) );
+  REMUS_ASSERT( (decoded.EventCategory == BinaryEvent::WORKER) );
+  REMUS_ASSERT( (decoded.JobId.is_nil()) );
+  REMUS_ASSERT( (decoded.Requirements.empty()) );
+}
+
+void invalid_test()
+{
+  BinaryEvent event;
+  event.WorkerId = "worker";
+  const std::string encoded = to_binary(event);
+
+  BinaryEvent decoded;
+  //truncated data is rejected
+  REMUS_ASSERT( (!from_binary(encoded.data(), encoded.size()-1, decoded)) );
+  REMUS_ASSERT( (!from_binary(encoded.data(), 3, decoded)) );
+
+  //unknown versions are rejected
+  std::string badVersion = encoded;
+  badVersion[0] = 42;
+  REMUS_ASSERT( (!from_binary(badVersion.data(), badVersion.size(), decoded)) );
+}
+
+}
+
+int UnitTestBinaryEvent(int, char *[])
+{
+  round_trip_test();
+  compact_test();
+  invalid_test();
+  return 0;
+}
@@ -0,0 +1,159 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/ContentCacheIndex.h>
+#include <remus/testing/Testing.h>
+
+namespace
+{
+using namespace remus::proto;
+
+void verify_disabled()
+{
+  ContentCacheIndex index;
+  REMUS_ASSERT( (!index.enabled()) );
+  REMUS_ASSERT( (!index.cacheable(1024)) );
+
+  std::vector<std::string> evicted;
+  index.insert("a", 1024, evicted);
+  REMUS_ASSERT( (index.size() == 0) );
+  REMUS_ASSERT( (!index.contains("a")) );
+  REMUS_ASSERT( (evicted.empty()) );
+}
+
+void verify_cacheable()
+{
+  ContentCacheIndex index(1000, 100);
+  REMUS_ASSERT( (index.enabled()) );
+  REMUS_ASSERT( (!index.cacheable(99)) );
+  REMUS_ASSERT( (index.cacheable(100)) );
+  REMUS_ASSERT( (index.cacheable(1000)) );
+  REMUS_ASSERT( (!index.cacheable(1001)) );
+
+  //content that is too small or too large isn't added
+  std::vector<std::string> evicted;
+  index.insert("small", 99, evicted);
+  index.insert("large", 1001, evicted);
+  REMUS_ASSERT( (index.size() == 0) );
+  REMUS_ASSERT( (index.sizeInBytes() == 0) );
+}
+
+void verify_lru_eviction()
+{
+  ContentCacheIndex index(1000, 100);
+  std::vector<std::string> evicted;
+  index.insert("a", 400, evicted);
+  index.insert("b", 400, evicted);
+  REMUS_ASSERT( (evicted.empty()) );
+  REMUS_ASSERT( (index.size() == 2) );
+  REMUS_ASSERT( (index.sizeInBytes() == 800) );
+  REMUS_ASSERT( (index.contentSize("a") == 400) );
+  REMUS_ASSERT( (index.contentSize("c") == 0) );
+
+  //touching a makes b the least recently used
+  REMUS_ASSERT( (index.touch("a")) );
+  REMUS_ASSERT( (!index.touch("c")) );
+
+  index.insert("c", 400, evicted);
+  REMUS_ASSERT( (evicted.size() == 1) );
+  REMUS_ASSERT( (evicted[0] == "b") );
+  REMUS_ASSERT( (index.contains("a")) );
+  REMUS_ASSERT( (!index.contains("b")) );
+  REMUS_ASSERT( (index.contains("c")) );
+  REMUS_ASSERT( (index.sizeInBytes() == 800) );
+
+  std::vector<std::string> order = index.hashes();
+  REMUS_ASSERT( (order.size() == 2) );
+  REMUS_ASSERT( (order[0] == "a") );
+  REMUS_ASSERT( (order[1] == "c") );
+
+  //inserting a held entry only touches it
+  evicted.clear();
+  index.insert("a", 400, evicted);
+  REMUS_ASSERT( (evicted.empty()) );
+  REMUS_ASSERT( (index.size() == 2) );
+  order = index.hashes();
+  REMUS_ASSERT( (order[0] == "c") );
+  REMUS_ASSERT( (order[1] == "a") );
+
+  //a large entry evicts as many entries as it needs
+  index.insert("d", 1000, evicted);
+  REMUS_ASSERT( (evicted.size() == 2) );
+  REMUS_ASSERT( (evicted[0] == "c") );
+  REMUS_ASSERT( (evicted[1] == "a") );
+  REMUS_ASSERT( (index.size() == 1) );
+  REMUS_ASSERT( (index.sizeInBytes() == 1000) );
+}
+
+void verify_mirrors_match()
+{
+  //two indices that see the same sequence hold the same entries, which
+  //is what lets the server mirror the cache of a worker
+  ContentCacheIndex worker(1000, 100);
+  std::vector<std::string> evicted;
+  worker.insert("a", 300, evicted);
+  worker.insert("b", 300, evicted);
+
+  ContentCacheIndex server(worker);
+  const char* sequence[] = { "c", "a", "d", "b", "a", "e" };
+  for(std::size_t i=0; i < 6; ++i)
+    {
+    std::vector<std::string> workerEvicted, serverEvicted;
+    if(!worker.touch(sequence[i]))
+      {
+      worker.insert(sequence[i], 300, workerEvicted);
+      }
+    if(!server.touch(sequence[i]))
+      {
+      server.insert(sequence[i], 300, serverEvicted);
+      }
+    REMUS_ASSERT( (workerEvicted == serverEvicted) );
+    }
+  REMUS_ASSERT( (worker.hashes() == server.hashes()) );
+  REMUS_ASSERT( (worker.sizeInBytes() == server.sizeInBytes()) );
+}
+
+void verify_serialization()
+{
+  ContentCacheIndex index(1000, 100);
+  std::vector<std::string> evicted;
+  index.insert("a", 400, evicted);
+
+  //only the size of the cache is sent, the other side starts out empty
+  const std::string payload = to_string(index);
+  ContentCacheIndex from_wire = to_ContentCacheIndex(payload.data(),
+                                                     payload.size());
+  REMUS_ASSERT( (from_wire.enabled()) );
+  REMUS_ASSERT( (from_wire.maxBytes() == 1000) );
+  REMUS_ASSERT( (from_wire.minContentSize() == 100) );
+  REMUS_ASSERT( (from_wire.size() == 0) );
+
+  const std::string disabled = to_string(ContentCacheIndex());
+  REMUS_ASSERT( (!to_ContentCacheIndex(disabled.data(),
+                                       disabled.size()).enabled()) );
+
+  const std::string garbage("not a cache");
+  REMUS_ASSERT( (!to_ContentCacheIndex(garbage.data(),
+                                       garbage.size()).enabled()) );
+}
+
+}
+
+int UnitTestContentCacheIndex(int, char *[])
+{
+  verify_disabled();
+  verify_cacheable();
+  verify_lru_eviction();
+  verify_mirrors_match();
+  verify_serialization();
+  return 0;
+}
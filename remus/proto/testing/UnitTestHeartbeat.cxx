@@ -0,0 +1,64 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/proto/Heartbeat.h>
+#include <remus/testing/Testing.h>
+
+namespace
+{
+using namespace remus::proto;
+
+void round_trip_test()
+{
+  const boost::int64_t intervals[] = { 0, 1, 250, 60000,
+                                       boost::int64_t(1) << 40 };
+  for(std::size_t i=0; i < 5; ++i)
+    {
+    const std::string payload = to_HeartbeatPayload(intervals[i]);
+    REMUS_ASSERT( (payload.size() == 9) );
+    REMUS_ASSERT( (to_HeartbeatInterval(payload.data(), payload.size()) ==
+                   intervals[i]) );
+    }
+}
+
+void text_payload_test()
+{
+  //workers that predate the binary payload send the interval as text
+  const std::string text("60000");
+  REMUS_ASSERT( (to_HeartbeatInterval(text.data(), text.size()) == 60000) );
+
+  const std::string nine("123456789");
+  REMUS_ASSERT( (to_HeartbeatInterval(nine.data(), nine.size()) == 123456789) );
+}
+
+void bad_payload_test()
+{
+  const std::string empty;
+  REMUS_ASSERT( (to_HeartbeatInterval(empty.data(), empty.size()) == -1) );
+
+  const std::string garbage("not a number");
+  REMUS_ASSERT( (to_HeartbeatInterval(garbage.data(), garbage.size()) == -1) );
+
+  //truncated binary payload
+  const std::string payload = to_HeartbeatPayload(250);
+  REMUS_ASSERT( (to_HeartbeatInterval(payload.data(), 5) == -1) );
+}
+
+}
+
+int UnitTestHeartbeat(int, char *[])
+{
+  round_trip_test();
+  text_payload_test();
+  bad_payload_test();
+  return 0;
+}
@@ -0,0 +1,140 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/proto/JobArray.h>
+#include <remus/testing/Testing.h>
+
+namespace
+{
+using namespace remus::proto;
+using namespace remus::meshtypes;
+
+const remus::common::MeshIOType types2D =
+                              remus::common::MeshIOType(Edges(),Mesh2D());
+
+JobSubmission make_base()
+{
+  JobRequirements reqs(remus::common::ContentFormat::User,
+                       types2D, "mesher", "");
+  JobSubmission base(reqs, make_JobContent("a large model"));
+  base["size"] = make_JobContent("1.0");
+  return base;
+}
+
+void verify_elements()
+{
+  JobArraySubmission sweep(make_base());
+  REMUS_ASSERT( (sweep.size() == 0) );
+  REMUS_ASSERT( (sweep.type() == types2D) );
+
+  REMUS_ASSERT( (sweep.addElement("size", make_JobContent("0.5")) == 0) );
+  REMUS_ASSERT( (sweep.addElement("size", make_JobContent("0.25")) == 1) );
+  JobArraySubmission::Overrides extra;
+  extra["extra"] = make_JobContent("new key");
+  REMUS_ASSERT( (sweep.addElement(extra) == 2) );
+  REMUS_ASSERT( (sweep.size() == 3) );
+
+  //overrides replace the contents of the base
+  JobSubmission first = sweep.element(0);
+  REMUS_ASSERT( (first.size() == 2) );
+  REMUS_ASSERT( (std::string(first["size"].data(),
+                             first["size"].dataSize()) == "0.5") );
+  REMUS_ASSERT( (first.requirements() == sweep.requirements()) );
+
+  //and add new contents to it
+  JobSubmission third = sweep.element(2);
+  REMUS_ASSERT( (third.size() == 3) );
+  REMUS_ASSERT( (std::string(third["size"].data(),
+                             third["size"].dataSize()) == "1.0") );
+
+  //the shared contents aren't copied
+  REMUS_ASSERT( (first[first.default_key()].data() ==
+                 third[third.default_key()].data()) );
+
+  JobArraySubmission from_wire = to_JobArraySubmission(to_string(sweep));
+  REMUS_ASSERT( (from_wire.size() == 3) );
+  REMUS_ASSERT( (from_wire.base() == sweep.base()) );
+  REMUS_ASSERT( (from_wire.element(1) == sweep.element(1)) );
+  REMUS_ASSERT( (from_wire.overrides(2).count("extra") == 1) );
+}
+
+void verify_element_ids()
+{
+  const boost::uuids::uuid random = remus::testing::UUIDGenerator();
+  const boost::uuids::uuid arrayId = make_JobArrayId(random);
+
+  boost::uuids::uuid splitId;
+  std::size_t index = 0;
+  REMUS_ASSERT( (split_JobArrayElementId(arrayId, splitId, index) == false) );
+
+  JobArray array(arrayId, types2D, 70000);
+  REMUS_ASSERT( (array.valid() == true) );
+
+  const std::size_t indices[3] = { 0, 255, 69999 };
+  for(int i=0; i < 3; ++i)
+    {
+    const Job job = array.job(indices[i]);
+    REMUS_ASSERT( (job.id() != arrayId) );
+    REMUS_ASSERT( (job.type() == types2D) );
+    REMUS_ASSERT( (split_JobArrayElementId(job.id(), splitId, index) == true) );
+    REMUS_ASSERT( (splitId == arrayId) );
+    REMUS_ASSERT( (index == indices[i]) );
+    //the bytes used by the ShardedClient are kept
+    REMUS_ASSERT( (job.id().data[14] == random.data[14]) );
+    REMUS_ASSERT( (job.id().data[15] == random.data[15]) );
+    }
+
+  JobArray from_wire = to_JobArray(to_string(array));
+  REMUS_ASSERT( (from_wire == array) );
+  REMUS_ASSERT( (from_wire.size() == 70000) );
+  REMUS_ASSERT( (from_wire.type() == types2D) );
+
+  REMUS_ASSERT( (make_invalidJobArray().valid() == false) );
+}
+
+void verify_status()
+{
+  const boost::uuids::uuid arrayId =
+                          make_JobArrayId(remus::testing::UUIDGenerator());
+  JobArrayStatus status(arrayId, 4);
+  REMUS_ASSERT( (status.count(remus::INVALID_STATUS) == 4) );
+  REMUS_ASSERT( (status.complete() == true) );
+
+  status.status(0, remus::QUEUED);
+  status.status(1, remus::IN_PROGRESS);
+  status.status(2, remus::FINISHED);
+  REMUS_ASSERT( (status.complete() == false) );
+  REMUS_ASSERT( (status.count(remus::FINISHED) == 1) );
+
+  JobArrayStatus from_wire = to_JobArrayStatus(to_string(status));
+  REMUS_ASSERT( (from_wire.id() == arrayId) );
+  REMUS_ASSERT( (from_wire.size() == 4) );
+  REMUS_ASSERT( (from_wire.status(0) == remus::QUEUED) );
+  REMUS_ASSERT( (from_wire.status(1) == remus::IN_PROGRESS) );
+  REMUS_ASSERT( (from_wire.status(2) == remus::FINISHED) );
+  REMUS_ASSERT( (from_wire.status(3) == remus::INVALID_STATUS) );
+}
+
+}
+
+int UnitTestJobArray(int, char *[])
+{
+  verify_elements();
+  verify_element_ids();
+  verify_status();
+  return 0;
+}
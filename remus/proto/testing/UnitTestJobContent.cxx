@@ -281,12 +281,48 @@ void verify_zero_copy_serilization(StringFactory factory)
   REMUS_ASSERT( (from_wire == input_content) );
 }
 
+void verify_reference()
+{
+  JobContent content = make_JobContent(make_large_string()(),
+                                       ContentFormat::BSON);
+  content.tag("large");
+  REMUS_ASSERT( (!content.isReference()) );
+  REMUS_ASSERT( (content.referencedHash().empty()) );
+
+  //a reference only holds the hash, and survives the wire
+  JobContent ref = content.reference();
+  REMUS_ASSERT( (ref.isReference()) );
+  REMUS_ASSERT( (ref.sourceType() == ContentSource::Reference) );
+  REMUS_ASSERT( (ref.formatType() == ContentFormat::BSON) );
+  REMUS_ASSERT( (ref.tag() == "large") );
+  REMUS_ASSERT( (ref.dataSize() < content.dataSize()) );
+  REMUS_ASSERT( (ref.referencedHash() == content.hash()) );
+
+  const JobContent from_wire = to_JobContent(to_string(ref));
+  REMUS_ASSERT( (from_wire.isReference()) );
+  REMUS_ASSERT( (from_wire.referencedHash() == content.hash()) );
+
+  //resolving gives back the content, with the source type, format and
+  //tag of the reference
+  const JobContent cached = make_JobContent(
+                      remus::common::FileHandle("example_data.txt"),
+                      ContentFormat::XML);
+  const JobContent resolved = from_wire.resolve(cached);
+  REMUS_ASSERT( (!resolved.isReference()) );
+  REMUS_ASSERT( (resolved.sourceType() == ContentSource::Memory) );
+  REMUS_ASSERT( (resolved.formatType() == ContentFormat::BSON) );
+  REMUS_ASSERT( (resolved.tag() == "large") );
+  REMUS_ASSERT( (resolved.data() == cached.data()) );
+  REMUS_ASSERT( (resolved.dataSize() == cached.dataSize()) );
+}
+
 }
 
 int UnitTestJobContent(int, char *[])
 {
   verify_source_and_format();
   verify_tag();
+  verify_reference();
 
   verify_container_algorithm_support();
 
@@ -0,0 +1,140 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/proto/JobListing.h>
+#include <remus/testing/Testing.h>
+
+namespace
+{
+using namespace remus::proto;
+using namespace remus::meshtypes;
+
+const remus::common::MeshIOType types2D =
+                              remus::common::MeshIOType(Edges(),Mesh2D());
+const remus::common::MeshIOType types3D =
+                              remus::common::MeshIOType(Edges(),Mesh3D());
+
+void verify_request_filters()
+{
+  JobListingRequest request;
+  REMUS_ASSERT( (request.locations() == JobListingRequest::ALL_JOBS) );
+
+  //by default everything is accepted
+  REMUS_ASSERT( request.accepts(JobListingRequest::ACTIVE_JOBS, types2D,
+                                "", remus::IN_PROGRESS, "worker", 0) );
+
+  request.locations(JobListingRequest::QUEUED_JOBS |
+                    JobListingRequest::WAITING_FOR_WORKER_JOBS);
+  REMUS_ASSERT( !request.accepts(JobListingRequest::ACTIVE_JOBS, types2D,
+                                 "", remus::IN_PROGRESS, "worker", 0) );
+  REMUS_ASSERT( request.accepts(JobListingRequest::QUEUED_JOBS, types2D,
+                                "", remus::QUEUED, "", 0) );
+
+  request.meshTypes(types3D);
+  REMUS_ASSERT( !request.accepts(JobListingRequest::QUEUED_JOBS, types2D,
+                                 "", remus::QUEUED, "", 0) );
+  REMUS_ASSERT( request.accepts(JobListingRequest::QUEUED_JOBS, types3D,
+                                "", remus::QUEUED, "", 0) );
+
+  request.workerName("mesher");
+  REMUS_ASSERT( !request.accepts(JobListingRequest::QUEUED_JOBS, types3D,
+                                 "other", remus::QUEUED, "", 0) );
+
+  request.status(remus::QUEUED);
+  request.minimumAge(1000);
+  REMUS_ASSERT( !request.accepts(JobListingRequest::QUEUED_JOBS, types3D,
+                                 "mesher", remus::QUEUED, "", 999) );
+  REMUS_ASSERT( request.accepts(JobListingRequest::QUEUED_JOBS, types3D,
+                                "mesher", remus::QUEUED, "", 1000) );
+
+  request.worker("worker");
+  REMUS_ASSERT( !request.accepts(JobListingRequest::QUEUED_JOBS, types3D,
+                                 "mesher", remus::QUEUED, "", 1000) );
+}
+
+void verify_serialization()
+{
+  JobListingRequest request(25);
+  request.locations(JobListingRequest::ACTIVE_JOBS);
+  request.meshTypes(types2D);
+  request.workerName("mesher");
+  request.worker("worker with spaces\nand newlines");
+  request.status(remus::IN_PROGRESS);
+  request.minimumAge(500);
+  request.cursor("4 some cursor");
+
+  JobListingRequest from_wire = to_JobListingRequest(to_string(request));
+  REMUS_ASSERT( (from_wire.locations() == request.locations()) );
+  REMUS_ASSERT( (from_wire.meshTypes() == request.meshTypes()) );
+  REMUS_ASSERT( (from_wire.workerName() == request.workerName()) );
+  REMUS_ASSERT( (from_wire.worker() == request.worker()) );
+  REMUS_ASSERT( (from_wire.status() == request.status()) );
+  REMUS_ASSERT( (from_wire.minimumAge() == request.minimumAge()) );
+  REMUS_ASSERT( (from_wire.maxEntries() == 25) );
+  REMUS_ASSERT( (from_wire.cursor() == request.cursor()) );
+
+  JobListing listing;
+  REMUS_ASSERT( (listing.complete()) );
+  for(int i=0; i < 3; ++i)
+    {
+    JobListingEntry entry;
+    entry.Id = remus::testing::UUIDGenerator();
+    entry.Location = JobListingRequest::ACTIVE_JOBS;
+    entry.MeshTypes = types3D;
+    entry.WorkerName = "mesher";
+    entry.Tag = "";
+    entry.Status = remus::IN_PROGRESS;
+    entry.Progress = 10 * i;
+    entry.Worker = "worker";
+    entry.AgeInMillisec = 1000 * i;
+    listing.add(entry);
+    }
+  listing.nextCursor("4 next");
+  REMUS_ASSERT( (!listing.complete()) );
+
+  JobListing listing_from_wire = to_JobListing(to_string(listing));
+  REMUS_ASSERT( (listing_from_wire.size() == 3) );
+  REMUS_ASSERT( (listing_from_wire.nextCursor() == "4 next") );
+  for(std::size_t i=0; i < 3; ++i)
+    {
+    const JobListingEntry& a = listing.entries()[i];
+    const JobListingEntry& b = listing_from_wire.entries()[i];
+    REMUS_ASSERT( (a.Id == b.Id) );
+    REMUS_ASSERT( (a.Location == b.Location) );
+    REMUS_ASSERT( (a.MeshTypes == b.MeshTypes) );
+    REMUS_ASSERT( (a.WorkerName == b.WorkerName) );
+    REMUS_ASSERT( (a.Tag == b.Tag) );
+    REMUS_ASSERT( (a.Status == b.Status) );
+    REMUS_ASSERT( (a.Progress == b.Progress) );
+    REMUS_ASSERT( (a.Worker == b.Worker) );
+    REMUS_ASSERT( (a.AgeInMillisec == b.AgeInMillisec) );
+    }
+
+  //an empty listing round trips as complete
+  JobListing empty = to_JobListing(to_string(JobListing()));
+  REMUS_ASSERT( (empty.size() == 0) );
+  REMUS_ASSERT( (empty.complete()) );
+}
+
+}
+
+int UnitTestJobListing(int, char *[])
+{
+  verify_request_filters();
+  verify_serialization();
+  return 0;
+}
@@ -264,6 +264,27 @@ void zero_copy_api()
   REMUS_ASSERT( (meshSub.modelItemsToMesh() == meshSub2.modelItemsToMesh() ) );
 }
 
+void session_api()
+{
+  JobRequirements reqs = make_random_MeshReqs();
+  SMTKMeshSubmission meshSub(reqs);
+  REMUS_ASSERT( (meshSub.session().empty()) );
+
+  //a session stands in for the model
+  meshSub.session("4ad8c089-01f6-457e-9ed9-a75cc833411a");
+  meshSub.attributes( randomString(), ContentFormat::User );
+  meshSub.modelItemsToMesh( randomString(), ContentFormat::User );
+  REMUS_ASSERT( (meshSub.hasAllComponents() == true) );
+  REMUS_ASSERT( (meshSub.model().dataSize() == 0) );
+
+  SMTKMeshSubmission meshSub2;
+  std::stringstream buffer;
+  buffer << meshSub;
+  buffer >> meshSub2;
+
+  REMUS_ASSERT( (meshSub2.hasAllComponents() == true) );
+  REMUS_ASSERT( (meshSub2.session() == "4ad8c089-01f6-457e-9ed9-a75cc833411a") );
+}
 
 } //namespace
 
@@ -277,6 +298,7 @@ int UnitTestSMTKMeshSubmission(int, char *[])
 
   string_api();
   zero_copy_api();
+  session_api();
 
   return 0;
 }
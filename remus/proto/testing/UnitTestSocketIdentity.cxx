@@ -64,6 +64,41 @@ void verify_uniqueness( F f )
     REMUS_ASSERT( (sockets.size() == size) );
 }
 
+void verify_virtual_identity()
+{
+  std::string routeName = randomIdentity();
+  zmq::SocketIdentity route(routeName.c_str(), routeName.size());
+  REMUS_ASSERT( (route.isVirtual() == false) );
+  REMUS_ASSERT( (route.virtualId().empty()) );
+  REMUS_ASSERT( (route.route() == route) );
+
+  //a virtual identity needs to route back to the socket it sits behind
+  const std::string vid = randomIdentity();
+  zmq::SocketIdentity virtualSocket(route, vid);
+  REMUS_ASSERT( (virtualSocket.isVirtual()) );
+  REMUS_ASSERT( (virtualSocket.virtualId() == vid) );
+  REMUS_ASSERT( (virtualSocket.route() == route) );
+  REMUS_ASSERT( (virtualSocket.size() == route.size() + vid.size()) );
+  REMUS_ASSERT( (virtualSocket.name() == routeName + "/" + vid) );
+
+  //virtual identities must never match a plain identity that happens to
+  //hold the same bytes, or a sibling behind the same route
+  std::string flat = routeName + vid;
+  zmq::SocketIdentity flatSocket(flat.c_str(), flat.size());
+  REMUS_ASSERT( (!(flatSocket == virtualSocket)) );
+  REMUS_ASSERT( ((flatSocket < virtualSocket) != (virtualSocket < flatSocket)) );
+
+  zmq::SocketIdentity sibling(route, randomIdentity());
+  REMUS_ASSERT( (!(sibling == virtualSocket)) );
+
+  std::set< zmq::SocketIdentity > sockets;
+  sockets.insert(route);
+  sockets.insert(virtualSocket);
+  sockets.insert(sibling);
+  sockets.insert(flatSocket);
+  REMUS_ASSERT( (sockets.size() == 4) );
+}
+
 } //namespace
 
 
@@ -108,5 +143,7 @@ int UnitTestSocketIdentity(int, char *[])
   verify_uniqueness(randomIdentity);
   verify_uniqueness(nextIntegerIdentity);
 
+  verify_virtual_identity();
+
   return 0;
 }
@@ -173,6 +173,13 @@ bool recv_harder(zmq::socket_t& socket, zmq::message_t* message, int flags)
 //Returns true if we removed the ReqHeader, or if no header
 //needs to be removed
 bool removeReqHeader(zmq::socket_t& socket, int flags)
+{
+  std::string header;
+  return zmq::removeReqHeader(socket, header, flags);
+}
+
+//------------------------------------------------------------------------------
+bool removeReqHeader(zmq::socket_t& socket, std::string& header, int flags)
 {
   bool removedHeader = true;
   int socketType;
@@ -189,6 +196,11 @@ bool removeReqHeader(zmq::socket_t& socket, int flags)
       {
       removedHeader = false;
       }
+    if(removedHeader)
+      {
+      header.assign(static_cast<const char*>(reqHeader.data()),
+                    reqHeader.size());
+      }
     }
   return removedHeader;
 }
@@ -199,6 +211,14 @@ bool removeReqHeader(zmq::socket_t& socket, int flags)
 //Returns true if we added the ReqHeader, or if no header
 //needs to be added
 bool attachReqHeader(zmq::socket_t& socket, int flags)
+{
+  return zmq::attachReqHeader(socket, std::string(), flags);
+}
+
+//------------------------------------------------------------------------------
+bool attachReqHeader(zmq::socket_t& socket,
+                     const std::string& header,
+                     int flags)
 {
   bool attachedHeader = true;
   int socketType;
@@ -206,7 +226,9 @@ bool attachReqHeader(zmq::socket_t& socket, int flags)
   socket.getsockopt(ZMQ_TYPE,&socketType,&socketTypeSize);
   if(socketType != ZMQ_REQ && socketType != ZMQ_REP)
     {
-    zmq::message_t reqHeader(0);
+    zmq::message_t reqHeader(header.size());
+    std::copy(header.begin(), header.end(),
+              static_cast<char*>(reqHeader.data()));
     try
       {
       attachedHeader = zmq::send_harder(socket, reqHeader, flags|ZMQ_SNDMORE);
@@ -147,6 +147,11 @@ bool recv_harder(zmq::socket_t& socket, zmq::message_t* message, int flags=0);
 //needs to be removed
 bool removeReqHeader(zmq::socket_t& socket, int flags=0);
 
+//------------------------------------------------------------------------------
+//same as removeReqHeader, but stores the contents of the header into
+//the header argument. The header will be empty for REQ/REP sockets.
+bool removeReqHeader(zmq::socket_t& socket, std::string& header, int flags=0);
+
 //------------------------------------------------------------------------------
 //we presume that every message needs to be treated like a Req/Rep
 //message and we need to pad a null message on everything
@@ -154,6 +159,14 @@ bool removeReqHeader(zmq::socket_t& socket, int flags=0);
 //needs to be added
 bool attachReqHeader(zmq::socket_t& socket,int flags=0);
 
+//------------------------------------------------------------------------------
+//same as attachReqHeader, but the header frame will hold the contents of
+//the header argument. This is how we tag messages with a request id.
+//The header is ignored for REQ/REP sockets
+bool attachReqHeader(zmq::socket_t& socket,
+                     const std::string& header,
+                     int flags=0);
+
 } //namespace zmq
 
 
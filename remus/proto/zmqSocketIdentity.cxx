@@ -58,6 +58,7 @@ namespace zmq
 SocketIdentity::SocketIdentity( const char* start, std::size_t s )
 {
   this->Size = s;
+  this->RouteSize = s;
   std::memcpy(this->Data, start, s);
 
 
@@ -84,6 +85,22 @@ SocketIdentity::SocketIdentity( const char* start, std::size_t s )
 
 }
 
+//------------------------------------------------------------------------------
+SocketIdentity::SocketIdentity(const SocketIdentity& route,
+                               const std::string& virtualId)
+{
+  //zmq identities are at most 255 bytes, so the virtual id has to fit
+  //in whatever room is left
+  const std::size_t idSize = std::min(virtualId.size(),
+                                      sizeof(this->Data) - route.size());
+  this->RouteSize = route.size();
+  this->Size = this->RouteSize + idSize;
+  std::memcpy(this->Data, route.data(), this->RouteSize);
+  std::memcpy(this->Data + this->RouteSize, virtualId.data(), idSize);
+
+  this->Name = route.name() + "/" + virtualId.substr(0, idSize);
+}
+
 //disable warning about elements of array 'Data' will be default initialized
 //this is only a warning on msvc, since previously it was broken and wouldn't
 //default initialize member arrays
@@ -94,6 +111,7 @@ SocketIdentity::SocketIdentity( const char* start, std::size_t s )
 //------------------------------------------------------------------------------
 SocketIdentity::SocketIdentity():
 Size(0),
+RouteSize(0),
 Data(),
 Name()
 {
@@ -109,7 +127,8 @@ bool SocketIdentity::operator ==(const SocketIdentity& b) const
   //this can't just compare names, as the names are unique. You could have a user
   //encode a string of "1" as the unique id of the socket and have a zmq provided
   //id be 1 which would produce the name of "1", while the actual Data blocks aren't the same
-  if(this->size() != b.size()) { return false; }
+  if(this->size() != b.size() || this->RouteSize != b.RouteSize)
+    { return false; }
   return std::equal(this->data(),this->data()+this->size(),b.data());
 }
 
@@ -118,6 +137,7 @@ bool SocketIdentity::operator<(const SocketIdentity& b) const
 {
     //sort first on size
     if(this->Size != b.size()) { return this->Size < b.size(); }
+    if(this->RouteSize != b.RouteSize) { return this->RouteSize < b.RouteSize; }
 
     //second sort on content.
     return std::lexicographical_compare(this->data(),this->data()+this->size(),
@@ -33,6 +33,11 @@ struct REMUSPROTO_EXPORT SocketIdentity
 {
   SocketIdentity(const char* d, std::size_t s);
 
+  //construct the identity of a virtual socket, which is one of many
+  //endpoints behind a single socket. Messages to a virtual identity are
+  //routed to the route socket, with the virtual id as the request id
+  SocketIdentity(const SocketIdentity& route, const std::string& virtualId);
+
   SocketIdentity();
 
   bool operator ==(const SocketIdentity& b) const;
@@ -42,12 +47,24 @@ struct REMUSPROTO_EXPORT SocketIdentity
   const char* data() const { return &Data[0]; }
   std::size_t size() const { return Size; }
 
+  //returns true if this is the identity of a virtual socket
+  bool isVirtual() const { return RouteSize != Size; }
+
+  //returns the identity of the socket that messages need to be routed
+  //to. For non virtual identities this is the identity itself
+  SocketIdentity route() const { return SocketIdentity(Data, RouteSize); }
+
+  //returns the virtual id, which is empty for non virtual identities
+  std::string virtualId() const
+    { return std::string(Data + RouteSize, Size - RouteSize); }
+
   //returns this socket identity as a human
   //readable name
   const std::string& name() const { return this->Name; }
 
 private:
   std::size_t Size;
+  std::size_t RouteSize;
   char Data[256];
   std::string Name;
 };
@@ -19,9 +19,16 @@ REMUS_THIRDPARTY_PRE_INCLUDE
 #include <boost/uuid/uuid.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
+#include <remus/proto/ContentCacheIndex.h>
+#include <remus/proto/Heartbeat.h>
 #include <remus/proto/Job.h>
+#include <remus/proto/JobArray.h>
+#include <remus/proto/JobListing.h>
+#include <remus/proto/ModelSession.h>
+#include <remus/proto/JobReservation.h>
 #include <remus/proto/JobResult.h>
 #include <remus/proto/JobStatus.h>
+#include <remus/proto/JobSubmission.h>
 #include <remus/proto/JobRequirements.h>
 #include <remus/proto/Message.h>
 #include <remus/proto/Response.h>
@@ -36,17 +43,125 @@ REMUS_THIRDPARTY_POST_INCLUDE
 #include <remus/server/detail/ActiveJobs.h>
 #include <remus/server/detail/EventPublisher.h>
 #include <remus/server/detail/JobQueue.h>
+#include <remus/server/detail/ModelSessions.h>
+#include <remus/server/detail/FactoryWorkers.h>
+#include <remus/server/detail/CapabilityCache.h>
+#include <remus/server/detail/ContentCaches.h>
+#include <remus/server/detail/ServerSummary.h>
 #include <remus/server/detail/SocketMonitor.h>
 #include <remus/server/detail/WorkerPool.h>
 #include <remus/server/WorkerFactory.h>
 
+#include <algorithm>
 #include <set>
+#include <sstream>
 #include <ctime>
 
 namespace remus{
 namespace server{
 namespace detail{
 
+//------------------------------------------------------------------------------
+//returns the status of a job as a client should see it, and clears the
+//progress message so that clients only see each message once
+remus::proto::JobStatus current_status(const boost::uuids::uuid& id,
+                                       const remus::server::detail::JobQueue& queued,
+                                       remus::server::detail::ActiveJobs& active)
+{
+  remus::proto::JobStatus js(id,remus::INVALID_STATUS);
+  if(queued.haveUUID(id))
+    {
+    js = remus::proto::JobStatus(id,remus::QUEUED);
+    }
+  else if(active.haveUUID(id))
+    {
+    js = active.status(id);
+    active.clearStatus(id);
+    }
+  return js;
+}
+
+//------------------------------------------------------------------------------
+//the most jobs a single LIST_JOBS response holds, no matter what the
+//client asks for, so that listing a big queue can't stall the server
+const std::size_t MaxJobsPerListing = 1000;
+
+//------------------------------------------------------------------------------
+//the longest a WAIT_FOR_STATUS_CHANGE request is parked, no matter what the
+//client asks for, so that a client can't make the server hold a waiter
+//forever. The client gets the current status and can ask again
+const boost::int64_t MaxStatusWaitMillisec = 60 * 1000;
+
+//------------------------------------------------------------------------------
+//the most jobs sent to a worker in a single MAKE_MESH_BATCH message, so that
+//a worker with a large prefetch window doesn't stall the server while the
+//batch is serialized
+const std::size_t MaxJobsPerDispatch = 32;
+
+//------------------------------------------------------------------------------
+//how long a job stays reserved for a launched worker before it goes back
+//in the queue. Workers that take longer than this to start still work,
+//they just wait in line for their first job like every other worker
+const boost::int64_t ReservationTimeoutInSeconds = 60;
+
+//------------------------------------------------------------------------------
+//how long a model session stays open without any job using it
+const boost::int64_t ModelSessionTimeoutInSeconds = 30 * 60;
+
+//------------------------------------------------------------------------------
+//the payload of JOB_CREDITS is the number of credits followed by the
+//requirements. Returns false for a payload that can't be parsed or that
+//holds no credits, which is dropped
+bool parse_jobCredits(const std::string& payload,
+                      std::size_t& credits,
+                      std::string& reqs)
+{
+  const std::size_t split = payload.find('\n');
+  if(split == std::string::npos)
+    {
+    return false;
+    }
+  std::istringstream buffer(payload.substr(0,split));
+  long long count = 0;
+  buffer >> count;
+  if(buffer.fail() || !(buffer >> std::ws).eof() || count <= 0)
+    {
+    return false;
+    }
+  //credits past the most a worker can hold are dropped by the WorkerPool
+  credits = static_cast<std::size_t>(
+      std::min<long long>(count,
+                          static_cast<long long>(WorkerPool::maxCredits())));
+  reqs = payload.substr(split+1);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//a listing cursor is the location and id of the last job that was listed
+std::string make_listingCursor(const remus::proto::JobListingEntry& last)
+{
+  std::ostringstream buffer;
+  buffer << static_cast<int>(last.Location) << ' ' << last.Id;
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+//returns false if the cursor is empty or can't be parsed, in which case
+//the listing starts at the first job
+bool parse_listingCursor(const std::string& cursor,
+                         int& location,
+                         boost::uuids::uuid& after)
+{
+  if(cursor.empty())
+    {
+    return false;
+    }
+  std::istringstream buffer(cursor);
+  buffer >> location;
+  buffer >> after;
+  return !buffer.fail();
+}
+
 //------------------------------------------------------------------------------
 void send_terminateWorker(boost::uuids::uuid jobId,
                           zmq::socket_t& socket,
@@ -61,6 +176,27 @@ void send_terminateWorker(boost::uuids::uuid jobId,
                                          workerId);
 }
 
+//------------------------------------------------------------------------------
+//tell the workers that hold a model session which has been closed, that
+//they can drop it
+void send_closedModelSessions(remus::server::detail::ModelSessions& sessions,
+                              zmq::socket_t& socket)
+{
+  typedef remus::server::detail::ModelSessions::ClosedSessions Closed;
+  const Closed closed = sessions.takeClosedSessions();
+  for(Closed::const_iterator s = closed.begin(); s != closed.end(); ++s)
+    {
+    typedef std::set<zmq::SocketIdentity>::const_iterator WorkerIt;
+    for(WorkerIt w = s->second.begin(); w != s->second.end(); ++w)
+      {
+      remus::proto::send_NonBlockingResponse(remus::CLOSE_MODEL_SESSION,
+                                             s->first,
+                                             &socket,
+                                             *w);
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 void send_terminateJob(boost::uuids::uuid jobId,
                           zmq::socket_t& socket,
@@ -209,7 +345,12 @@ Server::Server():
   SocketMonitor( new remus::server::detail::SocketMonitor() ),
   WorkerPool( new remus::server::detail::WorkerPool() ),
   ActiveJobs( new remus::server::detail::ActiveJobs () ),
+  Capabilities( new remus::server::detail::CapabilityCache() ),
+  ContentCaches( new remus::server::detail::ContentCaches() ),
+  ModelSessions( new remus::server::detail::ModelSessions() ),
+  FactoryWorkers( new remus::server::detail::FactoryWorkers() ),
   Publish( new remus::server::detail::EventPublisher() ),
+  Summary( new remus::server::detail::ServerSummary(1000) ),
   UUIDGenerator( new detail::UUIDManagement() ),
   Thread( new detail::ThreadManagement() ),
   WorkerFactory( boost::make_shared<remus::server::WorkerFactory>() )
@@ -223,7 +364,12 @@ Server::Server(const boost::shared_ptr<remus::server::WorkerFactoryBase>& factor
   SocketMonitor( new remus::server::detail::SocketMonitor() ),
   WorkerPool( new remus::server::detail::WorkerPool() ),
   ActiveJobs( new remus::server::detail::ActiveJobs () ),
+  Capabilities( new remus::server::detail::CapabilityCache() ),
+  ContentCaches( new remus::server::detail::ContentCaches() ),
+  ModelSessions( new remus::server::detail::ModelSessions() ),
+  FactoryWorkers( new remus::server::detail::FactoryWorkers() ),
   Publish( new remus::server::detail::EventPublisher() ),
+  Summary( new remus::server::detail::ServerSummary(1000) ),
   UUIDGenerator( new detail::UUIDManagement() ),
   Thread( new detail::ThreadManagement() ),
   WorkerFactory( factory )
@@ -237,7 +383,12 @@ Server::Server(const remus::server::ServerPorts& ports):
   SocketMonitor( new remus::server::detail::SocketMonitor() ),
   WorkerPool( new remus::server::detail::WorkerPool() ),
   ActiveJobs( new remus::server::detail::ActiveJobs () ),
+  Capabilities( new remus::server::detail::CapabilityCache() ),
+  ContentCaches( new remus::server::detail::ContentCaches() ),
+  ModelSessions( new remus::server::detail::ModelSessions() ),
+  FactoryWorkers( new remus::server::detail::FactoryWorkers() ),
   Publish( new remus::server::detail::EventPublisher() ),
+  Summary( new remus::server::detail::ServerSummary(1000) ),
   UUIDGenerator( new detail::UUIDManagement() ),
   Thread( new detail::ThreadManagement() ),
   WorkerFactory( boost::make_shared<remus::server::WorkerFactory>() )
@@ -252,7 +403,12 @@ Server::Server(const remus::server::ServerPorts& ports,
   SocketMonitor( new remus::server::detail::SocketMonitor() ),
   WorkerPool( new remus::server::detail::WorkerPool() ),
   ActiveJobs( new remus::server::detail::ActiveJobs () ),
+  Capabilities( new remus::server::detail::CapabilityCache() ),
+  ContentCaches( new remus::server::detail::ContentCaches() ),
+  ModelSessions( new remus::server::detail::ModelSessions() ),
+  FactoryWorkers( new remus::server::detail::FactoryWorkers() ),
   Publish( new remus::server::detail::EventPublisher() ),
+  Summary( new remus::server::detail::ServerSummary(1000) ),
   UUIDGenerator( new detail::UUIDManagement() ),
   Thread( new detail::ThreadManagement() ),
   WorkerFactory( factory )
@@ -286,6 +442,18 @@ remus::server::PollingRates Server::pollingRates() const
   return remus::server::PollingRates(low,high);
 }
 
+//------------------------------------------------------------------------------
+void Server::summaryInterval(boost::int64_t millisec)
+{
+  this->Summary->interval(millisec);
+}
+
+//------------------------------------------------------------------------------
+boost::int64_t Server::summaryInterval() const
+{
+  return this->Summary->interval();
+}
+
 //------------------------------------------------------------------------------
 bool Server::Brokering(Server::SignalHandling sh)
   {
@@ -299,14 +467,17 @@ bool Server::Brokering(Server::SignalHandling sh)
 
   zmq::socket_t clientChannel(*(this->PortInfo.context()),ZMQ_ROUTER);
   zmq::socket_t workerChannel(*(this->PortInfo.context()),ZMQ_ROUTER);
-  zmq::socket_t statusChannel(*(this->PortInfo.context()),ZMQ_PUB);
+  //the status channel is a XPUB socket so that the publisher knows
+  //when nobody is listening, and can skip building events
+  zmq::socket_t statusChannel(*(this->PortInfo.context()),ZMQ_XPUB);
 
   //attempts to bind to the sockets to the desired ports
   this->PortInfo.bindClient(&clientChannel);
   this->PortInfo.bindWorker(&workerChannel);
   this->PortInfo.bindStatus(&statusChannel);
 
-  //tell the StatusPublisher what socket to use
+  //tell the StatusPublisher what socket to use, from now on only
+  //the publisher thread uses the status socket
   this->Publish->socketToUse(&statusChannel);
 
   //give to the worker factory the endpoint information so it can properly
@@ -333,6 +504,9 @@ bool Server::Brokering(Server::SignalHandling sh)
                       boost::posix_time::microsec_clock::local_time() +
                       boost::posix_time::milliseconds(workerCheckInterval);
 
+  //start the first summary interval now that we are brokering
+  this->Summary->interval( this->Summary->interval() );
+
   //We need to notify the Thread management that brokering is about to start.
   //This allows the calling thread to resume, as it has been waiting for this
   //notification, and will also allow threads that have been holding on
@@ -345,7 +519,20 @@ bool Server::Brokering(Server::SignalHandling sh)
     //number of living workers. This is done
     bool worker_shutting_down = false;
 
-    zmq::poll_safely(&items[0], 2, monitor.current());
+    //don't sleep past the point where a parked client needs an answer,
+    //or a summary needs to be published
+    boost::int64_t pollTimeout = monitor.current();
+    const boost::posix_time::ptime nextDeadline =
+                  std::min(this->ActiveJobs->nextStatusWaiterDeadline(),
+                           this->Summary->nextSnapshot());
+    if(!nextDeadline.is_pos_infinity())
+      {
+      const boost::int64_t untilDeadline =
+                            (nextDeadline - currentTime).total_milliseconds();
+      pollTimeout = std::max<boost::int64_t>(1, std::min(pollTimeout, untilDeadline));
+      }
+
+    zmq::poll_safely(&items[0], 2, pollTimeout);
     monitor.pollOccurred();
 
     //update the current time
@@ -369,10 +556,24 @@ bool Server::Brokering(Server::SignalHandling sh)
     if(whenToCheckForDeadOrCompletedWorkers <= currentTime || worker_shutting_down)
       {
       this->CheckForChangeInWorkersAndJobs();
+      this->balanceFactoryWorkers( workerChannel );
+      detail::send_closedModelSessions( *this->ModelSessions, workerChannel );
       whenToCheckForDeadOrCompletedWorkers = currentTime +
                       boost::posix_time::milliseconds(workerCheckInterval);
       }
 
+    //answer any client that is waiting on a job whose status has changed
+    this->AnswerStatusWaiters(clientChannel);
+
+    //the counts are all kept up to date as jobs move through the
+    //server, so building the summary is cheap
+    if(this->Summary->due(currentTime))
+      {
+      this->Publish->summary( this->Summary->snapshot(currentTime,
+                                                      *this->QueuedJobs,
+                                                      *this->ActiveJobs) );
+      }
+
     //see if we have a worker in the pool for the next job in the queue,
     //otherwise as the factory to generate a new worker to handle that job
     if(Thread->isBrokering())
@@ -440,7 +641,8 @@ void Server::DetermineClientResponse(zmq::socket_t& clientChannel,
     remus::proto::send_NonBlockingResponse(remus::INVALID_SERVICE,
                                            remus::INVALID_MSG,
                                            &clientChannel,
-                                           clientIdentity);
+                                           clientIdentity,
+                                           msg.requestId());
     return; //no need to continue
     }
 
@@ -457,29 +659,32 @@ void Server::DetermineClientResponse(zmq::socket_t& clientChannel,
     case remus::SUPPORTED_IO_TYPES:
       //returns what MeshIOTypes the server supports
       //by checking the worker pool and factory
-      response_data = this->allSupportedMeshIOTypes(msg);
-      break;
     case remus::CAN_MESH_IO_TYPE:
       //returns if we can mesh a given MeshIOType
       //by checking the worker pool and factory
-      response_data = this->canMesh(msg);
-      break;
     case remus::CAN_MESH_REQUIREMENTS:
       //returns if we can mesh a given proto::JobRequirements
       //by checking the worker pool and factory
-      response_data = this->canMeshRequirements(msg);
-      break;
     case remus::MESH_REQUIREMENTS_FOR_IO_TYPE:
       //Generates all the JobRequirments that have the
       //passed in MeshIOType. Does this
       //by checking the worker pool and factory
-      response_data = this->meshRequirements(msg);
+      //
+      //all of these only change when workers come and go, so the
+      //answers are cached between those changes
+      response_data = this->capabilityQuery(msg);
       break;
     case remus::MAKE_MESH:
       //queues the proto::JobSubmission and returns
       //a proto::Job that can be used to track that job
       response_data = this->queueJob(msg);
       break;
+    case remus::MAKE_MESH_WITH_ID:
+      //queues the proto::JobSubmission using the job id the client
+      //generated. Returns the proto::Job as an acknowledgment, or an
+      //invalid job if the id is already in use
+      response_data = this->queueJob(msg);
+      break;
     case remus::MESH_STATUS:
       //retrieves the current status of the job related to the passed
       //proto::Job. Returns a proto::JobStatus
@@ -501,6 +706,50 @@ void Server::DetermineClientResponse(zmq::socket_t& clientChannel,
       //we can do nothing to stop it
       response_data = this->terminateJob(workerChannel,msg);
       break;
+    case remus::MAKE_MESH_ARRAY:
+      //queues every element of a proto::JobArraySubmission and returns
+      //a proto::JobArray that can be used to track the elements. The
+      //elements share the submission until they are given to a worker
+      response_data = this->queueJobArray(msg);
+      break;
+    case remus::JOB_ARRAY_STATUS:
+      //returns the status of every element of a proto::JobArray as
+      //a proto::JobArrayStatus
+      response_data = this->jobArrayStatus(msg);
+      break;
+    case remus::TERMINATE_JOB_ARRAY:
+      //terminates every element of a proto::JobArray, the same way
+      //TERMINATE_JOB does for a single job
+      response_data = this->terminateJobArray(workerChannel,msg);
+      break;
+    case remus::LIST_JOBS:
+      //returns a page of the jobs that the server holds, read straight
+      //from the queue and active jobs
+      response_data = this->listJobs(msg);
+      break;
+    case remus::OPEN_MODEL_SESSION:
+      //stores the contents of a proto::JobSubmission that later
+      //submissions share, and returns the id of the session
+      response_data = this->openModelSession(msg);
+      break;
+    case remus::CLOSE_MODEL_SESSION:
+      //frees a model session, jobs of the session that are already
+      //queued still run
+      response_data = this->closeModelSession(msg);
+      break;
+    case remus::WAIT_FOR_STATUS_CHANGE:
+      {
+      //returns a proto::JobStatus once the status of the job differs
+      //from what the client last saw, or the client timeout passes.
+      //If neither is true yet the client is parked and answered later
+      bool parked = false;
+      response_data = this->waitForStatusChange(clientIdentity, msg, parked);
+      if(parked)
+        {
+        return;
+        }
+      }
+      break;
     default:
       response_service = remus::INVALID_SERVICE;
       response_data = remus::INVALID_MSG;
@@ -508,12 +757,54 @@ void Server::DetermineClientResponse(zmq::socket_t& clientChannel,
 
   //now that we have the proper service_type and data send it in a non
   //blocking manner so the server doesn't stall out sending to a client
-  //that has disconnected
+  //that has disconnected. We echo back the request id so that clients
+  //with multiple requests in flight can match up the response
   remus::proto::send_NonBlockingResponse(response_service, response_data,
-                                         &clientChannel,   clientIdentity);
+                                         &clientChannel,   clientIdentity,
+                                         msg.requestId());
   return;
 }
 
+//------------------------------------------------------------------------------
+std::string Server::capabilityQuery(const remus::proto::Message& msg)
+{
+  //only factories that tell us when their capabilities change can
+  //have their answers cached
+  const bool cacheable = this->WorkerFactory->tracksCapabilityChanges();
+  if(cacheable)
+    {
+    this->Capabilities->validate(this->WorkerFactory->capabilitiesVersion(),
+                                 this->WorkerFactory->maxWorkerCount(),
+                                 this->WorkerPool->capabilitiesVersion());
+
+    const std::string* cached = this->Capabilities->find(msg);
+    if(cached)
+      {
+      return *cached;
+      }
+    }
+
+  std::string response;
+  switch(msg.serviceType())
+    {
+    case remus::SUPPORTED_IO_TYPES:
+      response = this->allSupportedMeshIOTypes(msg);
+      break;
+    case remus::CAN_MESH_IO_TYPE:
+      response = this->canMesh(msg);
+      break;
+    case remus::CAN_MESH_REQUIREMENTS:
+      response = this->canMeshRequirements(msg);
+      break;
+    case remus::MESH_REQUIREMENTS_FOR_IO_TYPE:
+      response = this->meshRequirements(msg);
+      break;
+    default:
+      return remus::INVALID_MSG;
+    }
+  return cacheable ? this->Capabilities->store(msg, response) : response;
+}
+
 //------------------------------------------------------------------------------
 std::string Server::allSupportedMeshIOTypes(const remus::proto::Message& )
 {
@@ -595,29 +886,163 @@ std::string Server::meshRequirements(const remus::proto::Message& msg)
 std::string Server::meshStatus(const remus::proto::Message& msg)
 {
   remus::proto::Job job = remus::proto::to_Job(msg.data(),msg.dataSize());
-  remus::proto::JobStatus js(job.id(),remus::INVALID_STATUS);
-  if(this->QueuedJobs->haveUUID(job.id()))
+  remus::proto::JobStatus js = detail::current_status(job.id(),
+                                                      *this->QueuedJobs,
+                                                      *this->ActiveJobs);
+  std::string status = remus::proto::to_string(js);
+  return status;
+}
+
+//------------------------------------------------------------------------------
+std::string Server::listJobs(const remus::proto::Message& msg)
+{
+  typedef remus::proto::JobListingRequest Request;
+  const Request request =
+              remus::proto::to_JobListingRequest(msg.data(),msg.dataSize());
+  const std::size_t maxEntries =
+      std::max<std::size_t>(1, std::min(request.maxEntries(),
+                                        detail::MaxJobsPerListing));
+
+  int cursorLocation = 0;
+  boost::uuids::uuid cursorId = boost::uuids::uuid();
+  const bool haveCursor = detail::parse_listingCursor(request.cursor(),
+                                                      cursorLocation,
+                                                      cursorId);
+
+  //jobs are listed by location, and by id inside a location. Locations
+  //before the cursor are skipped, and the location of the cursor
+  //continues after the cursor id
+  const Request::JobLocation locations[3] = { Request::QUEUED_JOBS,
+                                              Request::WAITING_FOR_WORKER_JOBS,
+                                              Request::ACTIVE_JOBS };
+  const boost::posix_time::ptime now =
+                              boost::posix_time::microsec_clock::local_time();
+
+  remus::proto::JobListing listing;
+  bool more = false;
+  for(int i=0; i < 3 && !more; ++i)
     {
-    js = remus::proto::JobStatus(job.id(),remus::QUEUED);
+    const Request::JobLocation location = locations[i];
+    if((request.locations() & location) == 0 ||
+       (haveCursor && location < cursorLocation))
+      {
+      continue;
+      }
+
+    const boost::uuids::uuid* after =
+              (haveCursor && location == cursorLocation) ? &cursorId : NULL;
+    if(location == Request::ACTIVE_JOBS)
+      {
+      more = this->ActiveJobs->listJobs(request, after, now,
+                                        maxEntries, listing);
+      }
+    else
+      {
+      more = this->QueuedJobs->listJobs(request, location, after, now,
+                                        maxEntries, listing);
+      }
     }
-  else if(this->ActiveJobs->haveUUID(job.id()))
+
+  if(more && listing.size() > 0)
     {
-    js = this->ActiveJobs->status(job.id());
-    this->ActiveJobs->clearStatus(job.id());
+    listing.nextCursor(
+                  detail::make_listingCursor(listing.entries().back()));
     }
-  std::string status = remus::proto::to_string(js);
-  return status;
+  return remus::proto::to_string(listing);
+}
+
+//------------------------------------------------------------------------------
+std::string Server::waitForStatusChange(const zmq::SocketIdentity &clientIdentity,
+                                        const remus::proto::Message& msg,
+                                        bool& parked)
+{
+  parked = false;
+
+  //the client sends the job, the status it last saw, and how long
+  //it is willing to wait in milliseconds
+  std::istringstream buffer(std::string(msg.data(),msg.dataSize()));
+  remus::proto::Job job = remus::proto::make_invalidJob();
+  buffer >> job;
+  remus::proto::JobStatus lastSeen(job.id(),remus::INVALID_STATUS);
+  buffer >> lastSeen;
+  boost::int64_t timeoutInMillisec = 0;
+  buffer >> timeoutInMillisec;
+
+  //we only check the status and progress value, since the progress message
+  //is cleared every time a client sees it
+  const bool queued = this->QueuedJobs->haveUUID(job.id());
+  const bool active = this->ActiveJobs->haveUUID(job.id());
+  remus::proto::JobStatus current(job.id(),remus::INVALID_STATUS);
+  if(queued)
+    {
+    current = remus::proto::JobStatus(job.id(),remus::QUEUED);
+    }
+  else if(active)
+    {
+    current = this->ActiveJobs->status(job.id());
+    }
+
+  const bool changed = current.status() != lastSeen.status() ||
+                  current.progress().value() != lastSeen.progress().value();
+  if(changed || (!queued && !active) || timeoutInMillisec <= 0 || !buffer)
+    {
+    return remus::proto::to_string(
+      detail::current_status(job.id(), *this->QueuedJobs, *this->ActiveJobs));
+    }
+
+  remus::server::detail::ActiveJobs::StatusWaiter waiter;
+  waiter.JobId = job.id();
+  waiter.Client = clientIdentity;
+  waiter.RequestId = msg.requestId();
+  waiter.Deadline = boost::posix_time::microsec_clock::local_time() +
+                    boost::posix_time::milliseconds(
+                      std::min(timeoutInMillisec, detail::MaxStatusWaitMillisec));
+  this->ActiveJobs->addStatusWaiter(waiter);
+
+  parked = true;
+  return std::string();
 }
 
 //------------------------------------------------------------------------------
 std::string Server::queueJob(const remus::proto::Message& msg)
 {
-  //generate an UUID
-  const boost::uuids::uuid jobUUID = (*this->UUIDGenerator)();
+  boost::uuids::uuid jobUUID;
+  remus::proto::JobSubmission submission;
+
+  if(msg.serviceType() == remus::MAKE_MESH_WITH_ID)
+    {
+    //the client has already generated the job id, and sent it along
+    //as a proto::Job in front of the submission
+    std::istringstream buffer(std::string(msg.data(),msg.dataSize()));
+    remus::proto::Job requestedJob = remus::proto::make_invalidJob();
+    buffer >> requestedJob;
+    buffer >> submission;
+
+    jobUUID = requestedJob.id();
+    const bool idInUse = jobUUID.is_nil() ||
+                         this->QueuedJobs->haveUUID(jobUUID) ||
+                         this->ActiveJobs->haveUUID(jobUUID);
+    if(!requestedJob.valid() || idInUse)
+      {
+      return remus::proto::to_string(remus::proto::make_invalidJob());
+      }
+    }
+  else
+    {
+    //generate an UUID
+    jobUUID = (*this->UUIDGenerator)();
 
-  //create a new job to place on the queue
-  const remus::proto::JobSubmission submission =
-                  remus::proto::to_JobSubmission(msg.data(),msg.dataSize());
+    //create a new job to place on the queue
+    submission = remus::proto::to_JobSubmission(msg.data(),msg.dataSize());
+    }
+
+  //a submission of a model session gets the contents of the session,
+  //and is refused once the session has been closed
+  if(!this->ModelSessions->addSessionContents(submission,
+                            boost::posix_time::microsec_clock::local_time()))
+    {
+    return remus::proto::to_string(remus::proto::make_invalidJob());
+    }
 
   this->QueuedJobs->addJob(jobUUID,submission);
 
@@ -631,6 +1056,156 @@ std::string Server::queueJob(const remus::proto::Message& msg)
   return remus::proto::to_string(validJob);
 }
 
+//------------------------------------------------------------------------------
+std::string Server::openModelSession(const remus::proto::Message& msg)
+{
+  remus::proto::JobSubmission contents;
+  std::size_t maxWorkers = 1;
+  if(!remus::proto::from_ModelSessionRequest(msg.data(), msg.dataSize(),
+                                             contents, maxWorkers))
+    {
+    return remus::INVALID_MSG;
+    }
+
+  const std::string id = remus::to_string((*this->UUIDGenerator)());
+  this->ModelSessions->open(id, contents, maxWorkers,
+                            boost::posix_time::microsec_clock::local_time());
+  return id;
+}
+
+//------------------------------------------------------------------------------
+std::string Server::closeModelSession(const remus::proto::Message& msg)
+{
+  const std::string id(msg.data(), msg.dataSize());
+  std::ostringstream buffer;
+  buffer << this->ModelSessions->close(id) << '\n';
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+std::string Server::queueJobArray(const remus::proto::Message& msg)
+{
+  typedef remus::proto::JobArraySubmission ArraySubmission;
+  boost::shared_ptr<ArraySubmission> parsed = boost::make_shared<ArraySubmission>(
+            remus::proto::to_JobArraySubmission(msg.data(),msg.dataSize()));
+
+  if(parsed->size() == 0 || parsed->size() > ArraySubmission::MaxElements)
+    {
+    return remus::proto::to_string(remus::proto::make_invalidJobArray());
+    }
+
+  //the base of an array of a model session gets the contents of the
+  //session, the same as a single submission does
+  if(!remus::proto::to_ModelSessionId(parsed->base()).empty())
+    {
+    remus::proto::JobSubmission base = parsed->base();
+    if(!this->ModelSessions->addSessionContents(base,
+                            boost::posix_time::microsec_clock::local_time()))
+      {
+      return remus::proto::to_string(remus::proto::make_invalidJobArray());
+      }
+    boost::shared_ptr<ArraySubmission> withSession =
+                                      boost::make_shared<ArraySubmission>(base);
+    for(std::size_t i=0; i < parsed->size(); ++i)
+      {
+      withSession->addElement(parsed->overrides(i));
+      }
+    parsed.swap(withSession);
+    }
+  boost::shared_ptr<const ArraySubmission> array = parsed;
+
+  //the element ids are made from the array id, so the array id has
+  //to leave room for the element index
+  const boost::uuids::uuid arrayId =
+                    remus::proto::make_JobArrayId((*this->UUIDGenerator)());
+  if(!this->QueuedJobs->addJobArray(arrayId, array))
+    {
+    return remus::proto::to_string(remus::proto::make_invalidJobArray());
+    }
+
+  const remus::proto::JobArray validArray(arrayId, msg.MeshIOType(),
+                                          array->size());
+
+  //publish that each element has been queued
+  for(std::size_t i=0; i < validArray.size(); ++i)
+    {
+    this->Publish->jobQueued(validArray.job(i), array->requirements());
+    }
+
+  return remus::proto::to_string(validArray);
+}
+
+//------------------------------------------------------------------------------
+std::string Server::jobArrayStatus(const remus::proto::Message& msg)
+{
+  const remus::proto::JobArray array =
+                  remus::proto::to_JobArray(msg.data(),msg.dataSize());
+  const std::size_t size = std::min<std::size_t>(array.size(),
+                             remus::proto::JobArraySubmission::MaxElements);
+
+  //unlike MESH_STATUS this doesn't clear the progress messages, as
+  //they aren't part of the array status
+  remus::proto::JobArrayStatus status(array.id(), size);
+  for(std::size_t i=0; i < size; ++i)
+    {
+    const boost::uuids::uuid id =
+                      remus::proto::make_JobArrayElementId(array.id(), i);
+    if(this->QueuedJobs->haveUUID(id))
+      {
+      status.status(i, remus::QUEUED);
+      }
+    else if(this->ActiveJobs->haveUUID(id))
+      {
+      status.status(i, this->ActiveJobs->status(id).status());
+      }
+    }
+  return remus::proto::to_string(status);
+}
+
+//------------------------------------------------------------------------------
+std::string Server::terminateJobArray(zmq::socket_t& workerChannel,
+                                      const remus::proto::Message& msg)
+{
+  const remus::proto::JobArray array =
+                  remus::proto::to_JobArray(msg.data(),msg.dataSize());
+  const std::size_t size = std::min<std::size_t>(array.size(),
+                             remus::proto::JobArraySubmission::MaxElements);
+
+  remus::proto::JobArrayStatus status(array.id(), size);
+  std::vector<boost::uuids::uuid> queued;
+  for(std::size_t i=0; i < size; ++i)
+    {
+    const boost::uuids::uuid id =
+                      remus::proto::make_JobArrayElementId(array.id(), i);
+    if(this->QueuedJobs->haveUUID(id))
+      {
+      queued.push_back(id);
+      status.status(i, remus::FAILED);
+      }
+    else if(this->ActiveJobs->haveUUID(id))
+      {
+      //the same as terminateJob, ask the worker to drop the job
+      zmq::SocketIdentity worker = this->ActiveJobs->workerAddress(id);
+      const remus::proto::JobStatus lastStatus = this->ActiveJobs->status(id);
+
+      detail::send_terminateJob(id, workerChannel, worker);
+      this->Publish->jobTerminated(lastStatus, worker);
+      status.status(i, remus::FAILED);
+      }
+    }
+
+  //all the queued elements are removed in a single pass over the queue
+  this->QueuedJobs->removeJobArray(array.id());
+  for(std::vector<boost::uuids::uuid>::const_iterator i = queued.begin();
+      i != queued.end(); ++i)
+    {
+    this->Publish->jobTerminated(remus::proto::JobStatus(*i,remus::QUEUED));
+    this->ActiveJobs->markChanged(*i);
+    }
+
+  return remus::proto::to_string(status);
+}
+
 //------------------------------------------------------------------------------
 std::string Server::retrieveResult(const remus::proto::Message& msg)
 {
@@ -675,6 +1250,9 @@ std::string Server::terminateJob(zmq::socket_t& workerChannel,
     //publish that this job is now terminated and what it's last status was
     remus::proto::JobStatus lastStatus(job.id(),remus::QUEUED);
     this->Publish->jobTerminated(lastStatus);
+
+    //wake up any client that is waiting on this job
+    this->ActiveJobs->markChanged(job.id());
     }
   else
     {
@@ -695,9 +1273,31 @@ std::string Server::terminateJob(zmq::socket_t& workerChannel,
   return remus::proto::to_string(jstatus);
 }
 
+//------------------------------------------------------------------------------
+void Server::AnswerStatusWaiters(zmq::socket_t& clientChannel)
+{
+  typedef remus::server::detail::ActiveJobs::StatusWaiter StatusWaiter;
+  const std::vector< StatusWaiter > waiters =
+    this->ActiveJobs->takeStatusWaiters(
+                            boost::posix_time::microsec_clock::local_time());
+
+  typedef std::vector< StatusWaiter >::const_iterator WaiterIt;
+  for(WaiterIt i = waiters.begin(); i != waiters.end(); ++i)
+    {
+    remus::proto::JobStatus js = detail::current_status(i->JobId,
+                                                        *this->QueuedJobs,
+                                                        *this->ActiveJobs);
+    remus::proto::send_NonBlockingResponse(remus::WAIT_FOR_STATUS_CHANGE,
+                                           remus::proto::to_string(js),
+                                           &clientChannel,
+                                           i->Client,
+                                           i->RequestId);
+    }
+}
+
 //------------------------------------------------------------------------------
 void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
-                                     const zmq::SocketIdentity &workerIdentity,
+                                     const zmq::SocketIdentity &workerRoute,
                                      bool& workerTerminated )
 {
   remus::proto::Message msg = remus::proto::receive_Message(&workerChannel);
@@ -707,6 +1307,11 @@ void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
     return;
     }
 
+  //workers that share a connection through a WorkerHub tag every message
+  //with their virtual id, which makes each of them a worker of its own
+  const zmq::SocketIdentity workerIdentity = msg.requestId().empty() ?
+        workerRoute : zmq::SocketIdentity(workerRoute, msg.requestId());
+
   //Everything but TERMINATE_WORKER must have a msg payload
   if( (msg.serviceType() != TERMINATE_WORKER) &&
       (msg.dataSize() == 0))
@@ -739,6 +1344,76 @@ void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
       this->Publish->workerReady(workerIdentity, reqs);
       }
       break;
+    case remus::CLAIM_RESERVED_JOB:
+      {
+      //A launched worker asks for the job that was reserved for it. This
+      //stands in for the first MAKE_MESH of the worker, so when the
+      //reservation is gone the worker waits for a job like any other
+      std::string token;
+      remus::proto::JobRequirements reqs;
+      if(!remus::proto::from_ReservationClaim(msg.data(),msg.dataSize(),
+                                              token,reqs))
+        {
+        break;
+        }
+      //let the factory know which of its workers has connected
+      if(!token.empty())
+        {
+        this->FactoryWorkers->claimed(workerIdentity, token);
+        this->WorkerFactory->reservationClaimed(token);
+        }
+      //a job reserved for other requirements than the worker has goes
+      //back in the queue, and the worker waits for a job it can run
+      remus::worker::Job job = this->QueuedJobs->takeReservedJob(token, reqs);
+      if(job.valid())
+        {
+        //like a dispatched job, this pins the model session of the job
+        this->assignJobsToWorker(workerChannel, workerIdentity,
+                                 std::vector<remus::worker::Job>(1,job));
+        }
+      else
+        {
+        this->WorkerPool->readyForWork(workerIdentity,reqs);
+        this->Publish->workerReady(workerIdentity, reqs);
+        }
+      }
+      break;
+    case remus::JOB_CREDITS:
+      {
+      //The worker gives us credits for a number of jobs, which we can send
+      //in batches without waiting for the worker to ask for each job. The
+      //payload is the number of credits followed by the requirements
+      std::size_t credits = 0;
+      std::string reqsData;
+      if(!detail::parse_jobCredits(std::string(msg.data(),msg.dataSize()),
+                                   credits, reqsData))
+        {
+        break;
+        }
+      const remus::proto::JobRequirements reqs =
+          remus::proto::to_JobRequirements(reqsData);
+      this->WorkerPool->addCredits(workerIdentity,reqs,credits);
+      this->Publish->workerReady(workerIdentity, reqs);
+      }
+      break;
+    case remus::CONTENT_CACHE:
+      {
+      //The worker keeps a cache of job content. We acknowledge the cache,
+      //and from then on both sides start with an empty cache that they
+      //fill in the same order, see remus::proto::ContentCacheIndex
+      const remus::proto::ContentCacheIndex index =
+            remus::proto::to_ContentCacheIndex(msg.data(),msg.dataSize());
+      remus::proto::Response response =
+        remus::proto::send_NonBlockingResponse(remus::CONTENT_CACHE,
+                                               remus::proto::to_string(index),
+                                               &workerChannel,
+                                               workerIdentity);
+      if(response.isValid())
+        {
+        this->ContentCaches->configure(workerIdentity, index);
+        }
+      }
+      break;
     case remus::MESH_STATUS:
       //store the mesh status msg which is a proto::JobStatus
       //no response needed
@@ -765,11 +1440,13 @@ void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
       //message. The heartbeat message contains the msec delta for when
       //to next expect a heartbeat message from the given worker
       { //scoped so we don't get jump bypasses variable initialization errors
-      const std::string msgPayload(msg.data(),msg.dataSize());
-      boost::int64_t dur_in_milli = boost::lexical_cast<boost::int64_t>(
-                                                              msgPayload);
-      this->SocketMonitor->heartbeat(workerIdentity,dur_in_milli);
-      this->Publish->workerHeartbeat(workerIdentity);
+      const boost::int64_t dur_in_milli =
+        remus::proto::to_HeartbeatInterval(msg.data(),msg.dataSize());
+      if(dur_in_milli >= 0)
+        {
+        this->SocketMonitor->heartbeat(workerIdentity,dur_in_milli);
+        this->Publish->workerHeartbeat(workerIdentity);
+        }
       }
       break;
     case remus::TERMINATE_WORKER:
@@ -778,6 +1455,9 @@ void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
       //else as the WorkerPool and ActiveJobs will find out about the dead
       //worker by asking the SocketMonitor
       this->SocketMonitor->markAsDead(workerIdentity);
+      this->requeueUnstartedJobs(workerIdentity);
+      this->ContentCaches->remove(workerIdentity);
+      this->FactoryWorkers->remove(workerIdentity);
       this->Publish->workerTerminated(workerIdentity);
       workerTerminated = true;
     default:
@@ -786,11 +1466,13 @@ void Server::DetermineWorkerResponse(zmq::socket_t& workerChannel,
     }
   //if we are anything but a heartbeat message we need to refresh
   //the worker. Not the cleanest logic but I don't have a better idea
-  //on how to handle this
+  //on how to handle this. The refresh is deferred till we next check
+  //for dead workers, so a worker streaming messages at us only costs
+  //a set insert per message
   if(msg.serviceType() != remus::HEARTBEAT &&
      msg.serviceType() != remus::TERMINATE_WORKER)
     {
-    this->SocketMonitor->refresh(workerIdentity);
+    this->SocketMonitor->refreshLater(workerIdentity);
     }
 }
 
@@ -801,7 +1483,13 @@ void Server::storeMeshStatus(const zmq::SocketIdentity &workerIdentity,
   //the string in the data is actually a job status object
   remus::proto::JobStatus js = remus::proto::to_JobStatus(msg.data(),
                                                           msg.dataSize());
+  const bool wasGood = this->ActiveJobs->haveUUID(js.id()) &&
+                       this->ActiveJobs->status(js.id()).good();
   this->ActiveJobs->updateStatus(js);
+  if(wasGood && this->ActiveJobs->status(js.id()).failed())
+    {
+    this->Summary->jobFailed();
+    }
 
   this->Publish->jobStatus(js, workerIdentity);
 }
@@ -812,32 +1500,182 @@ void Server::storeMesh(const zmq::SocketIdentity &workerIdentity,
 {
   remus::proto::JobResult jr = remus::proto::to_JobResult(msg.data(),
                                                             msg.dataSize());
-  this->ActiveJobs->updateResult(jr);
+  //workers can send a result more than once, and send results for jobs
+  //that failed or that we have already dropped, only count real finishes
+  if(this->ActiveJobs->updateResult(jr))
+    {
+    this->Summary->jobFinished();
+    }
 
   this->Publish->jobFinished(jr, workerIdentity);
 }
 
 //------------------------------------------------------------------------------
-void Server::assignJobToWorker(zmq::socket_t& workerChannel,
-                               const zmq::SocketIdentity &workerIdentity,
-                               const remus::worker::Job& job )
+void Server::assignJobsToWorker(zmq::socket_t& workerChannel,
+                                const zmq::SocketIdentity &workerIdentity,
+                                const std::vector<remus::worker::Job>& jobs )
 {
-  this->ActiveJobs->add( workerIdentity, job.id() );
+  if(jobs.empty())
+    {
+    return;
+    }
+
+  typedef std::vector<remus::worker::Job>::const_iterator JobIt;
+  for(JobIt job = jobs.begin(); job != jobs.end(); ++job)
+    {
+    this->ActiveJobs->add( workerIdentity, *job );
+    }
+
+  //jobs of a model session are sent without the contents of the session,
+  //which the worker is sent once before the first job of the session
+  std::vector<remus::worker::Job> sessionJobs;
+  bool inSession = false;
+  if(!this->ModelSessions->empty())
+    {
+    std::map<std::string, remus::proto::JobSubmission> newSessions;
+    sessionJobs.reserve(jobs.size());
+    for(JobIt job = jobs.begin(); job != jobs.end(); ++job)
+      {
+      remus::proto::JobSubmission submission = job->submission();
+      if(this->ModelSessions->removeSessionContents(submission,
+                                                    workerIdentity,
+                                                    newSessions))
+        {
+        inSession = true;
+        sessionJobs.push_back(remus::worker::Job(job->id(), submission));
+        }
+      else
+        {
+        sessionJobs.push_back(*job);
+        }
+      }
 
-  remus::proto::Response response =
+    typedef std::map<std::string, remus::proto::JobSubmission>::const_iterator
+            SessionIt;
+    for(SessionIt s = newSessions.begin(); s != newSessions.end(); ++s)
+      {
+      remus::proto::send_NonBlockingResponse(remus::OPEN_MODEL_SESSION,
+                  remus::proto::to_ModelSessionContents(s->first, s->second),
+                  &workerChannel,
+                  workerIdentity);
+      }
+    }
+  const std::vector<remus::worker::Job>& sessionOrJobs =
+                                            inSession ? sessionJobs : jobs;
+
+  //content the worker has cached is sent as a reference. The index of
+  //the worker is only updated once we know the jobs have been sent
+  std::vector<remus::worker::Job> referencedJobs;
+  remus::proto::ContentCacheIndex updatedCache;
+  bool referenced = false;
+  if(!this->ContentCaches->empty())
+    {
+    referencedJobs = sessionOrJobs;
+    referenced = this->ContentCaches->referenceCachedContent(workerIdentity,
+                                                             referencedJobs,
+                                                             updatedCache);
+    }
+  const std::vector<remus::worker::Job>& toSend =
+                                  referenced ? referencedJobs : sessionOrJobs;
+
+  //a single job is sent as MAKE_MESH so that workers which never gave
+  //us credits only see the message they asked for
+  remus::proto::Response response = (toSend.size() == 1) ?
         remus::proto::send_NonBlockingResponse(remus::MAKE_MESH,
-                                               remus::worker::to_string(job),
+                                               remus::worker::to_string(toSend[0]),
+                                               &workerChannel,
+                                               workerIdentity) :
+        remus::proto::send_NonBlockingResponse(remus::MAKE_MESH_BATCH,
+                                               remus::proto::to_string(toSend),
                                                &workerChannel,
                                                workerIdentity);
   if(response.isValid())
     { //consider sending the job to be refreshing the worker
-    this->SocketMonitor->refresh(workerIdentity);
+    this->SocketMonitor->refreshLater(workerIdentity);
+    if(referenced)
+      {
+      this->ContentCaches->update(workerIdentity, updatedCache);
+      }
+    for(JobIt job = jobs.begin(); job != jobs.end(); ++job)
+      {
+      this->Summary->jobDispatched();
+      this->Publish->jobSentToWorker(*job, workerIdentity);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Server::requeueUnstartedJobs(const zmq::SocketIdentity &workerIdentity)
+{
+  //workers with a prefetch window can have jobs pending that they never
+  //took. Rather than letting those jobs expire, give them to another worker
+  const std::vector<remus::worker::Job> unstarted =
+                    this->ActiveJobs->takeUnstartedJobs(workerIdentity);
+  typedef std::vector<remus::worker::Job>::const_iterator JobIt;
+  for(JobIt job = unstarted.begin(); job != unstarted.end(); ++job)
+    {
+    if(this->QueuedJobs->addJob(job->id(), job->submission()))
+      {
+      this->Publish->jobQueued(remus::proto::Job(job->id(), job->type()),
+                               job->submission().requirements());
+      }
+    }
+}
 
-    //we should encode the worker id as part of the string
-    std::string wi(workerIdentity.data(), workerIdentity.size());
-    this->Publish->jobSentToWorker(job, workerIdentity);
+//------------------------------------------------------------------------------
+bool Server::dispatchJobs(zmq::socket_t& workerChannel,
+                          const remus::proto::JobRequirements& reqs)
+{
+  typedef remus::server::detail::JobQueue::CountsPerRequirement Counts;
+  const Counts& counts = this->QueuedJobs->countsPerRequirement();
+  Counts::const_iterator count = counts.find(reqs);
+  if(count == counts.end())
+    {
+    return false;
     }
+  std::size_t available = count->second.Queued +
+                          count->second.WaitingForWorker;
+
+  bool dispatched = false;
+  while(available > 0 && this->WorkerPool->haveWaitingWorker(reqs))
+    {
+    //the worker pool lowers the number of jobs to what the worker
+    //has credits for
+    std::size_t numberOfJobs = std::min(available, detail::MaxJobsPerDispatch);
+
+    //the next job goes to a worker its model session is pinned to, and
+    //otherwise when workers cache job content, the worker that holds
+    //the most content of the next job takes it
+    std::set<zmq::SocketIdentity> preferred;
+    if(!this->ModelSessions->empty() || !this->ContentCaches->empty())
+      {
+      const remus::proto::JobSubmission next = this->QueuedJobs->peekJob(reqs);
+      preferred = this->ModelSessions->pinnedWorkers(next);
+      if(preferred.empty() && !this->ContentCaches->empty())
+        {
+        preferred = this->ContentCaches->preferredWorkers(next);
+        }
+      }
+    const zmq::SocketIdentity worker =
+                    this->WorkerPool->takeWorker(reqs, numberOfJobs, preferred);
+    if(numberOfJobs == 0)
+      {
+      break;
+      }
+
+    std::vector<remus::worker::Job> jobs;
+    jobs.reserve(numberOfJobs);
+    for(std::size_t i=0; i < numberOfJobs; ++i)
+      {
+      jobs.push_back(this->QueuedJobs->takeJob(reqs));
+      }
+    //pins the model sessions of the jobs to the worker
+    this->assignJobsToWorker(workerChannel, worker, jobs);
 
+    available -= numberOfJobs;
+    dispatched = true;
+    }
+  return dispatched;
 }
 
 //see if we have a worker in the pool for the next job in the queue,
@@ -867,13 +1705,8 @@ void Server::FindWorkerForQueuedJob(zmq::socket_t& workerChannel)
   waiting_types = this->QueuedJobs->waitingJobRequirements();
   for(it type = waiting_types.begin(); type != waiting_types.end(); ++type)
     {
-    if(this->WorkerPool->haveWaitingWorker(*type))
-      {
-      //give this job to that worker
-      this->assignJobToWorker(workerChannel,
-                              this->WorkerPool->takeWorker(*type),
-                              this->QueuedJobs->takeJob(*type));
-      }
+    //give the jobs to the waiting workers
+    this->dispatchJobs(workerChannel, *type);
     }
 
 
@@ -883,12 +1716,9 @@ void Server::FindWorkerForQueuedJob(zmq::socket_t& workerChannel)
   bool assignedJob = false;
   for(it type = queued_types.begin(); type != queued_types.end(); ++type)
     {
-    if(this->WorkerPool->haveWaitingWorker(*type))
+    //give the jobs to the waiting workers
+    if(this->dispatchJobs(workerChannel, *type))
       {
-      //give this job to that worker
-      this->assignJobToWorker(workerChannel,
-                              this->WorkerPool->takeWorker(*type),
-                              this->QueuedJobs->takeJob(*type));
       assignedJob = true;
       }
     }
@@ -907,9 +1737,21 @@ void Server::FindWorkerForQueuedJob(zmq::socket_t& workerChannel)
     //We are not going to assign the job to the worker now, instead we will
     //move the job to the waiting queue, and give it to the worker once
     //it has registered with us through the worker port.
+    //When the factory can pass a reservation to the worker, the job is
+    //held for that worker, which claims it with its first request
+    const bool reserve = this->WorkerFactory->supportsJobReservations();
     for(it type = queued_types.begin(); type != queued_types.end(); ++type)
       {
-      if(this->WorkerFactory->createWorker(*type,
+      if(reserve)
+        {
+        const std::string token = remus::to_string((*this->UUIDGenerator)());
+        if(this->WorkerFactory->createWorkerWithReservation(*type,
+                           WorkerFactoryBase::KillOnFactoryDeletion, token))
+          {
+          this->QueuedJobs->workerDispatched(*type, token);
+          }
+        }
+      else if(this->WorkerFactory->createWorker(*type,
                            WorkerFactoryBase::KillOnFactoryDeletion))
         {
         this->QueuedJobs->workerDispatched(*type);
@@ -918,9 +1760,65 @@ void Server::FindWorkerForQueuedJob(zmq::socket_t& workerChannel)
     }
 }
 
+//------------------------------------------------------------------------------
+void Server::balanceFactoryWorkers(zmq::socket_t& workerChannel)
+{
+  //the factory knows its workers by the reservation they claimed, and uses
+  //the idle ones to decide if it needs to launch warm workers
+  const std::set<std::string> idle = this->FactoryWorkers->idleReservations(
+                                  this->WorkerPool->allWorkersWantingWork(),
+                                  this->ActiveJobs->workingJobsPerWorker());
+  const std::set<zmq::SocketIdentity> retired = this->FactoryWorkers->workers(
+                                  this->WorkerFactory->idleWorkers(idle));
+
+  //the retired workers are taken out of the pool right away, so that
+  //they aren't sent a job while they shut down
+  typedef std::set<zmq::SocketIdentity>::const_iterator iterator;
+  for(iterator i=retired.begin(); i != retired.end(); ++i)
+    {
+    const boost::uuids::uuid jobId = (*this->UUIDGenerator)();
+    detail::send_terminateWorker(jobId, workerChannel, *i);
+    this->WorkerPool->removeWorker(*i);
+    this->ContentCaches->remove(*i);
+    this->FactoryWorkers->remove(*i);
+    }
+}
+
 //------------------------------------------------------------------------------
 void Server::CheckForChangeInWorkersAndJobs()
 {
+  //bring the socket monitor up to date with every worker we have
+  //heard from since the last check
+  this->SocketMonitor->applyRefreshes();
+
+  //jobs reserved for workers that failed to launch, or exited before
+  //claiming them, go back in the queue right away
+  const std::set<std::string> abandoned =
+                                this->WorkerFactory->abandonedReservations();
+  for(std::set<std::string>::const_iterator i = abandoned.begin();
+      i != abandoned.end(); ++i)
+    {
+    this->QueuedJobs->releaseReservation(*i);
+    }
+
+  //jobs reserved for workers that never claimed them go back in the queue
+  if(this->QueuedJobs->numJobsReserved() > 0)
+    {
+    const boost::posix_time::ptime reservedBefore =
+        boost::posix_time::microsec_clock::local_time() -
+        boost::posix_time::seconds(detail::ReservationTimeoutInSeconds);
+    this->QueuedJobs->releaseReservations(reservedBefore);
+    }
+
+  //model sessions that the client stopped using are freed
+  if(!this->ModelSessions->empty())
+    {
+    const boost::posix_time::ptime usedBefore =
+        boost::posix_time::microsec_clock::local_time() -
+        boost::posix_time::seconds(detail::ModelSessionTimeoutInSeconds);
+    this->ModelSessions->expire(usedBefore);
+    }
+
   //mark all jobs whose worker haven't sent a heartbeat in time
   //as a job that failed. We are returned the set of job's that are
   //expired
@@ -928,6 +1826,7 @@ void Server::CheckForChangeInWorkersAndJobs()
               this->ActiveJobs->markExpiredJobs((*this->SocketMonitor));
 
   //publish the jobs that have failed
+  this->Summary->jobsExpired( expiredJobs.size() );
   this->Publish->jobsExpired( expiredJobs );
 
   //purge all pending workers that have been explicitly terminated
@@ -936,6 +1835,9 @@ void Server::CheckForChangeInWorkersAndJobs()
   //the responsive state of all workers.
   // detail::ChangedWorkers updatedWorkers =
           this->WorkerPool->purgeDeadWorkers((*this->SocketMonitor));
+  this->ContentCaches->purgeDeadWorkers((*this->SocketMonitor));
+  this->ModelSessions->purgeDeadWorkers((*this->SocketMonitor));
+  this->FactoryWorkers->purgeDeadWorkers((*this->SocketMonitor));
 
   //Resync the worker factory with the updated status of workers. If we have
   //purged dead workers, the factory itself needs to become aware of this!
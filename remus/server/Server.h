@@ -28,6 +28,8 @@ REMUS_THIRDPARTY_POST_INCLUDE
 //included for export symbols
 #include <remus/server/ServerExports.h>
 
+#include <vector>
+
 #ifdef REMUS_MSVC
  #pragma warning(push)
  #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
@@ -39,6 +41,7 @@ namespace zmq { struct SocketIdentity; }
 namespace remus {
   //forward declaration of classes only the implementation needs
   namespace proto {
+  class JobRequirements;
   class WorkerJob;
   class Message;
   }
@@ -54,10 +57,15 @@ namespace server{
     {
     //forward declaration of classes only the implementation needs
     class ActiveJobs;
+    class CapabilityCache;
+    class ContentCaches;
+    class FactoryWorkers;
     class JobQueue;
+    class ModelSessions;
     class SocketMonitor;
     class WorkerPool;
     class EventPublisher;
+    class ServerSummary;
 
     struct ThreadManagement;
     struct UUIDManagement;
@@ -121,6 +129,16 @@ public:
   void pollingRates( const remus::server::PollingRates& rates );
   remus::server::PollingRates pollingRates() const;
 
+  //Modify how often the server publishes a summary of the queue depth,
+  //active jobs per worker, and job rates on the status channel under the
+  //key summary:server. The summary is only built when somebody is
+  //subscribed to the status channel. The default is once a second.
+  //
+  //Note: the interval is in milliseconds
+  //Note: a non positive interval disables the summary
+  void summaryInterval( boost::int64_t millisec );
+  boost::int64_t summaryInterval() const;
+
   //when you call start brokering the server will actually start accepting
   //worker and client requests.
   //IMPORTANT:
@@ -187,6 +205,10 @@ protected:
                                const zmq::SocketIdentity &clientIdentity,
                                zmq::socket_t& WorkerChannel);
 
+  //answers the capability queries from the cache, and only falls back to
+  //asking the factory and worker pool when they have changed
+  std::string capabilityQuery(const remus::proto::Message& msg);
+
   //These methods are all to do with sending responses to clients
   std::string allSupportedMeshIOTypes(const remus::proto::Message& msg);
   std::string canMesh(const remus::proto::Message& msg);
@@ -197,9 +219,44 @@ protected:
   std::string retrieveResult(const remus::proto::Message& msg);
   std::string terminateJob(zmq::socket_t& WorkerChannel,const remus::proto::Message& msg);
 
+  //queues every element of the proto::JobArraySubmission in the message,
+  //and returns a proto::JobArray that can be used to track the elements
+  std::string queueJobArray(const remus::proto::Message& msg);
+
+  //returns the proto::JobArrayStatus of the proto::JobArray in the message
+  std::string jobArrayStatus(const remus::proto::Message& msg);
+
+  //terminates every element of the proto::JobArray in the message, and
+  //returns a proto::JobArrayStatus where the terminated elements are FAILED
+  std::string terminateJobArray(zmq::socket_t& WorkerChannel,
+                                const remus::proto::Message& msg);
+
+  //returns a page of the queued and active jobs that pass the filters
+  //of the proto::JobListingRequest in the message
+  std::string listJobs(const remus::proto::Message& msg);
+
+  //opens a model session with the contents of the message, and returns
+  //the id of the session
+  std::string openModelSession(const remus::proto::Message& msg);
+
+  //closes the model session with the id in the message
+  std::string closeModelSession(const remus::proto::Message& msg);
+
+  //Parks the client until the status of the job differs from the status the
+  //client last saw, or the timeout passes. When the client has been parked
+  //the returned string is empty and parked is set to true, and the response
+  //will be sent later by AnswerStatusWaiters
+  std::string waitForStatusChange(const zmq::SocketIdentity &clientIdentity,
+                                  const remus::proto::Message& msg,
+                                  bool& parked);
+
+  //send responses to all parked clients whose job has changed, or whose
+  //timeout has passed
+  void AnswerStatusWaiters(zmq::socket_t& clientChannel);
+
   //Methods for processing Worker queries
   void DetermineWorkerResponse(zmq::socket_t& clientChannel,
-                               const zmq::SocketIdentity &workerIdentity,
+                               const zmq::SocketIdentity &workerRoute,
                                bool& workerTerminated);
 
   //These methods are all to do with sending/recving to workers
@@ -207,9 +264,23 @@ protected:
                        const remus::proto::Message& msg);
   void storeMesh(const zmq::SocketIdentity &workerIdentity,
                  const remus::proto::Message& msg);
-  void assignJobToWorker(zmq::socket_t& workerChannel,
-                         const zmq::SocketIdentity &workerIdentity,
-                         const remus::worker::Job& job);
+  //sends the jobs to a worker in a single message
+  void assignJobsToWorker(zmq::socket_t& workerChannel,
+                          const zmq::SocketIdentity &workerIdentity,
+                          const std::vector<remus::worker::Job>& jobs);
+  //queue the jobs a worker was sent but never started again, used when
+  //the worker tells us it is shutting down
+  void requeueUnstartedJobs(const zmq::SocketIdentity &workerIdentity);
+
+  //tells the worker factory which of its workers are waiting for a job,
+  //and shuts down the idle workers that the factory no longer wants
+  void balanceFactoryWorkers(zmq::socket_t& workerChannel);
+
+  //give queued jobs with the given requirements to the workers that are
+  //waiting for them, batching the jobs for workers that have given us
+  //credits. Returns true if any job was dispatched
+  bool dispatchJobs(zmq::socket_t& workerChannel,
+                    const remus::proto::JobRequirements& reqs);
 
   //see if we have a worker in the pool for the next job in the queue,
   //otherwise ask the factory to generate a new worker to handle that job
@@ -239,8 +310,13 @@ private:
   boost::scoped_ptr<remus::server::detail::SocketMonitor> SocketMonitor;
   boost::scoped_ptr<remus::server::detail::WorkerPool> WorkerPool;
   boost::scoped_ptr<remus::server::detail::ActiveJobs> ActiveJobs;
+  boost::scoped_ptr<remus::server::detail::CapabilityCache> Capabilities;
+  boost::scoped_ptr<remus::server::detail::ContentCaches> ContentCaches;
+  boost::scoped_ptr<remus::server::detail::ModelSessions> ModelSessions;
+  boost::scoped_ptr<remus::server::detail::FactoryWorkers> FactoryWorkers;
 
   boost::scoped_ptr<remus::server::detail::EventPublisher> Publish;
+  boost::scoped_ptr<remus::server::detail::ServerSummary> Summary;
 
   boost::scoped_ptr<detail::UUIDManagement> UUIDGenerator;
   boost::scoped_ptr<detail::ThreadManagement> Thread;
@@ -13,10 +13,11 @@
 #include <remus/server/WorkerFactory.h>
 
 #include <remus/common/CompilerInformation.h>
-#include <remus/common/ExecuteProcess.h>
 #include <remus/common/MeshIOType.h>
+#include <remus/proto/JobReservation.h>
 #include <remus/server/FactoryFileParser.h>
 #include <remus/server/FactoryWorkerSpecification.h>
+#include <remus/server/detail/ProcessSpawner.h>
 #include <remus/server/detail/WorkerFinder.h>
 
 //force to use filesystem version 3
@@ -24,18 +25,54 @@ REMUS_THIRDPARTY_PRE_INCLUDE
 #define BOOST_FILESYSTEM_VERSION 3
 #include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
 #include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
 
 namespace
 {
   //typedefs required
-  typedef remus::common::ExecuteProcess ExecuteProcess;
-  typedef boost::shared_ptr<ExecuteProcess> ExecuteProcessPtr;
-  typedef std::pair<ExecuteProcessPtr,
-                    remus::server::WorkerFactoryBase::FactoryDeletionBehavior>
-              RunningProcessInfo;
+  typedef remus::server::detail::ProcessSpawner::ProcessPtr ProcessPtr;
+
+  //----------------------------------------------------------------------------
+  struct RunningProcessInfo
+  {
+    RunningProcessInfo(const ProcessPtr& process,
+                       remus::server::WorkerFactoryBase::FactoryDeletionBehavior lifespan,
+                       const remus::server::FactoryWorkerSpecification& spec):
+      Process(process),
+      Lifespan(lifespan),
+      Requirements(spec.Requirements),
+      Reservation(),
+      Warm(false),
+      Connected(false),
+      Retiring(false),
+      IdleSince()
+      {
+      typedef std::map<std::string, std::string>::const_iterator EnvIt;
+      EnvIt r = spec.EnvironmentVariables.find(
+                            remus::proto::reservationEnvironmentVariable());
+      if(r != spec.EnvironmentVariables.end())
+        {
+        this->Reservation = r->second;
+        }
+      }
+
+    ProcessPtr Process;
+    remus::server::WorkerFactoryBase::FactoryDeletionBehavior Lifespan;
+    remus::proto::JobRequirements Requirements;
+    std::string Reservation;
+    bool Warm; //launched ahead of any job
+    bool Connected; //has claimed its reservation
+    bool Retiring; //the server has been asked to shut it down
+    boost::posix_time::ptime IdleSince; //not_a_date_time while not idle
+  };
 
   typedef std::vector<remus::server::FactoryWorkerSpecification>::const_iterator WorkerIterator;
   typedef std::vector< RunningProcessInfo >::iterator ProcessIterator;
@@ -74,7 +111,7 @@ namespace
   {
     bool operator()(const RunningProcessInfo& process) const
       {
-      return !process.first->isAlive();
+      return !process.Process->isAlive();
       }
   };
 
@@ -85,11 +122,11 @@ namespace
       {
       is_dead isDead;
       const bool shouldBeTerminated =
-        (process.second == remus::server::WorkerFactoryBase::KillOnFactoryDeletion);
+        (process.Lifespan == remus::server::WorkerFactoryBase::KillOnFactoryDeletion);
       const bool is_alive = !isDead(process);
       if(shouldBeTerminated && is_alive)
         {
-        process.first->kill();
+        process.Process->kill();
         }
       }
   };
@@ -130,6 +167,27 @@ namespace
     return ValidWorker();
   }
 
+  //----------------------------------------------------------------------------
+  //returns the bytes of memory the machine has available, or the largest
+  //value we can return when we can't tell
+  boost::uint64_t available_memory()
+  {
+#ifdef __linux__
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    boost::uint64_t value = 0;
+    while(meminfo >> key >> value)
+      {
+      if(key == "MemAvailable:")
+        { //the value is in kB
+        return value * 1024;
+        }
+      std::getline(meminfo, key);
+      }
+#endif
+    return std::numeric_limits<boost::uint64_t>::max();
+  }
+
     //----------------------------------------------------------------------------
   template<typename Container >
   remus::common::MeshIOTypeSet
@@ -168,7 +226,14 @@ struct WorkerFactory::WorkerTracker
 {
   WorkerTracker():
     PossibleWorkers(),
-    CurrentProcesses()
+    CurrentProcesses(),
+    WarmCount(0),
+    WarmCounts(),
+    IdleTimeout(-1),
+    MemoryReserve(0),
+    ReservationGenerator(),
+    AbandonedReservations(),
+    Spawner()
     {
 
     }
@@ -180,6 +245,20 @@ struct WorkerFactory::WorkerTracker
   std::vector< remus::server::FactoryWorkerSpecification > PossibleWorkers;
   std::vector< RunningProcessInfo > CurrentProcesses;
 
+  //warm workers for every type of worker, unless WarmCounts has an
+  //entry for the type
+  unsigned int WarmCount;
+  std::map< remus::proto::JobRequirements, unsigned int > WarmCounts;
+  boost::int64_t IdleTimeout;
+  boost::uint64_t MemoryReserve;
+  boost::uuids::random_generator ReservationGenerator;
+
+  //reservations of workers that died before claiming them
+  std::set<std::string> AbandonedReservations;
+
+  //launches the worker processes, on a helper thread when we have
+  //posix_spawn
+  remus::server::detail::ProcessSpawner Spawner;
 };
 
 //----------------------------------------------------------------------------
@@ -252,6 +331,7 @@ void WorkerFactory::addWorkerSearchDirectory(const std::string &directory)
   this->Tracker->PossibleWorkers.insert(this->Tracker->PossibleWorkers.end(),
                                         finder.begin(),
                                         finder.end());
+  this->capabilitiesChanged();
 }
 
 //----------------------------------------------------------------------------
@@ -277,6 +357,15 @@ bool WorkerFactory::haveSupport(
 //----------------------------------------------------------------------------
 bool WorkerFactory::createWorker(const remus::proto::JobRequirements& reqs,
                                  WorkerFactoryBase::FactoryDeletionBehavior lifespan)
+{
+  return this->createWorkerWithReservation(reqs, lifespan, std::string());
+}
+
+//----------------------------------------------------------------------------
+bool WorkerFactory::createWorkerWithReservation(
+                        const remus::proto::JobRequirements& reqs,
+                        WorkerFactoryBase::FactoryDeletionBehavior lifespan,
+                        const std::string& reservation)
 {
   //we check if we can create a worker with a given set of requirements, before
   //we check for space, since the 'updateWorkerCount' call is really really
@@ -290,7 +379,14 @@ bool WorkerFactory::createWorker(const remus::proto::JobRequirements& reqs,
     this->updateWorkerCount(); //remove dead workers
     if(this->currentWorkerCount() < this->maxWorkerCount())
       {
-      return this->addWorker(w.spec, lifespan);
+      if(reservation.empty())
+        {
+        return this->addWorker(w.spec, lifespan);
+        }
+      FactoryWorkerSpecification spec(w.spec);
+      spec.EnvironmentVariables[
+        remus::proto::reservationEnvironmentVariable()] = reservation;
+      return this->addWorker(spec, lifespan);
       }
     }
   return false;
@@ -299,6 +395,18 @@ bool WorkerFactory::createWorker(const remus::proto::JobRequirements& reqs,
 //----------------------------------------------------------------------------
 void WorkerFactory::updateWorkerCount()
 {
+  //workers that failed to launch, or exited before they connected, will
+  //never claim their reservation
+  is_dead isDead;
+  for(ProcessIterator i = this->Tracker->CurrentProcesses.begin();
+      i != this->Tracker->CurrentProcesses.end(); ++i)
+    {
+    if(!i->Reservation.empty() && !i->Connected && isDead(*i))
+      {
+      this->Tracker->AbandonedReservations.insert(i->Reservation);
+      }
+    }
+
   //foreach current worker remove any that return they are not alive
   this->Tracker->CurrentProcesses.erase(
       std::remove_if(this->Tracker->CurrentProcesses.begin(),
@@ -313,6 +421,157 @@ unsigned int WorkerFactory::currentWorkerCount() const
   return static_cast<unsigned int>(this->Tracker->CurrentProcesses.size());
 }
 
+//----------------------------------------------------------------------------
+void WorkerFactory::setWarmWorkerCount(unsigned int count)
+{
+  this->Tracker->WarmCount = count;
+  this->Tracker->WarmCounts.clear();
+}
+
+//----------------------------------------------------------------------------
+void WorkerFactory::setWarmWorkerCount(const remus::proto::JobRequirements& reqs,
+                                       unsigned int count)
+{
+  this->Tracker->WarmCounts[reqs] = count;
+}
+
+//----------------------------------------------------------------------------
+unsigned int WorkerFactory::warmWorkerCount(
+                            const remus::proto::JobRequirements& reqs) const
+{
+  typedef std::map< remus::proto::JobRequirements, unsigned int >::const_iterator It;
+  It i = this->Tracker->WarmCounts.find(reqs);
+  return (i != this->Tracker->WarmCounts.end()) ? i->second
+                                                : this->Tracker->WarmCount;
+}
+
+//----------------------------------------------------------------------------
+void WorkerFactory::setIdleWorkerTimeout(boost::int64_t millisec)
+{
+  this->Tracker->IdleTimeout = millisec;
+}
+
+//----------------------------------------------------------------------------
+boost::int64_t WorkerFactory::idleWorkerTimeout() const
+{
+  return this->Tracker->IdleTimeout;
+}
+
+//----------------------------------------------------------------------------
+void WorkerFactory::setWarmWorkerMemoryReserve(boost::uint64_t bytes)
+{
+  this->Tracker->MemoryReserve = bytes;
+}
+
+//----------------------------------------------------------------------------
+boost::uint64_t WorkerFactory::warmWorkerMemoryReserve() const
+{
+  return this->Tracker->MemoryReserve;
+}
+
+//----------------------------------------------------------------------------
+void WorkerFactory::reservationClaimed(const std::string& reservation)
+{
+  for(ProcessIterator i = this->Tracker->CurrentProcesses.begin();
+      i != this->Tracker->CurrentProcesses.end(); ++i)
+    {
+    if(i->Reservation == reservation)
+      {
+      i->Connected = true;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+std::set<std::string> WorkerFactory::abandonedReservations()
+{
+  std::set<std::string> abandoned;
+  abandoned.swap(this->Tracker->AbandonedReservations);
+  return abandoned;
+}
+
+//----------------------------------------------------------------------------
+std::set<std::string> WorkerFactory::idleWorkers(
+                                const std::set<std::string>& reservations)
+{
+  typedef std::map< remus::proto::JobRequirements, unsigned int > CountMap;
+  const boost::posix_time::ptime now =
+                            boost::posix_time::microsec_clock::local_time();
+  this->updateWorkerCount(); //remove dead workers
+
+  //find out which of our workers are idle, and since when. Warm workers
+  //that haven't connected yet will be idle soon, so they count as idle
+  CountMap idle;
+  for(ProcessIterator i = this->Tracker->CurrentProcesses.begin();
+      i != this->Tracker->CurrentProcesses.end(); ++i)
+    {
+    const bool isIdle = !i->Reservation.empty() &&
+                        reservations.count(i->Reservation) > 0;
+    if(isIdle)
+      {
+      i->Connected = true;
+      if(i->IdleSince.is_not_a_date_time())
+        {
+        i->IdleSince = now;
+        }
+      }
+    else
+      {
+      i->IdleSince = boost::posix_time::ptime();
+      }
+
+    if(!i->Retiring && (isIdle || (i->Warm && !i->Connected)))
+      {
+      ++idle[i->Requirements];
+      }
+    }
+
+  //shut down the workers that have been idle for too long, while keeping
+  //the warm workers around
+  std::set<std::string> retire;
+  const boost::int64_t timeout = this->Tracker->IdleTimeout;
+  for(ProcessIterator i = this->Tracker->CurrentProcesses.begin();
+      timeout >= 0 && i != this->Tracker->CurrentProcesses.end(); ++i)
+    {
+    if(i->Retiring || i->IdleSince.is_not_a_date_time())
+      {
+      continue;
+      }
+    const bool expired = (now - i->IdleSince).total_milliseconds() > timeout;
+    unsigned int& count = idle[i->Requirements];
+    if(expired && count > this->warmWorkerCount(i->Requirements))
+      {
+      i->Retiring = true;
+      --count;
+      retire.insert(i->Reservation);
+      }
+    }
+
+  //replace the warm workers that have taken a job. Each warm worker gets a
+  //reservation that has no job, so that we know when it has connected
+  for(WorkerIterator w = this->Tracker->PossibleWorkers.begin();
+      w != this->Tracker->PossibleWorkers.end(); ++w)
+    {
+    const unsigned int warm = this->warmWorkerCount(w->Requirements);
+    unsigned int& count = idle[w->Requirements];
+    while(count < warm &&
+          this->currentWorkerCount() < this->maxWorkerCount() &&
+          available_memory() > this->Tracker->MemoryReserve)
+      {
+      FactoryWorkerSpecification spec(*w);
+      spec.EnvironmentVariables[remus::proto::reservationEnvironmentVariable()] =
+          boost::uuids::to_string(this->Tracker->ReservationGenerator());
+      if(!this->addWorker(spec, WorkerFactoryBase::KillOnFactoryDeletion))
+        {
+        break;
+        }
+      this->Tracker->CurrentProcesses.back().Warm = true;
+      ++count;
+      }
+    }
+  return retire;
+}
+
 //----------------------------------------------------------------------------
 bool WorkerFactory::addWorker(
   const FactoryWorkerSpecification& spec,
@@ -334,18 +593,16 @@ bool WorkerFactory::addWorker(
   arguments.insert( arguments.end(), cmlArgs.begin(), cmlArgs.end() );
   arguments.insert( arguments.end(), spec.ExtraCommandLineArguments.begin(), spec.ExtraCommandLineArguments.end() );
 
-  ExecuteProcessPtr ep(
-    boost::make_shared<ExecuteProcess>(
-      spec.ExecutionPath.string(), arguments, spec.EnvironmentVariables
-      )
-    );
-
   //launch all process in attached mode, that way we can determine if
   //they are still alive or not. Once a process goes to detached mode
-  //it is impossible to determine if it is still running or not
-  ep->execute( );
-
-  RunningProcessInfo p_info(ep,lifespan);
+  //it is impossible to determine if it is still running or not.
+  //The spawner can launch the process after we return, but the process
+  //counts as alive from now on
+  ProcessPtr ep = this->Tracker->Spawner.spawn(spec.ExecutionPath.string(),
+                                               arguments,
+                                               spec.EnvironmentVariables);
+
+  RunningProcessInfo p_info(ep,lifespan,spec);
 
   this->Tracker->CurrentProcesses.push_back(p_info);
   return true;
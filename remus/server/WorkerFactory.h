@@ -74,6 +74,12 @@ public:
   //this allows the client to discover workers types that can be constructed
   virtual remus::common::MeshIOTypeSet supportedIOTypes() const;
 
+  //the workers we can create only change in addWorkerSearchDirectory,
+  //which lets the server cache its answers to capability queries.
+  //Subclasses that change the answers of supportedIOTypes,
+  //workerRequirements or haveSupport need to override this
+  virtual bool tracksCapabilityChanges() const { return true; }
+
   //return all the JobRequirementsSet for all workers that match a give
   //MeshIOType
   virtual remus::proto::JobRequirementsSet workerRequirements(
@@ -88,12 +94,56 @@ public:
   virtual bool createWorker(const remus::proto::JobRequirements& type,
                             WorkerFactoryBase::FactoryDeletionBehavior lifespan);
 
+  //the reservation is passed to the worker process through the
+  //REMUS_WORKER_RESERVATION environment variable, which remus::worker::Worker
+  //reads when it is constructed
+  virtual bool supportsJobReservations() const { return true; }
+
+  virtual bool createWorkerWithReservation(const remus::proto::JobRequirements& type,
+                            WorkerFactoryBase::FactoryDeletionBehavior lifespan,
+                            const std::string& reservation);
+
   //checks all current processes and removes any that have
   //shutdown
   virtual void updateWorkerCount();
 
   virtual unsigned int currentWorkerCount() const;
 
+  //keep the given number of idle workers connected to the server for every
+  //type of worker the factory can launch, so that jobs don't wait for a
+  //worker to start. Warm workers count towards maxWorkerCount, and are
+  //replaced as they take jobs. Defaults to zero
+  void setWarmWorkerCount(unsigned int count);
+
+  //same as above, for the worker with the given requirements
+  void setWarmWorkerCount(const remus::proto::JobRequirements& reqs,
+                          unsigned int count);
+
+  unsigned int warmWorkerCount(const remus::proto::JobRequirements& reqs) const;
+
+  //shut down workers that have been idle for longer than the timeout, other
+  //than the warm workers. A negative timeout, which is the default, keeps
+  //idle workers around until the factory is deleted
+  void setIdleWorkerTimeout(boost::int64_t millisec);
+  boost::int64_t idleWorkerTimeout() const;
+
+  //stop launching warm workers while the machine has less than the given
+  //number of bytes of memory available. Defaults to zero, which launches
+  //warm workers no matter how little memory is left
+  void setWarmWorkerMemoryReserve(boost::uint64_t bytes);
+  boost::uint64_t warmWorkerMemoryReserve() const;
+
+  //marks the worker with the given reservation as connected
+  virtual void reservationClaimed(const std::string& reservation);
+
+  //the reservations of the workers that updateWorkerCount found dead
+  //before they claimed their reservation
+  virtual std::set<std::string> abandonedReservations();
+
+  //launches warm workers to replace the ones that have taken a job, and
+  //returns the workers that have been idle for too long
+  virtual std::set<std::string> idleWorkers(const std::set<std::string>& reservations);
+
   //return the worker file extension we have
   std::string workerExtension() const { return this->WorkerExtension;  }
 
@@ -21,6 +21,7 @@ namespace server{
 //----------------------------------------------------------------------------
 WorkerFactoryBase::WorkerFactoryBase():
   MaxWorkers(1),
+  CapabilitiesVersion(0),
   WorkerEndpoint()
 {
 
@@ -13,11 +13,14 @@
 #ifndef remus_server_WorkeryFactoryBase_h
 #define remus_server_WorkeryFactoryBase_h
 
+#include <set>
+#include <string>
 #include <vector>
 
 #include <remus/common/CompilerInformation.h>
 
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
@@ -82,15 +85,70 @@ public:
   virtual bool createWorker(const remus::proto::JobRequirements& type,
                             WorkerFactoryBase::FactoryDeletionBehavior lifespan) = 0;
 
+  //returns true if the workers that the factory creates are told about
+  //the reservation passed to createWorkerWithReservation. The server only
+  //reserves jobs for new workers when this is true
+  virtual bool supportsJobReservations() const { return false; }
+
+  //create a worker that is told to claim the job reserved with the given
+  //token as its first job. By default the token is dropped, and this
+  //is the same as createWorker
+  virtual bool createWorkerWithReservation(const remus::proto::JobRequirements& type,
+                            WorkerFactoryBase::FactoryDeletionBehavior lifespan,
+                            const std::string& reservation)
+    { (void)reservation; return this->createWorker(type, lifespan); }
+
+  //called by the server when a worker created with createWorkerWithReservation
+  //connects and claims its reservation, whether or not a job is still
+  //reserved for it
+  virtual void reservationClaimed(const std::string& reservation)
+    { (void)reservation; }
+
+  //called by the server every time it checks on its workers. Returns the
+  //reservations of the workers created with createWorkerWithReservation
+  //that failed to launch, or exited before claiming their reservation,
+  //since the last call. The server puts the jobs reserved for them back
+  //in the queue right away, instead of waiting for the reservation to
+  //time out. By default no reservations are returned
+  virtual std::set<std::string> abandonedReservations()
+    { return std::set<std::string>(); }
+
+  //called by the server every time it checks on its workers, with the
+  //reservations of the workers created by this factory that are connected
+  //and waiting for a job. Returns the reservations of the idle workers that
+  //the server should shut down. Factories that keep warm workers use this
+  //to launch workers ahead of the jobs. By default nothing is done
+  virtual std::set<std::string> idleWorkers(const std::set<std::string>& reservations)
+    { (void)reservations; return std::set<std::string>(); }
+
   virtual void updateWorkerCount() = 0;
 
   //Set the maximum number of total workers that can be returning at once
-  virtual void setMaxWorkerCount(unsigned int count){MaxWorkers = count;}
+  virtual void setMaxWorkerCount(unsigned int count)
+    {MaxWorkers = count;}
   virtual unsigned int maxWorkerCount() const {return MaxWorkers;}
   virtual unsigned int currentWorkerCount() const =0;
 
+  //returns true if the factory calls capabilitiesChanged every time the
+  //answers of supportedIOTypes, workerRequirements or haveSupport could
+  //have changed. Only then does the server cache its answers to capability
+  //queries, until capabilitiesVersion or maxWorkerCount change. By default
+  //this is false, and the factory is asked for every query
+  virtual bool tracksCapabilityChanges() const { return false; }
+
+  //returns a number that changes every time capabilitiesChanged is called
+  boost::uint64_t capabilitiesVersion() const
+    { return this->CapabilitiesVersion; }
+
+protected:
+  //factories that track capability changes need to call this whenever the
+  //workers they can create change, for example when a new search directory
+  //is added
+  void capabilitiesChanged() { ++this->CapabilitiesVersion; }
+
 private:
   unsigned int MaxWorkers;
+  boost::uint64_t CapabilitiesVersion;
   std::string WorkerEndpoint;
 };
 
@@ -14,6 +14,8 @@
 
 #include <remus/server/detail/uuidHelper.h>
 
+#include <algorithm>
+
 namespace remus{
 namespace server{
 namespace detail{
@@ -25,7 +27,12 @@ ActiveJobs::JobState::JobState(const zmq::SocketIdentity& workerIdentity,
   WorkerAddress(workerIdentity),
   jstatus(id,stat),
   jresult(id),
-  haveResult(false)
+  haveResult(false),
+  Submission(),
+  MeshTypes(),
+  WorkerName(),
+  Tag(),
+  StartTime(boost::posix_time::microsec_clock::local_time())
 {
 
 }
@@ -44,13 +51,30 @@ bool ActiveJobs::JobState::canUpdateStatusTo(remus::proto::JobStatus s) const
 
 //-----------------------------------------------------------------------------
 bool ActiveJobs::add(const zmq::SocketIdentity &workerIdentity,
-                     const boost::uuids::uuid& id)
+                     const boost::uuids::uuid& id,
+                     const remus::proto::JobRequirements& reqs)
 {
   if(!this->haveUUID(id))
     {
     JobState ws(workerIdentity,id,remus::QUEUED);
+    ws.MeshTypes = reqs.meshTypes();
+    ws.WorkerName = reqs.workerName();
+    ws.Tag = reqs.tag();
     InfoPair pair(id,ws);
     this->Info.insert(pair);
+    ++this->WorkingJobs[workerIdentity];
+    return true;
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+bool ActiveJobs::add(const zmq::SocketIdentity &workerIdentity,
+                     const remus::proto::WorkerJob& job)
+{
+  if(this->add(workerIdentity, job.id(), job.submission().requirements()))
+    {
+    this->Info.find(job.id())->second.Submission = job.submission();
     return true;
     }
   return false;
@@ -59,14 +83,50 @@ bool ActiveJobs::add(const zmq::SocketIdentity &workerIdentity,
 //-----------------------------------------------------------------------------
 bool ActiveJobs::remove(const boost::uuids::uuid& id)
 {
-  if(this->haveUUID(id))
+  InfoIt item = this->Info.find(id);
+  if(item != this->Info.end())
     {
-    this->Info.erase(id);
+    if(item->second.working())
+      {
+      this->jobStoppedWorking(item->second);
+      }
+    this->Info.erase(item);
+    this->markChanged(id);
     return true;
     }
   return false;
 }
 
+//-----------------------------------------------------------------------------
+std::vector<remus::proto::WorkerJob> ActiveJobs::takeUnstartedJobs(
+                                  const zmq::SocketIdentity& workerIdentity)
+{
+  std::vector<remus::proto::WorkerJob> unstarted;
+  if(this->WorkingJobs.find(workerIdentity) == this->WorkingJobs.end())
+    { //the worker has no queued or in progress jobs
+    return unstarted;
+    }
+
+  InfoIt item = this->Info.begin();
+  while(item != this->Info.end())
+    {
+    const JobState& state = item->second;
+    if(state.WorkerAddress == workerIdentity && state.jstatus.queued())
+      {
+      unstarted.push_back(
+              remus::proto::WorkerJob(item->first, state.Submission) );
+      this->jobStoppedWorking(state);
+      this->markChanged(item->first);
+      this->Info.erase(item++);
+      }
+    else
+      {
+      ++item;
+      }
+    }
+  return unstarted;
+}
+
 //-----------------------------------------------------------------------------
 zmq::SocketIdentity ActiveJobs::workerAddress(
                                           const boost::uuids::uuid& id) const
@@ -130,26 +190,43 @@ void ActiveJobs::updateStatus(const remus::proto::JobStatus& s)
     //job. That is why we use canUpdateStatusTo, which checks the status
     //we are moving to
     item->second.jstatus.mergeStatus(s);
+    //the worker has started on the job, so it can't be queued again
+    item->second.Submission = remus::proto::JobSubmission();
+    if(!item->second.working())
+      { //the job failed
+      this->jobStoppedWorking(item->second);
+      }
+    this->markChanged(s.id());
     }
 }
 
 //-----------------------------------------------------------------------------
-void ActiveJobs::updateResult(const remus::proto::JobResult& r)
+bool ActiveJobs::updateResult(const remus::proto::JobResult& r)
 {
+  bool finished = false;
   InfoIt item = this->Info.find(r.id());
   if(item != this->Info.end())
     {
+    if(item->second.working())
+      {
+      this->jobStoppedWorking(item->second);
+      }
+    item->second.Submission = remus::proto::JobSubmission();
+
     //once we get a result we can state our status is now finished,
     //since the uploading of data has finished.
     if( item->second.jstatus.status() != remus::FAILED )
       {
+      finished = item->second.jstatus.status() != remus::FINISHED;
       item->second.jstatus = remus::proto::JobStatus(r.id(),remus::FINISHED);
       }
 
     //update the client result data to equal the server data
     item->second.jresult = r;
     item->second.haveResult = true;
+    this->markChanged(r.id());
     }
+  return finished;
 }
 
 //-----------------------------------------------------------------------------
@@ -168,9 +245,12 @@ ActiveJobs::markExpiredJobs(remus::server::detail::SocketMonitor monitor)
     if (is_status_valid_to_expire && worker_is_unresponsive)
       {
       //marking the job status as expired
+      this->jobStoppedWorking(item->second);
+      item->second.Submission = remus::proto::JobSubmission();
       item->second.jstatus =
           remus::proto::JobStatus( item->second.jstatus.id(),remus::EXPIRED);
       expiredJobs.push_back( item->second.jstatus );
+      this->markChanged(item->first);
       }
     }
   return expiredJobs;
@@ -187,6 +267,119 @@ std::set<zmq::SocketIdentity> ActiveJobs::activeWorkers() const
   return workerAddresses;
 }
 
+//-----------------------------------------------------------------------------
+void ActiveJobs::jobStoppedWorking(const JobState& state)
+{
+  JobsPerWorker::iterator i = this->WorkingJobs.find(state.WorkerAddress);
+  if(i != this->WorkingJobs.end() && --(i->second) == 0)
+    {
+    this->WorkingJobs.erase(i);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ActiveJobs::addStatusWaiter(const StatusWaiter& waiter)
+{
+  this->Waiters.insert( std::make_pair(waiter.JobId, waiter) );
+  this->NextDeadline = std::min(this->NextDeadline, waiter.Deadline);
+}
+
+//-----------------------------------------------------------------------------
+void ActiveJobs::markChanged(const boost::uuids::uuid& id)
+{
+  //only track changes that somebody is waiting on
+  if(this->Waiters.count(id) > 0)
+    {
+    this->ChangedJobs.insert(id);
+    }
+}
+
+//-----------------------------------------------------------------------------
+std::vector< ActiveJobs::StatusWaiter >
+ActiveJobs::takeStatusWaiters(const boost::posix_time::ptime& now)
+{
+  std::vector< StatusWaiter > ready;
+
+  //first grab everybody waiting on a job that has changed
+  typedef std::set< boost::uuids::uuid >::const_iterator ChangedIt;
+  for(ChangedIt i = this->ChangedJobs.begin(); i != this->ChangedJobs.end(); ++i)
+    {
+    std::pair<WaiterIt,WaiterIt> range = this->Waiters.equal_range(*i);
+    for(WaiterIt w = range.first; w != range.second; ++w)
+      {
+      ready.push_back(w->second);
+      }
+    this->Waiters.erase(range.first, range.second);
+    }
+  this->ChangedJobs.clear();
+
+  //only walk all the waiters when we know a deadline has passed
+  if(this->NextDeadline <= now)
+    {
+    this->NextDeadline = boost::posix_time::pos_infin;
+    for(WaiterIt w = this->Waiters.begin(); w != this->Waiters.end();)
+      {
+      if(w->second.Deadline <= now)
+        {
+        ready.push_back(w->second);
+        this->Waiters.erase(w++);
+        }
+      else
+        {
+        this->NextDeadline = std::min(this->NextDeadline, w->second.Deadline);
+        ++w;
+        }
+      }
+    }
+  else if(this->Waiters.empty())
+    {
+    this->NextDeadline = boost::posix_time::pos_infin;
+    }
+
+  return ready;
+}
+
+
+//-----------------------------------------------------------------------------
+bool ActiveJobs::listJobs(const remus::proto::JobListingRequest& request,
+                          const boost::uuids::uuid* after,
+                          const boost::posix_time::ptime& now,
+                          std::size_t maxEntries,
+                          remus::proto::JobListing& listing) const
+{
+  const remus::proto::JobListingRequest::JobLocation location =
+                                  remus::proto::JobListingRequest::ACTIVE_JOBS;
+
+  InfoConstIt i = after ? this->Info.upper_bound(*after) : this->Info.begin();
+  for(; i != this->Info.end(); ++i)
+    {
+    const JobState& state = i->second;
+    const boost::int64_t age = (now - state.StartTime).total_milliseconds();
+    if(!request.accepts(location, state.MeshTypes, state.WorkerName,
+                        state.jstatus.status(), state.WorkerAddress.name(),
+                        age))
+      {
+      continue;
+      }
+    if(listing.size() >= maxEntries)
+      {
+      return true;
+      }
+
+    remus::proto::JobListingEntry entry;
+    entry.Id = i->first;
+    entry.Location = location;
+    entry.MeshTypes = state.MeshTypes;
+    entry.WorkerName = state.WorkerName;
+    entry.Tag = state.Tag;
+    entry.Status = state.jstatus.status();
+    entry.Progress = state.jstatus.progress().value();
+    entry.Worker = state.WorkerAddress.name();
+    entry.AgeInMillisec = age;
+    listing.add(entry);
+    }
+  return false;
+}
 
 }
 }
@@ -13,14 +13,24 @@
 #ifndef remus_server_detail_ActiveJobs_h
 #define remus_server_detail_ActiveJobs_h
 
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/proto/JobListing.h>
+#include <remus/proto/JobRequirements.h>
 #include <remus/proto/JobResult.h>
 #include <remus/proto/JobStatus.h>
+#include <remus/proto/WorkerJob.h>
 #include <remus/proto/zmqSocketIdentity.h>
 
 #include <remus/server/detail/SocketMonitor.h>
 
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 namespace remus{
@@ -30,13 +40,46 @@ namespace detail{
 class ActiveJobs
 {
   public:
-    ActiveJobs():Info(){}
+    //a client that is waiting for the status of a job to change
+    struct StatusWaiter
+    {
+      boost::uuids::uuid JobId;
+      zmq::SocketIdentity Client;
+      std::string RequestId;
+      boost::posix_time::ptime Deadline;
+    };
+
+    typedef std::map< zmq::SocketIdentity, std::size_t > JobsPerWorker;
+
+    ActiveJobs():
+      Info(),
+      WorkingJobs(),
+      Waiters(),
+      ChangedJobs(),
+      NextDeadline(boost::posix_time::pos_infin)
+      {}
+
+    //add a job that has been given to a worker. The requirements are
+    //only used to list the job
+    bool add(const zmq::SocketIdentity& workerIdentity,
+             const boost::uuids::uuid& id,
+             const remus::proto::JobRequirements& reqs =
+                                          remus::proto::JobRequirements());
 
+    //add a job that has been given to a worker, and hold on to its
+    //submission until the worker starts on it, so that the job can be
+    //queued again if the worker goes away without starting it
     bool add(const zmq::SocketIdentity& workerIdentity,
-             const boost::uuids::uuid& id);
+             const remus::proto::WorkerJob& job);
 
     bool remove(const boost::uuids::uuid& id);
 
+    //removes the jobs of a worker that it never started, and returns them
+    //so that they can be queued again. Used when a worker tells us it is
+    //shutting down with jobs it was sent ahead of time still pending
+    std::vector<remus::proto::WorkerJob>
+    takeUnstartedJobs(const zmq::SocketIdentity& workerIdentity);
+
     zmq::SocketIdentity workerAddress(const boost::uuids::uuid& id) const;
 
     bool haveUUID(const boost::uuids::uuid& id) const;
@@ -62,13 +105,51 @@ class ActiveJobs
     // not update status
     void updateStatus(const remus::proto::JobStatus& s);
 
-    void updateResult(const remus::proto::JobResult& r);
+    //stores the result of a job, and returns true when that moved the job
+    //to the finished state. Returns false for unknown jobs, failed jobs,
+    //and jobs that already had a result
+    bool updateResult(const remus::proto::JobResult& r);
 
     std::vector< remus::proto::JobStatus > markExpiredJobs(
                                  remus::server::detail::SocketMonitor monitor);
 
     std::set<zmq::SocketIdentity> activeWorkers() const;
 
+    //returns the number of QUEUED or IN_PROGRESS jobs each worker has.
+    //Workers that have no such jobs aren't listed. This is kept up to
+    //date as jobs change, so it is cheap to call often
+    const JobsPerWorker& workingJobsPerWorker() const
+      { return this->WorkingJobs; }
+
+    //park a client that is waiting for the status of a job to change.
+    //The job doesn't need to be active yet, which allows clients to
+    //wait on jobs that are still queued
+    void addStatusWaiter(const StatusWaiter& waiter);
+
+    //mark that the status of a job has changed outside of ActiveJobs,
+    //for example a queued job being terminated
+    void markChanged(const boost::uuids::uuid& id);
+
+    //remove and return all the waiters whose job has changed since they
+    //were parked, or whose deadline has passed
+    std::vector< StatusWaiter > takeStatusWaiters(
+                                    const boost::posix_time::ptime& now);
+
+    //returns the earliest deadline of all parked waiters, or pos_infin
+    //if no clients are waiting
+    const boost::posix_time::ptime& nextStatusWaiterDeadline() const
+      { return this->NextDeadline; }
+
+    //add the jobs that the request accepts to the listing, in id order
+    //starting after the given id ( NULL to start at the first job ) until
+    //the listing holds maxEntries jobs. Results aren't copied.
+    //Returns true if more accepted jobs are left
+    bool listJobs(const remus::proto::JobListingRequest& request,
+                  const boost::uuids::uuid* after,
+                  const boost::posix_time::ptime& now,
+                  std::size_t maxEntries,
+                  remus::proto::JobListing& listing) const;
+
 private:
     struct JobState
     {
@@ -77,17 +158,40 @@ private:
       remus::proto::JobResult jresult;
       bool haveResult;
 
+      //only held while the job is QUEUED on the worker, so that it can
+      //be queued again. Copies share the content of the submission
+      remus::proto::JobSubmission Submission;
+
+      //what is needed to list the job
+      remus::common::MeshIOType MeshTypes;
+      std::string WorkerName;
+      std::string Tag;
+      boost::posix_time::ptime StartTime;
+
       JobState(const zmq::SocketIdentity& workerIdentity,
                const boost::uuids::uuid& id,
                remus::STATUS_TYPE stat);
 
       bool canUpdateStatusTo(remus::proto::JobStatus s) const;
+
+      //is the worker still working on this job
+      bool working() const
+        { return jstatus.good(); }
     };
 
+    //a job has stopped being worked on, update the count of its worker
+    void jobStoppedWorking(const JobState& state);
+
     typedef std::pair<boost::uuids::uuid, JobState> InfoPair;
     typedef std::map< boost::uuids::uuid, JobState>::const_iterator InfoConstIt;
     typedef std::map< boost::uuids::uuid, JobState>::iterator InfoIt;
     std::map<boost::uuids::uuid, JobState> Info;
+    JobsPerWorker WorkingJobs;
+
+    typedef std::multimap< boost::uuids::uuid, StatusWaiter >::iterator WaiterIt;
+    std::multimap< boost::uuids::uuid, StatusWaiter > Waiters;
+    std::set< boost::uuids::uuid > ChangedJobs;
+    boost::posix_time::ptime NextDeadline;
 };
 
 }
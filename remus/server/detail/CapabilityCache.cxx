@@ -0,0 +1,99 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/CapabilityCache.h>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//------------------------------------------------------------------------------
+CapabilityCache::CapabilityCache(std::size_t maxEntries):
+  MaxEntries(maxEntries),
+  FactoryVersion(0),
+  FactoryMaxWorkers(0),
+  PoolVersion(0),
+  Generation(0),
+  Responses()
+{
+}
+
+//------------------------------------------------------------------------------
+void CapabilityCache::validate(boost::uint64_t factoryVersion,
+                               unsigned int factoryMaxWorkers,
+                               boost::uint64_t poolVersion)
+{
+  if(factoryVersion != this->FactoryVersion ||
+     factoryMaxWorkers != this->FactoryMaxWorkers ||
+     poolVersion != this->PoolVersion)
+    {
+    this->clear();
+    this->FactoryVersion = factoryVersion;
+    this->FactoryMaxWorkers = factoryMaxWorkers;
+    this->PoolVersion = poolVersion;
+    }
+}
+
+//------------------------------------------------------------------------------
+const std::string* CapabilityCache::find(const remus::proto::Message& msg) const
+{
+  std::map<Key, std::string>::const_iterator i =
+                      this->Responses.find(Key(msg));
+  return (i != this->Responses.end()) ? &(i->second) : NULL;
+}
+
+//------------------------------------------------------------------------------
+const std::string& CapabilityCache::store(const remus::proto::Message& msg,
+                                          const std::string& response)
+{
+  //clients can send any request data, so don't let the cache grow
+  //without bounds
+  if(this->Responses.size() >= this->MaxEntries)
+    {
+    this->clear();
+    }
+  std::string& cached = this->Responses[Key(msg)];
+  cached = response;
+  return cached;
+}
+
+//------------------------------------------------------------------------------
+void CapabilityCache::clear()
+{
+  if(!this->Responses.empty())
+    {
+    this->Responses.clear();
+    ++this->Generation;
+    }
+}
+
+//------------------------------------------------------------------------------
+CapabilityCache::Key::Key(const remus::proto::Message& msg):
+  Service(msg.serviceType()),
+  Types(msg.MeshIOType()),
+  Data(msg.data() ? std::string(msg.data(), msg.dataSize()) : std::string())
+{
+}
+
+//------------------------------------------------------------------------------
+bool CapabilityCache::Key::operator<(const Key& other) const
+{
+  if(this->Service != other.Service)
+    { return this->Service < other.Service; }
+  if(!(this->Types == other.Types))
+    { return this->Types < other.Types; }
+  return this->Data < other.Data;
+}
+
+}
+}
+}
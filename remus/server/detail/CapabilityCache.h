@@ -0,0 +1,94 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_CapabilityCache_h
+#define remus_server_detail_CapabilityCache_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/proto/Message.h>
+
+#include <map>
+#include <string>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//Holds the serialized responses to the capability queries
+//( SUPPORTED_IO_TYPES, CAN_MESH_IO_TYPE, CAN_MESH_REQUIREMENTS and
+//MESH_REQUIREMENTS_FOR_IO_TYPE ). Responses are keyed on the service and
+//the raw request data, so a repeated query is answered without asking the
+//worker factory or the worker pool.
+//
+//The cached responses are tagged with the capability versions of the
+//factory and the worker pool they were computed from, and the max worker
+//count of the factory, and are all dropped the first time the cache is
+//validated against a different one of those.
+class CapabilityCache
+{
+public:
+  //the cache is emptied when it holds more than maxEntries responses
+  explicit CapabilityCache(std::size_t maxEntries = 1024);
+
+  //drop all cached responses if they were computed from different
+  //versions of the factory and the worker pool, or a different max
+  //worker count
+  void validate(boost::uint64_t factoryVersion,
+                unsigned int factoryMaxWorkers,
+                boost::uint64_t poolVersion);
+
+  //returns the cached response of a query, or NULL if it isn't cached
+  const std::string* find(const remus::proto::Message& msg) const;
+
+  //cache the response of a query, returns the cached response
+  const std::string& store(const remus::proto::Message& msg,
+                           const std::string& response);
+
+  //drop all cached responses
+  void clear();
+
+  //number of times the cache was emptied, so that callers can tell
+  //if a response they saw is still current
+  boost::uint64_t generation() const { return this->Generation; }
+
+  std::size_t size() const { return this->Responses.size(); }
+
+private:
+  //a query is fully described by its service, mesh types and data
+  struct Key
+  {
+    explicit Key(const remus::proto::Message& msg);
+    bool operator<(const Key& other) const;
+
+    remus::SERVICE_TYPE Service;
+    remus::common::MeshIOType Types;
+    std::string Data;
+  };
+
+  std::size_t MaxEntries;
+  boost::uint64_t FactoryVersion;
+  unsigned int FactoryMaxWorkers;
+  boost::uint64_t PoolVersion;
+  boost::uint64_t Generation;
+  std::map<Key, std::string> Responses;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,163 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ContentCaches.h>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//------------------------------------------------------------------------------
+ContentCaches::ContentCaches():
+  Caches()
+{
+}
+
+//------------------------------------------------------------------------------
+void ContentCaches::configure(const zmq::SocketIdentity& worker,
+                              const remus::proto::ContentCacheIndex& index)
+{
+  if(index.enabled())
+    {
+    this->Caches[worker] = index;
+    }
+  else
+    {
+    this->Caches.erase(worker);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ContentCaches::remove(const zmq::SocketIdentity& worker)
+{
+  this->Caches.erase(worker);
+}
+
+//------------------------------------------------------------------------------
+void ContentCaches::purgeDeadWorkers(
+                          const remus::server::detail::SocketMonitor& monitor)
+{
+  for(CacheMap::iterator i = this->Caches.begin(); i != this->Caches.end();)
+    {
+    if(monitor.isDead(i->first))
+      {
+      this->Caches.erase(i++);
+      }
+    else
+      {
+      ++i;
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+remus::proto::ContentCacheIndex
+ContentCaches::index(const zmq::SocketIdentity& worker) const
+{
+  CacheMap::const_iterator i = this->Caches.find(worker);
+  return (i != this->Caches.end()) ? i->second : remus::proto::ContentCacheIndex();
+}
+
+//------------------------------------------------------------------------------
+bool ContentCaches::referenceCachedContent(const zmq::SocketIdentity& worker,
+                                    std::vector<remus::worker::Job>& jobs,
+                                    remus::proto::ContentCacheIndex& updated) const
+{
+  CacheMap::const_iterator cache = this->Caches.find(worker);
+  if(cache == this->Caches.end())
+    {
+    return false;
+    }
+
+  //this has to walk the content in the same order as the worker does
+  //when it caches the jobs, see remus::worker::detail::ContentCache
+  updated = cache->second;
+  std::vector<std::string> evicted;
+  typedef std::vector<remus::worker::Job>::iterator JobIt;
+  for(JobIt job = jobs.begin(); job != jobs.end(); ++job)
+    {
+    remus::proto::JobSubmission submission = job->submission();
+    bool referenced = false;
+    typedef remus::proto::JobSubmission::iterator iter;
+    for(iter i = submission.begin(); i != submission.end(); ++i)
+      {
+      remus::proto::JobContent& content = i->second;
+      if(!updated.cacheable(content.dataSize()))
+        {
+        continue;
+        }
+      if(updated.touch(content.hash()))
+        {
+        content = content.reference();
+        referenced = true;
+        }
+      else
+        {
+        updated.insert(content.hash(), content.dataSize(), evicted);
+        }
+      }
+    if(referenced)
+      {
+      remus::worker::Job withReferences(job->id(), submission);
+      withReferences.updateValidityReason(job->validityReason());
+      *job = withReferences;
+      }
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ContentCaches::update(const zmq::SocketIdentity& worker,
+                           const remus::proto::ContentCacheIndex& updated)
+{
+  CacheMap::iterator cache = this->Caches.find(worker);
+  if(cache != this->Caches.end())
+    {
+    cache->second = updated;
+    }
+}
+
+//------------------------------------------------------------------------------
+std::set<zmq::SocketIdentity>
+ContentCaches::preferredWorkers(const remus::proto::JobSubmission& submission) const
+{
+  std::set<zmq::SocketIdentity> preferred;
+  std::size_t mostBytes = 0;
+  for(CacheMap::const_iterator cache = this->Caches.begin();
+      cache != this->Caches.end(); ++cache)
+    {
+    std::size_t bytes = 0;
+    typedef remus::proto::JobSubmission::const_iterator iter;
+    for(iter i = submission.begin(); i != submission.end(); ++i)
+      {
+      if(cache->second.cacheable(i->second.dataSize()))
+        {
+        bytes += cache->second.contentSize(i->second.hash());
+        }
+      }
+
+    if(bytes > mostBytes)
+      {
+      preferred.clear();
+      mostBytes = bytes;
+      }
+    if(bytes == mostBytes && bytes > 0)
+      {
+      preferred.insert(cache->first);
+      }
+    }
+  return preferred;
+}
+
+}
+}
+}
@@ -0,0 +1,88 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_ContentCaches_h
+#define remus_server_detail_ContentCaches_h
+
+#include <remus/proto/ContentCacheIndex.h>
+#include <remus/proto/JobSubmission.h>
+#include <remus/proto/zmqSocketIdentity.h>
+#include <remus/worker/Job.h>
+
+#include <remus/server/detail/SocketMonitor.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//Mirrors the content cache of every worker that keeps one. The server
+//updates the index of a worker with every batch of jobs it sends it, in
+//the same order that the worker caches the content, so the index always
+//matches what the worker holds. That lets the server send a reference
+//in place of content the worker has cached, and send a job to the worker
+//that already holds most of its content.
+class ContentCaches
+{
+public:
+  ContentCaches();
+
+  //start mirroring the cache of a worker, which starts out empty. A
+  //disabled index stops mirroring the worker
+  void configure(const zmq::SocketIdentity& worker,
+                 const remus::proto::ContentCacheIndex& index);
+
+  //stop mirroring the cache of a worker
+  void remove(const zmq::SocketIdentity& worker);
+
+  //stop mirroring the caches of workers that the monitor considers dead
+  void purgeDeadWorkers(const remus::server::detail::SocketMonitor& monitor);
+
+  //returns true if no worker keeps a cache
+  bool empty() const { return this->Caches.empty(); }
+
+  //returns the index of a worker, which is disabled if the worker
+  //doesn't keep a cache
+  remus::proto::ContentCacheIndex index(const zmq::SocketIdentity& worker) const;
+
+  //replaces the content of the jobs that the worker has cached with
+  //references, and fills updated with the index the worker will have once
+  //it has been sent the jobs. Returns false and leaves the jobs untouched
+  //if the worker doesn't keep a cache
+  bool referenceCachedContent(const zmq::SocketIdentity& worker,
+                              std::vector<remus::worker::Job>& jobs,
+                              remus::proto::ContentCacheIndex& updated) const;
+
+  //store the index that referenceCachedContent returned, once the jobs
+  //have been sent
+  void update(const zmq::SocketIdentity& worker,
+              const remus::proto::ContentCacheIndex& updated);
+
+  //returns the workers that have cached the most bytes of the content
+  //of a submission, which is empty if no worker has any of it cached
+  std::set<zmq::SocketIdentity>
+  preferredWorkers(const remus::proto::JobSubmission& submission) const;
+
+private:
+  typedef std::map<zmq::SocketIdentity, remus::proto::ContentCacheIndex>
+          CacheMap;
+  CacheMap Caches;
+};
+
+}
+}
+}
+
+#endif
@@ -12,18 +12,34 @@
 
 #include <remus/server/detail/EventPublisher.h>
 
+#include <remus/common/ConversionHelper.h>
 #include <remus/common/ServiceTypes.h>
 
+#include <remus/proto/BinaryEvent.h>
 #include <remus/proto/EventTypes.h>
 #include <remus/proto/Job.h>
 #include <remus/proto/JobRequirements.h>
 #include <remus/proto/JobResult.h>
 #include <remus/proto/JobStatus.h>
+#include <remus/proto/zmqHelper.h>
 #include <remus/proto/zmqSocketIdentity.h>
+#include <remus/server/detail/ServerSummary.h>
 #include <remus/worker/Job.h>
 
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
 #include "cJSON.h"
 
+#include <atomic>
+#include <cstring>
+#include <sstream>
+
 namespace
 {
 //------------------------------------------------------------------------------
@@ -34,15 +50,243 @@ void json_free(void *data, void *hint)
 }
 
 //------------------------------------------------------------------------------
-template <typename T, typename BufferType>
-std::string as_string(const T& t, BufferType& bt )
+enum EventKind
 {
-  bt << t;
-  const std::string result = bt.str();
-  bt.str("");
-  return result;
+  JOB_QUEUED,
+  JOB_STATUS,
+  JOB_TERMINATED_ON_WORKER,
+  JOB_TERMINATED_IN_QUEUE,
+  JOB_EXPIRED,
+  JOB_FINISHED,
+  JOB_SENT_TO_WORKER,
+  WORKER_READY,
+  WORKER_REGISTERED,
+  WORKER_HEARTBEAT,
+  WORKER_RESPONSIVE,
+  WORKER_UNRESPONSIVE,
+  WORKER_TERMINATED,
+  SERVER_ERROR,
+  SERVER_SUMMARY,
+  SERVER_STOP
+};
+
+//------------------------------------------------------------------------------
+//Text copied into a record. Text that fits is copied into the buffer, so
+//the common case doesn't allocate. Longer text is heap allocated, and owned
+//by the record until it is released, so events are never truncated
+template<std::size_t N>
+struct FixedText
+{
+  std::size_t Size;
+  char Data[N];
+  std::string* Overflow;
+
+  void clear()
+  {
+    this->Size = 0;
+    this->Overflow = NULL;
+  }
+
+  //the text needs to be cleared first
+  void assign(const std::string& text)
+  {
+    if(text.size() <= N)
+      {
+      this->Size = text.size();
+      std::memcpy(this->Data, text.data(), this->Size);
+      }
+    else
+      {
+      this->Overflow = new std::string(text);
+      }
+  }
+
+  void release()
+  {
+    delete this->Overflow;
+    this->Overflow = NULL;
+  }
+
+  std::string str() const
+  {
+    return this->Overflow ? *this->Overflow
+                          : std::string(this->Data, this->Size);
+  }
+};
+
+//------------------------------------------------------------------------------
+//The fixed size record that the broker thread hands to the publisher thread.
+//It is a POD so that it can be copied in and out of the ring without
+//allocating. Progress messages and requirements are copied into fixed size
+//fields, and are formatted by the publisher thread. Only the rare error
+//messages, summaries and text too long for its field are heap allocated,
+//and owned by the record until the publisher thread has sent it.
+struct EventRecord
+{
+  int Kind;
+  boost::uuids::uuid JobId;
+  int Status;
+  int ProgressValue;
+  std::size_t WorkerSize;
+  char WorkerData[256];
+
+  //progress message, empty when there is none
+  FixedText<256> ProgressMessage;
+
+  //requirements of a queued job or registering worker, without the
+  //requirements content. Only valid when HasRequirements is true
+  bool HasRequirements;
+  remus::common::ContentSource::Type SourceType;
+  remus::common::ContentFormat::Type FormatType;
+  FixedText<64> InputType;
+  FixedText<64> OutputType;
+  FixedText<128> WorkerName;
+  FixedText<128> Tag;
+
+  //error message, NULL otherwise
+  std::string* Message;
+
+  //snapshot of a server summary, NULL otherwise
+  remus::server::detail::SummarySnapshot* Summary;
+};
+
+//------------------------------------------------------------------------------
+void release(EventRecord& record)
+{
+  record.ProgressMessage.release();
+  record.InputType.release();
+  record.OutputType.release();
+  record.WorkerName.release();
+  record.Tag.release();
+  delete record.Message;
+  delete record.Summary;
+  record.Message = NULL;
+  record.Summary = NULL;
 }
 
+//------------------------------------------------------------------------------
+EventRecord make_record(EventKind kind)
+{
+  EventRecord record;
+  record.Kind = kind;
+  std::memset(record.JobId.data, 0, sizeof(record.JobId.data));
+  record.Status = remus::INVALID_STATUS;
+  record.ProgressValue = 0;
+  record.WorkerSize = 0;
+  record.ProgressMessage.clear();
+  record.HasRequirements = false;
+  record.InputType.clear();
+  record.OutputType.clear();
+  record.WorkerName.clear();
+  record.Tag.clear();
+  record.Message = NULL;
+  record.Summary = NULL;
+  return record;
+}
+
+//------------------------------------------------------------------------------
+EventRecord make_record(EventKind kind, const zmq::SocketIdentity& worker)
+{
+  EventRecord record = make_record(kind);
+  record.WorkerSize = std::min(worker.size(), sizeof(record.WorkerData));
+  std::memcpy(record.WorkerData, worker.data(), record.WorkerSize);
+  return record;
+}
+
+//------------------------------------------------------------------------------
+void set_status(EventRecord& record, const remus::proto::JobStatus& s)
+{
+  record.JobId = s.id();
+  record.Status = s.status();
+  record.ProgressValue = s.progress().value();
+  record.ProgressMessage.assign(s.progress().message());
+}
+
+//------------------------------------------------------------------------------
+void set_requirements(EventRecord& record,
+                      const remus::proto::JobRequirements& reqs)
+{
+  record.HasRequirements = true;
+  record.SourceType = reqs.sourceType();
+  record.FormatType = reqs.formatType();
+  record.InputType.assign(reqs.meshTypes().inputType());
+  record.OutputType.assign(reqs.meshTypes().outputType());
+  record.WorkerName.assign(reqs.workerName());
+  record.Tag.assign(reqs.tag());
+}
+
+//------------------------------------------------------------------------------
+//A bounded single producer, single consumer lock-free ring. The broker
+//thread is the only producer, and the publisher thread the only consumer.
+class EventRing
+{
+public:
+  EventRing():
+    Records(Capacity),
+    Head(0),
+    Tail(0)
+    {}
+
+  bool push(const EventRecord& record)
+  {
+    const std::size_t tail = this->Tail.load(std::memory_order_relaxed);
+    if(tail - this->Head.load(std::memory_order_acquire) == Capacity)
+      {
+      return false;
+      }
+    this->Records[tail & (Capacity-1)] = record;
+    this->Tail.store(tail+1);
+    return true;
+  }
+
+  bool pop(EventRecord& record)
+  {
+    const std::size_t head = this->Head.load(std::memory_order_relaxed);
+    if(head == this->Tail.load())
+      {
+      return false;
+      }
+    record = this->Records[head & (Capacity-1)];
+    this->Head.store(head+1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const
+  {
+    return this->Head.load() == this->Tail.load();
+  }
+
+private:
+  //needs to be a power of two
+  static const std::size_t Capacity = 4096;
+
+  std::vector<EventRecord> Records;
+  std::atomic<std::size_t> Head;
+  std::atomic<std::size_t> Tail;
+};
+
+//------------------------------------------------------------------------------
+//A single publication of an event, an event can be published under
+//multiple keys, with different fields
+struct Publication
+{
+  Publication(const std::string& category, const std::string& type,
+              const std::string& id, bool isJob, int eventType):
+    Key(category + ":" + type + ":" + id),
+    IsJob(isJob),
+    EventType(eventType),
+    Fields()
+    {}
+
+  std::string Key;
+  bool IsJob;
+  int EventType;
+  std::vector< std::pair<std::string, std::string> > Fields;
+
+  void add(const std::string& name, const std::string& value)
+    { this->Fields.push_back( std::make_pair(name,value) ); }
+};
+
 }
 
 
@@ -50,204 +294,720 @@ namespace remus{
 namespace server{
 namespace detail{
 
-//----------------------------------------------------------------------------
-EventPublisher::EventPublisher():
-  socket(NULL),
-  buffer()
-  {
+//-----------------------------------------------------------------------------
+class EventPublisher::PublisherThread
+{
+public:
+//-----------------------------------------------------------------------------
+PublisherThread(zmq::socket_t* s):
+  Socket(s),
+  TracksSubscriptions(false),
+  Subscriptions(),
+  Ring(),
+  HaveSubscribers(true),
+  Sleeping(false),
+  Dropped(0),
+  WakeMutex(),
+  WakeCondition(),
+  Thread()
+{
+  //only XPUB sockets tell us about subscriptions, for everything else
+  //we have to presume that somebody is listening
+  int socketType = 0;
+  std::size_t typeSize = sizeof(socketType);
+  this->Socket->getsockopt(ZMQ_TYPE, &socketType, &typeSize);
+  this->TracksSubscriptions = (socketType == ZMQ_XPUB);
+  this->HaveSubscribers = !this->TracksSubscriptions;
+
+  this->Thread.reset( new boost::thread(&PublisherThread::run, this) );
+}
+
+//-----------------------------------------------------------------------------
+~PublisherThread()
+{
+  this->finish();
+}
 
+//-----------------------------------------------------------------------------
+//called by the broker thread
+bool wanted() const
+{
+  return this->HaveSubscribers.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//called by the broker thread
+void push(EventRecord& record)
+{
+  if(!this->Ring.push(record))
+    {
+    //we never block the broker, if the publisher thread is that
+    //far behind we drop the event
+    release(record);
+    ++this->Dropped;
+    return;
+    }
+
+  if(this->Sleeping.load())
+    {
+    boost::lock_guard<boost::mutex> lock(this->WakeMutex);
+    this->WakeCondition.notify_one();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//called by the broker thread, sends the stop event and waits
+//for the publisher thread to finish
+void finish()
+{
+  if(!this->Thread)
+    {
+    return;
+    }
+
+  EventRecord record = make_record(SERVER_STOP);
+  while(!this->Ring.push(record))
+    {
+    boost::this_thread::yield();
+    }
+  {
+  boost::lock_guard<boost::mutex> lock(this->WakeMutex);
+  this->WakeCondition.notify_one();
   }
 
-//----------------------------------------------------------------------------
-bool EventPublisher::socketToUse( zmq::socket_t* s )
+  this->Thread->join();
+  this->Thread.reset();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t dropped() const
 {
-  this->socket = s;
-  return true;
+  return this->Dropped.load();
 }
 
-//----------------------------------------------------------------------------
-void EventPublisher::jobQueued(const remus::proto::Job& j,
-                                                        const remus::proto::JobRequirements& reqs)
-{ //queue job
-  const std::string suid = as_string(j.id(), buffer);
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::QUEUED ];
-  const std::string work_t = ""; //done for easier client parsing
+private:
+//-----------------------------------------------------------------------------
+void run()
+{
+  while(true)
+    {
+    this->updateSubscriptions();
 
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str())); //kept for easier client parsing
+    EventRecord record;
+    bool processedEvents = false;
+    while(this->Ring.pop(record))
+      {
+      processedEvents = true;
+      const bool stopping = (record.Kind == SERVER_STOP);
+      this->publish(record);
+      release(record);
+      if(stopping)
+        {
+        return;
+        }
+      }
 
-  const std::string source_type = as_string(reqs.sourceType(), buffer);
-  const std::string format_type = as_string(reqs.formatType(), buffer);
-  const std::string mesh_type = as_string(reqs.meshTypes(), buffer);
-  const std::string worker_name = as_string(reqs.workerName(), buffer);
-  const std::string tag = as_string(reqs.tag(), buffer);
+    if(!processedEvents)
+      {
+      //sleep until the broker pushes an event, we also wake up every so
+      //often so that we see subscription changes
+      boost::unique_lock<boost::mutex> lock(this->WakeMutex);
+      this->Sleeping.store(true);
+      if(this->Ring.empty())
+        {
+        this->WakeCondition.timed_wait(lock,
+                                       boost::posix_time::milliseconds(50));
+        }
+      this->Sleeping.store(false);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//a XPUB socket hands us a message for every new subscription, and for
+//every subscription that nobody holds anymore
+void updateSubscriptions()
+{
+  if(!this->TracksSubscriptions)
+    {
+    return;
+    }
+
+  zmq::message_t msg;
+  while(this->Socket->recv(&msg, ZMQ_DONTWAIT))
+    {
+    if(msg.size() > 0)
+      {
+      const char* data = static_cast<const char*>(msg.data());
+      const std::string prefix(data+1, msg.size()-1);
+      if(data[0] == 1)
+        {
+        this->Subscriptions.insert(prefix);
+        }
+      else
+        {
+        this->Subscriptions.erase(prefix);
+        }
+      }
+    msg.rebuild();
+    }
+  this->HaveSubscribers.store(!this->Subscriptions.empty(),
+                              std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+bool matches(const std::string& key) const
+{
+  if(!this->TracksSubscriptions)
+    {
+    return true;
+    }
+
+  typedef std::set<std::string>::const_iterator it;
+  for(it i = this->Subscriptions.begin(); i != this->Subscriptions.end(); ++i)
+    {
+    if(key.compare(0, i->size(), *i) == 0)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+//binary events are only sent to subscriptions that ask for them by
+//starting with the binary prefix, so subscribers of every key, or of a
+//category, keep getting only the JSON events they always have. Without
+//subscription tracking we can't tell, and binary events aren't sent
+bool matchesBinary(const std::string& key) const
+{
+  const std::string& binary = remus::proto::binary_event_prefix;
+  typedef std::set<std::string>::const_iterator it;
+  for(it i = this->Subscriptions.begin(); i != this->Subscriptions.end(); ++i)
+    {
+    if(i->compare(0, binary.size(), binary) == 0 &&
+       key.compare(0, i->size(), *i) == 0)
+      {
+      return true;
+      }
+    }
+  return false;
+}
 
-  cJSON *jsonReqs;
-  cJSON_AddItemToObject(root, "requirements", jsonReqs=cJSON_CreateObject());
-  cJSON_AddItemToObject(jsonReqs, "source_type",   cJSON_CreateString(source_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "format_type",   cJSON_CreateString(format_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "mesh_type",   cJSON_CreateString(mesh_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "worker_name",   cJSON_CreateString(worker_name.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "tag",   cJSON_CreateString(tag.c_str()));
+//-----------------------------------------------------------------------------
+void send(const std::string& key, const std::string& value)
+{
+  zmq::message_t keyMsg(key.size());
+  std::memcpy(keyMsg.data(), key.data(), key.size());
+  this->Socket->send(keyMsg, ZMQ_SNDMORE);
+
+  zmq::message_t valueMsg(value.size());
+  std::memcpy(valueMsg.data(), value.data(), value.size());
+  this->Socket->send(valueMsg);
+}
+
+//-----------------------------------------------------------------------------
+void publish(const EventRecord& record)
+{
+  //errors and stop don't have a structured payload
+  if(record.Kind == SERVER_ERROR || record.Kind == SERVER_STOP)
+    {
+    //error key is "error:server", this is to allow in the future for
+    //us to send specific component level failure messages
+    const std::string msg = (record.Kind == SERVER_STOP) ? std::string("END")
+                                                         : *record.Message;
+    this->send("error:server", msg);
+    if(record.Kind == SERVER_STOP)
+      {
+      this->send("stop", "END");
+      }
+    return;
+    }
+
+  if(record.Kind == SERVER_SUMMARY)
+    {
+    if(this->matches("summary:server"))
+      {
+      this->sendSummary("summary:server", *record.Summary);
+      }
+    return;
+    }
+
+  std::vector<Publication> pubs;
+  this->describe(record, pubs);
+
+  typedef std::vector<Publication>::const_iterator it;
+  for(it i = pubs.begin(); i != pubs.end(); ++i)
+    {
+    //we use job/service/id over job/id/service since the latter is
+    //impossible to monitor for only submit/status/queue by using zmq
+    //subscription features. The form we use allows subscription to a single
+    //job ( with a bit of setup ), and allows somebody to watch for all messages
+    //of a given status type
+    if(this->matches(i->Key))
+      {
+      this->sendJSON(*i, record);
+      }
+
+    const std::string binaryKey = remus::proto::binary_event_prefix + i->Key;
+    if(this->matchesBinary(binaryKey))
+      {
+      this->sendBinary(binaryKey, *i, record);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void sendJSON(const Publication& pub, const EventRecord& record)
+{
+  cJSON *root = cJSON_CreateObject();
+  typedef std::vector< std::pair<std::string, std::string> >::const_iterator it;
+  for(it i = pub.Fields.begin(); i != pub.Fields.end(); ++i)
+    {
+    cJSON_AddItemToObject(root, i->first.c_str(),
+                          cJSON_CreateString(i->second.c_str()));
+    }
+
+  if(record.HasRequirements)
+    {
+    const std::string source_type = as_string(record.SourceType);
+    const std::string format_type = as_string(record.FormatType);
+    const std::string mesh_type = as_string(meshTypes(record));
+    const std::string worker_name = record.WorkerName.str();
+    const std::string tag = record.Tag.str();
+
+    cJSON *jsonReqs;
+    cJSON_AddItemToObject(root, "requirements", jsonReqs=cJSON_CreateObject());
+    cJSON_AddItemToObject(jsonReqs, "source_type",   cJSON_CreateString(source_type.c_str()));
+    cJSON_AddItemToObject(jsonReqs, "format_type",   cJSON_CreateString(format_type.c_str()));
+    cJSON_AddItemToObject(jsonReqs, "mesh_type",   cJSON_CreateString(mesh_type.c_str()));
+    cJSON_AddItemToObject(jsonReqs, "worker_name",   cJSON_CreateString(worker_name.c_str()));
+    cJSON_AddItemToObject(jsonReqs, "tag",   cJSON_CreateString(tag.c_str()));
+    }
+
+  zmq::message_t keyMsg(pub.Key.size());
+  std::memcpy(keyMsg.data(), pub.Key.data(), pub.Key.size());
+  this->Socket->send(keyMsg, ZMQ_SNDMORE);
+
+  //send the actual data of the message to publish
+  char *json_str = cJSON_PrintUnformatted(root);
+  std::size_t len = std::strlen(json_str);
+
+  //zero copy zmq message
+  void *hint = NULL;
+  zmq::message_t msg(json_str, len, json_free, hint);
+  this->Socket->send(msg);
+
+  cJSON_Delete(root);
+}
+
+//-----------------------------------------------------------------------------
+void sendSummary(const std::string& key,
+                 const remus::server::detail::SummarySnapshot& snap)
+{
+  cJSON *root = cJSON_CreateObject();
+  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString("SUMMARY"));
+  cJSON_AddNumberToObject(root, "interval_ms",
+                          static_cast<double>(snap.IntervalMillisec));
+
+  //queue depth per requirement
+  std::size_t queued = 0, waiting = 0;
+  cJSON *jsonReqs = cJSON_CreateArray();
+  typedef remus::server::detail::JobQueue::CountsPerRequirement::const_iterator rit;
+  for(rit i = snap.Requirements.begin(); i != snap.Requirements.end(); ++i)
+    {
+    const std::string mesh_type = as_string(i->first.meshTypes());
+    const std::string worker_name = as_string(i->first.workerName());
+    const std::string tag = as_string(i->first.tag());
+
+    cJSON *item = cJSON_CreateObject();
+    cJSON_AddItemToObject(item, "mesh_type", cJSON_CreateString(mesh_type.c_str()));
+    cJSON_AddItemToObject(item, "worker_name", cJSON_CreateString(worker_name.c_str()));
+    cJSON_AddItemToObject(item, "tag", cJSON_CreateString(tag.c_str()));
+    cJSON_AddNumberToObject(item, "queued",
+                            static_cast<double>(i->second.Queued));
+    cJSON_AddNumberToObject(item, "waiting_for_worker",
+                            static_cast<double>(i->second.WaitingForWorker));
+    cJSON_AddItemToArray(jsonReqs, item);
+
+    queued += i->second.Queued;
+    waiting += i->second.WaitingForWorker;
+    }
+  cJSON_AddNumberToObject(root, "queued", static_cast<double>(queued));
+  cJSON_AddNumberToObject(root, "waiting_for_worker", static_cast<double>(waiting));
+  cJSON_AddItemToObject(root, "requirements", jsonReqs);
+
+  //active jobs per worker
+  cJSON *jsonWorkers = cJSON_CreateArray();
+  typedef remus::server::detail::ActiveJobs::JobsPerWorker::const_iterator wit;
+  for(wit i = snap.WorkingJobs.begin(); i != snap.WorkingJobs.end(); ++i)
+    {
+    cJSON *item = cJSON_CreateObject();
+    cJSON_AddItemToObject(item, "worker_id", cJSON_CreateString(i->first.name().c_str()));
+    cJSON_AddNumberToObject(item, "active_jobs", static_cast<double>(i->second));
+    cJSON_AddItemToArray(jsonWorkers, item);
+    }
+  cJSON_AddItemToObject(root, "workers", jsonWorkers);
+
+  cJSON_AddNumberToObject(root, "dispatched", static_cast<double>(snap.Dispatched));
+  cJSON_AddNumberToObject(root, "finished", static_cast<double>(snap.Finished));
+  cJSON_AddNumberToObject(root, "failed", static_cast<double>(snap.Failed));
+  cJSON_AddNumberToObject(root, "expired", static_cast<double>(snap.Expired));
+  cJSON_AddNumberToObject(root, "dispatch_rate", snap.dispatchRate());
+  cJSON_AddNumberToObject(root, "finish_rate", snap.finishRate());
+  cJSON_AddNumberToObject(root, "total_dispatched", static_cast<double>(snap.TotalDispatched));
+  cJSON_AddNumberToObject(root, "total_finished", static_cast<double>(snap.TotalFinished));
+  cJSON_AddNumberToObject(root, "total_failed", static_cast<double>(snap.TotalFailed));
+  cJSON_AddNumberToObject(root, "total_expired", static_cast<double>(snap.TotalExpired));
+
+  zmq::message_t keyMsg(key.size());
+  std::memcpy(keyMsg.data(), key.data(), key.size());
+  this->Socket->send(keyMsg, ZMQ_SNDMORE);
 
+  char *json_str = cJSON_PrintUnformatted(root);
+  std::size_t len = std::strlen(json_str);
 
-  this->pubJob(serv_t, suid, root);
+  //zero copy zmq message
+  void *hint = NULL;
+  zmq::message_t msg(json_str, len, json_free, hint);
+  this->Socket->send(msg);
 
   cJSON_Delete(root);
 }
 
+//-----------------------------------------------------------------------------
+void sendBinary(const std::string& key, const Publication& pub,
+                const EventRecord& record)
+{
+  remus::proto::BinaryEvent event;
+  event.EventCategory = pub.IsJob ? remus::proto::BinaryEvent::JOB
+                                  : remus::proto::BinaryEvent::WORKER;
+  event.Type = pub.EventType;
+  event.JobId = record.JobId;
+  event.WorkerId = this->workerName(record);
+  event.Status = static_cast<remus::STATUS_TYPE>(record.Status);
+  event.ProgressValue = record.ProgressValue;
+  event.Responsive = (record.Kind == WORKER_RESPONSIVE);
+  event.ProgressMessage = record.ProgressMessage.str();
+  if(record.HasRequirements)
+    {
+    event.Requirements = this->requirements(record);
+    }
+  this->send(key, remus::proto::to_binary(event));
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+std::string as_string(const T& t)
+{
+  this->Buffer << t;
+  const std::string result = this->Buffer.str();
+  this->Buffer.str("");
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+std::string workerName(const EventRecord& record) const
+{
+  if(record.WorkerSize == 0)
+    {
+    return std::string();
+    }
+  return zmq::SocketIdentity(record.WorkerData, record.WorkerSize).name();
+}
+
+//-----------------------------------------------------------------------------
+std::string progress(const EventRecord& record)
+{
+  //matches the serialized form of remus::proto::JobProgress
+  const std::string message = record.ProgressMessage.str();
+  this->Buffer << record.ProgressValue << '\n';
+  this->Buffer << message.size() << '\n';
+  remus::internal::writeString(this->Buffer, message);
+  const std::string result = this->Buffer.str();
+  this->Buffer.str("");
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+remus::common::MeshIOType meshTypes(const EventRecord& record) const
+{
+  return remus::common::MeshIOType(record.InputType.str(),
+                                   record.OutputType.str());
+}
+
+//-----------------------------------------------------------------------------
+std::string requirements(const EventRecord& record)
+{
+  //matches the serialized form of remus::proto::JobRequirements, without
+  //the requirements content
+  const std::string workerName = record.WorkerName.str();
+  const std::string tag = record.Tag.str();
+  this->Buffer << record.SourceType << std::endl;
+  this->Buffer << record.FormatType << std::endl;
+  this->Buffer << meshTypes(record) << std::endl;
+  this->Buffer << workerName.size() << std::endl;
+  remus::internal::writeString(this->Buffer, workerName);
+  this->Buffer << tag.size() << std::endl;
+  remus::internal::writeString(this->Buffer, tag);
+  this->Buffer << 0 << std::endl;
+  remus::internal::writeString(this->Buffer, std::string());
+  const std::string result = this->Buffer.str();
+  this->Buffer.str("");
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//converts a record into the keys and fields it is published with
+void describe(const EventRecord& record, std::vector<Publication>& pubs)
+{
+  using namespace remus::proto;
+  const std::string suid = boost::uuids::to_string(record.JobId);
+  const std::string work_t = this->workerName(record);
+
+  switch(record.Kind)
+    {
+    case JOB_QUEUED:
+      {
+      Publication pub("job", jobevents::to_string(jobevents::QUEUED), suid,
+                      true, jobevents::QUEUED);
+      pub.add("job_id", suid);
+      pub.add("msg_type", jobevents::to_string(jobevents::QUEUED));
+      pub.add("worker_id", ""); //kept for easier client parsing
+      pubs.push_back(pub);
+      }
+      break;
+    case JOB_STATUS:
+      {
+      const std::string serv_t = jobevents::to_string(jobevents::JOB_STATUS);
+      Publication pub("job", serv_t, suid, true, jobevents::JOB_STATUS);
+      pub.add("job_id", suid);
+      pub.add("msg_type", serv_t);
+      pub.add("worker_id", work_t);
+      pub.add("status_type", remus::common::stat_types[record.Status]);
+      pub.add("progress", this->progress(record));
+      pubs.push_back(pub);
+
+      Publication workerPub = pub;
+      workerPub.Key = "worker:" + serv_t + ":" + work_t;
+      workerPub.IsJob = false;
+      workerPub.EventType = workevents::JOB_STATUS;
+      pubs.push_back(workerPub);
+      }
+      break;
+    case JOB_TERMINATED_ON_WORKER:
+    case JOB_TERMINATED_IN_QUEUE:
+      {
+      const std::string serv_t = jobevents::to_string(jobevents::TERMINATED);
+      Publication pub("job", serv_t, suid, true, jobevents::TERMINATED);
+      pub.add("job_id", suid);
+      pub.add("msg_type", serv_t);
+      pub.add("worker_id", work_t); //empty for queued jobs
+      pub.add("last_status_type", remus::common::stat_types[record.Status]);
+      pub.add("last_progress", this->progress(record));
+      pubs.push_back(pub);
+
+      if(record.Kind == JOB_TERMINATED_ON_WORKER)
+        {
+        Publication workerPub = pub;
+        workerPub.Key = "worker:" + serv_t + ":" + work_t;
+        workerPub.IsJob = false;
+        workerPub.EventType = workevents::TERMINATED;
+        pubs.push_back(workerPub);
+        }
+      }
+      break;
+    case JOB_EXPIRED:
+      {
+      //active job has been marked as expired as the worker it was assigned to
+      //has stopped heartbeating
+      const std::string serv_t = jobevents::to_string(jobevents::EXPIRED);
+      Publication pub("job", serv_t, suid, true, jobevents::EXPIRED);
+      pub.add("job_id", suid);
+      pub.add("msg_type", serv_t);
+      pub.add("worker_id", ""); //kept for easier client parsing
+      pubs.push_back(pub);
+
+      //we also need to publish it on jobs/STATUS
+      Publication statusPub = pub;
+      statusPub.Key = "job:" + jobevents::to_string(jobevents::JOB_STATUS) +
+                      ":" + suid;
+      statusPub.EventType = jobevents::JOB_STATUS;
+      statusPub.add("status_type", remus::common::stat_types[record.Status]);
+      statusPub.add("progress", this->progress(record));
+      pubs.push_back(statusPub);
+      }
+      break;
+    case JOB_FINISHED:
+    case JOB_SENT_TO_WORKER:
+      {
+      const jobevents::EVENT_TYPE type = (record.Kind == JOB_FINISHED) ?
+                          jobevents::COMPLETED : jobevents::ASSIGNED_TO_WORKER;
+      const std::string serv_t = jobevents::to_string(type);
+      Publication pub("job", serv_t, suid, true, type);
+      pub.add("job_id", suid);
+      pub.add("msg_type", serv_t);
+      pub.add("worker_id", work_t);
+      pubs.push_back(pub);
+
+      //the job and worker event types share the same numbering
+      Publication workerPub = pub;
+      workerPub.Key = "worker:" + serv_t + ":" + work_t;
+      workerPub.IsJob = false;
+      pubs.push_back(workerPub);
+      }
+      break;
+    case WORKER_READY:
+    case WORKER_REGISTERED:
+    case WORKER_HEARTBEAT:
+      {
+      workevents::EVENT_TYPE type = workevents::HEARTBEAT;
+      if(record.Kind == WORKER_READY) { type = workevents::REGISTER; }
+      if(record.Kind == WORKER_REGISTERED) { type = workevents::ASKING_FOR_JOB; }
+
+      const std::string serv_t = workevents::to_string(type);
+      Publication pub("worker", serv_t, work_t, false, type);
+      pub.add("worker_id", work_t);
+      pub.add("msg_type", serv_t);
+      pubs.push_back(pub);
+      }
+      break;
+    case WORKER_TERMINATED:
+      {
+      const std::string serv_t = remus::common::serv_types[(int)remus::TERMINATE_WORKER];
+      Publication pub("worker", serv_t, work_t, false,
+                      workevents::TERMINATED_WORKER);
+      pub.add("worker_id", work_t);
+      pub.add("msg_type", serv_t);
+      pubs.push_back(pub);
+      }
+      //fall through, as a terminated worker is also unresponsive
+    case WORKER_RESPONSIVE:
+    case WORKER_UNRESPONSIVE:
+      {
+      const std::string serv_t = workevents::to_string(workevents::WORKER_STATE);
+      Publication pub("worker", serv_t, work_t, false,
+                      workevents::WORKER_STATE);
+      pub.add("worker_id", work_t);
+      pub.add("msg_type", serv_t);
+      pub.add("state", (record.Kind == WORKER_RESPONSIVE) ? "Responsive"
+                                                          : "Unresponsive");
+      pubs.push_back(pub);
+      }
+      break;
+    default:
+      break;
+    }
+}
+
+  zmq::socket_t* Socket;
+
+  //only touched by the publisher thread
+  bool TracksSubscriptions;
+  std::set<std::string> Subscriptions;
+  std::stringstream Buffer;
+
+  EventRing Ring;
+  std::atomic<bool> HaveSubscribers;
+  std::atomic<bool> Sleeping;
+  std::atomic<std::size_t> Dropped;
+
+  boost::mutex WakeMutex;
+  boost::condition_variable WakeCondition;
+  boost::scoped_ptr<boost::thread> Thread;
+};
+
 //----------------------------------------------------------------------------
-void EventPublisher::jobStatus(const remus::proto::JobStatus& s, const zmq::SocketIdentity &si)
-{ //status
-  buffer << s.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = si.name();
+EventPublisher::EventPublisher():
+  Thread()
+  {
+
+  }
 
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::JOB_STATUS ];
-  const std::string status_t = remus::common::stat_types[(int)s.status()];
+//----------------------------------------------------------------------------
+EventPublisher::~EventPublisher()
+{
+}
 
-  buffer << s.progress();
-  const std::string progress_t = buffer.str(); buffer.str("");
+//----------------------------------------------------------------------------
+bool EventPublisher::socketToUse( zmq::socket_t* s )
+{
+  this->Thread.reset( new PublisherThread(s) );
+  return true;
+}
 
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "status_type", cJSON_CreateString(status_t.c_str()));
-  cJSON_AddItemToObject(root, "progress", cJSON_CreateString(progress_t.c_str()));
-  this->pubJob(serv_t, suid, root);
+//----------------------------------------------------------------------------
+void EventPublisher::jobQueued(const remus::proto::Job& j,
+                               const remus::proto::JobRequirements& reqs)
+{ //queue job
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
+  EventRecord record = make_record(JOB_QUEUED);
+  record.JobId = j.id();
+  set_requirements(record, reqs);
+  this->Thread->push(record);
+}
 
-  this->pubWorker(serv_t, work_t, root);
+//----------------------------------------------------------------------------
+void EventPublisher::jobStatus(const remus::proto::JobStatus& s, const zmq::SocketIdentity &si)
+{ //status
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_STATUS, si);
+  set_status(record, s);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::jobTerminated(const remus::proto::JobStatus& s,
                                    const zmq::SocketIdentity &si)
 { //job assigned to a worker has been terminated
-  buffer << s.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = si.name();
-
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::TERMINATED ];
-  const std::string status_t = remus::common::stat_types[(int)s.status()];
-
-  buffer << s.progress();
-  const std::string progress_t = buffer.str(); buffer.str("");
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "last_status_type", cJSON_CreateString(status_t.c_str()));
-  cJSON_AddItemToObject(root, "last_progress", cJSON_CreateString(progress_t.c_str()));
-  this->pubJob(serv_t, suid, root);
-  this->pubWorker(serv_t, work_t, root);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_TERMINATED_ON_WORKER, si);
+  set_status(record, s);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::jobTerminated(const remus::proto::JobStatus& s)
 { //job queued has been terminated
-  buffer << s.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = ""; //kept for easier parsing of the json message
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::TERMINATED ];
-  const std::string status_t = remus::common::stat_types[(int)s.status()];
-
-  buffer << s.progress();
-  const std::string progress_t = buffer.str(); buffer.str("");
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str())); //kept for easier client parsing
-  cJSON_AddItemToObject(root, "last_status_type", cJSON_CreateString(status_t.c_str()));
-  cJSON_AddItemToObject(root, "last_progress", cJSON_CreateString(progress_t.c_str()));
-  this->pubJob(serv_t, suid, root);
-
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_TERMINATED_IN_QUEUE);
+  set_status(record, s);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::jobExpired(const remus::proto::JobStatus& s)
 { //active job has been marked as expired as the worker it was assigned to
   //has stopped heartbeating
-  buffer << s.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = ""; //kept for easier parsing of the json message
-
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::EXPIRED ];
-  const std::string status_t = remus::common::stat_types[(int)s.status()];
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str())); //kept for easier client parsing
-  this->pubJob(serv_t, suid, root);
-
-  //now that we have published it on jobs/EXPIRED we need to also publish it
-  //on jobs/STATUS
-  const std::string status_service = remus::proto::jobevents::event_types[ remus::proto::jobevents::JOB_STATUS ];
-
-  buffer << s.progress();
-  const std::string progress_t = buffer.str(); buffer.str("");
-
-  cJSON_AddItemToObject(root, "status_type", cJSON_CreateString(status_t.c_str()));
-  cJSON_AddItemToObject(root, "progress", cJSON_CreateString(progress_t.c_str()));
-  this->pubJob(status_service, suid, root);
-
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_EXPIRED);
+  set_status(record, s);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::jobFinished(const remus::proto::JobResult& r, const zmq::SocketIdentity &si)
 { //have result to fetch
-  buffer << r.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = si.name();
-
-  const std::string serv_t = remus::proto::jobevents::event_types[ remus::proto::jobevents::COMPLETED ];
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  this->pubJob(serv_t, suid, root);
-  this->pubWorker(serv_t, work_t, root);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_FINISHED, si);
+  record.JobId = r.id();
+  this->Thread->push(record);
 }
 
   //----------------------------------------------------------------------------
 void EventPublisher::jobSentToWorker(const remus::worker::Job& j, const zmq::SocketIdentity &si)
 { //assign job to worker
-  buffer << j.id();
-  const std::string suid = buffer.str(); buffer.str("");
-  const std::string work_t = si.name();
-
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::ASSIGNED_TO_WORKER ];
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "job_id", cJSON_CreateString(suid.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  this->pubJob(serv_t, suid, root);
-  this->pubWorker(serv_t, work_t, root);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(JOB_SENT_TO_WORKER, si);
+  record.JobId = j.id();
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
@@ -262,150 +1022,61 @@ void EventPublisher::jobsExpired( const std::vector<remus::proto::JobStatus>& ex
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerReady(const zmq::SocketIdentity &workerIdentity,
-                                                           const remus::proto::JobRequirements& reqs)
+                                 const remus::proto::JobRequirements& reqs)
 {
-  const std::string work_t = workerIdentity.name();
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::REGISTER ];
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-
-
-  const std::string source_type = as_string(reqs.sourceType(), buffer);
-  const std::string format_type = as_string(reqs.formatType(), buffer);
-  const std::string mesh_type = as_string(reqs.meshTypes(), buffer);
-  const std::string worker_name = as_string(reqs.workerName(), buffer);
-  const std::string tag = as_string(reqs.tag(), buffer);
-
-  cJSON *jsonReqs;
-  cJSON_AddItemToObject(root, "requirements", jsonReqs=cJSON_CreateObject());
-  cJSON_AddItemToObject(jsonReqs, "source_type",   cJSON_CreateString(source_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "format_type",   cJSON_CreateString(format_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "mesh_type",   cJSON_CreateString(mesh_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "worker_name",   cJSON_CreateString(worker_name.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "tag",   cJSON_CreateString(tag.c_str()));
-
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  this->pubWorker(serv_t, work_t, root);
-
-  cJSON_Delete(root);
+  EventRecord record = make_record(WORKER_READY, workerIdentity);
+  set_requirements(record, reqs);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerRegistered(const zmq::SocketIdentity &workerIdentity,
-                                                                  const remus::proto::JobRequirements& reqs)
+                                      const remus::proto::JobRequirements& reqs)
 {
-  const std::string work_t = workerIdentity.name();
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::ASKING_FOR_JOB ];
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-
-
-  const std::string source_type = as_string(reqs.sourceType(), buffer);
-  const std::string format_type = as_string(reqs.formatType(), buffer);
-  const std::string mesh_type = as_string(reqs.meshTypes(), buffer);
-  const std::string worker_name = as_string(reqs.workerName(), buffer);
-  const std::string tag = as_string(reqs.tag(), buffer);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON *jsonReqs;
-  cJSON_AddItemToObject(root, "requirements", jsonReqs=cJSON_CreateObject());
-  cJSON_AddItemToObject(jsonReqs, "source_type",   cJSON_CreateString(source_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "format_type",   cJSON_CreateString(format_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "mesh_type",   cJSON_CreateString(mesh_type.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "worker_name",   cJSON_CreateString(worker_name.c_str()));
-  cJSON_AddItemToObject(jsonReqs, "tag",   cJSON_CreateString(tag.c_str()));
-
-  this->pubWorker(serv_t, work_t, root);
-
-  cJSON_Delete(root);
+  EventRecord record = make_record(WORKER_REGISTERED, workerIdentity);
+  set_requirements(record, reqs);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerHeartbeat(const zmq::SocketIdentity &workerIdentity)
 {
-  const std::string work_t = workerIdentity.name();
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::HEARTBEAT ];
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  this->pubWorker(serv_t, work_t, root);
-
-  cJSON_Delete(root);
+  EventRecord record = make_record(WORKER_HEARTBEAT, workerIdentity);
+  this->Thread->push(record);
 }
 
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerResponsive(const zmq::SocketIdentity &workerIdentity)
 {
-  const std::string work_t = workerIdentity.name();
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::WORKER_STATE ];
-  const std::string state_t =  "Responsive";
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "state", cJSON_CreateString(state_t.c_str()));
-  this->pubWorker(serv_t, work_t, root);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(WORKER_RESPONSIVE, workerIdentity);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerUnresponsive(const zmq::SocketIdentity &workerIdentity)
 {
-  const std::string work_t = workerIdentity.name();
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::WORKER_STATE ];
-  const std::string state_t =  "Unresponsive";
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "state", cJSON_CreateString(state_t.c_str()));
-  this->pubWorker(serv_t, work_t, root);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  cJSON_Delete(root);
+  EventRecord record = make_record(WORKER_UNRESPONSIVE, workerIdentity);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
 void EventPublisher::workerTerminated(const zmq::SocketIdentity &workerIdentity)
 {
-  const std::string work_t = workerIdentity.name();
-
-  {
-  const std::string serv_t = remus::common::serv_types[(int)remus::TERMINATE_WORKER];
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  this->pubWorker(serv_t, work_t, root);
-  cJSON_Delete(root);
-  }
-
-  {
-  const std::string serv_t = remus::proto::workevents::event_types[ remus::proto::workevents::WORKER_STATE ];
-  const std::string state_t =  "Unresponsive";
-
-  cJSON *root;
-  root=cJSON_CreateObject();
-  cJSON_AddItemToObject(root, "worker_id", cJSON_CreateString(work_t.c_str()));
-  cJSON_AddItemToObject(root, "msg_type", cJSON_CreateString(serv_t.c_str()));
-  cJSON_AddItemToObject(root, "state", cJSON_CreateString(state_t.c_str()));
-  this->pubWorker(serv_t, work_t, root);
-
-  cJSON_Delete(root);
-  }
+  EventRecord record = make_record(WORKER_TERMINATED, workerIdentity);
+  this->Thread->push(record);
 }
 
 
@@ -422,87 +1093,41 @@ void EventPublisher::unresponsiveWorkers( const std::set< zmq::SocketIdentity >&
 //----------------------------------------------------------------------------
 void EventPublisher::error(const std::string& msg)
 {
-  //send the key that people subscribe to
-
-  //error key is "error:server", this is to allow in the future for
-  //us to send specific component level failure messages
-  static const std::string error_key = "error:server";
-  zmq::message_t keyMsg(error_key.size());
-  std::memcpy(keyMsg.data(), error_key.data(), error_key.size());
-  socket->send(keyMsg, ZMQ_SNDMORE);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  zmq::message_t valueMsg(msg.size());
-  std::memcpy(valueMsg.data(), msg.data(), msg.size());
-  socket->send(valueMsg);
+  EventRecord record = make_record(SERVER_ERROR);
+  record.Message = new std::string(msg);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
-void EventPublisher::stop()
+void EventPublisher::summary(const remus::server::detail::SummarySnapshot& snapshot)
 {
-  //first send a message on error that the server is ending
-  this->error("END");
-
-  //publish
-  const std::string stop_key = "stop";
-  const std::string stop_value = "END";
-
-  //now send the same message on the stop channel
-  zmq::message_t keyMsg(stop_key.size());
-  std::memcpy(keyMsg.data(), stop_key.data(), stop_key.size());
-  socket->send(keyMsg, ZMQ_SNDMORE);
+  if(!this->Thread || !this->Thread->wanted()) { return; }
 
-  zmq::message_t valueMsg(stop_value.size());
-  std::memcpy(valueMsg.data(), stop_value.data(), stop_value.size());
-  socket->send(valueMsg);
+  EventRecord record = make_record(SERVER_SUMMARY);
+  record.Summary = new remus::server::detail::SummarySnapshot(snapshot);
+  this->Thread->push(record);
 }
 
 //----------------------------------------------------------------------------
-void EventPublisher::pubJob(const std::string& st, const std::string suid, cJSON *root)
-{
-  //we use job/service/id over job/id/service since the latter is
-  //impossible to monitor for only submit/status/queue by using zmq
-  //subscription features. The form we use allows subscription to a single
-  //job ( with a bit of setup ), and allows somebody to watch for all messages
-  //of a given status type
-  std::string key = "job:" + st + ":" + suid;
-  zmq::message_t keyMsg(key.size());
-  std::memcpy(keyMsg.data(), key.data(), key.size());
-  socket->send(keyMsg, ZMQ_SNDMORE);
-
-  //send the actual data of the message to publish
-  char *json_str = cJSON_PrintUnformatted(root);
-  std::size_t len = std::strlen(json_str);
-
-  //zero copy zmq message
-  void *hint = NULL;
-  zmq::message_t msg(json_str, len, json_free, hint);
-  socket->send(msg);
+void EventPublisher::stop()
+{
+  if(this->Thread)
+    {
+    //publishes END on the error and stop keys, and waits
+    //for everything queued before it to be sent
+    this->Thread->finish();
+    this->Thread.reset();
+    }
 }
 
 //----------------------------------------------------------------------------
-void EventPublisher::pubWorker(const std::string& st, const std::string suid, cJSON *root)
-{
-  //we use worker/service/id over worker/id/service since the latter is
-  //impossible to monitor for only submit/status/queue by using zmq
-  //subscription features. The form we use allows subscription to a single
-  //job ( with a bit of setup ), and allows somebody to watch for all messages
-  //of a given status type
-  std::string key = "worker:" + st + ":" + suid;
-  zmq::message_t keyMsg(key.size());
-  std::memcpy(keyMsg.data(), key.data(), key.size());
-  socket->send(keyMsg, ZMQ_SNDMORE);
-
-  //send the actual data of the message to publish
-  char *json_str = cJSON_PrintUnformatted(root);
-  std::size_t len = std::strlen(json_str);
-
-  //zero copy zmq message
-  void *hint = NULL;
-  zmq::message_t msg(json_str, len, json_free, hint);
-  socket->send(msg);
+std::size_t EventPublisher::droppedEvents() const
+{
+  return this->Thread ? this->Thread->dropped() : 0;
 }
 
-
 }
 }
 }
@@ -37,10 +37,16 @@ namespace zmq
   struct SocketIdentity;
 }
 
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/scoped_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
 #include <remus/proto/zmq.hpp>
 #include <remus/proto/EventTypes.h>
 
-#include <sstream>
+#include <string>
 #include <vector>
 #include <set>
 
@@ -49,11 +55,36 @@ namespace remus{
 namespace server{
 namespace detail{
 
+struct SummarySnapshot;
+
+//The EventPublisher publishes what is happening inside the server on the
+//status channel. All the event methods are called from the broker thread, and
+//only copy the event into a small fixed size record that is pushed onto a
+//lock-free ring, without allocating. Only progress messages, worker names and
+//tags longer than the record holds are copied to the heap. A dedicated
+//publisher thread pops the records and does all the formatting and sending.
+//
+//When the status socket is a XPUB socket the publisher thread tracks what
+//subscriptions exist, and events that no subscriber matches are never
+//encoded. When nobody is subscribed at all the broker thread doesn't even
+//push the event onto the ring.
+//
+//Every event is published in JSON form under the key job:<status>:<jobId>
+//or worker:<status>:<workerId>. Subscriptions that start with
+//remus::proto::binary_event_prefix are also sent the compact
+//remus::proto::BinaryEvent form, under the JSON key with that prefix.
+//Subscribers of every key don't get the binary form.
+//
+//Periodic summaries of the whole server are published in JSON form only,
+//under the key summary:server.
 class EventPublisher
 {
 public:
   EventPublisher();
 
+  //stops the publisher thread if it is still running
+  ~EventPublisher();
+
   //Job status sections
   //QUEUED
   //MESH_STATUS
@@ -75,9 +106,10 @@ public:
   //job:<status>:<jobId>
   //worker:<status>:<workerId>
 
-  //tell this EventPublisher  what socket to send all information out on.
-  //the socket_t is merely used, not owned by this class so it's lifespan
-  //must be externally managed.
+  //tell this EventPublisher what socket to send all information out on, and
+  //start the publisher thread. The socket_t is merely used, not owned by this
+  //class so it's lifespan must be externally managed. After this call
+  //the socket must only be used by the publisher thread, until stop is called.
   bool socketToUse( zmq::socket_t* s );
 
   void jobQueued( const remus::proto::Job& j,
@@ -115,14 +147,25 @@ public:
 
   void error(const std::string& msg);
 
+  //publish a summary of the server, see SummarySnapshot
+  void summary(const remus::server::detail::SummarySnapshot& snapshot);
+
+  //publish that the server is stopping, and wait for the publisher
+  //thread to send all pending events and finish. After this call the
+  //socket can be closed.
   void stop();
 
+  //returns the number of events that were thrown away because the
+  //publisher thread fell too far behind the broker
+  std::size_t droppedEvents() const;
+
 private:
-  void pubJob(const std::string& st, const std::string suid, cJSON *root);
-  void pubWorker(const std::string& st, const std::string suid, cJSON *root);
+  //explicitly state the publisher doesn't support copy or move semantics
+  EventPublisher(const EventPublisher&);
+  void operator=(const EventPublisher&);
 
-  zmq::socket_t* socket;
-  std::stringstream buffer;
+  class PublisherThread;
+  boost::scoped_ptr<PublisherThread> Thread;
 };
 
 }
@@ -0,0 +1,117 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/FactoryWorkers.h>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//------------------------------------------------------------------------------
+FactoryWorkers::FactoryWorkers():
+  Reservations()
+{
+}
+
+//------------------------------------------------------------------------------
+void FactoryWorkers::claimed(const zmq::SocketIdentity& worker,
+                             const std::string& reservation)
+{
+  if(!reservation.empty())
+    {
+    this->Reservations[worker] = reservation;
+    }
+}
+
+//------------------------------------------------------------------------------
+void FactoryWorkers::remove(const zmq::SocketIdentity& worker)
+{
+  this->Reservations.erase(worker);
+}
+
+//------------------------------------------------------------------------------
+void FactoryWorkers::purgeDeadWorkers(
+                          const remus::server::detail::SocketMonitor& monitor)
+{
+  for(ReservationMap::iterator i = this->Reservations.begin();
+      i != this->Reservations.end();)
+    {
+    if(monitor.isDead(i->first))
+      {
+      this->Reservations.erase(i++);
+      }
+    else
+      {
+      ++i;
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+std::set<std::string> FactoryWorkers::reservations(
+                      const std::set<zmq::SocketIdentity>& workers) const
+{
+  std::set<std::string> result;
+  typedef std::set<zmq::SocketIdentity>::const_iterator it;
+  for(it w = workers.begin(); w != workers.end(); ++w)
+    {
+    ReservationMap::const_iterator i = this->Reservations.find(*w);
+    if(i != this->Reservations.end())
+      {
+      result.insert(i->second);
+      }
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+std::set<std::string> FactoryWorkers::idleReservations(
+                      const std::set<zmq::SocketIdentity>& workers,
+                      const ActiveJobs::JobsPerWorker& workingJobs) const
+{
+  std::set<std::string> result;
+  typedef std::set<zmq::SocketIdentity>::const_iterator it;
+  for(it w = workers.begin(); w != workers.end(); ++w)
+    {
+    ActiveJobs::JobsPerWorker::const_iterator busy = workingJobs.find(*w);
+    if(busy != workingJobs.end() && busy->second > 0)
+      { //still processing or holding jobs, so not idle
+      continue;
+      }
+    ReservationMap::const_iterator i = this->Reservations.find(*w);
+    if(i != this->Reservations.end())
+      {
+      result.insert(i->second);
+      }
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+std::set<zmq::SocketIdentity> FactoryWorkers::workers(
+                      const std::set<std::string>& reservations) const
+{
+  std::set<zmq::SocketIdentity> result;
+  for(ReservationMap::const_iterator i = this->Reservations.begin();
+      i != this->Reservations.end(); ++i)
+    {
+    if(reservations.count(i->second) > 0)
+      {
+      result.insert(i->first);
+      }
+    }
+  return result;
+}
+
+}
+}
+}
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_FactoryWorkers_h
+#define remus_server_detail_FactoryWorkers_h
+
+#include <remus/proto/zmqSocketIdentity.h>
+
+#include <remus/server/detail/ActiveJobs.h>
+#include <remus/server/detail/SocketMonitor.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//Remembers the reservation that every worker launched by the worker
+//factory claimed when it connected. The factory only knows its workers
+//by their reservation, so this is how the server tells the factory which
+//of its workers are idle, and finds the worker the factory asks it to
+//shut down.
+class FactoryWorkers
+{
+public:
+  FactoryWorkers();
+
+  //remember the reservation a worker claimed. Claims without a
+  //reservation are ignored
+  void claimed(const zmq::SocketIdentity& worker,
+               const std::string& reservation);
+
+  //forget the reservation of a worker
+  void remove(const zmq::SocketIdentity& worker);
+
+  //forget the reservations of workers that the monitor considers dead
+  void purgeDeadWorkers(const remus::server::detail::SocketMonitor& monitor);
+
+  //returns true if no worker has claimed a reservation
+  bool empty() const { return this->Reservations.empty(); }
+
+  //returns the reservations claimed by the given workers. Workers that
+  //haven't claimed a reservation are skipped
+  std::set<std::string>
+  reservations(const std::set<zmq::SocketIdentity>& workers) const;
+
+  //returns the reservations claimed by the given workers that have no
+  //job that is still queued on or being processed by them. A worker asking
+  //for work can still be busy, since it can hold credits while it works
+  std::set<std::string>
+  idleReservations(const std::set<zmq::SocketIdentity>& workers,
+                   const remus::server::detail::ActiveJobs::JobsPerWorker&
+                                                        workingJobs) const;
+
+  //returns the workers that claimed the given reservations
+  std::set<zmq::SocketIdentity>
+  workers(const std::set<std::string>& reservations) const;
+
+private:
+  typedef std::map<zmq::SocketIdentity, std::string> ReservationMap;
+  ReservationMap Reservations;
+};
+
+}
+}
+}
+
+#endif
@@ -32,10 +32,69 @@ bool JobQueue::addJob(const boost::uuids::uuid &id,
           newQueuedJob);
     this->QueuedIds.insert(id);
     this->CachedQueuedJobRequirements.insert( submission.requirements() );
+    ++this->Counts[submission.requirements()].Queued;
     }
   return can_add;
 }
 
+//------------------------------------------------------------------------------
+bool JobQueue::addJobArray(const boost::uuids::uuid& arrayId,
+            const boost::shared_ptr<const remus::proto::JobArraySubmission>& array)
+{
+  const std::size_t size = array ? array->size() : 0;
+  if(size == 0)
+    {
+    return false;
+    }
+
+  std::vector<QueuedJob> elements;
+  elements.reserve(size);
+  const boost::posix_time::ptime now =
+                              boost::posix_time::microsec_clock::local_time();
+  for(std::size_t i=0; i < size; ++i)
+    {
+    const boost::uuids::uuid id =
+                          remus::proto::make_JobArrayElementId(arrayId, i);
+    if(this->QueuedIds.count(id) != 0)
+      {
+      return false;
+      }
+    elements.push_back( QueuedJob(id, array, i, now) );
+    }
+
+  //the element ids only differ in the index bytes, so they are already
+  //sorted and can be merged into the queue in a single pass
+  const std::size_t oldSize = this->QueuedJobs.size();
+  this->QueuedJobs.insert(this->QueuedJobs.end(),
+                          elements.begin(), elements.end());
+  std::inplace_merge(this->QueuedJobs.begin(),
+                     this->QueuedJobs.begin() + oldSize,
+                     this->QueuedJobs.end());
+
+  for(std::vector<QueuedJob>::const_iterator i = elements.begin();
+      i != elements.end(); ++i)
+    {
+    this->QueuedIds.insert(i->Id);
+    }
+  this->CachedQueuedJobRequirements.insert( array->requirements() );
+  this->Counts[array->requirements()].Queued += size;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobQueue::removeJobArray(const boost::uuids::uuid& arrayId)
+{
+  const std::size_t removed =
+      this->removeArrayElements(this->QueuedJobs, arrayId, false) +
+      this->removeArrayElements(this->JobsWaitingForWorker, arrayId, true) +
+      this->removeArrayElements(this->ReservedJobs, arrayId, false, false);
+  if(removed > 0)
+    {
+    this->CachedQueuedJobRequirements.clear();
+    }
+  return removed;
+}
+
 //------------------------------------------------------------------------------
 remus::worker::Job JobQueue::takeJob(const remus::proto::JobRequirements& reqs)
 {
@@ -65,8 +124,11 @@ remus::worker::Job JobQueue::takeJob(const remus::proto::JobRequirements& reqs)
   //we need to copy the id and the contents of item now into a job
   //submission, if we use item after the remove_if it is invalid as
   //remove_if moves the vector items around making what item
-  //is pointing too change
-  remus::worker::Job job(item->Id,item->Submission);
+  //is pointing too change. This is also where array elements are
+  //turned into a complete submission
+  remus::worker::Job job(item->Id,item->submission());
+  this->decrementCount(item->requirements(),
+                       searched_vector == &this->JobsWaitingForWorker);
 
   //again don't use item after the remove_if the iterator is invalid
   JobIdMatches id_pred(job.id());
@@ -78,11 +140,32 @@ remus::worker::Job JobQueue::takeJob(const remus::proto::JobRequirements& reqs)
 
   this->QueuedIds.erase(job.id());
 
-  //clear the queued job cache
-
   return job;
 }
 
+//------------------------------------------------------------------------------
+remus::proto::JobSubmission
+JobQueue::peekJob(const remus::proto::JobRequirements& reqs) const
+{
+  typedef std::vector<QueuedJob>::const_iterator iter;
+
+  JobTypeMatches pred(reqs);
+  iter item = std::find_if(this->JobsWaitingForWorker.begin(),
+                           this->JobsWaitingForWorker.end(),
+                           pred);
+  if(item != this->JobsWaitingForWorker.end())
+    {
+    return item->submission();
+    }
+
+  item = std::find_if(this->QueuedJobs.begin(), this->QueuedJobs.end(), pred);
+  if(item != this->QueuedJobs.end())
+    {
+    return item->submission();
+    }
+  return remus::proto::JobSubmission();
+}
+
 //------------------------------------------------------------------------------
 remus::proto::JobRequirementsSet JobQueue::waitingJobRequirements() const
 {
@@ -91,7 +174,7 @@ remus::proto::JobRequirementsSet JobQueue::waitingJobRequirements() const
       i != this->JobsWaitingForWorker.end();
       ++i)
     {
-    result.insert(i->Submission.requirements());
+    result.insert(i->requirements());
     }
   return result;
 }
@@ -105,7 +188,7 @@ remus::proto::JobRequirementsSet JobQueue::queuedJobRequirements()
       i != this->QueuedJobs.end();
       ++i)
       {
-      this->CachedQueuedJobRequirements.insert(i->Submission.requirements());
+      this->CachedQueuedJobRequirements.insert(i->requirements());
       }
     }
 
@@ -123,6 +206,10 @@ bool JobQueue::workerDispatched(const remus::proto::JobRequirements& reqs)
   const bool found = this->QueuedJobs.end() != item;
   if(found)
     {
+    RequirementCounts& counts = this->Counts[item->requirements()];
+    --counts.Queued;
+    ++counts.WaitingForWorker;
+
     this->JobsWaitingForWorker.push_back(*item);
     this->QueuedJobs.erase(item);
     this->CachedQueuedJobRequirements.clear();
@@ -130,6 +217,110 @@ bool JobQueue::workerDispatched(const remus::proto::JobRequirements& reqs)
   return found;
 }
 
+//------------------------------------------------------------------------------
+bool JobQueue::workerDispatched(const remus::proto::JobRequirements& reqs,
+                                const std::string& reservation)
+{
+  typedef std::vector<QueuedJob>::iterator iter;
+  JobTypeMatches pred(reqs);
+
+  iter item = std::find_if(this->QueuedJobs.begin(),
+                           this->QueuedJobs.end(), pred);
+  const bool found = this->QueuedJobs.end() != item && !reservation.empty();
+  if(found)
+    {
+    this->decrementCount(item->requirements(), false);
+
+    item->Reservation = reservation;
+    item->ReservedTime = boost::posix_time::microsec_clock::local_time();
+    this->ReservedJobs.push_back(*item);
+    this->QueuedJobs.erase(item);
+    this->CachedQueuedJobRequirements.clear();
+    }
+  return found;
+}
+
+//------------------------------------------------------------------------------
+remus::worker::Job JobQueue::takeReservedJob(const std::string& reservation,
+                                      const remus::proto::JobRequirements& reqs)
+{
+  typedef std::vector<QueuedJob>::iterator iter;
+  iter item = std::find_if(this->ReservedJobs.begin(),
+                           this->ReservedJobs.end(),
+                           ReservationMatches(reservation));
+  if(reservation.empty() || item == this->ReservedJobs.end())
+    {
+    return remus::worker::Job();
+    }
+
+  //the worker can't run the job, so let the server dispatch it to any
+  //worker that can, or launch a new one for it
+  if(item->requirements() != reqs)
+    {
+    this->requeueReserved(*item);
+    this->ReservedJobs.erase(item);
+    return remus::worker::Job();
+    }
+
+  remus::worker::Job job(item->Id,item->submission());
+  this->ReservedJobs.erase(item);
+  this->QueuedIds.erase(job.id());
+  return job;
+}
+
+//------------------------------------------------------------------------------
+bool JobQueue::releaseReservation(const std::string& reservation)
+{
+  typedef std::vector<QueuedJob>::iterator iter;
+  iter item = std::find_if(this->ReservedJobs.begin(),
+                           this->ReservedJobs.end(),
+                           ReservationMatches(reservation));
+  if(reservation.empty() || item == this->ReservedJobs.end())
+    {
+    return false;
+    }
+  this->requeueReserved(*item);
+  this->ReservedJobs.erase(item);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobQueue::releaseReservations(
+                            const boost::posix_time::ptime& reservedBefore)
+{
+  typedef std::vector<QueuedJob>::iterator iter;
+  std::size_t released = 0;
+  iter i = this->ReservedJobs.begin();
+  while(i != this->ReservedJobs.end())
+    {
+    if(i->ReservedTime >= reservedBefore)
+      {
+      ++i;
+      continue;
+      }
+
+    //the job goes back in the queue, so that the server can dispatch it
+    //to any worker, or launch a new one for it
+    this->requeueReserved(*i);
+    i = this->ReservedJobs.erase(i);
+    ++released;
+    }
+  return released;
+}
+
+//------------------------------------------------------------------------------
+void JobQueue::requeueReserved(QueuedJob job)
+{
+  job.Reservation.clear();
+  job.ReservedTime = boost::posix_time::ptime();
+  this->QueuedJobs.insert(
+        std::lower_bound( this->QueuedJobs.begin(), this->QueuedJobs.end(),
+                          job ),
+        job);
+  this->CachedQueuedJobRequirements.insert( job.requirements() );
+  ++this->Counts[job.requirements()].Queued;
+}
+
 //------------------------------------------------------------------------------
 bool JobQueue::haveUUID(const boost::uuids::uuid &id) const
 {
@@ -142,29 +333,34 @@ bool JobQueue::remove(const boost::uuids::uuid& id)
   typedef std::vector<QueuedJob>::iterator iter;
   JobIdMatches pred(id);
 
-  bool id_found = false;
-
-  iter new_end = std::remove_if(this->QueuedJobs.begin(),
-                                this->QueuedJobs.end(),
-                                pred);
-
-  id_found = (new_end != this->QueuedJobs.end());
-  if( id_found )
+  iter item = std::find_if(this->QueuedJobs.begin(),
+                           this->QueuedJobs.end(),
+                           pred);
+  if( item != this->QueuedJobs.end() )
     {
-    this->QueuedJobs.erase(new_end,this->QueuedJobs.end());
+    this->decrementCount(item->requirements(), false);
+    this->QueuedJobs.erase(item);
     this->CachedQueuedJobRequirements.clear();
     }
   else
     {
-    new_end = std::remove_if(this->JobsWaitingForWorker.begin(),
-                            this->JobsWaitingForWorker.end(),
-                            pred);
-
-    id_found = (new_end != this->JobsWaitingForWorker.end());
-
-    if( id_found )
+    item = std::find_if(this->JobsWaitingForWorker.begin(),
+                        this->JobsWaitingForWorker.end(),
+                        pred);
+    if( item != this->JobsWaitingForWorker.end() )
       {
-      this->JobsWaitingForWorker.erase(new_end,this->JobsWaitingForWorker.end());
+      this->decrementCount(item->requirements(), true);
+      this->JobsWaitingForWorker.erase(item);
+      }
+    else
+      {
+      item = std::find_if(this->ReservedJobs.begin(),
+                          this->ReservedJobs.end(),
+                          pred);
+      if( item != this->ReservedJobs.end() )
+        {
+        this->ReservedJobs.erase(item);
+        }
       }
     }
   return this->QueuedIds.erase(id)==1;
@@ -175,8 +371,144 @@ void JobQueue::clear()
 {
   this->QueuedIds.clear();
   this->QueuedJobs.clear();
-  this->QueuedJobs.clear();
+  this->JobsWaitingForWorker.clear();
+  this->ReservedJobs.clear();
   this->CachedQueuedJobRequirements.clear();
+  this->Counts.clear();
+}
+
+//------------------------------------------------------------------------------
+bool JobQueue::listJobs(const remus::proto::JobListingRequest& request,
+                        remus::proto::JobListingRequest::JobLocation location,
+                        const boost::uuids::uuid* after,
+                        const boost::posix_time::ptime& now,
+                        std::size_t maxEntries,
+                        remus::proto::JobListing& listing) const
+{
+  typedef std::vector<QueuedJob>::const_iterator iter;
+  if(location == remus::proto::JobListingRequest::QUEUED_JOBS)
+    {
+    //queued jobs are kept sorted by id, so we can jump to the cursor
+    iter i = this->QueuedJobs.begin();
+    if(after)
+      {
+      i = std::upper_bound(this->QueuedJobs.begin(), this->QueuedJobs.end(),
+                           *after, IdLessThanJob());
+      }
+    for(; i != this->QueuedJobs.end(); ++i)
+      {
+      if(!JobQueue::listJob(*i, request, location, now, maxEntries, listing))
+        { return true; }
+      }
+    }
+  else if(location == remus::proto::JobListingRequest::WAITING_FOR_WORKER_JOBS)
+    {
+    //jobs waiting for a worker are kept in dispatch order, and there are
+    //only as many as workers being started, so sort the few we need.
+    //Reserved jobs are also waiting for the worker that was started for them
+    std::vector<const QueuedJob*> jobs;
+    jobs.reserve(this->JobsWaitingForWorker.size() + this->ReservedJobs.size());
+    for(iter i = this->JobsWaitingForWorker.begin();
+        i != this->JobsWaitingForWorker.end(); ++i)
+      {
+      if(!after || *after < i->Id)
+        { jobs.push_back(&(*i)); }
+      }
+    for(iter i = this->ReservedJobs.begin(); i != this->ReservedJobs.end(); ++i)
+      {
+      if(!after || *after < i->Id)
+        { jobs.push_back(&(*i)); }
+      }
+    std::sort(jobs.begin(), jobs.end(), JobIdLess());
+
+    typedef std::vector<const QueuedJob*>::const_iterator ptr_iter;
+    for(ptr_iter i = jobs.begin(); i != jobs.end(); ++i)
+      {
+      if(!JobQueue::listJob(**i, request, location, now, maxEntries, listing))
+        { return true; }
+      }
+    }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool JobQueue::listJob(const QueuedJob& job,
+                       const remus::proto::JobListingRequest& request,
+                       remus::proto::JobListingRequest::JobLocation location,
+                       const boost::posix_time::ptime& now,
+                       std::size_t maxEntries,
+                       remus::proto::JobListing& listing)
+{
+  const remus::proto::JobRequirements& reqs = job.requirements();
+  const boost::int64_t age = (now - job.QueuedTime).total_milliseconds();
+  if(!request.accepts(location, reqs.meshTypes(), reqs.workerName(),
+                      remus::QUEUED, std::string(), age))
+    {
+    return true;
+    }
+  if(listing.size() >= maxEntries)
+    {
+    return false;
+    }
+
+  remus::proto::JobListingEntry entry;
+  entry.Id = job.Id;
+  entry.Location = location;
+  entry.MeshTypes = reqs.meshTypes();
+  entry.WorkerName = reqs.workerName();
+  entry.Tag = reqs.tag();
+  entry.Status = remus::QUEUED;
+  entry.AgeInMillisec = age;
+  listing.add(entry);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void JobQueue::decrementCount(const remus::proto::JobRequirements& reqs,
+                              bool waitingForWorker)
+{
+  CountsPerRequirement::iterator i = this->Counts.find(reqs);
+  if(i == this->Counts.end())
+    {
+    return;
+    }
+
+  std::size_t& count = waitingForWorker ? i->second.WaitingForWorker
+                                        : i->second.Queued;
+  if(count > 0)
+    {
+    --count;
+    }
+  if(i->second.Queued == 0 && i->second.WaitingForWorker == 0)
+    {
+    this->Counts.erase(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+std::size_t JobQueue::removeArrayElements(std::vector<QueuedJob>& jobs,
+                                          const boost::uuids::uuid& arrayId,
+                                          bool waitingForWorker,
+                                          bool counted)
+{
+  typedef std::vector<QueuedJob>::iterator iter;
+  JobInArray pred(arrayId);
+  for(iter i = jobs.begin(); i != jobs.end(); ++i)
+    {
+    if(pred(*i))
+      {
+      if(counted)
+        {
+        this->decrementCount(i->requirements(), waitingForWorker);
+        }
+      this->QueuedIds.erase(i->Id);
+      }
+    }
+
+  iter new_end = std::remove_if(jobs.begin(), jobs.end(), pred);
+  const std::size_t removed = static_cast<std::size_t>(jobs.end() - new_end);
+  jobs.erase(new_end, jobs.end());
+  return removed;
 }
 
 }
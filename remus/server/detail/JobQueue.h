@@ -13,6 +13,8 @@
 #ifndef remus_server_detail_JobQueue_h
 #define remus_server_detail_JobQueue_h
 
+#include <remus/proto/JobArray.h>
+#include <remus/proto/JobListing.h>
 #include <remus/proto/JobSubmission.h>
 #include <remus/proto/Message.h>
 
@@ -21,11 +23,15 @@
 #include <remus/worker/Job.h>
 
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/uuid/uuid.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
 #include <algorithm>
+#include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 namespace remus{
@@ -40,10 +46,24 @@ namespace detail{
 class JobQueue
 {
 public:
+  //the number of jobs for a single requirement, split by
+  //whether they are waiting for a worker or just queued
+  struct RequirementCounts
+  {
+    RequirementCounts(): Queued(0), WaitingForWorker(0) {}
+    std::size_t Queued;
+    std::size_t WaitingForWorker;
+  };
+  typedef std::map< remus::proto::JobRequirements,
+                    RequirementCounts > CountsPerRequirement;
+
   JobQueue():
     QueuedJobs(),
     JobsWaitingForWorker(),
-    QueuedIds()
+    ReservedJobs(),
+    QueuedIds(),
+    CachedQueuedJobRequirements(),
+    Counts()
   {}
 
   //Convert a Message and UUID into a WorkerMessage.
@@ -51,11 +71,25 @@ public:
   bool addJob( const boost::uuids::uuid& id,
                const remus::proto::JobSubmission& submission);
 
+  //Queue every element of a job array. The elements share the array
+  //submission, and the submission of an element is only built when the
+  //element is taken. Will return false if any element id is already queued
+  bool addJobArray( const boost::uuids::uuid& arrayId,
+                    const boost::shared_ptr<const remus::proto::JobArraySubmission>& array);
+
+  //Removes all the queued and waiting for worker elements of a job array.
+  //Returns the number of elements that were removed
+  std::size_t removeJobArray(const boost::uuids::uuid& arrayId);
+
   //Removes a job from the queue of the given mesh type.
   //Return it as a worker Job. We prioritize jobs waiting for
   //workers, and than take jobs that are just queued.
   remus::worker::Job takeJob(const remus::proto::JobRequirements& reqs);
 
+  //returns the submission of the job that takeJob would return, without
+  //removing it. Returns an empty submission if there is no such job
+  remus::proto::JobSubmission peekJob(const remus::proto::JobRequirements& reqs) const;
+
   //returns the types of jobs that are waiting for a worker
   remus::proto::JobRequirementsSet waitingJobRequirements() const;
 
@@ -70,10 +104,44 @@ public:
   std::size_t numJobsJustQueued() const
     { return QueuedJobs.size(); }
 
+  //return the number of jobs reserved for workers that are being launched
+  std::size_t numJobsReserved() const
+    { return ReservedJobs.size(); }
+
+  //returns the number of jobs for each requirement that has at least
+  //a single job. This is kept up to date as jobs are added and taken, so
+  //it is cheap to call often
+  const CountsPerRequirement& countsPerRequirement() const
+    { return Counts; }
+
   //marks the first job with the given type as having
   //a worker dispatched for it.
   bool workerDispatched(const remus::proto::JobRequirements& reqs);
 
+  //marks the first job with the given type as reserved for the worker
+  //that was launched with the given token. Reserved jobs are only handed
+  //out by takeReservedJob, and aren't part of countsPerRequirement
+  bool workerDispatched(const remus::proto::JobRequirements& reqs,
+                        const std::string& reservation);
+
+  //Removes the job reserved with the given token from the queue, when the
+  //job has the requirements of the worker that claims it. Returns an
+  //invalid job if the token doesn't match a reservation, for example when
+  //the job was terminated or the reservation expired. A reserved job with
+  //other requirements goes back in the queue, and an invalid job is returned
+  remus::worker::Job takeReservedJob(const std::string& reservation,
+                                     const remus::proto::JobRequirements& reqs);
+
+  //puts the job reserved with the given token back in the queue, for
+  //when the launched worker will never claim it. Returns false if the
+  //token doesn't match a reservation
+  bool releaseReservation(const std::string& reservation);
+
+  //puts every job that was reserved before the given time back in the
+  //queue, so that the job isn't lost when the launched worker never
+  //claims it. Returns the number of reservations that were released
+  std::size_t releaseReservations(const boost::posix_time::ptime& reservedBefore);
+
   //Returns true if we contain the UUID
   bool haveUUID(const boost::uuids::uuid& id) const;
 
@@ -83,17 +151,63 @@ public:
   //Removes all queued and waiting for worker jobs.
   void clear();
 
+  //add the jobs at the given location that the request accepts to the
+  //listing, in id order starting after the given id ( NULL to start at the
+  //first job ) until the listing holds maxEntries jobs. Only the
+  //requirements of a job are looked at, the contents aren't copied.
+  //Returns true if more accepted jobs are left at the location.
+  bool listJobs(const remus::proto::JobListingRequest& request,
+                remus::proto::JobListingRequest::JobLocation location,
+                const boost::uuids::uuid* after,
+                const boost::posix_time::ptime& now,
+                std::size_t maxEntries,
+                remus::proto::JobListing& listing) const;
+
 private:
   struct QueuedJob
   {
     QueuedJob(const boost::uuids::uuid& id,
               const remus::proto::JobSubmission& submission):
               Id(id),
-              Submission(submission)
+              Submission(submission),
+              QueuedTime(boost::posix_time::microsec_clock::local_time()),
+              Array(),
+              Element(0),
+              Reservation(),
+              ReservedTime()
+              {}
+
+    //an element of a job array, which only holds on to the array
+    QueuedJob(const boost::uuids::uuid& id,
+              const boost::shared_ptr<const remus::proto::JobArraySubmission>& array,
+              std::size_t element,
+              const boost::posix_time::ptime& queuedTime):
+              Id(id),
+              Submission(),
+              QueuedTime(queuedTime),
+              Array(array),
+              Element(element),
+              Reservation(),
+              ReservedTime()
               {}
 
+    const remus::proto::JobRequirements& requirements() const
+      { return this->Array ? this->Array->requirements()
+                           : this->Submission.requirements(); }
+
+    //builds the submission of array elements
+    remus::proto::JobSubmission submission() const
+      { return this->Array ? this->Array->element(this->Element)
+                           : this->Submission; }
+
     boost::uuids::uuid Id;
     remus::proto::JobSubmission Submission;
+    boost::posix_time::ptime QueuedTime;
+    boost::shared_ptr<const remus::proto::JobArraySubmission> Array;
+    std::size_t Element;
+    //only set while the job is reserved for a launched worker
+    std::string Reservation;
+    boost::posix_time::ptime ReservedTime;
 
     bool operator<(const QueuedJob& other) const
       { return this->Id < other.Id; }
@@ -111,13 +225,54 @@ private:
     boost::uuids::uuid UUID;
   };
 
+  struct ReservationMatches
+  {
+    ReservationMatches(const std::string& r):
+    Reservation(r) {}
+
+    bool operator()(const QueuedJob& job) const
+      { return job.Reservation == Reservation; }
+
+    const std::string& Reservation;
+  };
+
+  //elements that were queued again on their own, after a worker shut
+  //down without starting them, are still found by their id
+  struct JobInArray
+  {
+    JobInArray(boost::uuids::uuid id):
+    ArrayId(id) {}
+
+    bool operator()(const QueuedJob& job) const
+      {
+      boost::uuids::uuid arrayId;
+      std::size_t index = 0;
+      return remus::proto::split_JobArrayElementId(job.Id, arrayId, index) &&
+             arrayId == ArrayId;
+      }
+
+    boost::uuids::uuid ArrayId;
+  };
+
+  struct IdLessThanJob
+  {
+    bool operator()(const boost::uuids::uuid& id, const QueuedJob& job) const
+      { return id < job.Id; }
+  };
+
+  struct JobIdLess
+  {
+    bool operator()(const QueuedJob* a, const QueuedJob* b) const
+      { return a->Id < b->Id; }
+  };
+
   struct JobTypeMatches
   {
     JobTypeMatches(const remus::proto::JobRequirements& r):
     Reqs(r) {}
 
     bool operator()(const QueuedJob& job) const
-      { return Reqs == job.Submission.requirements(); }
+      { return Reqs == job.requirements(); }
 
     const remus::proto::JobRequirements& Reqs;
   };
@@ -133,8 +288,35 @@ private:
   //match the dispatch order
   std::vector<QueuedJob> JobsWaitingForWorker;
 
+  //jobs that are held for a single launched worker, in reservation order
+  std::vector<QueuedJob> ReservedJobs;
+
   std::set<boost::uuids::uuid> QueuedIds;
   std::set<remus::proto::JobRequirements> CachedQueuedJobRequirements;
+  CountsPerRequirement Counts;
+
+  //puts a job that was reserved back in the queue
+  void requeueReserved(QueuedJob job);
+
+  //decrement the count of a requirement, removing it when it hits zero
+  void decrementCount(const remus::proto::JobRequirements& reqs,
+                      bool waitingForWorker);
+
+  //remove all the jobs of a vector that are elements of the given array.
+  //Reserved jobs aren't counted, so they pass counted as false
+  std::size_t removeArrayElements(std::vector<QueuedJob>& jobs,
+                                  const boost::uuids::uuid& arrayId,
+                                  bool waitingForWorker,
+                                  bool counted = true);
+
+  //add a single job to a listing if the request accepts it. Returns
+  //false if the job was accepted but the listing was already full
+  static bool listJob(const QueuedJob& job,
+                      const remus::proto::JobListingRequest& request,
+                      remus::proto::JobListingRequest::JobLocation location,
+                      const boost::posix_time::ptime& now,
+                      std::size_t maxEntries,
+                      remus::proto::JobListing& listing);
 
   //make copying not possible
   JobQueue (const JobQueue&);
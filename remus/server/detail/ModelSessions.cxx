@@ -0,0 +1,222 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ModelSessions.h>
+
+#include <remus/proto/ModelSession.h>
+
+#include <algorithm>
+
+namespace
+{
+  void erase_dead(std::set<zmq::SocketIdentity>& workers,
+                  const remus::server::detail::SocketMonitor& monitor)
+  {
+    typedef std::set<zmq::SocketIdentity>::iterator WorkerIt;
+    for(WorkerIt w = workers.begin(); w != workers.end();)
+      {
+      if(monitor.isDead(*w))
+        {
+        workers.erase(w++);
+        }
+      else
+        {
+        ++w;
+        }
+      }
+  }
+}
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//------------------------------------------------------------------------------
+ModelSessions::ModelSessions():
+  Sessions(),
+  Closed()
+{
+}
+
+//------------------------------------------------------------------------------
+void ModelSessions::open(const std::string& id,
+                         const remus::proto::JobSubmission& contents,
+                         std::size_t maxWorkers,
+                         const boost::posix_time::ptime& now)
+{
+  Session& session = this->Sessions[id];
+  session.Contents = contents;
+  session.MaxWorkers = std::max<std::size_t>(1, maxWorkers);
+  session.Workers.clear();
+  session.Holders.clear();
+  session.LastUsed = now;
+}
+
+//------------------------------------------------------------------------------
+bool ModelSessions::close(const std::string& id)
+{
+  SessionMap::iterator session = this->Sessions.find(id);
+  if(session == this->Sessions.end())
+    {
+    return false;
+    }
+  this->closed(session);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ModelSessions::closed(SessionMap::iterator session)
+{
+  if(!session->second.Holders.empty())
+    {
+    this->Closed.push_back( std::make_pair(session->first,
+                                           session->second.Holders) );
+    }
+  this->Sessions.erase(session);
+}
+
+//------------------------------------------------------------------------------
+bool ModelSessions::addSessionContents(remus::proto::JobSubmission& submission,
+                                       const boost::posix_time::ptime& now)
+{
+  const std::string id = remus::proto::to_ModelSessionId(submission);
+  if(id.empty())
+    {
+    return true;
+    }
+
+  SessionMap::iterator session = this->Sessions.find(id);
+  if(session == this->Sessions.end())
+    {
+    return false;
+    }
+
+  //keys the submission already has are kept, as insert doesn't replace
+  submission.insert(session->second.Contents.begin(),
+                    session->second.Contents.end());
+  session->second.LastUsed = now;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::set<zmq::SocketIdentity>
+ModelSessions::pinnedWorkers(const remus::proto::JobSubmission& submission) const
+{
+  const std::string id = remus::proto::to_ModelSessionId(submission);
+  SessionMap::const_iterator session = this->Sessions.find(id);
+  if(id.empty() || session == this->Sessions.end())
+    {
+    return std::set<zmq::SocketIdentity>();
+    }
+  return session->second.Workers;
+}
+
+//------------------------------------------------------------------------------
+void ModelSessions::dispatched(const remus::proto::JobSubmission& submission,
+                               const zmq::SocketIdentity& worker)
+{
+  const std::string id = remus::proto::to_ModelSessionId(submission);
+  SessionMap::iterator session = this->Sessions.find(id);
+  if(id.empty() || session == this->Sessions.end())
+    {
+    return;
+    }
+
+  //once the session is pinned to as many workers as it can be, jobs
+  //that no pinned worker was free for don't pin the session
+  if(session->second.Workers.size() < session->second.MaxWorkers)
+    {
+    session->second.Workers.insert(worker);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ModelSessions::removeSessionContents(
+                  remus::proto::JobSubmission& submission,
+                  const zmq::SocketIdentity& worker,
+                  std::map<std::string,remus::proto::JobSubmission>& newSessions)
+{
+  const std::string id = remus::proto::to_ModelSessionId(submission);
+  SessionMap::iterator session = this->Sessions.find(id);
+  if(id.empty() || session == this->Sessions.end())
+    {
+    return false;
+    }
+
+  //every job of the session that is sent to a worker goes through here,
+  //whether it was dispatched or claimed from a reservation
+  this->dispatched(submission, worker);
+
+  if(session->second.Holders.insert(worker).second)
+    {
+    newSessions[id] = session->second.Contents;
+    }
+
+  //the contents the submission got from the session share their data with
+  //the session, contents that the submission holds itself are kept
+  const remus::proto::JobSubmission& contents = session->second.Contents;
+  remus::proto::JobSubmission::ContainerType kept;
+  typedef remus::proto::JobSubmission::const_iterator cit;
+  for(cit i = submission.begin(); i != submission.end(); ++i)
+    {
+    cit shared = contents.find(i->first);
+    if(shared == contents.end() || shared->second.data() != i->second.data() ||
+       shared->second.dataSize() != i->second.dataSize())
+      {
+      kept.insert(*i);
+      }
+    }
+  submission = remus::proto::JobSubmission(submission.requirements(), kept);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+ModelSessions::ClosedSessions ModelSessions::takeClosedSessions()
+{
+  ClosedSessions result;
+  result.swap(this->Closed);
+  return result;
+}
+
+//------------------------------------------------------------------------------
+std::size_t ModelSessions::expire(const boost::posix_time::ptime& usedBefore)
+{
+  std::size_t expired = 0;
+  for(SessionMap::iterator i = this->Sessions.begin(); i != this->Sessions.end();)
+    {
+    if(i->second.LastUsed < usedBefore)
+      {
+      this->closed(i++);
+      ++expired;
+      }
+    else
+      {
+      ++i;
+      }
+    }
+  return expired;
+}
+
+//------------------------------------------------------------------------------
+void ModelSessions::purgeDeadWorkers(
+                          const remus::server::detail::SocketMonitor& monitor)
+{
+  for(SessionMap::iterator i = this->Sessions.begin(); i != this->Sessions.end(); ++i)
+    {
+    erase_dead(i->second.Workers, monitor);
+    erase_dead(i->second.Holders, monitor);
+    }
+}
+
+}
+}
+}
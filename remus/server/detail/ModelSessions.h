@@ -0,0 +1,127 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_ModelSessions_h
+#define remus_server_detail_ModelSessions_h
+
+#include <remus/proto/JobSubmission.h>
+#include <remus/proto/zmqSocketIdentity.h>
+
+#include <remus/server/detail/SocketMonitor.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/date_time/posix_time/posix_time.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//Holds the model sessions that clients have opened, see
+//remus::proto::ModelSession.h. Each session holds the contents that the
+//submissions of the session share, and the workers that the session is
+//pinned to. A session is pinned to the first maxWorkers workers that are
+//sent one of its jobs, and after that its jobs prefer those workers.
+//
+//The contents of a session are sent to a worker only once, before the
+//first job of the session that the worker is sent. Later jobs are sent
+//without them, and the worker adds them back, see remus::worker::detail::JobQueue.
+class ModelSessions
+{
+public:
+  ModelSessions();
+
+  //opens a session with the given id. A session is pinned to at least
+  //one worker
+  void open(const std::string& id,
+            const remus::proto::JobSubmission& contents,
+            std::size_t maxWorkers,
+            const boost::posix_time::ptime& now);
+
+  //returns false if there is no session with the given id. The workers
+  //that hold the session are remembered till takeClosedSessions
+  bool close(const std::string& id);
+
+  bool contains(const std::string& id) const
+    { return this->Sessions.count(id) != 0; }
+
+  std::size_t size() const { return this->Sessions.size(); }
+  bool empty() const { return this->Sessions.empty(); }
+
+  //adds the contents of the session that the submission refers to, that
+  //the submission doesn't hold itself. Returns false if the submission
+  //refers to a session that isn't open. Submissions that don't refer to
+  //a session are left untouched.
+  bool addSessionContents(remus::proto::JobSubmission& submission,
+                          const boost::posix_time::ptime& now);
+
+  //returns the workers that the session of a submission is pinned to
+  std::set<zmq::SocketIdentity>
+  pinnedWorkers(const remus::proto::JobSubmission& submission) const;
+
+  //tell the session of a submission that a job has been sent to the
+  //given worker, which pins the session to the worker if it has room
+  void dispatched(const remus::proto::JobSubmission& submission,
+                  const zmq::SocketIdentity& worker);
+
+  //prepares a submission of an open session to be sent to a worker, by
+  //removing the contents it got from the session. The session is pinned to
+  //the worker like dispatched does. A worker that doesn't hold the session
+  //yet is marked as holding it, and the session is added to newSessions,
+  //so that its contents can be sent to the worker before the job. Returns false and leaves the submission alone when it doesn't
+  //refer to an open session, in which case it is sent as it is
+  bool removeSessionContents(remus::proto::JobSubmission& submission,
+                     const zmq::SocketIdentity& worker,
+                     std::map<std::string,remus::proto::JobSubmission>& newSessions);
+
+  //the sessions closed since the last call, and the workers that hold them,
+  //so that the workers can be told to drop them
+  typedef std::vector< std::pair<std::string,
+                                 std::set<zmq::SocketIdentity> > > ClosedSessions;
+  ClosedSessions takeClosedSessions();
+
+  //closes every session that hasn't been used since the given time,
+  //and returns the number of sessions that were closed
+  std::size_t expire(const boost::posix_time::ptime& usedBefore);
+
+  //unpins the sessions from workers that the monitor considers dead
+  void purgeDeadWorkers(const remus::server::detail::SocketMonitor& monitor);
+
+private:
+  struct Session
+  {
+    remus::proto::JobSubmission Contents;
+    std::size_t MaxWorkers;
+    std::set<zmq::SocketIdentity> Workers;
+    //the workers that have been sent the contents
+    std::set<zmq::SocketIdentity> Holders;
+    boost::posix_time::ptime LastUsed;
+  };
+
+  typedef std::map<std::string, Session> SessionMap;
+
+  void closed(SessionMap::iterator session);
+
+  SessionMap Sessions;
+  ClosedSessions Closed;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,329 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ProcessSpawner.h>
+
+#include <remus/common/ExecuteProcess.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <deque>
+
+#if defined(REMUS_HAVE_SPAWN_H)
+# include <signal.h>
+# include <spawn.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# if defined(__APPLE__)
+#  include <crt_externs.h>
+#  define environ (*_NSGetEnviron())
+# else
+extern char **environ;
+# endif
+#endif
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//----------------------------------------------------------------------------
+struct ProcessSpawner::Process::Internals
+{
+  enum State
+  {
+    Queued,
+    Running,
+    Finished
+  };
+
+  Internals():
+    Mutex(),
+    CurrentState(Queued),
+#if defined(REMUS_HAVE_SPAWN_H)
+    Pid(0),
+    Arguments(),
+    Environment()
+#else
+    Executor()
+#endif
+  {
+  }
+
+  //held while the process is launched, so that kill waits for the launch
+  //to finish instead of racing it
+  boost::mutex Mutex;
+  State CurrentState;
+#if defined(REMUS_HAVE_SPAWN_H)
+  pid_t Pid;
+  //the command followed by its arguments, and the complete environment
+  //of the process as NAME=VALUE, built before the process is queued
+  std::vector<std::string> Arguments;
+  std::vector<std::string> Environment;
+#else
+  boost::shared_ptr<remus::common::ExecuteProcess> Executor;
+#endif
+};
+
+//----------------------------------------------------------------------------
+ProcessSpawner::Process::Process():
+  Implementation(new ProcessSpawner::Process::Internals())
+{
+}
+
+//----------------------------------------------------------------------------
+ProcessSpawner::Process::~Process()
+{
+}
+
+//----------------------------------------------------------------------------
+bool ProcessSpawner::Process::isAlive()
+{
+  Internals& p = *this->Implementation;
+  boost::lock_guard<boost::mutex> lock(p.Mutex);
+  if(p.CurrentState != Internals::Running)
+    {
+    return p.CurrentState == Internals::Queued;
+    }
+
+#if defined(REMUS_HAVE_SPAWN_H)
+  int status = 0;
+  if(waitpid(p.Pid, &status, WNOHANG) == 0)
+    {
+    return true;
+    }
+#else
+  if(p.Executor->isAlive())
+    {
+    return true;
+    }
+#endif
+  p.CurrentState = Internals::Finished;
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool ProcessSpawner::Process::kill()
+{
+  Internals& p = *this->Implementation;
+  boost::lock_guard<boost::mutex> lock(p.Mutex);
+  if(p.CurrentState == Internals::Queued)
+    { //the helper thread skips processes that aren't queued
+    p.CurrentState = Internals::Finished;
+    return true;
+    }
+  else if(p.CurrentState == Internals::Finished)
+    {
+    return false;
+    }
+
+  p.CurrentState = Internals::Finished;
+#if defined(REMUS_HAVE_SPAWN_H)
+  int status = 0;
+  if(waitpid(p.Pid, &status, WNOHANG) != 0)
+    { //exited on its own
+    return false;
+    }
+  ::kill(p.Pid, SIGKILL);
+  waitpid(p.Pid, &status, 0);
+  return true;
+#else
+  return p.Executor->kill();
+#endif
+}
+
+//----------------------------------------------------------------------------
+struct ProcessSpawner::SpawnThread
+{
+  SpawnThread():
+    Mutex(),
+    Wake(),
+    Queue(),
+    Stopping(false),
+    Thread()
+  {
+    this->Thread.reset(new boost::thread(&SpawnThread::run, this));
+  }
+
+  ~SpawnThread()
+  {
+    {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    this->Stopping = true;
+    }
+    this->Wake.notify_all();
+    this->Thread->join();
+
+    //nothing will launch the processes that are still queued
+    for(std::size_t i=0; i < this->Queue.size(); ++i)
+      {
+      this->Queue[i]->kill();
+      }
+  }
+
+  void push(const ProcessSpawner::ProcessPtr& process)
+  {
+    {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    this->Queue.push_back(process);
+    }
+    this->Wake.notify_one();
+  }
+
+  std::size_t size() const
+  {
+    boost::lock_guard<boost::mutex> lock(this->Mutex);
+    return this->Queue.size();
+  }
+
+  void run()
+  {
+    while(true)
+      {
+      ProcessSpawner::ProcessPtr process;
+      {
+      boost::unique_lock<boost::mutex> lock(this->Mutex);
+      while(this->Queue.empty() && !this->Stopping)
+        {
+        this->Wake.wait(lock);
+        }
+      if(this->Stopping)
+        {
+        return;
+        }
+      process = this->Queue.front();
+      this->Queue.pop_front();
+      }
+      ProcessSpawner::launch(process);
+      }
+  }
+
+  mutable boost::mutex Mutex;
+  boost::condition_variable Wake;
+  std::deque<ProcessSpawner::ProcessPtr> Queue;
+  bool Stopping;
+  boost::scoped_ptr<boost::thread> Thread;
+};
+
+//----------------------------------------------------------------------------
+ProcessSpawner::ProcessSpawner():
+  Thread()
+{
+}
+
+//----------------------------------------------------------------------------
+ProcessSpawner::~ProcessSpawner()
+{
+}
+
+//----------------------------------------------------------------------------
+ProcessSpawner::ProcessPtr
+ProcessSpawner::spawn(const std::string& command,
+                      const std::vector<std::string>& args,
+                      const std::map<std::string,std::string>& env)
+{
+  ProcessPtr process(new ProcessSpawner::Process());
+  Process::Internals& p = *process->Implementation;
+
+#if defined(REMUS_HAVE_SPAWN_H)
+  p.Arguments.reserve(args.size() + 1);
+  p.Arguments.push_back(command);
+  p.Arguments.insert(p.Arguments.end(), args.begin(), args.end());
+
+  //the given variables replace the ones the server has with the same name
+  typedef std::map<std::string,std::string>::const_iterator EnvIt;
+  for(char** e = environ; e != NULL && *e != NULL; ++e)
+    {
+    const std::string variable(*e);
+    if(env.find(variable.substr(0, variable.find('='))) == env.end())
+      {
+      p.Environment.push_back(variable);
+      }
+    }
+  for(EnvIt i = env.begin(); i != env.end(); ++i)
+    {
+    p.Environment.push_back(i->first + "=" + i->second);
+    }
+
+  //the thread is only started once the first process is queued, as most
+  //factories never launch a process
+  if(!this->Thread)
+    {
+    this->Thread.reset(new SpawnThread());
+    }
+  this->Thread->push(process);
+#else
+  p.Executor.reset(new remus::common::ExecuteProcess(command, args, env));
+  p.Executor->execute();
+  p.CurrentState = Process::Internals::Running;
+#endif
+  return process;
+}
+
+//----------------------------------------------------------------------------
+std::size_t ProcessSpawner::queued() const
+{
+  return this->Thread ? this->Thread->size() : 0;
+}
+
+//----------------------------------------------------------------------------
+void ProcessSpawner::launch(const ProcessPtr& process)
+{
+#if defined(REMUS_HAVE_SPAWN_H)
+  Process::Internals& p = *process->Implementation;
+  boost::lock_guard<boost::mutex> lock(p.Mutex);
+  if(p.CurrentState != Process::Internals::Queued)
+    { //killed before it was launched
+    return;
+    }
+
+  std::vector<char*> argv;
+  for(std::size_t i=0; i < p.Arguments.size(); ++i)
+    {
+    argv.push_back(const_cast<char*>(p.Arguments[i].c_str()));
+    }
+  argv.push_back(NULL);
+
+  std::vector<char*> envp;
+  for(std::size_t i=0; i < p.Environment.size(); ++i)
+    {
+    envp.push_back(const_cast<char*>(p.Environment[i].c_str()));
+    }
+  envp.push_back(NULL);
+
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+#if defined(POSIX_SPAWN_USEVFORK)
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_USEVFORK);
+#endif
+  //like ExecuteProcess, commands without a path are looked up in the PATH
+  const int result = posix_spawnp(&p.Pid, argv[0], NULL, &attributes,
+                                  &argv[0], &envp[0]);
+  posix_spawnattr_destroy(&attributes);
+
+  p.CurrentState = (result == 0) ? Process::Internals::Running
+                                 : Process::Internals::Finished;
+
+  //the strings are only needed to launch the process
+  std::vector<std::string>().swap(p.Arguments);
+  std::vector<std::string>().swap(p.Environment);
+#else
+  (void)process;
+#endif
+}
+
+}
+}
+}
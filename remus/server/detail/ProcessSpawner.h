@@ -0,0 +1,100 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_ProcessSpawner_h
+#define remus_server_detail_ProcessSpawner_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//Launches the worker processes of the WorkerFactory.
+//When we have posix_spawn, the command line and environment of a process
+//are built when it is queued, and a helper thread launches the queued
+//processes with posix_spawnp, which unlike fork doesn't copy the page
+//tables of the server. Commands without a path are looked up in the PATH.
+//The thread that asks for a process never waits on it to be launched, so
+//a burst of workers doesn't stall the server.
+//Otherwise processes are launched right away with
+//remus::common::ExecuteProcess
+class ProcessSpawner
+{
+public:
+  class Process;
+  typedef boost::shared_ptr<Process> ProcessPtr;
+
+  ProcessSpawner();
+
+  //processes that are still queued are never launched
+  ~ProcessSpawner();
+
+  //queue a process to be launched. The environment variables are added
+  //to the environment of the server
+  ProcessPtr spawn(const std::string& command,
+                   const std::vector<std::string>& args,
+                   const std::map<std::string,std::string>& env);
+
+  //returns the number of processes that are waiting to be launched
+  std::size_t queued() const;
+
+private:
+  ProcessSpawner(const ProcessSpawner&);
+  void operator=(const ProcessSpawner&);
+
+  //launches a queued process, called by the helper thread
+  static void launch(const ProcessPtr& process);
+
+  struct SpawnThread;
+  boost::scoped_ptr<SpawnThread> Thread;
+};
+
+//A process launched by the ProcessSpawner. A process is alive from the
+//moment it is queued until it exits, is killed, or fails to launch
+class ProcessSpawner::Process
+{
+public:
+  ~Process();
+
+  //returns if the process is queued or running
+  bool isAlive();
+
+  //kills the process if it is running, and makes sure a queued process
+  //is never launched. Returns false if the process wasn't alive
+  bool kill();
+
+private:
+  friend class ProcessSpawner;
+  Process();
+
+  Process(const Process&);
+  void operator=(const Process&);
+
+  struct Internals;
+  boost::scoped_ptr<Internals> Implementation;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,94 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ServerSummary.h>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//-----------------------------------------------------------------------------
+ServerSummary::ServerSummary(boost::int64_t intervalMillisec):
+  IntervalMillisec(0),
+  IntervalStart(),
+  NextSnapshot(boost::posix_time::pos_infin),
+  Dispatched(0),
+  Finished(0),
+  Failed(0),
+  Expired(0),
+  TotalDispatched(0),
+  TotalFinished(0),
+  TotalFailed(0),
+  TotalExpired(0)
+{
+  this->interval(intervalMillisec);
+}
+
+//-----------------------------------------------------------------------------
+void ServerSummary::interval(boost::int64_t intervalMillisec)
+{
+  this->IntervalMillisec = intervalMillisec;
+  this->IntervalStart = boost::posix_time::microsec_clock::local_time();
+  if(intervalMillisec > 0)
+    {
+    this->NextSnapshot = this->IntervalStart +
+                         boost::posix_time::milliseconds(intervalMillisec);
+    }
+  else
+    {
+    this->NextSnapshot = boost::posix_time::pos_infin;
+    }
+}
+
+//-----------------------------------------------------------------------------
+SummarySnapshot ServerSummary::snapshot(
+                        const boost::posix_time::ptime& now,
+                        const remus::server::detail::JobQueue& queue,
+                        const remus::server::detail::ActiveJobs& active)
+{
+  this->TotalDispatched += this->Dispatched;
+  this->TotalFinished += this->Finished;
+  this->TotalFailed += this->Failed;
+  this->TotalExpired += this->Expired;
+
+  SummarySnapshot snap;
+  snap.IntervalMillisec = (now - this->IntervalStart).total_milliseconds();
+  snap.Requirements = queue.countsPerRequirement();
+  snap.WorkingJobs = active.workingJobsPerWorker();
+  snap.Dispatched = this->Dispatched;
+  snap.Finished = this->Finished;
+  snap.Failed = this->Failed;
+  snap.Expired = this->Expired;
+  snap.TotalDispatched = this->TotalDispatched;
+  snap.TotalFinished = this->TotalFinished;
+  snap.TotalFailed = this->TotalFailed;
+  snap.TotalExpired = this->TotalExpired;
+
+  this->Dispatched = 0;
+  this->Finished = 0;
+  this->Failed = 0;
+  this->Expired = 0;
+
+  //don't try to catch up if the broker was busy, just start
+  //the next interval from now
+  this->IntervalStart = now;
+  if(this->IntervalMillisec > 0)
+    {
+    this->NextSnapshot = now +
+                  boost::posix_time::milliseconds(this->IntervalMillisec);
+    }
+  return snap;
+}
+
+}
+}
+}
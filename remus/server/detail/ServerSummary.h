@@ -0,0 +1,132 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_server_detail_ServerSummary_h
+#define remus_server_detail_ServerSummary_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/server/detail/ActiveJobs.h>
+#include <remus/server/detail/JobQueue.h>
+
+namespace remus{
+namespace server{
+namespace detail{
+
+//A point in time snapshot of what the server is doing, built by
+//ServerSummary and published by the EventPublisher under "summary:server"
+struct SummarySnapshot
+{
+  SummarySnapshot():
+    IntervalMillisec(0),
+    Requirements(),
+    WorkingJobs(),
+    Dispatched(0),
+    Finished(0),
+    Failed(0),
+    Expired(0),
+    TotalDispatched(0),
+    TotalFinished(0),
+    TotalFailed(0),
+    TotalExpired(0)
+    {}
+
+  //length of the interval the rates and interval counts cover
+  boost::int64_t IntervalMillisec;
+
+  //queue depth and jobs waiting for a worker per requirement
+  remus::server::detail::JobQueue::CountsPerRequirement Requirements;
+
+  //number of QUEUED or IN_PROGRESS jobs each worker has
+  remus::server::detail::ActiveJobs::JobsPerWorker WorkingJobs;
+
+  //counts for this interval
+  std::size_t Dispatched;
+  std::size_t Finished;
+  std::size_t Failed;
+  std::size_t Expired;
+
+  //counts since the server started brokering
+  std::size_t TotalDispatched;
+  std::size_t TotalFinished;
+  std::size_t TotalFailed;
+  std::size_t TotalExpired;
+
+  //jobs per second for this interval
+  double dispatchRate() const { return rate(Dispatched); }
+  double finishRate() const { return rate(Finished); }
+
+private:
+  double rate(std::size_t count) const
+  {
+    return IntervalMillisec > 0 ? (1000.0 * count) / IntervalMillisec : 0.0;
+  }
+};
+
+//ServerSummary keeps the counters that go into a SummarySnapshot. The broker
+//tells it about every dispatched, finished, failed, and expired job as they
+//happen, while the per requirement and per worker counts are kept up to
+//date by the JobQueue and ActiveJobs. That way building a snapshot never has
+//to walk all the jobs the server knows about.
+class ServerSummary
+{
+public:
+  //an interval of zero or less disables the summary
+  explicit ServerSummary(boost::int64_t intervalMillisec);
+
+  void interval(boost::int64_t intervalMillisec);
+  boost::int64_t interval() const { return IntervalMillisec; }
+
+  void jobDispatched() { ++Dispatched; }
+  void jobFinished() { ++Finished; }
+  void jobFailed() { ++Failed; }
+  void jobsExpired(std::size_t count) { Expired += count; }
+
+  //returns when the next snapshot is due, or pos_infin when disabled
+  boost::posix_time::ptime nextSnapshot() const { return NextSnapshot; }
+
+  //is a snapshot due at the given time
+  bool due(const boost::posix_time::ptime& now) const
+    { return !NextSnapshot.is_special() && NextSnapshot <= now; }
+
+  //build a snapshot for the interval that ends now, and start
+  //the next interval
+  SummarySnapshot snapshot(const boost::posix_time::ptime& now,
+                           const remus::server::detail::JobQueue& queue,
+                           const remus::server::detail::ActiveJobs& active);
+
+private:
+  boost::int64_t IntervalMillisec;
+  boost::posix_time::ptime IntervalStart;
+  boost::posix_time::ptime NextSnapshot;
+
+  std::size_t Dispatched;
+  std::size_t Finished;
+  std::size_t Failed;
+  std::size_t Expired;
+
+  std::size_t TotalDispatched;
+  std::size_t TotalFinished;
+  std::size_t TotalFailed;
+  std::size_t TotalExpired;
+};
+
+}
+}
+}
+
+#endif
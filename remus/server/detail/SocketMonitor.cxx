@@ -17,6 +17,7 @@ REMUS_THIRDPARTY_PRE_INCLUDE
 REMUS_THIRDPARTY_POST_INCLUDE
 
 #include <algorithm>
+#include <set>
 
 namespace remus{
 namespace server{
@@ -41,6 +42,7 @@ public:
   remus::common::PollingMonitor PollMonitor;
 
   std::map< zmq::SocketIdentity, BeatInfo > HeartBeats;
+  std::set< zmq::SocketIdentity > PendingRefreshes;
 
   typedef std::pair< zmq::SocketIdentity, BeatInfo > InsertType;
   typedef std::map< zmq::SocketIdentity, BeatInfo >::iterator IteratorType;
@@ -59,6 +61,12 @@ public:
 
   //----------------------------------------------------------------------------
   void refresh(const zmq::SocketIdentity& socket)
+  {
+    this->refresh(socket, boost::posix_time::microsec_clock::local_time());
+  }
+
+  //----------------------------------------------------------------------------
+  void refresh(const zmq::SocketIdentity& socket, const ptime& now)
   {
     //insert a new item if it doesn't exist, otherwise get the beatInfo already
     //in the map
@@ -66,7 +74,7 @@ public:
     IteratorType iter = (this->HeartBeats.insert(key_value)).first;
     BeatInfo& beat = iter->second;
 
-    beat.LastOccurrence = boost::posix_time::microsec_clock::local_time();
+    beat.LastOccurrence = now;
 
     //look at our current max time out and the and the current duration that
     //we last polled the worker at. Take the slower of the two.
@@ -80,6 +88,26 @@ public:
     beat.Duration = std::max( beat.Duration, PollMonitor.maxTimeOut() );
   }
 
+  //----------------------------------------------------------------------------
+  void applyRefreshes()
+  {
+    if(this->PendingRefreshes.empty())
+      {
+      return;
+      }
+
+    //every queued socket was heard from since the last time we applied
+    //refreshes, so they can all share the same timestamp
+    const ptime now = boost::posix_time::microsec_clock::local_time();
+    typedef std::set< zmq::SocketIdentity >::const_iterator PendingIt;
+    for(PendingIt i = this->PendingRefreshes.begin();
+        i != this->PendingRefreshes.end(); ++i)
+      {
+      this->refresh(*i, now);
+      }
+    this->PendingRefreshes.clear();
+  }
+
   //----------------------------------------------------------------------------
   void heartbeat( const zmq::SocketIdentity& socket, boost::int64_t dur )
   {
@@ -114,6 +142,8 @@ public:
   //----------------------------------------------------------------------------
   void markAsDead( const zmq::SocketIdentity& socket )
   {
+    //drop any queued refresh so that we don't bring the socket back
+    this->PendingRefreshes.erase(socket);
     this->HeartBeats.erase(socket);
   }
 
@@ -187,6 +217,24 @@ void SocketMonitor::refresh( const zmq::SocketIdentity& socket )
   this->Tracker->refresh(socket);
 }
 
+//------------------------------------------------------------------------------
+void SocketMonitor::refreshLater( const zmq::SocketIdentity& socket )
+{
+  this->Tracker->PendingRefreshes.insert(socket);
+}
+
+//------------------------------------------------------------------------------
+void SocketMonitor::applyRefreshes()
+{
+  this->Tracker->applyRefreshes();
+}
+
+//------------------------------------------------------------------------------
+std::size_t SocketMonitor::pendingRefreshes() const
+{
+  return this->Tracker->PendingRefreshes.size();
+}
+
 //------------------------------------------------------------------------------
 void SocketMonitor::heartbeat( const zmq::SocketIdentity& socket,
                                boost::int64_t dur_in_milli )
@@ -48,6 +48,19 @@ public:
   //to determine the expect time of the next heartbeat from the socket.
   void refresh( const zmq::SocketIdentity& socket);
 
+  //queue a refresh of a socket, which is applied by the next call to
+  //applyRefreshes. A busy socket is refreshed by every message it sends,
+  //so deferring the refresh lets a burst of messages share a single
+  //update and clock read.
+  void refreshLater( const zmq::SocketIdentity& socket);
+
+  //refresh all sockets queued by refreshLater. Needs to be called before
+  //asking if sockets are dead or unresponsive
+  void applyRefreshes();
+
+  //returns the number of sockets that are waiting on applyRefreshes
+  std::size_t pendingRefreshes() const;
+
   //update a sockets heartbeat duration, marks the socket as alive.
   //Compares the heart beat interval and the pollingMontior
   //to determine the expect time of the next heartbeat from the socket
@@ -17,6 +17,13 @@
 
 #include <algorithm>
 
+namespace
+{
+//far more than any prefetch window, while keeping the number of desired
+//jobs of a worker well inside of an int
+const int MaxCreditsPerWorker = 1 << 16;
+}
+
 namespace remus{
 namespace server{
 namespace detail{
@@ -27,13 +34,15 @@ WorkerPool::WorkerInfo::WorkerInfo(const zmq::SocketIdentity& address,
   NumberOfDesiredJobs(0),
   Reqs(reqs),
   Address(address),
-  IsResponsive(true)
+  IsResponsive(true),
+  AcceptsBatches(false)
 {
 }
 
 //------------------------------------------------------------------------------
 WorkerPool::WorkerPool():
-  Pool()
+  Pool(),
+  Version(0)
 {
 
 }
@@ -45,6 +54,7 @@ bool WorkerPool::addWorker(zmq::SocketIdentity workerIdentity,
   if(!this->haveWorker(workerIdentity,reqs))
     {
     this->Pool.push_back( WorkerPool::WorkerInfo(workerIdentity,reqs) );
+    ++this->Version;
     }
   return true;
 }
@@ -112,24 +122,84 @@ bool WorkerPool::readyForWork(const zmq::SocketIdentity& address,
     {
     if(i->Address == address && i->Reqs == reqs)
       {
+      const bool wasWaiting = i->isWaitingForWork();
       i->IsResponsive = true; //mark the worker as responsive
       i->addJob();
       ++count;
+      if(!wasWaiting && i->isWaitingForWork())
+        { ++this->Version; }
+      }
+    }
+  return (count > 0);
+}
+
+
+//------------------------------------------------------------------------------
+bool WorkerPool::addCredits(const zmq::SocketIdentity& address,
+                            const remus::proto::JobRequirements& reqs,
+                            std::size_t numberOfJobs)
+{
+  int count = 0;
+  for(It i=this->Pool.begin(); i != this->Pool.end(); ++i)
+    {
+    if(i->Address == address && i->Reqs == reqs)
+      {
+      const bool wasWaiting = i->isWaitingForWork();
+      i->IsResponsive = true; //mark the worker as responsive
+      i->AcceptsBatches = true;
+      const int room = MaxCreditsPerWorker -
+                       std::max(0, i->NumberOfDesiredJobs);
+      if(room > 0)
+        {
+        i->addJobs( static_cast<int>(
+            std::min(numberOfJobs, static_cast<std::size_t>(room))) );
+        }
+      ++count;
+      if(!wasWaiting && i->isWaitingForWork())
+        { ++this->Version; }
       }
     }
   return (count > 0);
 }
 
+//------------------------------------------------------------------------------
+std::size_t WorkerPool::maxCredits()
+{
+  return static_cast<std::size_t>(MaxCreditsPerWorker);
+}
 
 //------------------------------------------------------------------------------
 zmq::SocketIdentity WorkerPool::takeWorker(
                              const remus::proto::JobRequirements& reqs)
+{
+  std::size_t numberOfJobs = 1;
+  return this->takeWorker(reqs, numberOfJobs);
+}
+
+//------------------------------------------------------------------------------
+zmq::SocketIdentity WorkerPool::takeWorker(
+                             const remus::proto::JobRequirements& reqs,
+                             std::size_t& numberOfJobs)
+{
+  return this->takeWorker(reqs, numberOfJobs, std::set<zmq::SocketIdentity>());
+}
+
+//------------------------------------------------------------------------------
+zmq::SocketIdentity WorkerPool::takeWorker(
+                             const remus::proto::JobRequirements& reqs,
+                             std::size_t& numberOfJobs,
+                             const std::set<zmq::SocketIdentity>& preferred)
 {
   bool found = false;
   It i;
-  for(i=this->Pool.begin(); !found && i != this->Pool.end(); ++i)
+  //the first pass only looks at the preferred workers
+  for(int pass = preferred.empty() ? 1 : 0; !found && pass < 2; ++pass)
     {
-    found = (i->Reqs == reqs) && (i->isWaitingForWork());
+    for(i=this->Pool.begin(); !found && i != this->Pool.end(); ++i)
+      {
+      found = (i->Reqs == reqs) && (i->isWaitingForWork()) &&
+              (pass == 1 || preferred.count(i->Address) != 0);
+      }
     }
 
   zmq::SocketIdentity workerIdentity;
@@ -141,17 +211,53 @@ zmq::SocketIdentity WorkerPool::takeWorker(
 
     //take the worker id as it matches the reqs
     workerIdentity = zmq::SocketIdentity(i->Address);
-    i->takesJob();
+    if(i->AcceptsBatches)
+      {
+      numberOfJobs = std::min<std::size_t>(numberOfJobs,
+                                           i->NumberOfDesiredJobs);
+      }
+    else
+      {
+      numberOfJobs = std::min<std::size_t>(numberOfJobs, 1);
+      }
+    i->takesJobs( static_cast<int>(numberOfJobs) );
+    if(!i->isWaitingForWork())
+      { ++this->Version; }
 
     //now that the worker has taken the job, we move him to the back of
     //the vector so he is the last worker to take a job of that type again,
     //this allows us to handle multiple workers taking jobs
     std::rotate(this->Pool.begin(), this->Pool.begin() + 1,this->Pool.end());
     }
+  else
+    {
+    numberOfJobs = 0;
+    }
 
   return workerIdentity;
 }
 
+//------------------------------------------------------------------------------
+bool WorkerPool::removeWorker(const zmq::SocketIdentity& address)
+{
+  const std::size_t size = this->Pool.size();
+  for(It i=this->Pool.begin(); i != this->Pool.end();)
+    {
+    if(i->Address == address)
+      {
+      i = this->Pool.erase(i);
+      }
+    else
+      {
+      ++i;
+      }
+    }
+  const bool removed = (this->Pool.size() != size);
+  if(removed)
+    { ++this->Version; }
+  return removed;
+}
+
 //------------------------------------------------------------------------------
 void WorkerPool::purgeDeadWorkers(remus::server::detail::SocketMonitor monitor)
 {
@@ -162,10 +268,15 @@ void WorkerPool::purgeDeadWorkers(remus::server::detail::SocketMonitor monitor)
   //an iterator to the new end. Remove if is easiest way to remove from middle
   It newEnd = std::remove_if(this->Pool.begin(),this->Pool.end(),dead);
 
+  bool changed = (newEnd != this->Pool.end());
   for(It i=this->Pool.begin(); i != newEnd; ++i)
     {
-    i->IsResponsive = !monitor.isUnresponsive(i->Address);
+    const bool responsive = !monitor.isUnresponsive(i->Address);
+    changed = changed || (i->IsResponsive != responsive);
+    i->IsResponsive = responsive;
     }
+  if(changed)
+    { ++this->Version; }
 
   //erase all the dead workers to free up space
   this->Pool.erase(newEnd,this->Pool.end());
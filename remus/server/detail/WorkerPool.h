@@ -18,6 +18,10 @@
 
 #include <remus/server/detail/SocketMonitor.h>
 
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
 #include <set>
 #include <vector>
 
@@ -62,6 +66,34 @@ public:
   //queue
   zmq::SocketIdentity takeWorker(const remus::proto::JobRequirements& reqs);
 
+  //give a worker credits for the given number of jobs. Unlike readyForWork
+  //the worker can be sent multiple jobs in a single message after this.
+  //A worker never holds more than maxCredits() jobs worth of credits.
+  //returns false if a worker with that address wasn't found
+  bool addCredits(const zmq::SocketIdentity& address,
+                  const remus::proto::JobRequirements& reqs,
+                  std::size_t numberOfJobs);
+
+  //the most jobs a worker can have credits for
+  static std::size_t maxCredits();
+
+  //same as takeWorker, but marks that the worker takes up to numberOfJobs.
+  //numberOfJobs is lowered to the number of jobs the worker can take
+  //in a single message, which is 1 for workers that don't use credits
+  zmq::SocketIdentity takeWorker(const remus::proto::JobRequirements& reqs,
+                                 std::size_t& numberOfJobs);
+
+  //same as takeWorker, but a waiting worker in preferred is taken before
+  //any other waiting worker
+  zmq::SocketIdentity takeWorker(const remus::proto::JobRequirements& reqs,
+                                 std::size_t& numberOfJobs,
+                                 const std::set<zmq::SocketIdentity>& preferred);
+
+  //remove every registration of the worker with the given address, for
+  //workers that the server has told to shut down. Returns false if a
+  //worker with that address wasn't found
+  bool removeWorker(const zmq::SocketIdentity& address);
+
   //remove all workers that haven't responded based on the passed in monitor
   void purgeDeadWorkers(remus::server::detail::SocketMonitor monitor);
 
@@ -75,6 +107,12 @@ public:
   //return the socket identity of all workers that want to work on a job
   std::set<zmq::SocketIdentity> allWorkersWantingWork() const;
 
+  //returns a number that changes every time the answer of supportedIOTypes,
+  //waitingWorkerRequirements or haveWaitingWorker could have changed. This
+  //happens when workers register, become ready for work, take their
+  //last job or die
+  boost::uint64_t capabilitiesVersion() const { return this->Version; }
+
 private:
   struct WorkerInfo
   {
@@ -82,13 +120,15 @@ private:
     remus::proto::JobRequirements Reqs;
     zmq::SocketIdentity Address;
     bool IsResponsive; //as in we are getting heartbeating from the worker
+    bool AcceptsBatches; //the worker has sent us credits
 
     WorkerInfo(const zmq::SocketIdentity& address,
                const remus::proto::JobRequirements& type);
 
     bool isWaitingForWork() const { return NumberOfDesiredJobs > 0 && IsResponsive; }
     void addJob() { ++NumberOfDesiredJobs; }
-    void takesJob() { --NumberOfDesiredJobs; }
+    void addJobs(int count) { NumberOfDesiredJobs += count; }
+    void takesJobs(int count) { NumberOfDesiredJobs -= count; }
   };
 
   struct DeadWorkers
@@ -104,6 +144,7 @@ private:
   typedef std::vector<WorkerInfo>::const_iterator ConstIt;
   typedef std::vector<WorkerInfo>::iterator It;
   std::vector<WorkerInfo> Pool;
+  boost::uint64_t Version;
 };
 
 }
@@ -11,6 +11,7 @@
 //=============================================================================
 #include <remus/server/detail/ActiveJobs.h>
 
+#include <remus/common/ContentTypes.h>
 #include <remus/common/SleepFor.h>
 #include <remus/testing/Testing.h>
 
@@ -114,15 +115,20 @@ void verify_updating_status()
       REMUS_ASSERT( (jobs.status(uuids_used[0]).status() != status_type) );
 
       remus::proto::JobResult result(uuids_used[0]);
-      jobs.updateResult(result);
+      REMUS_ASSERT( (jobs.updateResult(result)) );
       REMUS_ASSERT( (jobs.status(uuids_used[0]).status() == status_type) );
       REMUS_ASSERT( (jobs.result(uuids_used[0]).valid() == false) );
 
       remus::proto::JobResult result_with_data =
                         remus::proto::make_JobResult(uuids_used[0],"data");
-      jobs.updateResult(result_with_data);
+      //a second result updates the data, but doesn't finish the job again
+      REMUS_ASSERT( (!jobs.updateResult(result_with_data)) );
       REMUS_ASSERT( (jobs.status(uuids_used[0]).status() == status_type) );
       REMUS_ASSERT( (jobs.result(uuids_used[0]).valid() == true) );
+
+      //results of jobs we don't know don't finish anything
+      remus::proto::JobResult unknown(remus::testing::UUIDGenerator());
+      REMUS_ASSERT( (!jobs.updateResult(unknown)) );
       }
     else
       {
@@ -361,6 +367,208 @@ void verify_expire_jobs()
 
 }
 
+void verify_status_waiters()
+{
+  typedef remus::server::detail::ActiveJobs::StatusWaiter StatusWaiter;
+  const boost::posix_time::ptime now =
+                          boost::posix_time::microsec_clock::local_time();
+
+  remus::server::detail::ActiveJobs jobs;
+  REMUS_ASSERT( (jobs.nextStatusWaiterDeadline().is_pos_infinity()) );
+
+  boost::uuids::uuid changingJob = remus::testing::UUIDGenerator();
+  boost::uuids::uuid idleJob = remus::testing::UUIDGenerator();
+  jobs.add(make_socketId(), changingJob);
+  jobs.add(make_socketId(), idleJob);
+
+  StatusWaiter changingWaiter;
+  changingWaiter.JobId = changingJob;
+  changingWaiter.Client = make_socketId();
+  changingWaiter.RequestId = "1";
+  changingWaiter.Deadline = now + boost::posix_time::seconds(60);
+  jobs.addStatusWaiter(changingWaiter);
+
+  StatusWaiter idleWaiter;
+  idleWaiter.JobId = idleJob;
+  idleWaiter.Client = make_socketId();
+  idleWaiter.RequestId = "2";
+  idleWaiter.Deadline = now + boost::posix_time::seconds(1);
+  jobs.addStatusWaiter(idleWaiter);
+
+  REMUS_ASSERT( (jobs.nextStatusWaiterDeadline() == idleWaiter.Deadline) );
+
+  //nothing has changed and no deadline has passed
+  REMUS_ASSERT( (jobs.takeStatusWaiters(now).size() == 0) );
+
+  //updating a job wakes up only the client waiting on that job
+  remus::proto::JobProgress progress(remus::IN_PROGRESS);
+  jobs.updateStatus( remus::proto::JobStatus(changingJob,progress) );
+  std::vector< StatusWaiter > ready = jobs.takeStatusWaiters(now);
+  REMUS_ASSERT( (ready.size() == 1) );
+  REMUS_ASSERT( (ready[0].JobId == changingJob) );
+  REMUS_ASSERT( (ready[0].RequestId == "1") );
+
+  //a waiter is only answered once
+  jobs.updateStatus( remus::proto::JobStatus(changingJob,remus::FAILED) );
+  REMUS_ASSERT( (jobs.takeStatusWaiters(now).size() == 0) );
+
+  //once the deadline passes the idle waiter is handed back
+  ready = jobs.takeStatusWaiters(now + boost::posix_time::seconds(2));
+  REMUS_ASSERT( (ready.size() == 1) );
+  REMUS_ASSERT( (ready[0].JobId == idleJob) );
+  REMUS_ASSERT( (jobs.nextStatusWaiterDeadline().is_pos_infinity()) );
+
+  //removing a job wakes up the clients waiting on it
+  idleWaiter.Deadline = now + boost::posix_time::seconds(60);
+  jobs.addStatusWaiter(idleWaiter);
+  jobs.remove(idleJob);
+  ready = jobs.takeStatusWaiters(now);
+  REMUS_ASSERT( (ready.size() == 1) );
+  REMUS_ASSERT( (ready[0].JobId == idleJob) );
+}
+
+void verify_listing_jobs()
+{
+  typedef remus::proto::JobListingRequest Request;
+  using namespace remus::meshtypes;
+  remus::server::detail::ActiveJobs jobs;
+
+  remus::proto::JobRequirements reqs(
+                             remus::common::ContentFormat::User,
+                             remus::common::MeshIOType(Edges(),Mesh2D()),
+                             "mesher", "" );
+  reqs.tag("tag");
+
+  const zmq::SocketIdentity workerA = make_socketId();
+  const zmq::SocketIdentity workerB = make_socketId();
+  std::vector< boost::uuids::uuid > ids;
+  for(int i=0; i < 4; ++i)
+    {
+    ids.push_back(remus::testing::UUIDGenerator());
+    jobs.add( (i == 0 ? workerB : workerA), ids.back(), reqs);
+    }
+  jobs.updateStatus(remus::proto::make_JobStatus(ids[1], 50));
+
+  const boost::posix_time::ptime now =
+                        boost::posix_time::microsec_clock::local_time();
+
+  Request request;
+  remus::proto::JobListing all;
+  REMUS_ASSERT( (jobs.listJobs(request, NULL, now, 10, all) == false) );
+  REMUS_ASSERT( (all.size() == 4) );
+  REMUS_ASSERT( (all.entries()[0].Location == Request::ACTIVE_JOBS) );
+  REMUS_ASSERT( (all.entries()[0].WorkerName == "mesher") );
+  REMUS_ASSERT( (all.entries()[0].Tag == "tag") );
+
+  //a full page reports that there are more jobs, and the next page
+  //continues after the last listed job
+  remus::proto::JobListing first;
+  REMUS_ASSERT( (jobs.listJobs(request, NULL, now, 3, first) == true) );
+  REMUS_ASSERT( (first.size() == 3) );
+  remus::proto::JobListing second;
+  REMUS_ASSERT( (jobs.listJobs(request, &first.entries().back().Id,
+                               now, 3, second) == false) );
+  REMUS_ASSERT( (second.size() == 1) );
+  REMUS_ASSERT( (second.entries()[0].Id == all.entries()[3].Id) );
+
+  //filter on the worker
+  remus::proto::JobListing onWorkerB;
+  request.worker(workerB.name());
+  jobs.listJobs(request, NULL, now, 10, onWorkerB);
+  REMUS_ASSERT( (onWorkerB.size() == 1) );
+  REMUS_ASSERT( (onWorkerB.entries()[0].Id == ids[0]) );
+  REMUS_ASSERT( (onWorkerB.entries()[0].Worker == workerB.name()) );
+
+  //filter on the status
+  remus::proto::JobListing inProgress;
+  request.worker(std::string());
+  request.status(remus::IN_PROGRESS);
+  jobs.listJobs(request, NULL, now, 10, inProgress);
+  REMUS_ASSERT( (inProgress.size() == 1) );
+  REMUS_ASSERT( (inProgress.entries()[0].Id == ids[1]) );
+  REMUS_ASSERT( (inProgress.entries()[0].Progress == 50) );
+
+  //active jobs aren't listed when only asking for queued jobs
+  remus::proto::JobListing none;
+  Request queuedOnly;
+  queuedOnly.locations(Request::QUEUED_JOBS);
+  jobs.listJobs(queuedOnly, NULL, now, 10, none);
+  REMUS_ASSERT( (none.size() == 0) );
+}
+
+void verify_take_unstarted_jobs()
+{
+  using namespace remus::meshtypes;
+  remus::server::detail::ActiveJobs jobs;
+
+  remus::proto::JobRequirements reqs(
+                             remus::common::ContentFormat::User,
+                             remus::common::MeshIOType(Edges(),Mesh2D()),
+                             "mesher", "" );
+  remus::proto::JobSubmission submission(reqs);
+  submission["data"] = remus::proto::make_JobContent("prefetched");
+
+  const zmq::SocketIdentity stopping = make_socketId();
+  const zmq::SocketIdentity other = make_socketId();
+
+  //the stopping worker was sent three jobs ahead of time, and only
+  //started on one of them
+  std::vector< boost::uuids::uuid > ids;
+  for(int i=0; i < 3; ++i)
+    {
+    ids.push_back(remus::testing::UUIDGenerator());
+    REMUS_ASSERT( (jobs.add(stopping,
+                     remus::proto::WorkerJob(ids.back(), submission))) );
+    }
+  const boost::uuids::uuid otherId = remus::testing::UUIDGenerator();
+  jobs.add(other, remus::proto::WorkerJob(otherId, submission));
+  jobs.updateStatus(remus::proto::make_JobStatus(ids[0], 10));
+
+  std::vector<remus::proto::WorkerJob> unstarted =
+                                        jobs.takeUnstartedJobs(stopping);
+  REMUS_ASSERT( (unstarted.size() == 2) );
+  for(std::size_t i=0; i < unstarted.size(); ++i)
+    {
+    //the jobs come back with their submission so they can be queued again
+    REMUS_ASSERT( (unstarted[i].id() == ids[1] || unstarted[i].id() == ids[2]) );
+    REMUS_ASSERT( (unstarted[i].submission() == submission) );
+    REMUS_ASSERT( (jobs.haveUUID(unstarted[i].id()) == false) );
+    }
+
+  //the started job stays with the worker, and other workers are untouched
+  REMUS_ASSERT( (jobs.haveUUID(ids[0]) == true) );
+  REMUS_ASSERT( (jobs.haveUUID(otherId) == true) );
+  REMUS_ASSERT( (jobs.workingJobsPerWorker().find(stopping)->second == 1) );
+  REMUS_ASSERT( (jobs.takeUnstartedJobs(stopping).empty()) );
+  REMUS_ASSERT( (jobs.takeUnstartedJobs(make_socketId()).empty()) );
+}
+
+void verify_results_finish_once()
+{
+  remus::server::detail::ActiveJobs jobs;
+  const zmq::SocketIdentity worker = make_socketId();
+  const boost::uuids::uuid good = remus::testing::UUIDGenerator();
+  const boost::uuids::uuid failed = remus::testing::UUIDGenerator();
+  jobs.add(worker, good);
+  jobs.add(worker, failed);
+
+  //only the first result of a job moves it to finished
+  REMUS_ASSERT( (jobs.updateResult(remus::proto::JobResult(good))) );
+  REMUS_ASSERT( (!jobs.updateResult(remus::proto::make_JobResult(good,"data"))) );
+  REMUS_ASSERT( (jobs.status(good).status() == remus::FINISHED) );
+  REMUS_ASSERT( (jobs.result(good).valid()) );
+
+  //failed jobs stay failed
+  jobs.updateStatus(remus::proto::JobStatus(failed, remus::FAILED));
+  REMUS_ASSERT( (!jobs.updateResult(remus::proto::JobResult(failed))) );
+  REMUS_ASSERT( (jobs.status(failed).status() == remus::FAILED) );
+
+  //and results of jobs we don't know about are ignored
+  const boost::uuids::uuid unknown = remus::testing::UUIDGenerator();
+  REMUS_ASSERT( (!jobs.updateResult(remus::proto::JobResult(unknown))) );
+  REMUS_ASSERT( (jobs.haveUUID(unknown) == false) );
+}
+
 } //namespace
 
 int UnitTestActiveJobs(int, char *[])
@@ -375,5 +583,13 @@ int UnitTestActiveJobs(int, char *[])
 
   verify_expire_jobs();
 
+  verify_status_waiters();
+
+  verify_listing_jobs();
+
+  verify_take_unstarted_jobs();
+
+  verify_results_finish_once();
+
   return 0;
 }
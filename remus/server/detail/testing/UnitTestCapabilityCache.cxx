@@ -0,0 +1,144 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/server/detail/CapabilityCache.h>
+#include <remus/server/detail/WorkerPool.h>
+
+#include <remus/proto/zmqHelper.h>
+#include <remus/testing/Testing.h>
+
+namespace {
+
+using namespace remus::common;
+using namespace remus::meshtypes;
+
+const remus::proto::JobRequirements reqs2D(ContentFormat::User,
+                                           MeshIOType(Edges(),Mesh2D()),
+                                           "", "" );
+
+//makes a random socket identity
+zmq::SocketIdentity make_socketId()
+{
+  boost::uuids::uuid new_uid = remus::testing::UUIDGenerator();
+  const std::string str_id = boost::lexical_cast<std::string>(new_uid);
+  return zmq::SocketIdentity(str_id.c_str(),str_id.size());
+}
+
+void verify_cache(zmq::socket_t& socket)
+{
+  const MeshIOType types2D = MeshIOType(Edges(),Mesh2D());
+  const MeshIOType types3D = MeshIOType(Edges(),Mesh3D());
+
+  remus::proto::Message can2D =
+      remus::proto::send_Message(types2D, remus::CAN_MESH_IO_TYPE, &socket);
+  remus::proto::Message can3D =
+      remus::proto::send_Message(types3D, remus::CAN_MESH_IO_TYPE, &socket);
+  remus::proto::Message reqs2D_a =
+      remus::proto::send_Message(types2D, remus::MESH_REQUIREMENTS_FOR_IO_TYPE,
+                                 std::string("a"), &socket);
+  remus::proto::Message reqs2D_b =
+      remus::proto::send_Message(types2D, remus::MESH_REQUIREMENTS_FOR_IO_TYPE,
+                                 std::string("b"), &socket);
+
+  remus::server::detail::CapabilityCache cache;
+  cache.validate(0,1,0);
+  REMUS_ASSERT( (cache.find(can2D) == NULL) );
+
+  cache.store(can2D, "1\n");
+  REMUS_ASSERT( (cache.find(can2D) != NULL) );
+  REMUS_ASSERT( (*cache.find(can2D) == "1\n") );
+
+  //the mesh types, service and data all take part in the lookup
+  REMUS_ASSERT( (cache.find(can3D) == NULL) );
+  cache.store(reqs2D_a, "a\n");
+  REMUS_ASSERT( (cache.find(reqs2D_b) == NULL) );
+  REMUS_ASSERT( (*cache.find(reqs2D_a) == "a\n") );
+  REMUS_ASSERT( (cache.size() == 2) );
+
+  //validating against the same versions keeps the responses
+  const boost::uint64_t generation = cache.generation();
+  cache.validate(0,1,0);
+  REMUS_ASSERT( (cache.size() == 2) );
+  REMUS_ASSERT( (cache.generation() == generation) );
+
+  //a change to either version drops them
+  cache.validate(0,1,1);
+  REMUS_ASSERT( (cache.size() == 0) );
+  REMUS_ASSERT( (cache.find(can2D) == NULL) );
+  REMUS_ASSERT( (cache.generation() == generation + 1) );
+
+  cache.store(can2D, "0\n");
+  cache.validate(1,1,1);
+  REMUS_ASSERT( (cache.size() == 0) );
+
+  //and so does a change to the max worker count of the factory
+  cache.store(can2D, "1\n");
+  cache.validate(1,0,1);
+  REMUS_ASSERT( (cache.size() == 0) );
+
+  //the cache never grows past its max size
+  remus::server::detail::CapabilityCache small(2);
+  small.store(can2D, "1\n");
+  small.store(can3D, "0\n");
+  small.store(reqs2D_a, "a\n");
+  REMUS_ASSERT( (small.size() == 1) );
+  REMUS_ASSERT( (*small.find(reqs2D_a) == "a\n") );
+}
+
+void verify_pool_versions()
+{
+  remus::server::detail::WorkerPool pool;
+  const zmq::SocketIdentity worker = make_socketId();
+
+  boost::uint64_t version = pool.capabilitiesVersion();
+
+  //registering a worker changes the supported types
+  pool.addWorker(worker, reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() != version) );
+  version = pool.capabilitiesVersion();
+
+  //registering the same worker again doesn't
+  pool.addWorker(worker, reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() == version) );
+
+  //a worker that starts waiting for work changes the answer of canMesh,
+  //asking for more work while already waiting doesn't
+  pool.readyForWork(worker, reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() != version) );
+  version = pool.capabilitiesVersion();
+  pool.readyForWork(worker, reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() == version) );
+
+  //only taking the last job stops the worker from waiting
+  pool.takeWorker(reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() == version) );
+  pool.takeWorker(reqs2D);
+  REMUS_ASSERT( (pool.capabilitiesVersion() != version) );
+}
+
+} //namespace
+
+int UnitTestCapabilityCache(int, char *[])
+{
+  zmq::context_t context(0);
+  zmq::socket_t in_socket(context, ZMQ_PAIR);
+  zmq::socket_t out_socket(context, ZMQ_PAIR);
+
+  zmq::socketInfo<zmq::proto::inproc> channel(remus::testing::UniqueString());
+  zmq::bindToAddress(in_socket, channel);
+  zmq::connectToAddress(out_socket, channel);
+
+  verify_cache(in_socket);
+
+  verify_pool_versions();
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ContentCaches.h>
+#include <remus/server/detail/WorkerPool.h>
+
+#include <remus/proto/zmqSocketIdentity.h>
+#include <remus/server/detail/uuidHelper.h>
+
+#include <remus/testing/Testing.h>
+
+#include <vector>
+
+namespace {
+
+using namespace remus::common;
+using namespace remus::meshtypes;
+
+const remus::proto::JobRequirements reqs2D(ContentFormat::User,
+                                           MeshIOType(Edges(),Mesh2D()),
+                                           "", "" );
+
+//makes a random socket identity
+zmq::SocketIdentity make_socketId()
+{
+  boost::uuids::uuid new_uid = remus::testing::UUIDGenerator();
+  const std::string str_id = boost::lexical_cast<std::string>(new_uid);
+  return zmq::SocketIdentity(str_id.c_str(),str_id.size());
+}
+
+//makes a job whose model is large enough to be cached, and whose
+//options are too small to be cached
+remus::worker::Job make_Job(const std::string& model)
+{
+  remus::proto::JobSubmission sub(reqs2D);
+  sub["model"] = remus::proto::make_JobContent(model);
+  sub["options"] = remus::proto::make_JobContent(std::string("fast"));
+  return remus::worker::Job(remus::testing::UUIDGenerator(), sub);
+}
+
+void verify_configure()
+{
+  remus::server::detail::ContentCaches caches;
+  REMUS_ASSERT( (caches.empty()) );
+
+  const zmq::SocketIdentity worker = make_socketId();
+  caches.configure(worker, remus::proto::ContentCacheIndex(4096, 1024));
+  REMUS_ASSERT( (!caches.empty()) );
+  REMUS_ASSERT( (caches.index(worker).enabled()) );
+  REMUS_ASSERT( (caches.index(worker).maxBytes() == 4096) );
+
+  //a disabled index stops mirroring the worker
+  caches.configure(worker, remus::proto::ContentCacheIndex());
+  REMUS_ASSERT( (caches.empty()) );
+  REMUS_ASSERT( (!caches.index(worker).enabled()) );
+
+  caches.configure(worker, remus::proto::ContentCacheIndex(4096, 1024));
+  caches.remove(worker);
+  REMUS_ASSERT( (caches.empty()) );
+
+  //workers the monitor doesn't know about are dead
+  caches.configure(worker, remus::proto::ContentCacheIndex(4096, 1024));
+  remus::server::detail::SocketMonitor monitor;
+  monitor.refresh(worker);
+  caches.purgeDeadWorkers(monitor);
+  REMUS_ASSERT( (!caches.empty()) );
+  monitor.markAsDead(worker);
+  caches.purgeDeadWorkers(monitor);
+  REMUS_ASSERT( (caches.empty()) );
+}
+
+void verify_references()
+{
+  const std::string model = remus::testing::BinaryDataGenerator(2048);
+  const zmq::SocketIdentity worker = make_socketId();
+  const zmq::SocketIdentity uncached = make_socketId();
+
+  remus::server::detail::ContentCaches caches;
+  caches.configure(worker, remus::proto::ContentCacheIndex(4096, 1024));
+
+  //workers without a cache are sent the jobs as they are
+  std::vector<remus::worker::Job> jobs(1, make_Job(model));
+  remus::proto::ContentCacheIndex updated;
+  REMUS_ASSERT( (!caches.referenceCachedContent(uncached, jobs, updated)) );
+
+  //the first time the worker is sent the model it gets the content
+  REMUS_ASSERT( (caches.referenceCachedContent(worker, jobs, updated)) );
+  remus::proto::JobContent content;
+  REMUS_ASSERT( (jobs[0].details("model", content)) );
+  REMUS_ASSERT( (!content.isReference()) );
+  REMUS_ASSERT( (updated.size() == 1) );
+
+  //until the jobs have been sent the index doesn't change
+  REMUS_ASSERT( (caches.index(worker).size() == 0) );
+  REMUS_ASSERT( (caches.preferredWorkers(jobs[0].submission()).empty()) );
+  caches.update(worker, updated);
+  REMUS_ASSERT( (caches.index(worker).size() == 1) );
+
+  //after that the model is sent by reference, and the options aren't
+  //touched as they are too small to be cached
+  std::vector<remus::worker::Job> next(1, make_Job(model));
+  const boost::uuids::uuid nextId = next[0].id();
+  REMUS_ASSERT( (caches.referenceCachedContent(worker, next, updated)) );
+  REMUS_ASSERT( (next[0].valid()) );
+  REMUS_ASSERT( (next[0].id() == nextId) );
+  REMUS_ASSERT( (next[0].details("model", content)) );
+  REMUS_ASSERT( (content.isReference()) );
+  REMUS_ASSERT( (content.referencedHash() == make_Job(model).submission().
+                                              find("model")->second.hash()) );
+  REMUS_ASSERT( (next[0].details("options") == "fast") );
+
+  //the worker holding the model is preferred for any job with the model
+  std::set<zmq::SocketIdentity> preferred =
+                        caches.preferredWorkers(make_Job(model).submission());
+  REMUS_ASSERT( (preferred.size() == 1) );
+  REMUS_ASSERT( (preferred.count(worker) == 1) );
+}
+
+void verify_preferred_worker_pool()
+{
+  const zmq::SocketIdentity first = make_socketId();
+  const zmq::SocketIdentity second = make_socketId();
+
+  remus::server::detail::WorkerPool pool;
+  pool.addWorker(first, reqs2D);
+  pool.addWorker(second, reqs2D);
+  pool.readyForWork(first, reqs2D);
+  pool.readyForWork(second, reqs2D);
+
+  //the preferred worker is taken first, even if it isn't next in line
+  std::set<zmq::SocketIdentity> preferred;
+  preferred.insert(second);
+  std::size_t numberOfJobs = 1;
+  REMUS_ASSERT( (pool.takeWorker(reqs2D, numberOfJobs, preferred) == second) );
+  REMUS_ASSERT( (numberOfJobs == 1) );
+
+  //when no preferred worker is waiting, any worker is taken
+  numberOfJobs = 1;
+  REMUS_ASSERT( (pool.takeWorker(reqs2D, numberOfJobs, preferred) == first) );
+  numberOfJobs = 1;
+  pool.takeWorker(reqs2D, numberOfJobs, preferred);
+  REMUS_ASSERT( (numberOfJobs == 0) );
+}
+
+} //namespace
+
+int UnitTestContentCaches(int, char *[])
+{
+  verify_configure();
+  verify_references();
+  verify_preferred_worker_pool();
+  return 0;
+}
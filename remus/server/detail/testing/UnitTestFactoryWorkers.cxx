@@ -0,0 +1,128 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ActiveJobs.h>
+#include <remus/server/detail/FactoryWorkers.h>
+
+#include <remus/proto/zmqSocketIdentity.h>
+#include <remus/server/detail/uuidHelper.h>
+
+#include <remus/testing/Testing.h>
+
+namespace {
+
+//makes a random socket identity
+zmq::SocketIdentity make_socketId()
+{
+  boost::uuids::uuid new_uid = remus::testing::UUIDGenerator();
+  const std::string str_id = boost::lexical_cast<std::string>(new_uid);
+  return zmq::SocketIdentity(str_id.c_str(),str_id.size());
+}
+
+void verify_claims()
+{
+  remus::server::detail::FactoryWorkers factoryWorkers;
+  REMUS_ASSERT( (factoryWorkers.empty()) );
+
+  const zmq::SocketIdentity launched = make_socketId();
+  const zmq::SocketIdentity external = make_socketId();
+
+  //workers started outside of the factory claim no reservation
+  factoryWorkers.claimed(external, std::string());
+  REMUS_ASSERT( (factoryWorkers.empty()) );
+
+  factoryWorkers.claimed(launched, "warm");
+  REMUS_ASSERT( (!factoryWorkers.empty()) );
+
+  std::set<zmq::SocketIdentity> workers;
+  workers.insert(launched);
+  workers.insert(external);
+  std::set<std::string> reservations = factoryWorkers.reservations(workers);
+  REMUS_ASSERT( (reservations.size() == 1) );
+  REMUS_ASSERT( (reservations.count("warm") == 1) );
+
+  std::set<zmq::SocketIdentity> found = factoryWorkers.workers(reservations);
+  REMUS_ASSERT( (found.size() == 1) );
+  REMUS_ASSERT( (found.count(launched) == 1) );
+
+  reservations.clear();
+  reservations.insert("unknown");
+  REMUS_ASSERT( (factoryWorkers.workers(reservations).empty()) );
+
+  factoryWorkers.remove(launched);
+  REMUS_ASSERT( (factoryWorkers.empty()) );
+}
+
+void verify_purge()
+{
+  remus::server::detail::FactoryWorkers factoryWorkers;
+  const zmq::SocketIdentity worker = make_socketId();
+  factoryWorkers.claimed(worker, "warm");
+
+  remus::server::detail::SocketMonitor monitor;
+  monitor.refresh(worker);
+  factoryWorkers.purgeDeadWorkers(monitor);
+  REMUS_ASSERT( (!factoryWorkers.empty()) );
+
+  monitor.markAsDead(worker);
+  factoryWorkers.purgeDeadWorkers(monitor);
+  REMUS_ASSERT( (factoryWorkers.empty()) );
+}
+
+void verify_busy_workers_not_idle()
+{
+  remus::server::detail::FactoryWorkers factoryWorkers;
+  remus::server::detail::ActiveJobs activeJobs;
+
+  const zmq::SocketIdentity idleWorker = make_socketId();
+  const zmq::SocketIdentity busyWorker = make_socketId();
+  factoryWorkers.claimed(idleWorker, "idle");
+  factoryWorkers.claimed(busyWorker, "busy");
+
+  //both workers still ask for work, but one of them is processing a job
+  std::set<zmq::SocketIdentity> wanting;
+  wanting.insert(idleWorker);
+  wanting.insert(busyWorker);
+
+  const boost::uuids::uuid jobId = remus::testing::UUIDGenerator();
+  REMUS_ASSERT( (activeJobs.add(busyWorker, jobId)) );
+  activeJobs.updateStatus(
+    remus::proto::JobStatus(jobId, remus::proto::JobProgress(50)) );
+
+  std::set<std::string> idle =
+    factoryWorkers.idleReservations(wanting,
+                                    activeJobs.workingJobsPerWorker());
+  REMUS_ASSERT( (idle.size() == 1) );
+  REMUS_ASSERT( (idle.count("idle") == 1) );
+
+  //retiring every idle worker must leave the busy one running
+  std::set<zmq::SocketIdentity> retired = factoryWorkers.workers(idle);
+  REMUS_ASSERT( (retired.size() == 1) );
+  REMUS_ASSERT( (retired.count(idleWorker) == 1) );
+  REMUS_ASSERT( (retired.count(busyWorker) == 0) );
+
+  //once the job is finished the worker is idle again
+  activeJobs.updateResult(remus::proto::JobResult(jobId));
+  idle = factoryWorkers.idleReservations(wanting,
+                                         activeJobs.workingJobsPerWorker());
+  REMUS_ASSERT( (idle.size() == 2) );
+}
+
+} //namespace
+
+int UnitTestFactoryWorkers(int, char *[])
+{
+  verify_claims();
+  verify_purge();
+  verify_busy_workers_not_idle();
+  return 0;
+}
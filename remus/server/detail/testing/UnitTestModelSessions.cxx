@@ -0,0 +1,300 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/server/detail/ModelSessions.h>
+
+#include <remus/proto/ModelSession.h>
+#include <remus/proto/SMTKMeshSubmission.h>
+#include <remus/server/detail/uuidHelper.h>
+
+#include <remus/testing/Testing.h>
+
+namespace {
+
+using namespace remus::common;
+using namespace remus::meshtypes;
+
+typedef boost::posix_time::ptime ptime;
+
+const remus::proto::JobRequirements reqs2D(ContentFormat::User,
+                                           MeshIOType(Model(),Mesh2D()),
+                                           "", "" );
+
+//makes a random socket identity
+zmq::SocketIdentity make_socketId()
+{
+  boost::uuids::uuid new_uid = remus::testing::UUIDGenerator();
+  const std::string str_id = boost::lexical_cast<std::string>(new_uid);
+  return zmq::SocketIdentity(str_id.c_str(),str_id.size());
+}
+
+remus::proto::SMTKMeshSubmission make_Submission(const std::string& session,
+                                                 const std::string& attributes)
+{
+  remus::proto::SMTKMeshSubmission sub(reqs2D);
+  sub.session(session);
+  sub.attributes(attributes, ContentFormat::XML);
+  sub.modelItemsToMesh(std::string("{\"ids\":[]}"), ContentFormat::JSON);
+  return sub;
+}
+
+void verify_contents()
+{
+  const ptime now = boost::posix_time::microsec_clock::local_time();
+  remus::proto::SMTKMeshSubmission contents(reqs2D);
+  contents.model(std::string("the model"), ContentFormat::JSON);
+  contents.attributes(std::string("default attributes"), ContentFormat::XML);
+
+  remus::server::detail::ModelSessions sessions;
+  REMUS_ASSERT( (sessions.empty()) );
+  sessions.open("a", contents, 1, now);
+  REMUS_ASSERT( (sessions.contains("a")) );
+  REMUS_ASSERT( (sessions.size() == 1) );
+
+  //the submission gets the model of the session, but keeps its own
+  //attributes
+  remus::proto::SMTKMeshSubmission sub = make_Submission("a", "fine");
+  REMUS_ASSERT( (sub.hasAllComponents()) );
+  REMUS_ASSERT( (sub.session() == "a") );
+  REMUS_ASSERT( (sessions.addSessionContents(sub, now)) );
+  REMUS_ASSERT( (sub.hasAllComponents()) );
+  const remus::proto::JobContent model = sub.model();
+  REMUS_ASSERT( (std::string(model.data(), model.dataSize()) == "the model") );
+  const remus::proto::JobContent attributes = sub.attributes();
+  REMUS_ASSERT( (std::string(attributes.data(), attributes.dataSize()) == "fine") );
+
+  //submissions without a session are left alone
+  remus::proto::JobSubmission plain(reqs2D);
+  REMUS_ASSERT( (sessions.addSessionContents(plain, now)) );
+  REMUS_ASSERT( (plain.find("model") == plain.end()) );
+
+  //submissions of a closed session are refused
+  REMUS_ASSERT( (sessions.close("a")) );
+  REMUS_ASSERT( (!sessions.close("a")) );
+  remus::proto::SMTKMeshSubmission closed = make_Submission("a", "fine");
+  REMUS_ASSERT( (!sessions.addSessionContents(closed, now)) );
+}
+
+void verify_pinning()
+{
+  const ptime now = boost::posix_time::microsec_clock::local_time();
+  remus::server::detail::ModelSessions sessions;
+  sessions.open("one", remus::proto::JobSubmission(reqs2D), 1, now);
+  sessions.open("two", remus::proto::JobSubmission(reqs2D), 2, now);
+
+  const zmq::SocketIdentity w1 = make_socketId();
+  const zmq::SocketIdentity w2 = make_socketId();
+  const zmq::SocketIdentity w3 = make_socketId();
+
+  const remus::proto::SMTKMeshSubmission one = make_Submission("one", "");
+  const remus::proto::SMTKMeshSubmission two = make_Submission("two", "");
+  REMUS_ASSERT( (sessions.pinnedWorkers(one).empty()) );
+
+  //a session is pinned to the first workers that are sent its jobs
+  sessions.dispatched(one, w1);
+  sessions.dispatched(one, w2);
+  REMUS_ASSERT( (sessions.pinnedWorkers(one).size() == 1) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(one).count(w1) == 1) );
+
+  sessions.dispatched(two, w2);
+  sessions.dispatched(two, w2);
+  sessions.dispatched(two, w3);
+  sessions.dispatched(two, w1);
+  REMUS_ASSERT( (sessions.pinnedWorkers(two).size() == 2) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(two).count(w2) == 1) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(two).count(w3) == 1) );
+
+  //dead workers are unpinned, which makes room for other workers
+  remus::server::detail::SocketMonitor monitor;
+  monitor.refresh(w1);
+  monitor.refresh(w2);
+  sessions.purgeDeadWorkers(monitor);
+  REMUS_ASSERT( (sessions.pinnedWorkers(one).count(w1) == 1) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(two).size() == 1) );
+  sessions.dispatched(two, w1);
+  REMUS_ASSERT( (sessions.pinnedWorkers(two).count(w1) == 1) );
+}
+
+void verify_expiration()
+{
+  const ptime start = boost::posix_time::microsec_clock::local_time();
+  const ptime later = start + boost::posix_time::minutes(10);
+
+  remus::server::detail::ModelSessions sessions;
+  sessions.open("idle", remus::proto::JobSubmission(reqs2D), 1, start);
+  sessions.open("used", remus::proto::JobSubmission(reqs2D), 1, start);
+
+  //using a session keeps it open
+  remus::proto::SMTKMeshSubmission sub = make_Submission("used", "");
+  REMUS_ASSERT( (sessions.addSessionContents(sub, later)) );
+
+  REMUS_ASSERT( (sessions.expire(start) == 0) );
+  REMUS_ASSERT( (sessions.expire(later) == 1) );
+  REMUS_ASSERT( (!sessions.contains("idle")) );
+  REMUS_ASSERT( (sessions.contains("used")) );
+}
+
+void verify_worker_contents()
+{
+  const ptime now = boost::posix_time::microsec_clock::local_time();
+  remus::proto::SMTKMeshSubmission contents(reqs2D);
+  contents.model(std::string("the model"), ContentFormat::JSON);
+  contents.attributes(std::string("default attributes"), ContentFormat::XML);
+
+  remus::server::detail::ModelSessions sessions;
+  sessions.open("a", contents, 2, now);
+
+  const zmq::SocketIdentity w1 = make_socketId();
+  const zmq::SocketIdentity w2 = make_socketId();
+  typedef std::map<std::string,remus::proto::JobSubmission> NewSessions;
+
+  //the first job a worker is sent opens the session on the worker, and
+  //the job doesn't carry the model, but keeps its own attributes
+  remus::proto::SMTKMeshSubmission sub = make_Submission("a", "fine");
+  REMUS_ASSERT( (sessions.addSessionContents(sub, now)) );
+  remus::proto::JobSubmission first = sub;
+  NewSessions opened;
+  REMUS_ASSERT( (sessions.removeSessionContents(first, w1, opened)) );
+  REMUS_ASSERT( (opened.size() == 1) );
+  REMUS_ASSERT( (opened["a"] == contents) );
+  REMUS_ASSERT( (first.find(sub.model_key()) == first.end()) );
+  REMUS_ASSERT( (first.find(sub.attribute_key()) != first.end()) );
+  REMUS_ASSERT( (remus::proto::to_ModelSessionId(first) == "a") );
+
+  //the worker adds the contents back, which gives the submission we had
+  remus::proto::JobSubmission filled = first;
+  filled.insert(opened["a"].begin(), opened["a"].end());
+  REMUS_ASSERT( (filled == sub) );
+
+  //later jobs for the same worker don't open the session again
+  remus::proto::JobSubmission second = sub;
+  opened.clear();
+  REMUS_ASSERT( (sessions.removeSessionContents(second, w1, opened)) );
+  REMUS_ASSERT( (opened.empty()) );
+  REMUS_ASSERT( (second.find(sub.model_key()) == second.end()) );
+
+  //but another worker needs the contents
+  remus::proto::JobSubmission third = sub;
+  REMUS_ASSERT( (sessions.removeSessionContents(third, w2, opened)) );
+  REMUS_ASSERT( (opened.size() == 1) );
+
+  //submissions without a session are sent as they are
+  remus::proto::JobSubmission plain(reqs2D);
+  plain[sub.model_key()] = remus::proto::make_JobContent(std::string("mine"));
+  opened.clear();
+  REMUS_ASSERT( (!sessions.removeSessionContents(plain, w1, opened)) );
+  REMUS_ASSERT( (plain.find(sub.model_key()) != plain.end()) );
+  REMUS_ASSERT( (opened.empty()) );
+
+  //closing the session lets us tell the workers that hold it
+  REMUS_ASSERT( (sessions.takeClosedSessions().empty()) );
+  REMUS_ASSERT( (sessions.close("a")) );
+  remus::server::detail::ModelSessions::ClosedSessions closed =
+                                              sessions.takeClosedSessions();
+  REMUS_ASSERT( (closed.size() == 1) );
+  REMUS_ASSERT( (closed[0].first == "a") );
+  REMUS_ASSERT( (closed[0].second.size() == 2) );
+  REMUS_ASSERT( (closed[0].second.count(w1) == 1) );
+  REMUS_ASSERT( (sessions.takeClosedSessions().empty()) );
+
+  //and so do expired sessions
+  sessions.open("b", contents, 1, now);
+  remus::proto::SMTKMeshSubmission expiring = make_Submission("b", "");
+  REMUS_ASSERT( (sessions.addSessionContents(expiring, now)) );
+  remus::proto::JobSubmission sent = expiring;
+  REMUS_ASSERT( (sessions.removeSessionContents(sent, w2, opened)) );
+  REMUS_ASSERT( (sessions.expire(now + boost::posix_time::minutes(1)) == 1) );
+  closed = sessions.takeClosedSessions();
+  REMUS_ASSERT( (closed.size() == 1) );
+  REMUS_ASSERT( (closed[0].first == "b") );
+  REMUS_ASSERT( (closed[0].second.count(w2) == 1) );
+}
+
+void verify_sent_jobs_pin()
+{
+  const ptime now = boost::posix_time::microsec_clock::local_time();
+  remus::proto::SMTKMeshSubmission contents(reqs2D);
+  contents.model(std::string("the model"), ContentFormat::JSON);
+
+  remus::server::detail::ModelSessions sessions;
+  sessions.open("a", contents, 1, now);
+
+  const zmq::SocketIdentity w1 = make_socketId();
+  const zmq::SocketIdentity w2 = make_socketId();
+  typedef std::map<std::string,remus::proto::JobSubmission> NewSessions;
+
+  //a job that is sent without being dispatched, such as a job a worker
+  //claims from a reservation, still pins the session to the worker
+  remus::proto::SMTKMeshSubmission sub = make_Submission("a", "fine");
+  REMUS_ASSERT( (sessions.addSessionContents(sub, now)) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(sub).empty()) );
+  remus::proto::JobSubmission claimed = sub;
+  NewSessions opened;
+  REMUS_ASSERT( (sessions.removeSessionContents(claimed, w1, opened)) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(sub).size() == 1) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(sub).count(w1) == 1) );
+
+  //and the session stays pinned to the workers it has room for
+  remus::proto::JobSubmission other = sub;
+  REMUS_ASSERT( (sessions.removeSessionContents(other, w2, opened)) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(sub).size() == 1) );
+  REMUS_ASSERT( (sessions.pinnedWorkers(sub).count(w1) == 1) );
+}
+
+void verify_request_serialization()
+{
+  remus::proto::SMTKMeshSubmission contents(reqs2D);
+  contents.model(std::string("the model"), ContentFormat::JSON);
+
+  const std::string payload = remus::proto::to_ModelSessionRequest(contents, 3);
+  remus::proto::JobSubmission from_wire;
+  std::size_t maxWorkers = 0;
+  REMUS_ASSERT( (remus::proto::from_ModelSessionRequest(payload.data(),
+                                                        payload.size(),
+                                                        from_wire,
+                                                        maxWorkers)) );
+  REMUS_ASSERT( (maxWorkers == 3) );
+  REMUS_ASSERT( (from_wire == contents) );
+
+  const std::string garbage("no workers");
+  REMUS_ASSERT( (!remus::proto::from_ModelSessionRequest(garbage.data(),
+                                                         garbage.size(),
+                                                         from_wire,
+                                                         maxWorkers)) );
+
+  //the contents sent to a worker
+  const std::string sent = remus::proto::to_ModelSessionContents("a", contents);
+  std::string id;
+  REMUS_ASSERT( (remus::proto::from_ModelSessionContents(sent.data(),
+                                                         sent.size(),
+                                                         id,
+                                                         from_wire)) );
+  REMUS_ASSERT( (id == "a") );
+  REMUS_ASSERT( (from_wire == contents) );
+  REMUS_ASSERT( (!remus::proto::from_ModelSessionContents(garbage.data(),
+                                                          garbage.size(),
+                                                          id,
+                                                          from_wire)) );
+}
+
+} //namespace
+
+int UnitTestModelSessions(int, char *[])
+{
+  verify_contents();
+  verify_pinning();
+  verify_expiration();
+  verify_worker_contents();
+  verify_sent_jobs_pin();
+  verify_request_serialization();
+  return 0;
+}
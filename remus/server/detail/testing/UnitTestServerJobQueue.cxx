@@ -212,6 +212,214 @@ void verify_dispatch_jobs()
   REMUS_ASSERT( (queue.waitingJobRequirements().count(worker_type3D) == 0) );
 }
 
+void verify_listing_jobs()
+{
+  typedef remus::proto::JobListingRequest Request;
+  remus::server::detail::JobQueue queue;
+
+  for(int i=0; i < 5; ++i)
+    {
+    queue.addJob(make_id(), make_jobSubmission(Edges(),Mesh2D()));
+    }
+  queue.addJob(make_id(), make_jobSubmission(Edges(),Mesh3D()));
+  queue.workerDispatched(worker_type3D);
+
+  const boost::posix_time::ptime now =
+                        boost::posix_time::microsec_clock::local_time();
+
+  //page through the queued jobs two at a time, the pages should
+  //hold each job exactly once in id order
+  Request request;
+  request.locations(Request::QUEUED_JOBS);
+
+  std::vector< boost::uuids::uuid > listed;
+  const boost::uuids::uuid* after = NULL;
+  bool more = true;
+  while(more)
+    {
+    remus::proto::JobListing page;
+    more = queue.listJobs(request, Request::QUEUED_JOBS, after, now, 2, page);
+    REMUS_ASSERT( (page.size() <= 2) );
+    for(remus::proto::JobListing::const_iterator i = page.begin();
+        i != page.end(); ++i)
+      {
+      REMUS_ASSERT( (i->Location == Request::QUEUED_JOBS) );
+      REMUS_ASSERT( (i->Status == remus::QUEUED) );
+      REMUS_ASSERT( (i->MeshTypes == worker_type2D.meshTypes()) );
+      listed.push_back(i->Id);
+      }
+    after = &listed.back();
+    }
+  REMUS_ASSERT( (listed.size() == 5) );
+  for(std::size_t i=1; i < listed.size(); ++i)
+    {
+    REMUS_ASSERT( (listed[i-1] < listed[i]) );
+    }
+
+  //the job waiting for a worker is listed separately
+  remus::proto::JobListing waiting;
+  request.locations(Request::ALL_JOBS);
+  queue.listJobs(request, Request::WAITING_FOR_WORKER_JOBS, NULL, now, 10,
+                 waiting);
+  REMUS_ASSERT( (waiting.size() == 1) );
+  REMUS_ASSERT( (waiting.entries()[0].MeshTypes == worker_type3D.meshTypes()) );
+
+  //filters are applied before the page size
+  remus::proto::JobListing filtered;
+  request.meshTypes(worker_type3D.meshTypes());
+  more = queue.listJobs(request, Request::QUEUED_JOBS, NULL, now, 1, filtered);
+  REMUS_ASSERT( (filtered.size() == 0) );
+  REMUS_ASSERT( (more == false) );
+
+  //jobs that are too young aren't listed
+  remus::proto::JobListing young;
+  Request oldJobs;
+  oldJobs.minimumAge(60 * 1000);
+  queue.listJobs(oldJobs, Request::QUEUED_JOBS, NULL, now, 10, young);
+  REMUS_ASSERT( (young.size() == 0) );
+}
+
+void verify_job_arrays()
+{
+  typedef remus::proto::JobArraySubmission ArraySubmission;
+  remus::server::detail::JobQueue queue;
+
+  remus::proto::JobSubmission base(worker_type2D,
+                                   remus::proto::make_JobContent("model"));
+  boost::shared_ptr<ArraySubmission> sweep(new ArraySubmission(base));
+  sweep->addElement("size", remus::proto::make_JobContent("0.5"));
+  sweep->addElement("size", remus::proto::make_JobContent("0.25"));
+  sweep->addElement("size", remus::proto::make_JobContent("0.125"));
+
+  //empty arrays aren't queued
+  const boost::shared_ptr<ArraySubmission> empty(new ArraySubmission(base));
+  REMUS_ASSERT( (queue.addJobArray(make_id(), empty) == false) );
+
+  const boost::uuids::uuid arrayId =
+                            remus::proto::make_JobArrayId(make_id());
+  const remus::proto::JobArray array(arrayId, worker_type2D.meshTypes(), 3);
+  queue.addJob(make_id(), make_jobSubmission(Edges(),Mesh3D()));
+  REMUS_ASSERT( (queue.addJobArray(arrayId, sweep) == true) );
+  REMUS_ASSERT( (queue.addJobArray(arrayId, sweep) == false) );
+  REMUS_ASSERT( (queue.numJobsJustQueued() == 4) );
+  REMUS_ASSERT( (queue.countsPerRequirement().find(worker_type2D)->second.Queued == 3) );
+  for(std::size_t i=0; i < 3; ++i)
+    {
+    REMUS_ASSERT( (queue.haveUUID(array.job(i).id()) == true) );
+    }
+
+  //the submission of an element is built when it is taken
+  remus::worker::Job job = queue.takeJob(worker_type2D);
+  boost::uuids::uuid takenFrom;
+  std::size_t index = 0;
+  REMUS_ASSERT( (remus::proto::split_JobArrayElementId(job.id(),
+                                                       takenFrom,
+                                                       index) == true) );
+  REMUS_ASSERT( (takenFrom == arrayId) );
+  REMUS_ASSERT( (job.details("size") ==
+                 std::string(sweep->overrides(index).find("size")->second.data(),
+                             sweep->overrides(index).find("size")->second.dataSize())) );
+  REMUS_ASSERT( (job.details("data") == "model") );
+  REMUS_ASSERT( (queue.haveUUID(job.id()) == false) );
+
+  //removing the array only removes its elements, including the
+  //ones waiting for a worker
+  REMUS_ASSERT( (queue.workerDispatched(worker_type2D) == true) );
+  REMUS_ASSERT( (queue.removeJobArray(arrayId) == 2) );
+  REMUS_ASSERT( (queue.numJobsWaitingForWorkers() +
+                 queue.numJobsJustQueued() == 1) );
+  for(std::size_t i=0; i < 3; ++i)
+    {
+    REMUS_ASSERT( (queue.haveUUID(array.job(i).id()) == false) );
+    }
+  REMUS_ASSERT( (queue.removeJobArray(arrayId) == 0) );
+}
+
+void verify_reserved_jobs()
+{
+  typedef remus::server::detail::JobQueue::CountsPerRequirement Counts;
+  remus::server::detail::JobQueue queue;
+
+  const boost::uuids::uuid first = make_id();
+  const boost::uuids::uuid second = make_id();
+  queue.addJob( first, make_jobSubmission(Edges(),Mesh2D()) );
+  queue.addJob( second, make_jobSubmission(Edges(),Mesh2D()) );
+
+  //reserving needs a token and a queued job of the type
+  REMUS_ASSERT( (queue.workerDispatched(worker_type2D, std::string()) == false) );
+  REMUS_ASSERT( (queue.workerDispatched(worker_type3D, "token-3d") == false) );
+  REMUS_ASSERT( (queue.workerDispatched(worker_type2D, "token-a") == true) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 1) );
+  REMUS_ASSERT( (queue.numJobsJustQueued() == 1) );
+
+  //a reserved job is still queued, but can't be taken by any other worker
+  const Counts& counts = queue.countsPerRequirement();
+  REMUS_ASSERT( (counts.find(worker_type2D)->second.Queued == 1) );
+  REMUS_ASSERT( (counts.find(worker_type2D)->second.WaitingForWorker == 0) );
+  remus::worker::Job job = queue.takeJob(worker_type2D);
+  REMUS_ASSERT( (job.valid() == true) );
+  REMUS_ASSERT( (queue.takeJob(worker_type2D).valid() == false) );
+  REMUS_ASSERT( (counts.find(worker_type2D) == counts.end()) );
+  REMUS_ASSERT( (queue.haveUUID(job.id()) == false) );
+
+  const boost::uuids::uuid reserved = (job.id() == first) ? second : first;
+  REMUS_ASSERT( (queue.haveUUID(reserved) == true) );
+
+  //only the right token claims the job, and only once
+  REMUS_ASSERT( (queue.takeReservedJob("token-b", worker_type2D).valid() == false) );
+  REMUS_ASSERT( (queue.takeReservedJob(std::string(), worker_type2D).valid() == false) );
+  job = queue.takeReservedJob("token-a", worker_type2D);
+  REMUS_ASSERT( (job.valid() == true) );
+  REMUS_ASSERT( (job.id() == reserved) );
+  REMUS_ASSERT( (queue.haveUUID(reserved) == false) );
+  REMUS_ASSERT( (queue.takeReservedJob("token-a", worker_type2D).valid() == false) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 0) );
+
+  //reservations that are never claimed go back in the queue
+  queue.addJob( first, make_jobSubmission(Edges(),Mesh3D()) );
+  REMUS_ASSERT( (queue.workerDispatched(worker_type3D, "token-c") == true) );
+  REMUS_ASSERT( (queue.queuedJobRequirements().size() == 0) );
+  const boost::posix_time::ptime now =
+                              boost::posix_time::microsec_clock::local_time();
+  REMUS_ASSERT( (queue.releaseReservations(now - boost::posix_time::hours(1)) == 0) );
+  REMUS_ASSERT( (queue.releaseReservations(now + boost::posix_time::hours(1)) == 1) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 0) );
+  REMUS_ASSERT( (queue.numJobsJustQueued() == 1) );
+  REMUS_ASSERT( (queue.queuedJobRequirements().count(worker_type3D) == 1) );
+  REMUS_ASSERT( (counts.find(worker_type3D)->second.Queued == 1) );
+  REMUS_ASSERT( (queue.takeReservedJob("token-c", worker_type3D).valid() == false) );
+
+  //terminating a reserved job removes the reservation
+  REMUS_ASSERT( (queue.workerDispatched(worker_type3D, "token-d") == true) );
+  REMUS_ASSERT( (queue.remove(first) == true) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 0) );
+  REMUS_ASSERT( (queue.takeReservedJob("token-d", worker_type3D).valid() == false) );
+  REMUS_ASSERT( (counts.find(worker_type3D) == counts.end()) );
+
+  //a worker with other requirements can't claim the job, which goes
+  //back in the queue
+  queue.addJob( second, make_jobSubmission(Edges(),Mesh3D()) );
+  REMUS_ASSERT( (queue.workerDispatched(worker_type3D, "token-e") == true) );
+  REMUS_ASSERT( (queue.takeReservedJob("token-e", worker_type2D).valid() == false) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 0) );
+  REMUS_ASSERT( (queue.haveUUID(second) == true) );
+  REMUS_ASSERT( (counts.find(worker_type3D)->second.Queued == 1) );
+  REMUS_ASSERT( (queue.takeReservedJob("token-e", worker_type3D).valid() == false) );
+  REMUS_ASSERT( (queue.takeJob(worker_type3D).id() == second) );
+
+  //a reservation can be released right away, when the launched worker
+  //is known to never claim it
+  queue.addJob( second, make_jobSubmission(Edges(),Mesh3D()) );
+  REMUS_ASSERT( (queue.workerDispatched(worker_type3D, "token-f") == true) );
+  REMUS_ASSERT( (queue.releaseReservation("token-g") == false) );
+  REMUS_ASSERT( (queue.releaseReservation(std::string()) == false) );
+  REMUS_ASSERT( (queue.releaseReservation("token-f") == true) );
+  REMUS_ASSERT( (queue.releaseReservation("token-f") == false) );
+  REMUS_ASSERT( (queue.numJobsReserved() == 0) );
+  REMUS_ASSERT( (counts.find(worker_type3D)->second.Queued == 1) );
+  REMUS_ASSERT( (queue.takeJob(worker_type3D).id() == second) );
+}
+
 } //namespace
 
 int UnitTestServerJobQueue(int, char *[])
@@ -221,6 +429,11 @@ int UnitTestServerJobQueue(int, char *[])
 
   verify_dispatch_jobs();
 
+  verify_listing_jobs();
+
+  verify_job_arrays();
+
+  verify_reserved_jobs();
 
   return 0;
 }
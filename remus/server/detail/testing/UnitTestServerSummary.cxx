@@ -0,0 +1,184 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/server/detail/ServerSummary.h>
+
+#include <remus/common/ContentTypes.h>
+#include <remus/testing/Testing.h>
+
+
+namespace {
+
+using namespace remus::common;
+using namespace remus::meshtypes;
+
+const remus::proto::JobRequirements reqs2D(ContentFormat::User,
+                                           MeshIOType(Edges(),Mesh2D()),
+                                           "", "" );
+const remus::proto::JobRequirements reqs3D(ContentFormat::User,
+                                           MeshIOType(Edges(),Mesh3D()),
+                                           "", "" );
+
+//makes a random socket identity
+zmq::SocketIdentity make_socketId()
+{
+  boost::uuids::uuid new_uid = remus::testing::UUIDGenerator();
+  const std::string str_id = boost::lexical_cast<std::string>(new_uid);
+  return zmq::SocketIdentity(str_id.c_str(),str_id.size());
+}
+
+void verify_queue_counts()
+{
+  typedef remus::server::detail::JobQueue::CountsPerRequirement Counts;
+  remus::server::detail::JobQueue queue;
+
+  std::vector< boost::uuids::uuid > ids;
+  for(int i=0; i < 5; ++i) { ids.push_back(remus::testing::UUIDGenerator()); }
+
+  queue.addJob(ids[0], remus::proto::JobSubmission(reqs2D));
+  queue.addJob(ids[1], remus::proto::JobSubmission(reqs2D));
+  queue.addJob(ids[2], remus::proto::JobSubmission(reqs2D));
+  queue.addJob(ids[3], remus::proto::JobSubmission(reqs3D));
+  queue.addJob(ids[4], remus::proto::JobSubmission(reqs3D));
+
+  const Counts& counts = queue.countsPerRequirement();
+  REMUS_ASSERT( (counts.size() == 2) );
+  REMUS_ASSERT( (counts.find(reqs2D)->second.Queued == 3) );
+  REMUS_ASSERT( (counts.find(reqs3D)->second.Queued == 2) );
+
+  //dispatching a worker moves a job to waiting for a worker
+  queue.workerDispatched(reqs2D);
+  REMUS_ASSERT( (counts.find(reqs2D)->second.Queued == 2) );
+  REMUS_ASSERT( (counts.find(reqs2D)->second.WaitingForWorker == 1) );
+
+  //taking a job prefers jobs waiting for a worker
+  REMUS_ASSERT( (queue.takeJob(reqs2D).valid() == true) );
+  REMUS_ASSERT( (counts.find(reqs2D)->second.Queued == 2) );
+  REMUS_ASSERT( (counts.find(reqs2D)->second.WaitingForWorker == 0) );
+
+  //removing the last jobs of a requirement drops the requirement
+  queue.remove(ids[3]);
+  queue.remove(ids[4]);
+  REMUS_ASSERT( (counts.size() == 1) );
+  REMUS_ASSERT( (counts.count(reqs3D) == 0) );
+
+  queue.clear();
+  REMUS_ASSERT( (counts.size() == 0) );
+  REMUS_ASSERT( (queue.numJobsWaitingForWorkers() == 0) );
+}
+
+void verify_worker_counts()
+{
+  typedef remus::server::detail::ActiveJobs::JobsPerWorker Counts;
+  remus::server::detail::ActiveJobs jobs;
+
+  const zmq::SocketIdentity workerA = make_socketId();
+  const zmq::SocketIdentity workerB = make_socketId();
+
+  std::vector< boost::uuids::uuid > ids;
+  for(int i=0; i < 4; ++i) { ids.push_back(remus::testing::UUIDGenerator()); }
+
+  jobs.add(workerA, ids[0]);
+  jobs.add(workerA, ids[1]);
+  jobs.add(workerA, ids[2]);
+  jobs.add(workerB, ids[3]);
+
+  const Counts& counts = jobs.workingJobsPerWorker();
+  REMUS_ASSERT( (counts.size() == 2) );
+  REMUS_ASSERT( (counts.find(workerA)->second == 3) );
+  REMUS_ASSERT( (counts.find(workerB)->second == 1) );
+
+  //in progress jobs are still being worked on
+  jobs.updateStatus(remus::proto::JobStatus(ids[0],remus::IN_PROGRESS));
+  REMUS_ASSERT( (counts.find(workerA)->second == 3) );
+
+  //failed and finished jobs are not
+  jobs.updateStatus(remus::proto::JobStatus(ids[0],remus::FAILED));
+  REMUS_ASSERT( (counts.find(workerA)->second == 2) );
+  jobs.updateResult(remus::proto::make_JobResult(ids[1],"data"));
+  REMUS_ASSERT( (counts.find(workerA)->second == 1) );
+
+  //removing a finished job doesn't change the count twice
+  jobs.remove(ids[1]);
+  REMUS_ASSERT( (counts.find(workerA)->second == 1) );
+
+  //removing a working job does, and workers without jobs are dropped
+  jobs.remove(ids[3]);
+  REMUS_ASSERT( (counts.size() == 1) );
+  REMUS_ASSERT( (counts.count(workerB) == 0) );
+}
+
+void verify_snapshot()
+{
+  remus::server::detail::ServerSummary summary(1000);
+  REMUS_ASSERT( (summary.interval() == 1000) );
+
+  const boost::posix_time::ptime start =
+                            boost::posix_time::microsec_clock::local_time();
+  REMUS_ASSERT( (summary.due(start) == false) );
+
+  remus::server::detail::JobQueue queue;
+  remus::server::detail::ActiveJobs jobs;
+  queue.addJob(remus::testing::UUIDGenerator(),
+               remus::proto::JobSubmission(reqs2D));
+  jobs.add(make_socketId(), remus::testing::UUIDGenerator());
+
+  summary.jobDispatched();
+  summary.jobDispatched();
+  summary.jobFinished();
+  summary.jobFailed();
+  summary.jobsExpired(3);
+
+  const boost::posix_time::ptime later =
+                            start + boost::posix_time::milliseconds(2000);
+  REMUS_ASSERT( (summary.due(later) == true) );
+
+  remus::server::detail::SummarySnapshot snap =
+                                          summary.snapshot(later, queue, jobs);
+  REMUS_ASSERT( (snap.IntervalMillisec >= 2000) );
+  REMUS_ASSERT( (snap.Requirements.size() == 1) );
+  REMUS_ASSERT( (snap.WorkingJobs.size() == 1) );
+  REMUS_ASSERT( (snap.Dispatched == 2) );
+  REMUS_ASSERT( (snap.Finished == 1) );
+  REMUS_ASSERT( (snap.Failed == 1) );
+  REMUS_ASSERT( (snap.Expired == 3) );
+  REMUS_ASSERT( (snap.dispatchRate() > 0.0) );
+  REMUS_ASSERT( (summary.due(later) == false) );
+
+  //interval counts restart, totals keep going
+  summary.jobDispatched();
+  snap = summary.snapshot(later + boost::posix_time::milliseconds(1000),
+                          queue, jobs);
+  REMUS_ASSERT( (snap.Dispatched == 1) );
+  REMUS_ASSERT( (snap.Expired == 0) );
+  REMUS_ASSERT( (snap.TotalDispatched == 3) );
+  REMUS_ASSERT( (snap.TotalExpired == 3) );
+  REMUS_ASSERT( (snap.IntervalMillisec == 1000) );
+  REMUS_ASSERT( (snap.dispatchRate() == 1.0) );
+
+  //a non positive interval disables the summary
+  summary.interval(0);
+  REMUS_ASSERT( (summary.nextSnapshot().is_pos_infinity()) );
+  REMUS_ASSERT( (summary.due(later + boost::posix_time::hours(1)) == false) );
+}
+
+} //namespace
+
+int UnitTestServerSummary(int, char *[])
+{
+  verify_queue_counts();
+
+  verify_worker_counts();
+
+  verify_snapshot();
+
+  return 0;
+}
@@ -237,6 +237,48 @@ void verify_responiveness()
   }
 }
 
+void verify_deferred_refresh()
+{
+  //a deferred refresh doesn't change the socket till it is applied
+  {
+  zmq::SocketIdentity sid = make_socketId();
+  SocketMonitor monitor;
+  monitor.refreshLater(sid);
+  monitor.refreshLater(sid);
+  REMUS_ASSERT( (monitor.pendingRefreshes() == 1) );
+  REMUS_ASSERT( (monitor.isDead(sid) == true) );
+
+  monitor.applyRefreshes();
+  REMUS_ASSERT( (monitor.pendingRefreshes() == 0) );
+  REMUS_ASSERT( (monitor.isDead(sid) == false) );
+  REMUS_ASSERT( (monitor.isUnresponsive(sid) == false) );
+  }
+
+  //a queued refresh keeps an unresponsive socket alive
+  {
+  zmq::SocketIdentity sid = make_socketId();
+  SocketMonitor monitor;
+  monitor.pollingMonitor().changeTimeOutRates(10,25);
+  monitor.refresh(sid);
+
+  remus::common::SleepForMillisec(60);
+  monitor.refreshLater(sid);
+  REMUS_ASSERT( (monitor.isUnresponsive(sid) == true) );
+  monitor.applyRefreshes();
+  REMUS_ASSERT( (monitor.isUnresponsive(sid) == false) );
+  }
+
+  //marking a socket as dead drops any queued refresh
+  {
+  zmq::SocketIdentity sid = make_socketId();
+  SocketMonitor monitor;
+  monitor.refresh(sid);
+  monitor.refreshLater(sid);
+  monitor.markAsDead(sid);
+  monitor.applyRefreshes();
+  REMUS_ASSERT( (monitor.isDead(sid) == true) );
+  }
+}
 
 }
 int UnitTestSocketMonitor(int, char *[])
@@ -250,6 +292,7 @@ int UnitTestSocketMonitor(int, char *[])
   verify_resurrection();
   verify_heartbeat_interval();
   verify_responiveness();
+  verify_deferred_refresh();
 
   return 0;
 }
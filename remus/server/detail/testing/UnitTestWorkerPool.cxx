@@ -178,6 +178,27 @@ void verify_purge_workers()
   REMUS_ASSERT( (pool.allWorkersWantingWork().size() == 1) );
 }
 
+void verify_remove_workers()
+{
+  remus::server::detail::WorkerPool pool;
+  zmq::SocketIdentity worker1_id = make_socketId();
+  zmq::SocketIdentity worker2_id = make_socketId();
+
+  pool.addWorker(worker1_id, worker_type2D);
+  pool.addWorker(worker1_id, worker_type3D);
+  pool.addWorker(worker2_id, worker_type2D);
+  pool.readyForWork(worker1_id, worker_type2D);
+
+  //every registration of the worker is removed
+  REMUS_ASSERT( (pool.removeWorker(worker1_id) == true) );
+  REMUS_ASSERT( (pool.haveWorker(worker1_id, worker_type2D) == false) );
+  REMUS_ASSERT( (pool.haveWorker(worker1_id, worker_type3D) == false) );
+  REMUS_ASSERT( (pool.haveWaitingWorker(worker_type2D) == false) );
+  REMUS_ASSERT( (pool.allWorkers().size() == 1) );
+
+  REMUS_ASSERT( (pool.removeWorker(worker1_id) == false) );
+}
+
 void verify_taking_works()
 {
   remus::server::detail::WorkerPool pool;
@@ -261,6 +282,60 @@ void verify_taking_works()
   }
 }
 
+void verify_taking_batches()
+{
+  remus::server::detail::WorkerPool pool;
+  zmq::SocketIdentity worker1_id = make_socketId();
+  zmq::SocketIdentity worker2_id = make_socketId();
+  pool.addWorker(worker1_id, worker_type2D);
+  pool.addWorker(worker2_id, worker_type2D);
+
+  //credits for a worker we don't know about are ignored
+  REMUS_ASSERT( (pool.addCredits(make_socketId(), worker_type2D, 4) == false) );
+
+  //a worker that asked for jobs the old way only gets one job at a time
+  pool.readyForWork(worker1_id, worker_type2D);
+  pool.readyForWork(worker1_id, worker_type2D);
+  std::size_t numberOfJobs = 8;
+  zmq::SocketIdentity id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == worker1_id) );
+  REMUS_ASSERT( (numberOfJobs == 1) );
+  numberOfJobs = 8;
+  id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == worker1_id) );
+  REMUS_ASSERT( (numberOfJobs == 1) );
+  REMUS_ASSERT( (pool.haveWaitingWorker(worker_type2D) == false) );
+
+  //a worker with credits takes as many jobs as it has credits for
+  REMUS_ASSERT( (pool.addCredits(worker2_id, worker_type2D, 5) == true) );
+  REMUS_ASSERT( (pool.haveWaitingWorker(worker_type2D) == true) );
+  numberOfJobs = 3;
+  id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == worker2_id) );
+  REMUS_ASSERT( (numberOfJobs == 3) );
+  numberOfJobs = 8;
+  id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == worker2_id) );
+  REMUS_ASSERT( (numberOfJobs == 2) );
+  REMUS_ASSERT( (pool.haveWaitingWorker(worker_type2D) == false) );
+
+  //no worker left, so no jobs can be taken
+  numberOfJobs = 8;
+  id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == zmq::SocketIdentity()) );
+  REMUS_ASSERT( (numberOfJobs == 0) );
+
+  //credits are capped, no matter how many the worker sends us
+  const std::size_t huge = static_cast<std::size_t>(-1);
+  REMUS_ASSERT( (pool.addCredits(worker2_id, worker_type2D, huge) == true) );
+  REMUS_ASSERT( (pool.addCredits(worker2_id, worker_type2D, huge) == true) );
+  numberOfJobs = huge;
+  id = pool.takeWorker(worker_type2D, numberOfJobs);
+  REMUS_ASSERT( (id == worker2_id) );
+  REMUS_ASSERT( (numberOfJobs == remus::server::detail::WorkerPool::maxCredits()) );
+  REMUS_ASSERT( (pool.haveWaitingWorker(worker_type2D) == false) );
+}
+
 } //namespace
 
 int UnitTestWorkerPool(int, char *[])
@@ -271,7 +346,11 @@ int UnitTestWorkerPool(int, char *[])
 
   verify_purge_workers();
 
+  verify_remove_workers();
+
   verify_taking_works();
 
+  verify_taking_batches();
+
   return 0;
 }
@@ -11,6 +11,7 @@
 //=============================================================================
 
 #include <iostream>
+#include <limits>
 #include <remus/server/WorkerFactory.h>
 #include <remus/testing/Testing.h>
 #include <remus/common/SleepFor.h>
@@ -75,8 +76,13 @@ void test_factory_worker_finder()
   //give our worker factory a unique extension to look for
   remus::server::WorkerFactory f_def(".tst");
 
+  //the factory tells the server when the workers it can create change
+  REMUS_ASSERT( (f_def.tracksCapabilityChanges()) );
+  const boost::uint64_t version = f_def.capabilitiesVersion();
+
   f_def.addWorkerSearchDirectory(
                   remus::server::testing::worker_factory::locationToSearch() );
+  REMUS_ASSERT( (f_def.capabilitiesVersion() != version) );
 
   //we should only support raw_edges and mesh2d, otherwise the rest
   //should return false
@@ -294,6 +300,115 @@ void test_factory_worker_launching()
     }
 }
 
+void test_factory_worker_burst()
+{
+  const remus::server::WorkerFactoryBase::FactoryDeletionBehavior kill =
+                remus::server::WorkerFactoryBase::KillOnFactoryDeletion;
+
+  remus::server::WorkerFactory f_def(".tst");
+  f_def.addCommandLineArgument("SLEEP_AND_EXIT");
+
+  f_def.addWorkerSearchDirectory(
+                  remus::server::testing::worker_factory::locationToSearch() );
+
+  remus::proto::JobRequirements raw_edges = make_Reqs(Edges(),Mesh2D());
+
+  //workers count as soon as they are asked for, even when they
+  //are still being launched
+  const unsigned int burst = 16;
+  f_def.setMaxWorkerCount(burst);
+  for(unsigned int i=0; i < burst; ++i)
+    {
+    REMUS_ASSERT( (f_def.createWorker(raw_edges,kill) == true) );
+    }
+  REMUS_ASSERT( (f_def.currentWorkerCount() == burst) );
+  REMUS_ASSERT( (f_def.createWorker(raw_edges,kill) == false) );
+
+  //wait for every worker to launch and exit
+  while (f_def.currentWorkerCount() > 0)
+    {
+    SleepForMillisec(5);
+    f_def.updateWorkerCount();
+    }
+}
+
+void test_factory_abandoned_reservations()
+{
+  const remus::server::WorkerFactoryBase::FactoryDeletionBehavior kill =
+                remus::server::WorkerFactoryBase::KillOnFactoryDeletion;
+
+  remus::server::WorkerFactory f_def(".tst");
+  f_def.setMaxWorkerCount(2);
+  f_def.addCommandLineArgument("SLEEP_AND_EXIT");
+  f_def.addWorkerSearchDirectory(
+                  remus::server::testing::worker_factory::locationToSearch() );
+
+  remus::proto::JobRequirements raw_edges = make_Reqs(Edges(),Mesh2D());
+  REMUS_ASSERT( (f_def.abandonedReservations().empty()) );
+
+  //a worker that exits without claiming its reservation abandons it,
+  //but one that claimed it doesn't
+  REMUS_ASSERT( (f_def.createWorkerWithReservation(raw_edges,kill,"token-a")) );
+  REMUS_ASSERT( (f_def.createWorkerWithReservation(raw_edges,kill,"token-b")) );
+  f_def.reservationClaimed("token-b");
+  while (f_def.currentWorkerCount() > 0)
+    {
+    SleepForMillisec(5);
+    f_def.updateWorkerCount();
+    }
+
+  std::set<std::string> abandoned = f_def.abandonedReservations();
+  REMUS_ASSERT( (abandoned.size() == 1) );
+  REMUS_ASSERT( (abandoned.count("token-a") == 1) );
+  REMUS_ASSERT( (f_def.abandonedReservations().empty()) );
+}
+
+void test_factory_warm_workers()
+{
+  remus::server::WorkerFactory f_def(".tst");
+  f_def.setMaxWorkerCount(4);
+  f_def.addCommandLineArgument("LOOP_FOREVER");
+
+  f_def.addWorkerSearchDirectory(
+                  remus::server::testing::worker_factory::locationToSearch() );
+
+  remus::proto::JobRequirements raw_edges = make_Reqs(Edges(),Mesh2D());
+  remus::proto::JobRequirements other = make_Reqs(Edges(),Mesh3D());
+
+  //by default no warm workers are kept
+  REMUS_ASSERT( (f_def.warmWorkerCount(raw_edges) == 0) );
+  REMUS_ASSERT( (f_def.idleWorkers(std::set<std::string>()).empty()) );
+  REMUS_ASSERT( (f_def.currentWorkerCount() == 0) );
+
+  //a count for a single type of worker wins over the count for all types
+  f_def.setWarmWorkerCount(2);
+  f_def.setWarmWorkerCount(other, 1);
+  REMUS_ASSERT( (f_def.warmWorkerCount(raw_edges) == 2) );
+  REMUS_ASSERT( (f_def.warmWorkerCount(other) == 1) );
+
+  //the warm workers are launched when the server tells the factory
+  //about its idle workers
+  REMUS_ASSERT( (f_def.idleWorkers(std::set<std::string>()).empty()) );
+  REMUS_ASSERT( (f_def.currentWorkerCount() == 2) );
+
+  //warm workers that haven't connected yet aren't replaced
+  f_def.idleWorkers(std::set<std::string>());
+  REMUS_ASSERT( (f_def.currentWorkerCount() == 2) );
+
+  //no warm workers are launched without enough memory left
+  remus::server::WorkerFactory f_mem(".tst");
+  f_mem.setMaxWorkerCount(4);
+  f_mem.addCommandLineArgument("LOOP_FOREVER");
+  f_mem.addWorkerSearchDirectory(
+                  remus::server::testing::worker_factory::locationToSearch() );
+  f_mem.setWarmWorkerCount(2);
+  f_mem.setWarmWorkerMemoryReserve(std::numeric_limits<boost::uint64_t>::max());
+  f_mem.idleWorkers(std::set<std::string>());
+  REMUS_ASSERT( (f_mem.currentWorkerCount() == 0) );
+
+  //the warm workers are killed with the factory
+}
+
 void test_shutdown_with_active_killOnFactoryDel_workers()
 {
   //give our worker factory a unique extension to look for
@@ -366,6 +481,12 @@ int UnitTestWorkerFactory(int, char *[])
 
   test_factory_worker_launching();
 
+  test_factory_worker_burst();
+
+  test_factory_abandoned_reservations();
+
+  test_factory_warm_workers();
+
   std::cout << __LINE__ << std::endl;
   test_shutdown_with_active_killOnFactoryDel_workers();
 
@@ -0,0 +1,262 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/client/Client.h>
+#include <remus/server/Server.h>
+#include <remus/server/WorkerFactoryBase.h>
+#include <remus/worker/Worker.h>
+
+#include <remus/common/SleepFor.h>
+#include <remus/testing/Testing.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/locks.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <remus/testing/integration/detail/Helpers.h>
+
+#include <algorithm>
+#include <map>
+
+//Measures the time from the submission of a job to the moment a worker
+//that the server had to launch for it starts working on it. This is the
+//latency that a client sees when the server has no idle workers, which
+//is compared with and without the server reserving the job for the
+//launched worker.
+namespace
+{
+  namespace detail
+  {
+  using namespace remus::testing::integration::detail;
+  }
+
+typedef boost::posix_time::ptime ptime;
+
+static std::size_t num_jobs = 64;
+
+//stands in for the time it takes a new worker process to start
+static boost::int64_t startup_delay_in_millisec = 20;
+
+//------------------------------------------------------------------------------
+remus::proto::JobRequirements make_Reqs()
+{
+  using namespace remus::meshtypes;
+  remus::common::MeshIOType io_type = remus::common::make_MeshIOType(Model(),Model());
+  return remus::proto::make_JobRequirements(io_type, "SpawnWorker", "");
+}
+
+//------------------------------------------------------------------------------
+//launches each worker on a thread of its own, that handles a single job and
+//then exits, like a worker process that the WorkerFactory launches would
+class SpawningFactory : public remus::server::WorkerFactoryBase
+{
+public:
+  SpawningFactory(const remus::proto::JobRequirements& reqs, bool reserve):
+    WorkerFactoryBase(),
+    Reqs(reqs),
+    Reserve(reserve),
+    Connection(),
+    HasConnection(false),
+    Mutex(),
+    Threads(),
+    RunningWorkers(0),
+    StartTimes()
+  {
+    this->setMaxWorkerCount(1);
+  }
+
+  ~SpawningFactory()
+  {
+    this->Threads.join_all();
+  }
+
+  remus::common::MeshIOTypeSet supportedIOTypes() const
+  {
+    remus::common::MeshIOTypeSet result;
+    result.insert(this->Reqs.meshTypes());
+    return result;
+  }
+
+  remus::proto::JobRequirementsSet workerRequirements(
+                                        remus::common::MeshIOType type) const
+  {
+    remus::proto::JobRequirementsSet result;
+    if(type == this->Reqs.meshTypes())
+      {
+      result.insert(this->Reqs);
+      }
+    return result;
+  }
+
+  bool haveSupport(const remus::proto::JobRequirements& reqs) const
+    { return reqs == this->Reqs; }
+
+  bool supportsJobReservations() const
+    { return this->Reserve; }
+
+  bool createWorker(const remus::proto::JobRequirements& reqs,
+                    WorkerFactoryBase::FactoryDeletionBehavior lifespan)
+    { return this->createWorkerWithReservation(reqs, lifespan, std::string()); }
+
+  bool createWorkerWithReservation(const remus::proto::JobRequirements& reqs,
+                                   WorkerFactoryBase::FactoryDeletionBehavior,
+                                   const std::string& reservation)
+  {
+    boost::lock_guard< boost::mutex > lock(this->Mutex);
+    if(this->RunningWorkers >= this->maxWorkerCount() || !(reqs == this->Reqs))
+      {
+      return false;
+      }
+    //all workers share a connection, see ThreadPoolWorkerFactory
+    //in the integration tests for why
+    if(!this->HasConnection)
+      {
+      this->Connection = remus::worker::make_ServerConnection(this->workerEndpoint());
+      this->HasConnection = true;
+      }
+    ++this->RunningWorkers;
+    this->Threads.create_thread(
+      boost::bind(&SpawningFactory::launchWorker, this, reservation));
+    return true;
+  }
+
+  void updateWorkerCount() {}
+
+  unsigned int currentWorkerCount() const
+  {
+    boost::lock_guard< boost::mutex > lock(this->Mutex);
+    return this->RunningWorkers;
+  }
+
+  //returns when the worker started on the given job, or not_a_date_time
+  ptime startTime(const remus::proto::Job& job) const
+  {
+    boost::lock_guard< boost::mutex > lock(this->Mutex);
+    std::map<boost::uuids::uuid, ptime>::const_iterator i =
+                                              this->StartTimes.find(job.id());
+    return (i != this->StartTimes.end()) ? i->second : ptime();
+  }
+
+private:
+  void launchWorker(std::string reservation)
+  {
+    remus::common::SleepForMillisec(startup_delay_in_millisec);
+
+    remus::worker::ServerConnection conn;
+    {
+    boost::lock_guard< boost::mutex > lock(this->Mutex);
+    conn = this->Connection;
+    }
+
+    {
+    remus::Worker worker(this->Reqs, conn);
+    worker.claimReservedJob(reservation);
+    remus::worker::Job job = worker.getJob();
+    const ptime started = boost::posix_time::microsec_clock::local_time();
+    if(job.valid())
+      {
+      {
+      boost::lock_guard< boost::mutex > lock(this->Mutex);
+      this->StartTimes[job.id()] = started;
+      }
+      worker.returnResult( remus::proto::make_JobResult(job.id(), "done") );
+      }
+    }
+
+    boost::lock_guard< boost::mutex > lock(this->Mutex);
+    --this->RunningWorkers;
+  }
+
+  remus::proto::JobRequirements Reqs;
+  bool Reserve;
+  remus::worker::ServerConnection Connection;
+  bool HasConnection;
+
+  mutable boost::mutex Mutex;
+  boost::thread_group Threads;
+  unsigned int RunningWorkers;
+  std::map<boost::uuids::uuid, ptime> StartTimes;
+};
+
+//------------------------------------------------------------------------------
+//returns the time from submission to start of every job, in microseconds
+std::vector<boost::int64_t> spawn_latency(bool reserve)
+{
+  boost::shared_ptr<SpawningFactory> factory(
+                                    new SpawningFactory(make_Reqs(), reserve));
+
+  remus::server::ServerPorts ports;
+  boost::shared_ptr<remus::Server> server( new remus::Server(ports,factory) );
+  server->startBrokering();
+  ports = server->serverPortInfo();
+
+  boost::shared_ptr<remus::Client> client = detail::make_Client( ports );
+
+  //a job at a time, so that every job needs a worker to be launched
+  std::vector<boost::int64_t> latencies;
+  for(std::size_t i=0; i < num_jobs; ++i)
+    {
+    const ptime submitted = boost::posix_time::microsec_clock::local_time();
+    remus::proto::Job job = client->submitJob(remus::proto::JobSubmission(make_Reqs()));
+    REMUS_ASSERT(job.valid())
+
+    remus::proto::JobResult result = client->waitForResult(job, 10000);
+    REMUS_ASSERT(result.valid())
+
+    //wait for the worker to exit, so that the next job finds no worker
+    while(factory->currentWorkerCount() > 0)
+      {
+      remus::common::SleepForMillisec(1);
+      }
+    const ptime started = factory->startTime(job);
+    REMUS_ASSERT( (!started.is_not_a_date_time()) )
+    latencies.push_back( (started - submitted).total_microseconds() );
+    }
+
+  server->stopBrokering();
+  return latencies;
+}
+
+//------------------------------------------------------------------------------
+void report(const std::string& name, std::vector<boost::int64_t> latencies)
+{
+  std::sort(latencies.begin(), latencies.end());
+  boost::int64_t total = 0;
+  for(std::size_t i=0; i < latencies.size(); ++i)
+    {
+    total += latencies[i];
+    }
+  const boost::int64_t size = static_cast<boost::int64_t>(latencies.size());
+  std::cout << name << ": " << size << " jobs, submission to start (usec)"
+            << " mean " << (total / size)
+            << " median " << latencies[latencies.size()/2]
+            << " p90 " << latencies[(latencies.size()*9)/10]
+            << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  (void) argc;
+  (void) argv;
+
+  std::cout << "every worker takes " << startup_delay_in_millisec
+            << " msec to start" << std::endl;
+
+  report("queued until the worker asks", spawn_latency(false));
+  report("reserved for the launched worker", spawn_latency(true));
+
+  return 0;
+}
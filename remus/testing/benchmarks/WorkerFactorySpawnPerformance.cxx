@@ -0,0 +1,170 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/server/WorkerFactory.h>
+
+#include <remus/common/ExecuteProcess.h>
+#include <remus/common/SleepFor.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#define BOOST_FILESYSTEM_VERSION 3
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+//Measures how fast the WorkerFactory launches a burst of workers, and for
+//how long the thread that asks for the workers is stalled, which is the
+//broker thread of the server. The same burst is launched with
+//remus::common::ExecuteProcess on the asking thread, which is how the
+//factory used to launch workers. This executable is also the worker that
+//is launched, which exits as soon as it starts.
+namespace
+{
+
+typedef boost::posix_time::ptime ptime;
+
+static std::size_t num_spawns = 100;
+
+const char* const spawned_argument = "SPAWNED_WORKER";
+
+//------------------------------------------------------------------------------
+ptime now()
+{
+  return boost::posix_time::microsec_clock::local_time();
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobRequirements make_Reqs()
+{
+  using namespace remus::meshtypes;
+  remus::common::MeshIOType io_type = remus::common::make_MeshIOType(Model(),Model());
+  return remus::proto::make_JobRequirements(io_type, "SpawnedWorker", "");
+}
+
+//------------------------------------------------------------------------------
+//writes a worker file that launches this executable
+boost::filesystem::path write_WorkerFile(const boost::filesystem::path& self)
+{
+  boost::filesystem::path dir = boost::filesystem::temp_directory_path() /
+                       boost::filesystem::unique_path("remus-spawn-%%%%-%%%%");
+  boost::filesystem::create_directories(dir);
+
+  std::ofstream file( (dir / "SpawnedWorker.spawn").string().c_str() );
+  file << "{\n"
+       << "\"ExecutableName\": \"" << self.generic_string() << "\",\n"
+       << "\"WorkerName\": \"SpawnedWorker\",\n"
+       << "\"InputType\": \"Model\",\n"
+       << "\"OutputType\": \"Model\"\n"
+       << "}\n";
+  return dir;
+}
+
+//------------------------------------------------------------------------------
+struct SpawnTimes
+{
+  SpawnTimes(): Stall(), LongestStall(), AllExited() {}
+  boost::posix_time::time_duration Stall;
+  boost::posix_time::time_duration LongestStall;
+  boost::posix_time::time_duration AllExited;
+};
+
+//------------------------------------------------------------------------------
+SpawnTimes spawn_with_factory(const boost::filesystem::path& workerDir)
+{
+  remus::server::WorkerFactory factory(".spawn");
+  factory.addWorkerSearchDirectory(workerDir.string());
+  factory.addCommandLineArgument(spawned_argument);
+  factory.setMaxWorkerCount(static_cast<unsigned int>(num_spawns));
+
+  const remus::proto::JobRequirements reqs = make_Reqs();
+  SpawnTimes times;
+  const ptime start = now();
+  for(std::size_t i=0; i < num_spawns; ++i)
+    {
+    const ptime before = now();
+    factory.createWorker(reqs,
+                         remus::server::WorkerFactoryBase::KillOnFactoryDeletion);
+    const boost::posix_time::time_duration stall = now() - before;
+    times.Stall += stall;
+    times.LongestStall = std::max(times.LongestStall, stall);
+    }
+
+  while(factory.currentWorkerCount() > 0)
+    {
+    factory.updateWorkerCount();
+    }
+  times.AllExited = now() - start;
+  return times;
+}
+
+//------------------------------------------------------------------------------
+SpawnTimes spawn_with_ExecuteProcess(const boost::filesystem::path& self)
+{
+  typedef boost::shared_ptr<remus::common::ExecuteProcess> ProcessPtr;
+  std::vector<std::string> args(1, spawned_argument);
+  std::vector<ProcessPtr> processes;
+
+  SpawnTimes times;
+  const ptime start = now();
+  for(std::size_t i=0; i < num_spawns; ++i)
+    {
+    const ptime before = now();
+    ProcessPtr process(new remus::common::ExecuteProcess(self.string(), args));
+    process->execute();
+    processes.push_back(process);
+    const boost::posix_time::time_duration stall = now() - before;
+    times.Stall += stall;
+    times.LongestStall = std::max(times.LongestStall, stall);
+    }
+
+  for(std::size_t i=0; i < processes.size(); ++i)
+    {
+    while(processes[i]->isAlive()) {}
+    }
+  times.AllExited = now() - start;
+  return times;
+}
+
+//------------------------------------------------------------------------------
+void report(const std::string& name, const SpawnTimes& times)
+{
+  const double seconds = times.AllExited.total_microseconds() / 1e6;
+  std::cout << name << ": " << num_spawns << " workers, "
+            << (num_spawns / seconds) << " spawns/sec, "
+            << "stalled " << times.Stall.total_microseconds() << " usec"
+            << " (longest " << times.LongestStall.total_microseconds()
+            << " usec)" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  if(argc == 2 && std::string(argv[1]) == spawned_argument)
+    { //we are a launched worker
+    return 0;
+    }
+
+  const boost::filesystem::path self =
+                            boost::filesystem::system_complete(argv[0]);
+  const boost::filesystem::path workerDir = write_WorkerFile(self);
+
+  report("ExecuteProcess on the asking thread", spawn_with_ExecuteProcess(self));
+  report("WorkerFactory", spawn_with_factory(workerDir));
+
+  boost::filesystem::remove_all(workerDir);
+  return 0;
+}
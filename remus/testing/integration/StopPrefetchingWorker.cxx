@@ -0,0 +1,147 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+#include <remus/client/Client.h>
+#include <remus/server/Server.h>
+#include <remus/server/WorkerFactoryBase.h>
+#include <remus/worker/Worker.h>
+#include <remus/worker/WorkerPoolExecutor.h>
+
+#include <remus/common/SleepFor.h>
+#include <remus/testing/Testing.h>
+#include <remus/testing/integration/detail/Factories.h>
+#include <remus/testing/integration/detail/Helpers.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace
+{
+  namespace detail
+  {
+  using namespace remus::testing::integration::detail;
+  }
+
+  //the job the executor thread is working on, and if it can stop
+  namespace data
+  {
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  boost::uuids::uuid startedId;
+  }
+
+//------------------------------------------------------------------------------
+boost::shared_ptr<remus::Server> make_Server( remus::server::ServerPorts ports )
+{
+  //create the server and start brokering, with an empty factory
+  boost::shared_ptr<detail::AlwaysSupportFactory> factory(new detail::AlwaysSupportFactory("PrefetchWorker"));
+  factory->setMaxWorkerCount(1); //max worker needs to be higher than 0
+  boost::shared_ptr<remus::Server> server( new remus::Server(ports,factory) );
+  server->startBrokering();
+  return server;
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobRequirements make_Requirements()
+{
+  using namespace remus::meshtypes;
+  remus::common::MeshIOType io_type = remus::common::make_MeshIOType(Mesh2D(),Mesh3D());
+  return remus::proto::make_JobRequirements(io_type, "PrefetchWorker", "");
+}
+
+//------------------------------------------------------------------------------
+std::vector<remus::proto::Job> submit_Jobs(boost::shared_ptr<remus::Client> client,
+                                           std::size_t numberOfJobs)
+{
+  std::vector<remus::proto::Job> jobs;
+  for(std::size_t i=0; i < numberOfJobs; ++i)
+    {
+    remus::proto::JobSubmission sub(make_Requirements());
+    sub["data"] = remus::proto::make_JobContent("prefetch");
+    jobs.push_back(client->submitJob(sub));
+    REMUS_ASSERT(jobs.back().valid())
+    }
+  return jobs;
+}
+
+//------------------------------------------------------------------------------
+void start_and_hold(const remus::worker::Job& job, remus::worker::Worker& worker)
+{
+  //report that we started, and hold the job until the test stops us
+  worker.updateStatus(remus::proto::make_JobStatus(job.id(), 10));
+  data::startedId = job.id();
+  data::started.store(true);
+  while(!data::release.load())
+    { remus::common::SleepForMillisec(10); }
+}
+
+}
+
+int StopPrefetchingWorker(int argc, char* argv[])
+{
+  (void) argc;
+  (void) argv;
+
+  boost::shared_ptr<remus::Server> server = make_Server( remus::server::ServerPorts() );
+  const remus::server::ServerPorts& ports = server->serverPortInfo();
+  boost::shared_ptr<remus::Client> client = detail::make_Client( ports );
+
+  const std::size_t numberOfJobs = 4;
+  std::vector<remus::proto::Job> jobs = submit_Jobs(client, numberOfJobs);
+
+  //a single thread with a window of every job, so that all but the job
+  //the thread is holding are pending on the worker
+  remus::worker::ServerConnection conn =
+              remus::worker::make_ServerConnection(ports.worker().endpoint());
+  boost::shared_ptr<remus::worker::WorkerPoolExecutor> executor(
+        new remus::worker::WorkerPoolExecutor(make_Requirements(), conn, 1) );
+  executor->worker().jobPrefetch(static_cast<unsigned int>(numberOfJobs));
+  executor->start(&start_and_hold);
+
+  while(!data::started.load() ||
+        executor->worker().pendingJobCount() != numberOfJobs - 1)
+    { remus::common::SleepForMillisec(50); }
+
+  //stopping the executor disconnects the worker with the prefetched
+  //jobs never taken
+  executor->stop();
+  data::release.store(true);
+  executor->wait();
+  executor.reset();
+
+  //the job that was started is lost with the worker, while the jobs that
+  //were never taken are queued again instead of expiring
+  remus::common::SleepForMillisec(1000);
+  std::vector<boost::uuids::uuid> requeued;
+  for(std::size_t i=0; i < jobs.size(); ++i)
+    {
+    if(jobs[i].id() == data::startedId)
+      {
+      detail::verify_job_status(jobs[i], client, remus::EXPIRED);
+      }
+    else
+      {
+      detail::verify_job_status(jobs[i], client, remus::QUEUED);
+      requeued.push_back(jobs[i].id());
+      }
+    }
+  REMUS_ASSERT( (requeued.size() == numberOfJobs - 1) );
+
+  //and a new worker is given one of them
+  boost::shared_ptr<remus::Worker> worker =
+      detail::make_Worker( ports, make_Requirements().meshTypes(), "PrefetchWorker" );
+  remus::worker::Job job = worker->getJob();
+  REMUS_ASSERT( job.valid() );
+  REMUS_ASSERT( (std::find(requeued.begin(), requeued.end(), job.id()) !=
+                 requeued.end()) );
+  return 0;
+}
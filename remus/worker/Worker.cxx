@@ -12,16 +12,29 @@
 
 #include <remus/worker/Worker.h>
 
+#include <remus/proto/ContentCacheIndex.h>
+#include <remus/proto/JobReservation.h>
 #include <remus/proto/Message.h>
 #include <remus/proto/Response.h>
 #include <remus/proto/zmqHelper.h>
+#include <remus/worker/WorkerHub.h>
 #include <remus/worker/detail/JobQueue.h>
 #include <remus/worker/detail/MessageRouter.h>
+#include <remus/worker/detail/StatusCoalescer.h>
+#include <remus/worker/detail/StatusQueue.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <sstream>
 #include <string>
 
 //suppress warnings inside boost headers for gcc and clang
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -39,13 +52,35 @@ struct ZmqManagement
   //the same context.
   boost::shared_ptr<zmq::context_t> InterWorkerContext;
   zmq::socket_t Server;
+  //zmq sockets can't be used by multiple threads at once, so every use
+  //of the Server socket, and the job credits, is guarded by this mutex.
+  //This allows a single worker to be shared by multiple mesher threads.
+  //Only take it through Worker::ServerLock, so that queued statuses
+  //are sent
+  boost::mutex ServerMutex;
+  //guards the counts of results sent and acknowledged. Threads that wait
+  //for an acknowledgement sleep on the condition, and only take the
+  //ServerMutex for short polls of the socket, so that they don't hold up
+  //the threads that get jobs or send statuses. Never take the ServerMutex
+  //while holding this one
+  boost::mutex AckMutex;
+  boost::condition_variable AckCondition;
   std::string WorkerChannelUUID;
   std::string JobChannelUUID;
+  //only set when the worker shares the connection of a hub, in which case
+  //the hub knows us by our virtual id
+  remus::worker::WorkerHub* Hub;
+  std::string VirtualId;
   ZmqManagement( remus::worker::ServerConnection const& conn ):
     InterWorkerContext( conn.context() ),
     Server( *InterWorkerContext, ZMQ_PAIR),
+    ServerMutex(),
+    AckMutex(),
+    AckCondition(),
     WorkerChannelUUID(),
-    JobChannelUUID()
+    JobChannelUUID(),
+    Hub(NULL),
+    VirtualId()
   {
   boost::uuids::random_generator generator;
 
@@ -58,52 +93,103 @@ struct ZmqManagement
   zmq::socketInfo<zmq::proto::inproc> sInfo( this->WorkerChannelUUID );
   zmq::bindToAddress(this->Server, sInfo);
   }
+
+  //connect to the routing socket of a hub, using our virtual id as the
+  //identity of the socket so the hub can route messages back to us
+  ZmqManagement( remus::worker::ServerConnection const& conn,
+                 remus::worker::WorkerHub* hub,
+                 const std::string& hubEndpoint ):
+    InterWorkerContext( conn.context() ),
+    Server( *InterWorkerContext, ZMQ_DEALER),
+    ServerMutex(),
+    AckMutex(),
+    AckCondition(),
+    WorkerChannelUUID(),
+    JobChannelUUID(),
+    Hub(hub),
+    VirtualId()
+  {
+  boost::uuids::random_generator generator;
+  this->VirtualId = boost::uuids::to_string(generator());
+  this->Server.setsockopt(ZMQ_IDENTITY, this->VirtualId.data(),
+                          this->VirtualId.size());
+  zmq::connectToAddress(this->Server, hubEndpoint);
+  }
 };
 
 
+//a process is launched with at most a single reservation, so only the
+//first worker of the process claims it
+std::string take_ProcessReservation()
+{
+  static std::atomic<bool> taken(false);
+  if(taken.exchange(true))
+    {
+    return std::string();
+    }
+  const char* reservation =
+              std::getenv(remus::proto::reservationEnvironmentVariable());
+  return reservation ? std::string(reservation) : std::string();
 }
 
+}
 
 //-----------------------------------------------------------------------------
-Worker::Worker(remus::common::MeshIOType mtype,
-               remus::worker::ServerConnection const& conn):
-  MeshRequirements( remus::proto::make_JobRequirements(mtype,"","") ),
-  ConnectionInfo(conn),
-  Zmq( new detail::ZmqManagement( conn ) ),
-  MessageRouter( new remus::worker::detail::MessageRouter(
-                    zmq::socketInfo<zmq::proto::inproc>(Zmq->WorkerChannelUUID),
-                    zmq::socketInfo<zmq::proto::inproc>(Zmq->JobChannelUUID))),
-  JobQueue( new remus::worker::detail::JobQueue( *Zmq->InterWorkerContext,
-                    zmq::socketInfo<zmq::proto::inproc>(Zmq->JobChannelUUID)))
+class Worker::ServerLock
 {
-  //build the buffer before we start the message router. This shortens the
-  //duration that the worker is stalling, while the message router is active
-  //and sending/recv without a registered worker
-  std::string buffer_str;
+public:
+  explicit ServerLock(const Worker& worker):
+    Owner(worker),
+    Lock(worker.Zmq->ServerMutex)
   {
-  std::ostringstream input_buffer;
-  input_buffer << this->MeshRequirements;
-  buffer_str = input_buffer.str();
   }
 
-  this->MessageRouter->start(conn, *Zmq->InterWorkerContext);
-  remus::proto::send_Message(this->MeshRequirements.meshTypes(),
-                            remus::CAN_MESH_REQUIREMENTS,
-                            buffer_str,
-                            &this->Zmq->Server);
+  ~ServerLock()
+  {
+    //statuses queued by threads that found the lock taken are our job
+    this->Owner.sendQueuedStatus();
+    this->Lock.unlock();
+    //a status queued after we sent, but before we let go, is missed by
+    //both us and the thread that queued it, so look again
+    this->Owner.publishQueuedStatus();
+  }
+
+private:
+  const Worker& Owner;
+  boost::unique_lock<boost::mutex> Lock;
+
+  ServerLock(const ServerLock&);
+  void operator=(const ServerLock&);
+};
+
+
+//-----------------------------------------------------------------------------
+Worker::Worker(remus::common::MeshIOType mtype,
+               remus::worker::ServerConnection const& conn):
+  Worker( remus::proto::make_JobRequirements(mtype,"",""), conn )
+{
 }
 
 //-----------------------------------------------------------------------------
 Worker::Worker(const remus::proto::JobRequirements& requirements,
                remus::worker::ServerConnection const& conn):
   MeshRequirements(requirements),
+  PrefetchWindow(0),
+  CreditsToReturn(0),
+  LastDroppedJobCount(0),
+  ResultsSent(0),
+  ResultsAcknowledged(0),
+  ResultUploadWindow(4),
+  ClaimsOutstanding(0),
   ConnectionInfo(conn),
   Zmq( new detail::ZmqManagement( conn ) ),
   MessageRouter( new remus::worker::detail::MessageRouter(
                     zmq::socketInfo<zmq::proto::inproc>(Zmq->WorkerChannelUUID),
                     zmq::socketInfo<zmq::proto::inproc>(Zmq->JobChannelUUID)) ),
   JobQueue( new remus::worker::detail::JobQueue( *Zmq->InterWorkerContext,
-                    zmq::socketInfo<zmq::proto::inproc>(Zmq->JobChannelUUID)) )
+                    zmq::socketInfo<zmq::proto::inproc>(Zmq->JobChannelUUID)) ),
+  StatusCoalescer( new remus::worker::detail::StatusCoalescer() ),
+  OutboundStatus( new remus::worker::detail::StatusQueue() )
 {
   //build the buffer before we start the message router. This shortens the
   //duration that the worker is stalling, while the message router is active
@@ -116,24 +202,93 @@ Worker::Worker(const remus::proto::JobRequirements& requirements,
   }
 
   this->MessageRouter->start(conn, *Zmq->InterWorkerContext);
+  this->registerWithServer(buffer_str);
+}
+
+//-----------------------------------------------------------------------------
+Worker::Worker(remus::common::MeshIOType mtype,
+               remus::worker::WorkerHub& hub):
+  Worker( remus::proto::make_JobRequirements(mtype,"",""), hub )
+{
+}
+
+//-----------------------------------------------------------------------------
+Worker::Worker(const remus::proto::JobRequirements& requirements,
+               remus::worker::WorkerHub& hub):
+  MeshRequirements(requirements),
+  PrefetchWindow(0),
+  CreditsToReturn(0),
+  LastDroppedJobCount(0),
+  ResultsSent(0),
+  ResultsAcknowledged(0),
+  ResultUploadWindow(4),
+  ClaimsOutstanding(0),
+  ConnectionInfo(hub.connection()),
+  Zmq( new detail::ZmqManagement( hub.connection(), &hub, hub.endpoint() ) ),
+  MessageRouter(),
+  JobQueue( new remus::worker::detail::JobQueue() ),
+  StatusCoalescer( new remus::worker::detail::StatusCoalescer() ),
+  OutboundStatus( new remus::worker::detail::StatusQueue() )
+{
+  //the hub needs to know where our jobs go before the server can send any
+  hub.attach(this->Zmq->VirtualId, this->JobQueue.get());
+
+  std::ostringstream input_buffer;
+  input_buffer << this->MeshRequirements;
+  this->registerWithServer(input_buffer.str());
+}
+
+//-----------------------------------------------------------------------------
+void Worker::registerWithServer(const std::string& requirements)
+{
   remus::proto::send_Message(this->MeshRequirements.meshTypes(),
                             remus::CAN_MESH_REQUIREMENTS,
-                            buffer_str,
+                            requirements,
                             &this->Zmq->Server);
+  this->claimReservedJob(detail::take_ProcessReservation());
 }
 
-
 //-----------------------------------------------------------------------------
 Worker::~Worker()
 {
-  if(this->MessageRouter->valid())
+  if(this->isTalking())
     {
+    //the results need to reach the server before we stop talking to it
+    this->waitForResultAcks(this->resultsSent());
+    ServerLock lock(*this);
+    this->sendQueuedStatus();
+
     //send message that we are shutting down communication, and we can stop
     //polling the server
     remus::proto::send_Message(this->MeshRequirements.meshTypes(),
                                remus::TERMINATE_WORKER,
                                &this->Zmq->Server);
-    } 
+    }
+  if(this->Zmq->Hub)
+    {
+    //the hub can't touch our job queue once we have detached
+    this->Zmq->Hub->detach(this->Zmq->VirtualId);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::isTalking() const
+{
+  if(this->Zmq->Hub)
+    {
+    return this->Zmq->Hub->isForwardingToServer(this->Zmq->VirtualId);
+    }
+  return this->MessageRouter->valid();
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::isForwardingToServer() const
+{
+  if(this->Zmq->Hub)
+    {
+    return this->Zmq->Hub->isForwardingToServer(this->Zmq->VirtualId);
+    }
+  return this->MessageRouter->isForwardingToServer();
 }
 
 //-----------------------------------------------------------------------------
@@ -145,6 +300,11 @@ const remus::worker::ServerConnection& Worker::connection() const
 //------------------------------------------------------------------------------
 void Worker::pollingRates(const remus::worker::PollingRates& rates)
 {
+  if(this->Zmq->Hub)
+    { //the polling rates are shared by all workers of the hub
+    this->Zmq->Hub->pollingRates(rates);
+    return;
+    }
 
   //setup a new polling monitor on the already created MessageRouter.
   //A MessageRouter instance has local state information that needs to exist,
@@ -157,6 +317,10 @@ void Worker::pollingRates(const remus::worker::PollingRates& rates)
 //------------------------------------------------------------------------------
 remus::worker::PollingRates Worker::pollingRates() const
 {
+  if(this->Zmq->Hub)
+    {
+    return this->Zmq->Hub->pollingRates();
+    }
   remus::common::PollingMonitor monitor = this->MessageRouter->pollingMonitor();
   const boost::int64_t low =  monitor.minTimeOut();
   const boost::int64_t high = monitor.maxTimeOut();
@@ -166,31 +330,135 @@ remus::worker::PollingRates Worker::pollingRates() const
 //-----------------------------------------------------------------------------
 void Worker::askForJobs( unsigned int numberOfJobs )
 {
-  if(this->MessageRouter->isForwardingToServer())
+  if(this->isForwardingToServer())
     {
+    ServerLock lock(*this);
     //next we send the MAKE_MESH call with the shorter version of the reqs,
     //which have none of the heavy data.
-    proto::JobRequirements lightReqs(this->MeshRequirements.formatType(),
-                                     this->MeshRequirements.meshTypes(),
-                                     this->MeshRequirements.workerName(),
-                                     "");
-    //override the source type
-    lightReqs.SourceType = this->MeshRequirements.sourceType();
-    lightReqs.Tag = this->MeshRequirements.tag();
-
-    std::ostringstream input_buffer;
-    input_buffer << lightReqs;
-
+    const std::string lightReqs = this->lightRequirements();
     for(unsigned int i=0; i < numberOfJobs; ++i)
       {
       proto::send_Message(this->MeshRequirements.meshTypes(),
                           remus::MAKE_MESH,
-                          input_buffer.str(),
+                          lightReqs,
                           &this->Zmq->Server);
       }
     }
 }
 
+//-----------------------------------------------------------------------------
+void Worker::jobPrefetch( unsigned int numberOfJobs )
+{
+  ServerLock lock(*this);
+  //credits that the server already has can't be taken back, so when the
+  //window shrinks we hold on to that many credits instead of returning them
+  this->CreditsToReturn += static_cast<long long>(numberOfJobs) -
+                           static_cast<long long>(this->PrefetchWindow.load());
+  this->PrefetchWindow.store(numberOfJobs);
+  this->LastDroppedJobCount = this->JobQueue->droppedJobCount();
+  this->returnCredits(0);
+}
+
+//-----------------------------------------------------------------------------
+unsigned int Worker::jobPrefetch() const
+{
+  return this->PrefetchWindow.load();
+}
+
+//-----------------------------------------------------------------------------
+std::string Worker::lightRequirements() const
+{
+  proto::JobRequirements lightReqs(this->MeshRequirements.formatType(),
+                                   this->MeshRequirements.meshTypes(),
+                                   this->MeshRequirements.workerName(),
+                                   "");
+  //override the source type
+  lightReqs.SourceType = this->MeshRequirements.sourceType();
+  lightReqs.Tag = this->MeshRequirements.tag();
+
+  std::ostringstream input_buffer;
+  input_buffer << lightReqs;
+  return input_buffer.str();
+}
+
+//-----------------------------------------------------------------------------
+void Worker::returnCredits(unsigned int jobsTaken)
+{
+  //the caller needs to hold the ServerMutex
+  //jobs that were terminated while pending also give their credit back
+  const std::size_t dropped = this->JobQueue->droppedJobCount();
+  this->CreditsToReturn += jobsTaken +
+              static_cast<long long>(dropped - this->LastDroppedJobCount);
+  this->LastDroppedJobCount = dropped;
+
+  //return credits in batches of half the window, so that a window of
+  //N costs the server two messages per N jobs while keeping at least
+  //half the window pending
+  const unsigned int window = this->PrefetchWindow.load();
+  const long long batch = std::max<long long>(1, window / 2);
+  if(window == 0 || this->CreditsToReturn < batch ||
+     !this->isForwardingToServer())
+    {
+    return;
+    }
+
+  std::ostringstream buffer;
+  buffer << this->CreditsToReturn << '\n';
+  buffer << this->lightRequirements();
+  proto::send_Message(this->MeshRequirements.meshTypes(),
+                      remus::JOB_CREDITS,
+                      buffer.str(),
+                      &this->Zmq->Server);
+  this->CreditsToReturn = 0;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::claimReservedJob(const std::string& reservation)
+{
+  if(reservation.empty() || !this->isForwardingToServer())
+    {
+    return;
+    }
+
+  ServerLock lock(*this);
+  proto::send_Message(this->MeshRequirements.meshTypes(),
+                      remus::CLAIM_RESERVED_JOB,
+                      proto::to_ReservationClaim(reservation,
+                                                 this->lightRequirements()),
+                      &this->Zmq->Server);
+  ++this->ClaimsOutstanding;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::contentCache( std::size_t maxBytes, std::size_t minContentSize )
+{
+  if(!this->isForwardingToServer())
+    {
+    return;
+    }
+
+  //the cache is set up once the server acknowledges it, so that the
+  //server and the job queue both start out with an empty cache
+  ServerLock lock(*this);
+  proto::send_Message(this->MeshRequirements.meshTypes(),
+                      remus::CONTENT_CACHE,
+                      proto::to_string(proto::ContentCacheIndex(maxBytes,
+                                                                minContentSize)),
+                      &this->Zmq->Server);
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::takeOutstandingClaim()
+{
+  ServerLock lock(*this);
+  if(this->ClaimsOutstanding == 0)
+    {
+    return false;
+    }
+  --this->ClaimsOutstanding;
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 std::size_t Worker::pendingJobCount() const
 {
@@ -200,34 +468,195 @@ std::size_t Worker::pendingJobCount() const
 //-----------------------------------------------------------------------------
 remus::worker::Job Worker::takePendingJob()
 {
-  return this->JobQueue->take();
+  remus::worker::Job job = this->JobQueue->take();
+  while(!this->acceptTakenJob(job))
+    {
+    job = this->JobQueue->take();
+    }
+  if(!job.valid())
+    { //the event loop has drained the queue
+    this->JobQueue->rearmNotification();
+    }
+  return job;
+}
+
+//-----------------------------------------------------------------------------
+int Worker::jobNotificationDescriptor()
+{
+  return this->JobQueue->notificationFileDescriptor();
 }
 
 //-----------------------------------------------------------------------------
 remus::worker::Job Worker::getJob()
 {
-  if(this->pendingJobCount() == 0)
+  //with a prefetch window the server sends jobs as soon as it
+  //has them, so there is no need to ask
+  remus::worker::Job job;
+  do
     {
-    this->askForJobs(1);
+    if(this->jobPrefetch() == 0 && this->pendingJobCount() == 0 &&
+       !this->takeOutstandingClaim())
+      {
+      this->askForJobs(1);
+      }
+    job = this->JobQueue->waitAndTakeJob();
     }
-  return this->JobQueue->waitAndTakeJob();
+  while(!this->acceptTakenJob(job));
+  return job;
 }
 
 //-----------------------------------------------------------------------------
-void Worker::updateStatus(const remus::proto::JobStatus& info)
+remus::worker::Job Worker::getJob(boost::int64_t timeoutInMillisec)
+{
+  const boost::system_time deadline = boost::get_system_time() +
+                      boost::posix_time::milliseconds(timeoutInMillisec);
+  remus::worker::Job job;
+  do
+    {
+    if(this->jobPrefetch() == 0 && this->pendingJobCount() == 0 &&
+       !this->takeOutstandingClaim())
+      {
+      this->askForJobs(1);
+      }
+    //a negative timeout waits forever
+    const boost::int64_t remaining = (timeoutInMillisec < 0) ?
+                    timeoutInMillisec : std::max<boost::int64_t>(0,
+                    (deadline - boost::get_system_time()).total_milliseconds());
+    job = this->JobQueue->waitAndTakeJob(remaining);
+    }
+  while(!this->acceptTakenJob(job));
+  return job;
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::acceptTakenJob(const remus::worker::Job& job)
+{
+  //a job the content cache couldn't resolve is marked invalid, but keeps
+  //its id, unlike the invalid job of a timeout
+  const bool unresolved =
+                job.validityReason() == remus::worker::Job::INVALID &&
+                !job.id().is_nil();
+  if(job.valid() || unresolved)
+    {
+    ServerLock lock(*this);
+    this->returnCredits(1);
+    }
+  if(unresolved)
+    {
+    this->sendJobFailure(job,
+              "the worker doesn't have the cached content the job refers to");
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::statusInterval(boost::int64_t intervalInMillisec)
+{
+  ServerLock lock(*this);
+  this->StatusCoalescer->interval(intervalInMillisec);
+  if(this->StatusCoalescer->interval() == 0)
+    { //nothing is allowed to be held anymore
+    this->sendQueuedStatus();
+    this->sendStatus(this->StatusCoalescer->flush(
+                                          this->StatusCoalescer->now()));
+    }
+}
+
+//-----------------------------------------------------------------------------
+boost::int64_t Worker::statusInterval() const
+{
+  ServerLock lock(*this);
+  return this->StatusCoalescer->interval();
+}
+
+//-----------------------------------------------------------------------------
+void Worker::flushStatus()
+{
+  ServerLock lock(*this);
+  this->sendQueuedStatus();
+  this->sendStatus(this->StatusCoalescer->flush(this->StatusCoalescer->now()));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t Worker::coalescedStatusCount() const
 {
-  if(this->MessageRouter->valid())
+  ServerLock lock(*this);
+  return this->StatusCoalescer->coalescedCount();
+}
+
+//-----------------------------------------------------------------------------
+void Worker::publishQueuedStatus() const
+{
+  while(!this->OutboundStatus->empty())
+    {
+    boost::unique_lock<boost::mutex> lock(this->Zmq->ServerMutex,
+                                          boost::try_to_lock);
+    if(!lock.owns_lock())
+      { //the thread talking to the server sends them before it lets go
+      return;
+      }
+    this->sendQueuedStatus();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::sendQueuedStatus() const
+{
+  //the caller needs to hold the ServerMutex
+  if(this->OutboundStatus->empty())
+    {
+    return;
+    }
+
+  const boost::int64_t now = this->StatusCoalescer->now();
+  std::vector<remus::proto::JobStatus> statuses;
+  remus::proto::JobStatus status(boost::uuids::uuid(), remus::INVALID_STATUS);
+  while(this->OutboundStatus->pop(status))
+    {
+    if(this->StatusCoalescer->update(status, now))
+      {
+      statuses.push_back(status);
+      }
+    }
+
+  //piggyback the statuses of other jobs whose interval has passed
+  std::vector<remus::proto::JobStatus> due = this->StatusCoalescer->due(now);
+  statuses.insert(statuses.end(), due.begin(), due.end());
+  this->sendStatus(statuses);
+}
+
+//-----------------------------------------------------------------------------
+void Worker::sendStatus(const std::vector<remus::proto::JobStatus>& statuses) const
+{
+  //the caller needs to hold the ServerMutex
+  if(statuses.empty() || !this->isTalking())
+    {
+    return;
+    }
+
+  typedef std::vector<remus::proto::JobStatus>::const_iterator iter;
+  for(iter i = statuses.begin(); i != statuses.end(); ++i)
     {
     //We want to send status as non blocking so we don't waste cycles
     //waiting to hear back from zmq that the message left its inbox
-    std::string msg = remus::proto::to_string(info);
     remus::proto::send_NonBlockingMessage(this->MeshRequirements.meshTypes(),
                               remus::MESH_STATUS,
-                              msg,
+                              remus::proto::to_string(*i),
                               &this->Zmq->Server);
     }
 }
 
+//-----------------------------------------------------------------------------
+void Worker::updateStatus(const remus::proto::JobStatus& info)
+{
+  if(this->isTalking())
+    {
+    this->OutboundStatus->push(info);
+    this->publishQueuedStatus();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void Worker::sendProgress(const remus::worker::Job& j,
                           int progress, const std::string& message)
@@ -252,22 +681,162 @@ void Worker::sendJobFailure(const remus::worker::Job& j,
 //-----------------------------------------------------------------------------
 void Worker::returnResult(const remus::proto::JobResult& result)
 {
-  if(this->MessageRouter->valid())
+  if(this->isTalking())
     {
-    //send a message that contains, the path to the resulting file
-    std::string msg = remus::proto::to_string(result);
-    remus::proto::send_Message(this->MeshRequirements.meshTypes(),
-                               remus::RETRIEVE_RESULT,
-                               msg,
-                               &this->Zmq->Server);
+    unsigned long long sent = 0;
+    {
+    ServerLock lock(*this);
+    sent = this->sendResult(result);
+    }
 
     //we need to block on waiting for the server to notify it has our result.
     //Otherwise it is possible to delete a worker before it is done transimiting
     //really large results to the server. Don't worry if the server terminates
     //the worker before this is over the MessageRouter spoofs the response.
+    //The acknowledgements arrive in the order the results were sent, so ours
+    //has arrived once that many results are acknowledged
+    this->waitForResultAcks(sent);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::returnResultAsync(const remus::proto::JobResult& result)
+{
+  if(this->isTalking())
+    {
+    //make room for this result in the window. Threads returning results at
+    //the same time can each make room for themselves, so the window can be
+    //exceeded by the number of such threads
+    unsigned long long acknowledged = 0;
+    {
+    boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+    const unsigned long long window = this->ResultUploadWindow;
+    if(this->ResultsSent >= window)
+      {
+      acknowledged = this->ResultsSent - window + 1;
+      }
+    }
+    this->waitForResultAcks(acknowledged);
+
+    ServerLock lock(*this);
+    this->sendResult(result);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::resultUploadWindow( unsigned int numberOfResults )
+{
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  this->ResultUploadWindow = std::max(1u, numberOfResults);
+}
+
+//-----------------------------------------------------------------------------
+unsigned int Worker::resultUploadWindow() const
+{
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  return this->ResultUploadWindow;
+}
+
+//-----------------------------------------------------------------------------
+std::size_t Worker::pendingResultUploads()
+{
+  {
+  ServerLock lock(*this);
+  this->receiveResultAcks();
+  }
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  return static_cast<std::size_t>(this->ResultsSent -
+                                  this->ResultsAcknowledged);
+}
+
+//-----------------------------------------------------------------------------
+void Worker::waitForResultUploads()
+{
+  this->waitForResultAcks(this->resultsSent());
+}
+
+//-----------------------------------------------------------------------------
+unsigned long long Worker::sendResult(const remus::proto::JobResult& result)
+{
+  //the caller needs to hold the ServerMutex
+  //statuses of the job that are still queued need to arrive first, and
+  //the result supersedes any status that is being held for the job
+  this->sendQueuedStatus();
+  this->StatusCoalescer->finished(result.id());
+  this->sendStatus(this->StatusCoalescer->due(this->StatusCoalescer->now()));
+
+  //send a message that contains, the path to the resulting file
+  remus::proto::send_Message(this->MeshRequirements.meshTypes(),
+                             remus::RETRIEVE_RESULT,
+                             remus::proto::to_string(result),
+                             &this->Zmq->Server);
+
+  //results are only sent while holding the ServerMutex, so the count
+  //matches the order in which the server acknowledges them
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  return ++this->ResultsSent;
+}
+
+//-----------------------------------------------------------------------------
+unsigned long long Worker::resultsSent() const
+{
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  return this->ResultsSent;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::receiveResultAcks()
+{
+  //the caller needs to hold the ServerMutex
+  //the only responses the worker is sent are the acknowledgements of
+  //results, and they arrive in the order the results were sent
+  unsigned long long received = 0;
+  while(true)
+    {
+    zmq::pollitem_t item = { this->Zmq->Server, 0, ZMQ_POLLIN, 0 };
+    zmq::poll_safely(&item, 1, 0);
+    if(!(item.revents & ZMQ_POLLIN))
+      {
+      break;
+      }
     remus::proto::Response response =
         remus::proto::receive_Response(&this->Zmq->Server);
     (void) response;
+    ++received;
+    }
+
+  if(received > 0)
+    {
+    boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+    this->ResultsAcknowledged += received;
+    this->Zmq->AckCondition.notify_all();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::waitForResultAcks(unsigned long long acknowledged)
+{
+  //the caller must not hold the ServerMutex.
+  //We look for acknowledgements with a short poll of the socket, and sleep
+  //between polls without the ServerMutex, so other threads can use the
+  //socket while we wait. A thread that takes acknowledgements for us wakes
+  //us up, otherwise we poll again, backing off while the upload takes long
+  boost::int64_t sleepInMillisec = 1;
+  boost::unique_lock<boost::mutex> acks(this->Zmq->AckMutex);
+  while(this->ResultsAcknowledged < acknowledged)
+    {
+    acks.unlock();
+    {
+    ServerLock lock(*this);
+    this->receiveResultAcks();
+    }
+    acks.lock();
+    if(this->ResultsAcknowledged < acknowledged)
+      {
+      this->Zmq->AckCondition.timed_wait(acks,
+                        boost::posix_time::milliseconds(sleepInMillisec));
+      sleepInMillisec = std::min<boost::int64_t>(sleepInMillisec * 2, 32);
+      }
     }
 }
 
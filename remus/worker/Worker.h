@@ -31,6 +31,9 @@ REMUS_THIRDPARTY_POST_INCLUDE
 //included for export symbols
 #include <remus/worker/WorkerExports.h>
 
+#include <atomic>
+#include <vector>
+
 #ifdef REMUS_MSVC
  #pragma warning(push)
  #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
@@ -38,11 +41,14 @@ REMUS_THIRDPARTY_POST_INCLUDE
 
 namespace remus{
 namespace worker{
+  class WorkerHub;
   namespace detail
   {
   //forward declaration of classes only the implementation needs
   class MessageRouter;
   class JobQueue;
+  class StatusCoalescer;
+  class StatusQueue;
   struct ZmqManagement;
   }
 
@@ -70,6 +76,11 @@ private:
 // remus server. Once you get a job from the server you process the given
 // job reporting back the status of the job, and than once finished the
 // results of the job.
+//
+// All methods can be called from multiple threads at once, so a single
+// worker can feed a pool of mesher threads. See WorkerPoolExecutor.
+// Status updates never wait on other threads, so they can be sent from
+// the inner loops of OpenMP or TBB meshers.
 class REMUSWORKER_EXPORT Worker
 {
 public:
@@ -86,6 +97,18 @@ public:
   Worker(const remus::proto::JobRequirements& requirements,
          const remus::worker::ServerConnection& conn);
 
+  //construct a worker that can mesh a single type, and shares the
+  //connection to the server of the given hub. The hub needs to outlive
+  //the worker
+  Worker(remus::common::MeshIOType mtype,
+         remus::worker::WorkerHub& hub);
+
+  //construct a worker that can mesh only an exact set of requirements,
+  //and shares the connection to the server of the given hub. The hub needs
+  //to outlive the worker
+  Worker(const remus::proto::JobRequirements& requirements,
+         remus::worker::WorkerHub& hub);
+
   virtual ~Worker();
 
   //return the connection info that was used to connect to the
@@ -108,6 +131,36 @@ public:
   //that we want to be sent to process
   void askForJobs( unsigned int numberOfJobs = 1 );
 
+  //set how many jobs the server is allowed to send to this worker ahead
+  //of time. The worker tells the server the size of the window once, and
+  //after that gives the credits back in batches as pending jobs are taken
+  //or terminated. The server keeps the pending jobs topped up, and packs
+  //several jobs into a single message when it can, so the worker never
+  //waits a round trip between finishing a job and starting the next one.
+  //A window of zero turns this off, and getJob goes back to asking for
+  //a single job when no jobs are pending
+  void jobPrefetch( unsigned int numberOfJobs );
+  unsigned int jobPrefetch() const;
+
+  //ask the server for the job that it reserved when it asked a factory
+  //to launch this worker. The claim stands in for the next job request
+  //of getJob, and when the reservation is gone the server sends the next
+  //job that matches our requirements instead.
+  //Workers launched by remus::server::WorkerFactory do this on construction,
+  //using the REMUS_WORKER_RESERVATION environment variable, so this is
+  //only needed by custom factories that pass the reservation another way
+  void claimReservedJob(const std::string& reservation);
+
+  //keep up to maxBytes of job content that is at least minContentSize bytes
+  //large, so that the server can send a reference to content this worker
+  //has seen before instead of the content itself. The server also prefers
+  //to send a job to the worker that holds most of its content. Jobs that
+  //are taken always hold the full content.
+  //Calling this again drops everything that is cached, and a maxBytes of
+  //zero turns the cache off
+  void contentCache( std::size_t maxBytes,
+                     std::size_t minContentSize = 64 * 1024 );
+
   //query to see how many pending jobs we need to process
   std::size_t pendingJobCount( ) const;
 
@@ -116,10 +169,48 @@ public:
   //from the server
   remus::worker::Job takePendingJob();
 
+  //returns a file descriptor that can be added to select, poll, epoll
+  //or an asio loop to wait for jobs without blocking a thread in getJob.
+  //The descriptor is readable while takePendingJob has a job or a
+  //TERMINATE_WORKER job to return, and is also made readable when the
+  //server terminates a job, so that jobShouldBeTerminated can be checked.
+  //When it is readable, call takePendingJob until it returns an invalid
+  //job, which makes the descriptor not readable again. Never read from
+  //or close the descriptor, it is owned by the worker.
+  //
+  //Returns -1 on platforms without support, such as Windows
+  int jobNotificationDescriptor();
+
   //Blocking fetch a pending job and return it
   remus::worker::Job getJob();
 
-  //update the status of the worker
+  //Blocking fetch a pending job, that gives up after the given amount of
+  //time and returns an invalid job
+  remus::worker::Job getJob(boost::int64_t timeoutInMillisec);
+
+  //set the minimum time between two status messages of the same job.
+  //Only the latest status of a job is kept, so progress reported in a
+  //tight loop is coalesced into a message per interval. A status that
+  //changes the status type, such as a failure, is always sent right away.
+  //Held statuses are sent by later status updates and results once their
+  //interval has passed, or by flushStatus. The default of zero sends every
+  //status.
+  //
+  //Note: the interval is in milliseconds
+  void statusInterval( boost::int64_t intervalInMillisec );
+  boost::int64_t statusInterval() const;
+
+  //send every status that is being held back by the status interval
+  void flushStatus();
+
+  //returns the number of status updates that were replaced by a newer
+  //status of the same job, and never sent
+  std::size_t coalescedStatusCount() const;
+
+  //update the status of the worker. The status is queued without taking
+  //any locks, and is sent by this thread, or by the thread that is
+  //currently talking to the server. The statuses of a job are sent in the
+  //order they are given.
   void updateStatus(const remus::proto::JobStatus& info);
 
   //send a progress status update. This is a convenience method
@@ -132,9 +223,30 @@ public:
   //JobStatus object and mark it as failed
   void sendJobFailure( const remus::worker::Job&, const std::string& reason );
 
-  //send to the server the mesh results.
+  //send to the server the mesh results. Blocks until the server has
+  //acknowledged the result. The server socket isn't held while waiting,
+  //so other threads can keep getting jobs and sending statuses.
   void returnResult(const remus::proto::JobResult& result);
 
+  //send to the server the mesh results, without waiting for the server to
+  //acknowledge them. The transfer happens on the zmq I/O threads, so the
+  //caller can start on the next job while a large result is uploaded.
+  //Only resultUploadWindow results can be in flight, after which this
+  //waits for the oldest upload to be acknowledged.
+  //The worker waits for all uploads to finish when it is destroyed.
+  void returnResultAsync(const remus::proto::JobResult& result);
+
+  //set how many results can be uploading at the same time. A window
+  //of zero is treated as one. Defaults to four.
+  void resultUploadWindow( unsigned int numberOfResults );
+  unsigned int resultUploadWindow() const;
+
+  //returns the number of results that the server hasn't acknowledged
+  std::size_t pendingResultUploads();
+
+  //blocks until the server has acknowledged every result
+  void waitForResultUploads();
+
   //ask the worker API if the server has told us we should shutdown.
   //This means that the server has shutdown and all jobs the worker
   //has are invalid and can be terminated.
@@ -146,14 +258,92 @@ public:
   bool jobShouldBeTerminated( const remus::worker::Job& job ) const;
 
 private:
+  //holds the lock of the server socket, and sends the statuses that other
+  //threads queued before letting go of it
+  class ServerLock;
+  friend class ServerLock;
+
+  //sends queued statuses for as long as no other thread is talking to the
+  //server. The thread that is, sends them when it is done
+  void publishQueuedStatus() const;
+
+  //sends every queued status, the caller needs to hold the server lock
+  void sendQueuedStatus() const;
+
+  //tells the server what we can mesh, given the serialized requirements,
+  //and claims the job reserved for this process if there is one
+  void registerWithServer(const std::string& requirements);
+
+  //returns true if we are still talking to the server, either
+  //through our own MessageRouter or through the hub
+  bool isTalking() const;
+
+  //returns true if messages are still forwarded to the server
+  bool isForwardingToServer() const;
+
+  //returns the serialized requirements without the requirements data,
+  //which is all the server needs when we ask for jobs
+  std::string lightRequirements() const;
+
+  //gives back the credits of the jobs that have left the pending jobs,
+  //once there are enough of them to send as a batch
+  void returnCredits(unsigned int jobsTaken);
+
+  //returns true once for every call of claimReservedJob, as each
+  //claim already asked the server for a job
+  bool takeOutstandingClaim();
+
+  //gives back the credit of a job that was taken from the pending jobs.
+  //Returns false for a job whose cached content couldn't be resolved,
+  //which is reported to the server as failed and never handed out
+  bool acceptTakenJob(const remus::worker::Job& job);
+
+  //sends the given statuses, the caller needs to hold the server lock
+  void sendStatus(const std::vector<remus::proto::JobStatus>& statuses) const;
+
+  //sends the result, and returns how many results have been sent
+  //including this one. The caller needs to hold the server lock
+  unsigned long long sendResult(const remus::proto::JobResult& result);
+
+  //takes the acknowledgements of results that have already arrived from
+  //the server. The caller needs to hold the server lock
+  void receiveResultAcks();
+
+  //blocks until the server has acknowledged the given number of results.
+  //The server lock is only taken for short polls of the socket, so the
+  //caller must not hold it
+  void waitForResultAcks(unsigned long long acknowledged);
+
+  //returns the number of results that were sent
+  unsigned long long resultsSent() const;
+
   //holds the type of mesh we support
   const remus::proto::JobRequirements MeshRequirements;
 
+  //the number of jobs the server can send ahead of time, and the
+  //credits we still have to give back to the server. The window is
+  //atomic so that getJob can read it without the server lock
+  std::atomic<unsigned int> PrefetchWindow;
+  long long CreditsToReturn;
+  std::size_t LastDroppedJobCount;
+
+  //the number of results sent and acknowledged, and the number that are
+  //allowed to be in flight. These are guarded by the ack mutex, not the
+  //server lock, so waiting on an upload doesn't hold up the server socket
+  unsigned long long ResultsSent;
+  unsigned long long ResultsAcknowledged;
+  unsigned int ResultUploadWindow;
+
+  //the number of claims of reserved jobs that stand in for job requests
+  unsigned int ClaimsOutstanding;
+
   remus::worker::ServerConnection ConnectionInfo;
 
   boost::scoped_ptr<detail::ZmqManagement> Zmq;
   boost::scoped_ptr<remus::worker::detail::MessageRouter> MessageRouter;
   boost::scoped_ptr<remus::worker::detail::JobQueue> JobQueue;
+  boost::scoped_ptr<remus::worker::detail::StatusCoalescer> StatusCoalescer;
+  boost::scoped_ptr<remus::worker::detail::StatusQueue> OutboundStatus;
 
   //explicitly state the worker doesn't support copy or move semantics
   Worker(const Worker&);
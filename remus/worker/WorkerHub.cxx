@@ -0,0 +1,533 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/WorkerHub.h>
+
+#include <remus/proto/Heartbeat.h>
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
+#include <remus/proto/zmqHelper.h>
+
+#include <remus/common/PollingMonitor.h>
+#include <remus/worker/detail/JobQueue.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_io.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <map>
+#include <vector>
+
+namespace
+{
+//the routing state of a single worker that is attached to the hub. This
+//is the same state the MessageRouter holds for a worker of its own
+struct AttachedWorker
+{
+  AttachedWorker():
+    Queue(NULL),
+    ForwardingToServer(true),
+    ForwardingToWorker(true),
+    OutstandingResults(0),
+    LastSentToServer()
+  {}
+
+  //NULL once the worker has detached
+  remus::worker::detail::JobQueue* Queue;
+  bool ForwardingToServer;
+  bool ForwardingToWorker;
+  std::size_t OutstandingResults;
+  //not_a_date_time until the first message is sent for the worker
+  boost::posix_time::ptime LastSentToServer;
+};
+
+//------------------------------------------------------------------------------
+zmq::SocketIdentity to_SocketIdentity(const std::string& virtualId)
+{
+  return zmq::SocketIdentity(virtualId.c_str(), virtualId.size());
+}
+
+}
+
+namespace remus{
+namespace worker{
+
+//-----------------------------------------------------------------------------
+class WorkerHub::WorkerHubImplementation
+{
+  typedef std::map<std::string, AttachedWorker> WorkerMap;
+
+  std::string ChannelName;
+
+  //kept as a member variable so that we can allow the user to specify
+  //custom polling rates for workers
+  remus::common::PollingMonitor PollMonitor;
+
+  //guards the attached workers, which are modified by the threads that
+  //construct and destroy workers
+  mutable boost::mutex WorkersMutex;
+  WorkerMap Workers;
+
+  mutable boost::mutex ThreadMutex;
+  boost::condition_variable ThreadStatusChanged;
+  bool ThreadStarted;
+  bool ContinuePolling;
+
+  boost::scoped_ptr<boost::thread> PollingThread;
+
+public:
+//-----------------------------------------------------------------------------
+WorkerHubImplementation(const remus::worker::ServerConnection& conn):
+  ChannelName(),
+  PollMonitor(boost::int64_t(250), boost::int64_t(60000)), //assign a low floor for faster testing
+  WorkersMutex(),
+  Workers(),
+  ThreadMutex(),
+  ThreadStatusChanged(),
+  ThreadStarted(false),
+  ContinuePolling(true),
+  PollingThread()
+{
+  //use a uuid for the channel name, so that multiple hubs can
+  //share the same context
+  boost::uuids::random_generator generator;
+  this->ChannelName = boost::uuids::to_string(generator());
+
+  this->PollingThread.reset(
+      new boost::thread( &WorkerHubImplementation::poll, this, conn) );
+
+  //workers can't connect until the routing thread has bound
+  boost::unique_lock<boost::mutex> lock(this->ThreadMutex);
+  while(!this->ThreadStarted)
+    {
+    this->ThreadStatusChanged.wait(lock);
+    }
+}
+
+//-----------------------------------------------------------------------------
+~WorkerHubImplementation()
+{
+  {
+  boost::lock_guard<boost::mutex> lock(this->ThreadMutex);
+  this->ContinuePolling = false;
+  }
+  this->PollingThread->join();
+}
+
+//-----------------------------------------------------------------------------
+std::string endpoint() const
+{
+  return zmq::socketInfo<zmq::proto::inproc>(this->ChannelName).endpoint();
+}
+
+//------------------------------------------------------------------------------
+remus::common::PollingMonitor monitor() const { return PollMonitor; }
+
+//-----------------------------------------------------------------------------
+std::size_t size() const
+{
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  std::size_t count = 0;
+  for(WorkerMap::const_iterator i = this->Workers.begin();
+      i != this->Workers.end(); ++i)
+    {
+    if(i->second.Queue != NULL) { ++count; }
+    }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+void attach(const std::string& virtualId,
+            remus::worker::detail::JobQueue* queue)
+{
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  AttachedWorker worker;
+  worker.Queue = queue;
+  this->Workers[virtualId] = worker;
+}
+
+//-----------------------------------------------------------------------------
+void detach(const std::string& virtualId)
+{
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  WorkerMap::iterator i = this->Workers.find(virtualId);
+  if(i == this->Workers.end())
+    {
+    return;
+    }
+
+  //when the server still expects to hear from the worker, the worker has
+  //sent a TERMINATE_WORKER that we haven't routed yet. We hold onto the
+  //worker until that message has been forwarded
+  if(i->second.ForwardingToServer)
+    {
+    i->second.Queue = NULL;
+    }
+  else
+    {
+    this->Workers.erase(i);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool isForwardingToServer(const std::string& virtualId) const
+{
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  WorkerMap::const_iterator i = this->Workers.find(virtualId);
+  return i != this->Workers.end() && i->second.ForwardingToServer;
+}
+
+private:
+//-----------------------------------------------------------------------------
+bool isPolling() const
+{
+  boost::lock_guard<boost::mutex> lock(this->ThreadMutex);
+  return this->ContinuePolling;
+}
+
+//------------------------------------------------------------------------------
+void poll(remus::worker::ServerConnection server_info)
+{
+  //we pass the ServerConnection by value since it is light weight
+
+  //the sockets are created inside the thread so that they are closed
+  //by the thread that uses them
+  zmq::socket_t serverComm(*(server_info.context()),ZMQ_DEALER);
+  zmq::connectToAddress(serverComm, server_info.endpoint());
+
+  zmq::socket_t workerComm(*(server_info.context()),ZMQ_ROUTER);
+  zmq::bindToAddress(workerComm,
+                     zmq::socketInfo<zmq::proto::inproc>(this->ChannelName));
+
+  zmq::pollitem_t items[2]  = {
+                                { workerComm,  0, ZMQ_POLLIN, 0 },
+                                { serverComm,  0, ZMQ_POLLIN, 0 }
+                              };
+
+  {
+  boost::lock_guard<boost::mutex> lock(this->ThreadMutex);
+  this->ThreadStarted = true;
+  }
+  this->ThreadStatusChanged.notify_all();
+
+  boost::posix_time::ptime nextHeartbeat =
+      boost::posix_time::microsec_clock::local_time();
+  while( this->isPolling() )
+    {
+    zmq::poll_safely(&items[0],2,this->PollMonitor.current());
+    this->PollMonitor.pollOccurred();
+
+    if(items[1].revents & ZMQ_POLLIN)
+      {
+      //Handle server messages before worker messages so that we don't
+      //send messages to a server that is now telling us to shut down
+      this->handleServerMessage(workerComm, serverComm);
+      }
+    if(items[0].revents & ZMQ_POLLIN)
+      {
+      this->handleWorkerMessage(workerComm, serverComm);
+      }
+
+    this->drainQueues();
+
+    //every attached worker needs a heartbeat, so we send them as a round
+    //at most once per minimum polling interval instead of after every poll
+    const boost::posix_time::ptime now =
+        boost::posix_time::microsec_clock::local_time();
+    if(now >= nextHeartbeat)
+      {
+      this->sendHeartBeats(serverComm, this->PollMonitor, now);
+      nextHeartbeat = now + boost::posix_time::milliseconds(
+                                          this->PollMonitor.minTimeOut());
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+//handles taking messages from the workers
+void handleWorkerMessage(zmq::socket_t& workerComm,
+                         zmq::socket_t& serverComm)
+{
+  const zmq::SocketIdentity workerIdentity = zmq::address_recv(workerComm);
+  remus::proto::Message message = remus::proto::receive_Message(&workerComm);
+  if(!message.isValid())
+    {
+    return;
+    }
+  const std::string virtualId(workerIdentity.data(), workerIdentity.size());
+
+  bool forward = false;
+  {
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  WorkerMap::iterator i = this->Workers.find(virtualId);
+  if(i != this->Workers.end() && i->second.ForwardingToServer)
+    {
+    forward = true;
+    AttachedWorker& worker = i->second;
+    worker.LastSentToServer = boost::posix_time::microsec_clock::local_time();
+    if(message.serviceType()==remus::TERMINATE_WORKER)
+      {
+      //the worker is shutting down, so we stop routing to and from it
+      if(worker.Queue && worker.ForwardingToWorker)
+        {
+        worker.Queue->terminateWorker();
+        }
+      worker.ForwardingToWorker = false;
+      worker.ForwardingToServer = false;
+      if(worker.Queue == NULL)
+        {
+        this->Workers.erase(i);
+        }
+      }
+    else if(message.serviceType()==remus::RETRIEVE_RESULT)
+      {
+      //Mark that we need a response from the server, so that the worker
+      //doesn't go away before the server has all of the results
+      ++worker.OutstandingResults;
+      }
+    }
+  }
+
+  if(forward)
+    {
+    remus::proto::forward_Message(message, virtualId, &serverComm);
+    }
+  else if(message.serviceType()==remus::RETRIEVE_RESULT)
+    {
+    //the server has already told the worker to terminate, so it will
+    //never acknowledge the result. We do it so the worker doesn't block
+    remus::proto::send_NonBlockingResponse(remus::RETRIEVE_RESULT,
+                                           remus::INVALID_MSG,
+                                           &workerComm,
+                                           to_SocketIdentity(virtualId));
+    }
+}
+
+//------------------------------------------------------------------------------
+//handles taking messages from the server, which are routed to a worker
+//based on the virtual id they carry
+void handleServerMessage(zmq::socket_t& workerComm,
+                         zmq::socket_t& serverComm)
+{
+  remus::proto::Response response = remus::proto::receive_Response(&serverComm);
+  if(!response.isValid())
+    {
+    return;
+    }
+
+  const std::string& virtualId = response.requestId();
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  WorkerMap::iterator i = this->Workers.find(virtualId);
+  if(i == this->Workers.end())
+    {
+    return;
+    }
+
+  AttachedWorker& worker = i->second;
+  const bool goodToForwardToQueue = worker.Queue && worker.ForwardingToWorker;
+  switch(response.serviceType())
+    {
+    case remus::TERMINATE_WORKER:
+      if(goodToForwardToQueue)
+        {
+        worker.Queue->handleResponse(response);
+        }
+      //if the worker is still waiting for a response to a RETRIEVE_RESULT
+      //we send that first
+      while(worker.OutstandingResults > 0)
+        {
+        remus::proto::send_NonBlockingResponse(remus::RETRIEVE_RESULT,
+                                               remus::INVALID_MSG,
+                                               &workerComm,
+                                               to_SocketIdentity(virtualId));
+        --worker.OutstandingResults;
+        }
+      //the server might not exist anymore, so don't send it messages
+      worker.ForwardingToServer = false;
+      if(worker.Queue == NULL)
+        {
+        this->Workers.erase(i);
+        }
+      break;
+    case remus::TERMINATE_JOB:
+    case remus::MAKE_MESH:
+    case remus::MAKE_MESH_BATCH:
+    case remus::CONTENT_CACHE:
+    case remus::OPEN_MODEL_SESSION:
+    case remus::CLOSE_MODEL_SESSION:
+      if(goodToForwardToQueue)
+        {
+        worker.Queue->handleResponse(response);
+        }
+      break;
+    case remus::RETRIEVE_RESULT:
+      //the server has our results, so let the worker stop blocking
+      remus::proto::forward_Response(response,
+                                     &workerComm,
+                                     to_SocketIdentity(virtualId));
+      if(worker.OutstandingResults > 0)
+        {
+        --worker.OutstandingResults;
+        }
+      break;
+    default:
+      break;
+    }
+}
+
+//------------------------------------------------------------------------------
+//move jobs that didn't fit into the rings of each queue
+void drainQueues()
+{
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  for(WorkerMap::iterator i = this->Workers.begin();
+      i != this->Workers.end(); ++i)
+    {
+    if(i->second.Queue && i->second.ForwardingToWorker)
+      {
+      i->second.Queue->drainOverflow();
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+//sends a heartbeat for every worker that is still talking to the server,
+//but has been quiet for half of the promised interval. Every message the
+//server gets for a worker already tells it the worker is alive
+void sendHeartBeats(zmq::socket_t& serverComm,
+                    const remus::common::PollingMonitor& m,
+                    const boost::posix_time::ptime& now)
+{
+  //see MessageRouter for why we send the max time out
+  const boost::int64_t polldur = m.maxTimeOut();
+  const boost::posix_time::time_duration quiet =
+      boost::posix_time::milliseconds(polldur/2);
+
+  std::vector<std::string> idle;
+  {
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  for(WorkerMap::const_iterator i = this->Workers.begin();
+      i != this->Workers.end(); ++i)
+    {
+    const AttachedWorker& worker = i->second;
+    if(worker.ForwardingToServer &&
+       ( worker.LastSentToServer.is_not_a_date_time() ||
+         now - worker.LastSentToServer >= quiet) )
+      {
+      idle.push_back(i->first);
+      }
+    }
+  }
+
+  const std::string payload = remus::proto::to_HeartbeatPayload(polldur);
+  std::vector<std::string> sent;
+  typedef std::vector<std::string>::const_iterator iter;
+  for(iter i = idle.begin(); i != idle.end(); ++i)
+    {
+    //if the heartbeat can't be queued right now, we try again next round
+    remus::proto::Message hb =
+      remus::proto::send_NonBlockingMessage(remus::common::MeshIOType(),
+                                            remus::HEARTBEAT,
+                                            payload,
+                                            *i,
+                                            &serverComm);
+    if(hb.isValid())
+      {
+      sent.push_back(*i);
+      }
+    }
+
+  boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+  for(iter i = sent.begin(); i != sent.end(); ++i)
+    {
+    WorkerMap::iterator w = this->Workers.find(*i);
+    if(w != this->Workers.end())
+      {
+      w->second.LastSentToServer = now;
+      }
+    }
+}
+
+};
+
+//-----------------------------------------------------------------------------
+WorkerHub::WorkerHub(const remus::worker::ServerConnection& conn):
+  ConnectionInfo(conn),
+  Implementation( new WorkerHubImplementation(conn) )
+{
+}
+
+//-----------------------------------------------------------------------------
+WorkerHub::~WorkerHub()
+{
+}
+
+//-----------------------------------------------------------------------------
+const remus::worker::ServerConnection& WorkerHub::connection() const
+{
+  return this->ConnectionInfo;
+}
+
+//-----------------------------------------------------------------------------
+std::size_t WorkerHub::numberOfWorkers() const
+{
+  return this->Implementation->size();
+}
+
+//------------------------------------------------------------------------------
+void WorkerHub::pollingRates(const remus::worker::PollingRates& rates)
+{
+  this->Implementation->monitor().changeTimeOutRates(rates.minRate(),
+                                                     rates.maxRate());
+}
+
+//------------------------------------------------------------------------------
+remus::worker::PollingRates WorkerHub::pollingRates() const
+{
+  remus::common::PollingMonitor monitor = this->Implementation->monitor();
+  return remus::worker::PollingRates(monitor.minTimeOut(),
+                                     monitor.maxTimeOut());
+}
+
+//-----------------------------------------------------------------------------
+std::string WorkerHub::endpoint() const
+{
+  return this->Implementation->endpoint();
+}
+
+//-----------------------------------------------------------------------------
+void WorkerHub::attach(const std::string& virtualId,
+                       detail::JobQueue* queue)
+{
+  this->Implementation->attach(virtualId, queue);
+}
+
+//-----------------------------------------------------------------------------
+void WorkerHub::detach(const std::string& virtualId)
+{
+  this->Implementation->detach(virtualId);
+}
+
+//-----------------------------------------------------------------------------
+bool WorkerHub::isForwardingToServer(const std::string& virtualId) const
+{
+  return this->Implementation->isForwardingToServer(virtualId);
+}
+
+}
+}
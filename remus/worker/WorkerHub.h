@@ -0,0 +1,103 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_WorkerHub_h
+#define remus_worker_WorkerHub_h
+
+#include <remus/worker/Worker.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/scoped_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <string>
+
+//included for export symbols
+#include <remus/worker/WorkerExports.h>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus{
+namespace worker{
+
+//The WorkerHub lets any number of Worker instances in a process share a
+//single connection to the server, and a single thread that routes messages
+//between the server and the workers. A Worker that is connected to the
+//server directly needs two polling threads and a connection of its own.
+//
+//Each worker that is attached to the hub is given a virtual identity, which
+//is sent along with every message, so the server still treats each of them
+//as a worker of its own. Workers are attached by constructing them with the
+//hub instead of a ServerConnection.
+//
+//The hub needs to outlive every worker that is attached to it.
+class REMUSWORKER_EXPORT WorkerHub
+{
+public:
+  //connect to the server described by the server connection, and start
+  //the routing thread
+  explicit WorkerHub(const remus::worker::ServerConnection& conn);
+
+  //stops the routing thread and disconnects from the server
+  ~WorkerHub();
+
+  //return the connection info that was used to connect to the
+  //remus server
+  const remus::worker::ServerConnection& connection() const;
+
+  //return the number of workers that are attached to the hub
+  std::size_t numberOfWorkers() const;
+
+  //Modify the polling interval rates of the hub. These apply to every
+  //worker attached to the hub. See Worker::pollingRates for more details
+  void pollingRates( const remus::worker::PollingRates& rates );
+  remus::worker::PollingRates pollingRates() const;
+
+private:
+  //explicitly state the hub doesn't support copy or move semantics
+  WorkerHub(const WorkerHub&);
+  void operator=(const WorkerHub&);
+
+  //the worker attaches to and detaches from the hub
+  friend class remus::worker::Worker;
+
+  //the inproc endpoint that attached workers connect to
+  std::string endpoint() const;
+
+  //route the responses for the virtual id to the queue. The queue needs
+  //to stay valid until detach is called
+  void attach(const std::string& virtualId, detail::JobQueue* queue);
+  void detach(const std::string& virtualId);
+
+  //returns true if messages from the worker are still sent to the server
+  bool isForwardingToServer(const std::string& virtualId) const;
+
+  remus::worker::ServerConnection ConnectionInfo;
+
+  class WorkerHubImplementation;
+  boost::scoped_ptr<WorkerHubImplementation> Implementation;
+};
+
+}
+
+typedef remus::worker::WorkerHub WorkerHub;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
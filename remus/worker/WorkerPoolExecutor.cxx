@@ -0,0 +1,188 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/WorkerPoolExecutor.h>
+
+//suppress warnings inside boost headers for gcc and clang
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+//how long an idle thread waits for a job before checking if it
+//has been told to stop
+const boost::int64_t IdlePollMillisec = 250;
+}
+
+namespace remus{
+namespace worker{
+
+//-----------------------------------------------------------------------------
+class WorkerPoolExecutor::ExecutorImplementation
+{
+public:
+  ExecutorImplementation(std::size_t numberOfThreads):
+    NumberOfThreads( std::max<std::size_t>(1, numberOfThreads) ),
+    Threads(),
+    Started(false),
+    Stopping(false),
+    ActiveJobs(0),
+    CompletedJobs(0)
+  {
+  }
+
+  ~ExecutorImplementation()
+  {
+    this->stop();
+    this->wait();
+  }
+
+  bool start(remus::worker::Worker* worker, const Handler& handler)
+  {
+    if(this->Started)
+      {
+      return false;
+      }
+    this->Started = true;
+    for(std::size_t i=0; i < this->NumberOfThreads; ++i)
+      {
+      this->Threads.create_thread(
+          boost::bind(&ExecutorImplementation::run, this, worker, handler) );
+      }
+    return true;
+  }
+
+  void stop() { this->Stopping.store(true); }
+
+  void wait() { this->Threads.join_all(); }
+
+  std::size_t numberOfThreads() const { return this->NumberOfThreads; }
+  std::size_t activeJobCount() const { return this->ActiveJobs.load(); }
+  std::size_t completedJobCount() const { return this->CompletedJobs.load(); }
+
+private:
+  void run(remus::worker::Worker* worker, Handler handler)
+  {
+    while(!this->Stopping.load())
+      {
+      //other threads waiting on the upload of a result don't hold up getJob
+      remus::worker::Job job = worker->getJob(IdlePollMillisec);
+      if(!job.valid())
+        {
+        if(job.validityReason() == remus::worker::Job::TERMINATE_WORKER)
+          {
+          break;
+          }
+        continue;
+        }
+
+      //a client could have terminated the job while it was pending
+      if(worker->jobShouldBeTerminated(job))
+        {
+        continue;
+        }
+
+      ++this->ActiveJobs;
+      handler(job, *worker);
+      --this->ActiveJobs;
+      ++this->CompletedJobs;
+      }
+  }
+
+  const std::size_t NumberOfThreads;
+  boost::thread_group Threads;
+  bool Started;
+  std::atomic<bool> Stopping;
+  std::atomic<std::size_t> ActiveJobs;
+  std::atomic<std::size_t> CompletedJobs;
+};
+
+//-----------------------------------------------------------------------------
+WorkerPoolExecutor::WorkerPoolExecutor(remus::common::MeshIOType mtype,
+                                const remus::worker::ServerConnection& conn,
+                                std::size_t numberOfThreads):
+  Worker( new remus::worker::Worker(mtype, conn) ),
+  Implementation( new ExecutorImplementation(numberOfThreads) )
+{
+  //let the server keep a job pending for every thread
+  this->Worker->jobPrefetch(
+              static_cast<unsigned int>(this->Implementation->numberOfThreads()));
+}
+
+//-----------------------------------------------------------------------------
+WorkerPoolExecutor::WorkerPoolExecutor(
+                                const remus::proto::JobRequirements& requirements,
+                                const remus::worker::ServerConnection& conn,
+                                std::size_t numberOfThreads):
+  Worker( new remus::worker::Worker(requirements, conn) ),
+  Implementation( new ExecutorImplementation(numberOfThreads) )
+{
+  //let the server keep a job pending for every thread
+  this->Worker->jobPrefetch(
+              static_cast<unsigned int>(this->Implementation->numberOfThreads()));
+}
+
+//-----------------------------------------------------------------------------
+WorkerPoolExecutor::~WorkerPoolExecutor()
+{
+  //the threads need to finish before the worker they share goes away
+  this->Implementation.reset();
+}
+
+//-----------------------------------------------------------------------------
+bool WorkerPoolExecutor::start(const Handler& handler)
+{
+  return this->Implementation->start(this->Worker.get(), handler);
+}
+
+//-----------------------------------------------------------------------------
+void WorkerPoolExecutor::stop()
+{
+  this->Implementation->stop();
+}
+
+//-----------------------------------------------------------------------------
+void WorkerPoolExecutor::wait()
+{
+  this->Implementation->wait();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t WorkerPoolExecutor::numberOfThreads() const
+{
+  return this->Implementation->numberOfThreads();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t WorkerPoolExecutor::activeJobCount() const
+{
+  return this->Implementation->activeJobCount();
+}
+
+//-----------------------------------------------------------------------------
+std::size_t WorkerPoolExecutor::completedJobCount() const
+{
+  return this->Implementation->completedJobCount();
+}
+
+//-----------------------------------------------------------------------------
+remus::worker::Worker& WorkerPoolExecutor::worker()
+{
+  return *this->Worker;
+}
+
+}
+}
@@ -0,0 +1,117 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_WorkerPoolExecutor_h
+#define remus_worker_WorkerPoolExecutor_h
+
+#include <remus/worker/Worker.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+//included for export symbols
+#include <remus/worker/WorkerExports.h>
+
+#ifdef REMUS_MSVC
+ #pragma warning(push)
+ #pragma warning(disable:4251)  /*dll-interface missing on stl type*/
+#endif
+
+namespace remus{
+namespace worker{
+
+//The WorkerPoolExecutor runs a pool of mesher threads behind a single
+//worker connection. Compared to running a Worker per thread, this
+//only needs one server registration, one set of heartbeats and one set of
+//router threads for the entire pool.
+//
+//Each thread takes a job and calls the handler with the job and the shared
+//worker, which the handler uses to send status and return the result. The
+//server is allowed to send up to a job per thread ahead of time, so
+//threads don't wait on the server between jobs. Handlers should use
+//returnResultAsync, so threads don't wait on the upload of their result
+//either. The uploads still in flight are waited for when the executor is
+//destroyed.
+//
+//The threads stop when the server tells the worker to terminate, or
+//when the executor is stopped or destroyed.
+class REMUSWORKER_EXPORT WorkerPoolExecutor
+{
+public:
+  typedef boost::function< void (const remus::worker::Job&,
+                                 remus::worker::Worker&) > Handler;
+
+  //construct an executor that can mesh a single type, using the given
+  //number of mesher threads. At least a single thread is always used
+  WorkerPoolExecutor(remus::common::MeshIOType mtype,
+                     const remus::worker::ServerConnection& conn,
+                     std::size_t numberOfThreads);
+
+  //construct an executor that can mesh only an exact set of requirements,
+  //using the given number of mesher threads
+  WorkerPoolExecutor(const remus::proto::JobRequirements& requirements,
+                     const remus::worker::ServerConnection& conn,
+                     std::size_t numberOfThreads);
+
+  //stops the threads, waiting for the jobs that are being processed
+  //to finish, and than disconnects from the server
+  ~WorkerPoolExecutor();
+
+  //start the mesher threads, each of which calls the handler for every
+  //job it takes. The handler is called from multiple threads at once.
+  //returns false if the executor has already been started
+  bool start(const Handler& handler);
+
+  //tell the threads to stop once they have finished their current job.
+  //this doesn't wait for the threads, use wait for that
+  void stop();
+
+  //blocks until every thread has stopped, which happens once the server
+  //tells the worker to terminate, or after stop has been called
+  void wait();
+
+  //return the number of mesher threads
+  std::size_t numberOfThreads() const;
+
+  //return the number of threads that are inside the handler
+  std::size_t activeJobCount() const;
+
+  //return the number of jobs the handler has been called with
+  std::size_t completedJobCount() const;
+
+  //the worker that is shared by all the threads
+  remus::worker::Worker& worker();
+
+private:
+  //explicitly state the executor doesn't support copy or move semantics
+  WorkerPoolExecutor(const WorkerPoolExecutor&);
+  void operator=(const WorkerPoolExecutor&);
+
+  boost::scoped_ptr<remus::worker::Worker> Worker;
+
+  class ExecutorImplementation;
+  boost::scoped_ptr<ExecutorImplementation> Implementation;
+};
+
+}
+
+typedef remus::worker::WorkerPoolExecutor WorkerPoolExecutor;
+
+}
+
+#ifdef REMUS_MSVC
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/ContentCache.h>
+
+#include <vector>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//------------------------------------------------------------------------------
+ContentCache::ContentCache():
+  Index(),
+  Contents(),
+  Misses(0)
+{
+}
+
+//------------------------------------------------------------------------------
+void ContentCache::reset(const remus::proto::ContentCacheIndex& index)
+{
+  this->Index = index;
+  this->Contents.clear();
+}
+
+//------------------------------------------------------------------------------
+remus::worker::Job ContentCache::resolve(const remus::worker::Job& job)
+{
+  if(!this->enabled() || !job.valid())
+    {
+    return job;
+    }
+
+  //the server walks the contents in the same order when it decides what
+  //to send by reference, so that both indices see the same sequence
+  remus::proto::JobSubmission submission = job.submission();
+  bool missed = false;
+  typedef remus::proto::JobSubmission::iterator iter;
+  for(iter i = submission.begin(); i != submission.end(); ++i)
+    {
+    remus::proto::JobContent& content = i->second;
+    if(content.isReference())
+      {
+      const std::string hash = content.referencedHash();
+      std::map<std::string, remus::proto::JobContent>::const_iterator cached =
+                                                    this->Contents.find(hash);
+      if(cached != this->Contents.end() && this->Index.touch(hash))
+        {
+        content = content.resolve(cached->second);
+        }
+      else
+        {
+        ++this->Misses;
+        missed = true;
+        content = remus::proto::JobContent();
+        }
+      }
+    else if(this->Index.cacheable(content.dataSize()))
+      {
+      std::vector<std::string> evicted;
+      this->Index.insert(content.hash(), content.dataSize(), evicted);
+      this->Contents[content.hash()] = content;
+      for(std::size_t e=0; e < evicted.size(); ++e)
+        {
+        this->Contents.erase(evicted[e]);
+        }
+      }
+    }
+
+  remus::worker::Job resolved(job.id(), submission);
+  resolved.updateValidityReason(missed ? remus::worker::Job::INVALID
+                                       : job.validityReason());
+  return resolved;
+}
+
+}
+}
+}
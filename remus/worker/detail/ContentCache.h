@@ -0,0 +1,70 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_detail_ContentCache_h
+#define remus_worker_detail_ContentCache_h
+
+#include <remus/proto/ContentCacheIndex.h>
+#include <remus/proto/JobContent.h>
+#include <remus/worker/Job.h>
+
+#include <map>
+#include <string>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//Holds on to the content of the jobs a worker was sent, so that the server
+//can refer to content the worker has already seen by its hash, instead of
+//sending it again. The server keeps the same index as the cache, see
+//remus::proto::ContentCacheIndex.
+//
+//The cache isn't thread safe, it is only used by the thread that
+//decodes the jobs from the server.
+class ContentCache
+{
+public:
+  //construct a disabled cache
+  ContentCache();
+
+  //drop everything that is cached and use the given index, which is
+  //what the server sends when it acknowledges the cache
+  void reset(const remus::proto::ContentCacheIndex& index);
+
+  bool enabled() const { return this->Index.enabled(); }
+
+  const remus::proto::ContentCacheIndex& index() const { return this->Index; }
+
+  //returns the job with every reference replaced by the cached content,
+  //and caches the content of the job that is worth caching. When a
+  //reference is to content that isn't cached, which only happens when the
+  //worker and the server disagree on the cache, the job is returned marked
+  //as INVALID, so the worker can fail it instead of running it with
+  //missing content.
+  remus::worker::Job resolve(const remus::worker::Job& job);
+
+  //the number of references that didn't match anything in the cache.
+  //This only ever increases
+  std::size_t missCount() const { return this->Misses; }
+
+private:
+  remus::proto::ContentCacheIndex Index;
+  std::map<std::string, remus::proto::JobContent> Contents;
+  std::size_t Misses;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,136 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/JobNotifier.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/thread/locks.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#if defined(REMUS_HAVE_EVENTFD_H)
+# include <sys/eventfd.h>
+# include <unistd.h>
+#elif !defined(_WIN32) || defined(__CYGWIN__)
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//-----------------------------------------------------------------------------
+JobNotifier::JobNotifier():
+  OpenMutex(),
+  Opened(false),
+  Signaled(false),
+  ReadFd(-1),
+  WriteFd(-1)
+{
+}
+
+//-----------------------------------------------------------------------------
+JobNotifier::~JobNotifier()
+{
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  if(this->ReadFd >= 0)
+    {
+    close(this->ReadFd);
+    }
+  if(this->WriteFd >= 0 && this->WriteFd != this->ReadFd)
+    {
+    close(this->WriteFd);
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int JobNotifier::fileDescriptor()
+{
+  boost::lock_guard<boost::mutex> lock(this->OpenMutex);
+  if(this->Opened.load())
+    {
+    return this->ReadFd;
+    }
+
+#if defined(REMUS_HAVE_EVENTFD_H)
+  this->ReadFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  this->WriteFd = this->ReadFd;
+#elif !defined(_WIN32) || defined(__CYGWIN__)
+  int fds[2];
+  if(pipe(fds) == 0)
+    {
+    for(int i=0; i < 2; ++i)
+      {
+      fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+      fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+      }
+    this->ReadFd = fds[0];
+    this->WriteFd = fds[1];
+    }
+#endif
+
+  if(this->ReadFd >= 0)
+    {
+    this->Opened.store(true);
+    }
+  return this->ReadFd;
+}
+
+//-----------------------------------------------------------------------------
+void JobNotifier::signal()
+{
+  if(!this->Opened.load() || this->Signaled.exchange(true))
+    { //nobody is listening, or the descriptor is already readable
+    return;
+    }
+
+#if defined(REMUS_HAVE_EVENTFD_H)
+  const boost::uint64_t one = 1;
+  ssize_t written = write(this->WriteFd, &one, sizeof(one));
+  (void)written;
+#elif !defined(_WIN32) || defined(__CYGWIN__)
+  //a full pipe is still readable, so a failed write is fine
+  const char one = 1;
+  ssize_t written = write(this->WriteFd, &one, sizeof(one));
+  (void)written;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void JobNotifier::clear()
+{
+  if(!this->Opened.load())
+    {
+    return;
+    }
+
+  //drain before resetting the flag, so that a signal racing with us is
+  //either drained and then seen by the caller re-checking the queue, or
+  //is written after the flag is reset
+#if defined(REMUS_HAVE_EVENTFD_H)
+  boost::uint64_t count = 0;
+  ssize_t bytes = read(this->ReadFd, &count, sizeof(count));
+  (void)bytes;
+#elif !defined(_WIN32) || defined(__CYGWIN__)
+  char buffer[64];
+  while(read(this->ReadFd, buffer, sizeof(buffer)) > 0)
+    {
+    }
+#endif
+  this->Signaled.store(false);
+}
+
+}
+}
+}
@@ -0,0 +1,74 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_detail_JobNotifier_h
+#define remus_worker_detail_JobNotifier_h
+
+#include <remus/common/CompilerInformation.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread/mutex.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <atomic>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//A file descriptor that becomes readable when the JobQueue has something
+//for the worker, so that applications can wait for jobs in their own
+//select, poll, epoll or asio loop instead of in a dedicated thread.
+//
+//The descriptor is an eventfd where available and the read end of a pipe
+//on other posix platforms. It is only created the first time it is asked
+//for, so workers that never use it don't pay for it. Until then, and on
+//platforms without support, signal and clear do nothing.
+//
+//Signalling is cheap once the descriptor is readable, as only the
+//transition from not readable to readable needs a system call.
+class JobNotifier
+{
+public:
+  JobNotifier();
+  ~JobNotifier();
+
+  //returns the readable end of the descriptor, creating it if needed.
+  //Returns -1 if the platform has no support
+  int fileDescriptor();
+
+  //returns true once the descriptor has been created
+  bool isOpen() const { return this->Opened.load(); }
+
+  //make the descriptor readable
+  void signal();
+
+  //make the descriptor not readable
+  void clear();
+
+private:
+  boost::mutex OpenMutex;
+  std::atomic<bool> Opened;
+  std::atomic<bool> Signaled;
+  int ReadFd;
+  int WriteFd;
+
+  //make copying not possible
+  JobNotifier (const JobNotifier&);
+  void operator = (const JobNotifier&);
+};
+
+}
+}
+}
+
+#endif
@@ -11,9 +11,12 @@
 //=============================================================================
 
 #include <remus/worker/detail/JobQueue.h>
+#include <remus/worker/detail/ContentCache.h>
+#include <remus/worker/detail/JobNotifier.h>
 
-#include <remus/proto/Response.h>
 #include <remus/proto/JobSubmission.h>
+#include <remus/proto/ModelSession.h>
+#include <remus/proto/Response.h>
 
 //suppress warnings inside boost headers for gcc and clang
 REMUS_THIRDPARTY_PRE_INCLUDE
@@ -21,8 +24,12 @@ REMUS_THIRDPARTY_PRE_INCLUDE
 #include <boost/thread/locks.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <map>
 #include <set>
+#include <vector>
 
 namespace
 {
@@ -36,6 +43,158 @@ struct JobIdMatches
 
     boost::uuids::uuid UUID;
   };
+
+//------------------------------------------------------------------------------
+//A bounded lock free ring of jobs with a single producer, the polling thread,
+//and any number of consumers. Each slot has a sequence number that tells
+//consumers when a slot has been filled, and the producer when it has been
+//emptied. Jobs can be cancelled while in the ring by the producer, which
+//races the consumers for the slot, so that terminated jobs never reach
+//the mesher
+class JobRing
+{
+public:
+  JobRing():
+    Slots(Capacity),
+    EnqueuePos(0),
+    DequeuePos(0)
+  {
+    for(std::size_t i=0; i < Capacity; ++i)
+      {
+      this->Slots[i].Sequence.store(i, std::memory_order_relaxed);
+      }
+  }
+
+  //called by the producer, returns false if the ring is full
+  bool push(const remus::worker::Job& job)
+  {
+    const std::size_t pos = this->EnqueuePos.load(std::memory_order_relaxed);
+    Slot& slot = this->Slots[pos & (Capacity-1)];
+    if(slot.Sequence.load(std::memory_order_acquire) != pos)
+      {
+      return false;
+      }
+    slot.Id = job.id();
+    slot.Job = job;
+    slot.State.store(READY, std::memory_order_relaxed);
+    slot.Sequence.store(pos+1, std::memory_order_release);
+    this->EnqueuePos.store(pos+1, std::memory_order_release);
+    return true;
+  }
+
+  //called by any consumer, returns false if the ring has no jobs. Jobs
+  //that have been cancelled are skipped
+  bool pop(remus::worker::Job& job)
+  {
+    while(true)
+      {
+      std::size_t pos = this->DequeuePos.load(std::memory_order_relaxed);
+      Slot* slot = NULL;
+      while(true)
+        {
+        slot = &this->Slots[pos & (Capacity-1)];
+        const std::size_t seq = slot->Sequence.load(std::memory_order_acquire);
+        if(seq == pos+1)
+          {
+          if(this->DequeuePos.compare_exchange_weak(pos, pos+1,
+                                                    std::memory_order_relaxed))
+            { break; }
+          }
+        else if(seq < pos+1)
+          { //the producer hasn't filled this slot yet
+          return false;
+          }
+        else
+          {
+          pos = this->DequeuePos.load(std::memory_order_relaxed);
+          }
+        }
+
+      int expected = READY;
+      const bool taken = slot->State.compare_exchange_strong(expected, TAKEN);
+      if(taken)
+        {
+        job = slot->Job;
+        }
+      //release the memory of the job before handing the slot back
+      slot->Job = remus::worker::Job();
+      slot->Sequence.store(pos+Capacity, std::memory_order_release);
+      if(taken)
+        {
+        return true;
+        }
+      }
+  }
+
+  //returns true if no slot is waiting to be taken. Cancelled jobs
+  //count as waiting until a consumer skips over them
+  bool empty() const
+  {
+    return this->DequeuePos.load(std::memory_order_acquire) ==
+           this->EnqueuePos.load(std::memory_order_acquire);
+  }
+
+  //called by the producer, cancels every job in the ring that matches.
+  //returns the number of jobs that were cancelled
+  std::size_t cancel(const boost::uuids::uuid& id)
+  {
+    return this->cancelMatching(&id);
+  }
+
+  //called by the producer, cancels every job in the ring
+  std::size_t cancelAll()
+  {
+    return this->cancelMatching(NULL);
+  }
+
+private:
+  enum SlotState { READY, TAKEN, CANCELLED };
+
+  struct Slot
+  {
+    Slot(): Sequence(0), State(TAKEN), Id(), Job() {}
+
+    std::atomic<std::size_t> Sequence;
+    std::atomic<int> State;
+    //only written by the producer, so that it can be read while
+    //a consumer owns the slot
+    boost::uuids::uuid Id;
+    remus::worker::Job Job;
+  };
+
+  std::size_t cancelMatching(const boost::uuids::uuid* id)
+  {
+    //only the producer fills slots, so every slot between the consumers
+    //and the producer holds the job the producer put there, or has been
+    //emptied by a consumer
+    std::size_t cancelled = 0;
+    const std::size_t end = this->EnqueuePos.load(std::memory_order_relaxed);
+    std::size_t pos = this->DequeuePos.load(std::memory_order_acquire);
+    for(; pos != end; ++pos)
+      {
+      Slot& slot = this->Slots[pos & (Capacity-1)];
+      if(slot.Sequence.load(std::memory_order_acquire) != pos+1 ||
+         (id && slot.Id != *id))
+        {
+        continue;
+        }
+      int expected = READY;
+      if(slot.State.compare_exchange_strong(expected, CANCELLED))
+        {
+        ++cancelled;
+        }
+      }
+    return cancelled;
+  }
+
+  //needs to be a power of two
+  static const std::size_t Capacity = 1024;
+
+  std::vector<Slot> Slots;
+  std::atomic<std::size_t> EnqueuePos;
+  std::atomic<std::size_t> DequeuePos;
+};
+
 }
 
 namespace remus{
@@ -48,14 +207,50 @@ class JobQueue::JobQueueImplementation
   //thread our polling method
   boost::scoped_ptr<boost::thread> PollingThread;
 
-  //used to keep the queue from breaking with threads
-  boost::mutex QueueMutex;
-  boost::condition_variable QueueChanged;
-  std::deque< remus::worker::Job > Queue;
+  //the jobs that are ready to be taken. The ring is lock free, and
+  //jobs are decoded before they are added, so taking a job never waits
+  //on the polling thread
+  JobRing Ring;
+
+  //jobs that didn't fit in the ring, only touched by the polling thread
+  //which moves them into the ring as space frees up
+  std::deque< remus::worker::Job > Overflow;
+
+  //the number of jobs that can be taken, including the overflow
+  std::atomic<std::size_t> Pending;
 
-  //a set of jobs that the JobQueue has been told should be terminated
+  //consumers that are blocked in waitAndTakeJob. The producer only
+  //takes the mutex to wake them when there is somebody to wake
+  std::atomic<int> Sleepers;
+  boost::mutex WakeMutex;
+  boost::condition_variable WakeCondition;
+
+  //readable while there are jobs to take, for workers that wait on
+  //jobs in an event loop instead of in waitAndTakeJob
+  JobNotifier Notifier;
+
+  //a set of jobs that the JobQueue has been told should be terminated,
+  //guarded by its own mutex as it is only touched on termination
+  mutable boost::mutex TerminatedMutex;
   std::set< boost::uuids::uuid > TerminatedJobs;
 
+  //the number of jobs that were removed from the queue because they
+  //were terminated before they were taken
+  std::atomic<std::size_t> DroppedJobs;
+
+  //set once the worker has been told to terminate, after which every
+  //thread that asks for a job is given a TERMINATE_WORKER job
+  std::atomic<bool> WorkerTerminated;
+
+  //the content of the jobs we were sent, so that the server can refer to
+  //it by hash. Only touched by the thread that decodes the jobs
+  ContentCache Cache;
+
+  //the contents of the model sessions the server sent us, which it
+  //leaves out of the jobs of those sessions. Only touched by the thread
+  //that decodes the jobs
+  std::map<std::string, remus::proto::JobSubmission> Sessions;
+
   //need to store our endpoint so we can pass it to the worker
   std::string EndPoint;
 
@@ -75,10 +270,19 @@ public:
 JobQueueImplementation(zmq::context_t& context,
                        const zmq::socketInfo<zmq::proto::inproc>& queue_info):
   PollingThread(new boost::thread()),
-  QueueMutex(),
-  QueueChanged(),
-  Queue(),
+  Ring(),
+  Overflow(),
+  Pending(0),
+  Sleepers(0),
+  WakeMutex(),
+  WakeCondition(),
+  Notifier(),
+  TerminatedMutex(),
   TerminatedJobs(),
+  DroppedJobs(0),
+  WorkerTerminated(false),
+  Cache(),
+  Sessions(),
   EndPoint(),
   ContinuePolling(true),
   PollingStarted(false),
@@ -95,11 +299,39 @@ JobQueueImplementation(zmq::context_t& context,
   this->PollingThread.swap(pollingThread);
 }
 
+//-----------------------------------------------------------------------------
+//construct a queue that is fed by somebody else's thread, so we have
+//no thread or socket of our own
+JobQueueImplementation():
+  PollingThread(new boost::thread()),
+  Ring(),
+  Overflow(),
+  Pending(0),
+  Sleepers(0),
+  WakeMutex(),
+  WakeCondition(),
+  Notifier(),
+  TerminatedMutex(),
+  TerminatedJobs(),
+  DroppedJobs(0),
+  WorkerTerminated(false),
+  Cache(),
+  Sessions(),
+  EndPoint(),
+  ContinuePolling(true),
+  PollingStarted(true),
+  PollingFinished(false)
+{
+}
+
 //------------------------------------------------------------------------------
 ~JobQueueImplementation()
 {
   //stop the thread
-  this->PollingThread->join();
+  if(this->PollingThread->joinable())
+    {
+    this->PollingThread->join();
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -140,125 +372,327 @@ void pollForJobs(zmq::context_t* context,
   while( this->ContinuePolling )
     {
     zmq::poll_safely(&item,1,250);
+    this->drainOverflow();
     if(item.revents & ZMQ_POLLIN)
       {
       remus::proto::Response response =
           remus::proto::receive_Response(&serverComm);
-      if(!response.isValid())
-        { //ignore this response if it isn't valid
-        continue;
-        }
-
-      switch(response.serviceType())
-        {
-        case remus::TERMINATE_WORKER:
-          this->clearJobs();
-          this->stop();
-          break;
-        case remus::MAKE_MESH:
-          this->addItem(response);
-          break;
-        case remus::TERMINATE_JOB:
-          this->terminateJob(response);
-        default:
-          //ignore other service types as we shouldn't be sent those
-          break;
-        }
+      this->handleResponse(response);
       }
     }
 }
 
 //------------------------------------------------------------------------------
-void terminateJob(remus::proto::Response& response)
+//called by the thread that feeds the queue
+void handleResponse(remus::proto::Response& response)
 {
-  boost::lock_guard<boost::mutex> lock(this->QueueMutex);
+  if(!response.isValid())
+    { //ignore this response if it isn't valid
+    return;
+    }
+
+  switch(response.serviceType())
+    {
+    case remus::TERMINATE_WORKER:
+      this->clearJobs();
+      this->stop();
+      break;
+    case remus::MAKE_MESH:
+      this->addItem(response);
+      break;
+    case remus::MAKE_MESH_BATCH:
+      this->addItems(response);
+      break;
+    case remus::TERMINATE_JOB:
+      this->terminateJob(response);
+      break;
+    case remus::CONTENT_CACHE:
+      //the server acknowledged our cache, from now on it mirrors it
+      this->Cache.reset( remus::proto::to_ContentCacheIndex(response.data(),
+                                                     response.dataSize()) );
+      break;
+    case remus::OPEN_MODEL_SESSION:
+      this->openSession(response);
+      break;
+    case remus::CLOSE_MODEL_SESSION:
+      this->Sessions.erase(std::string(response.data(), response.dataSize()));
+      break;
+    default:
+      //ignore other service types as we shouldn't be sent those
+      break;
+    }
+}
 
-  const std::string data(response.data(), response.dataSize());
-  remus::worker::Job tj = remus::worker::to_Job(data);
+//------------------------------------------------------------------------------
+void terminateJob(remus::proto::Response& response)
+{
+  remus::worker::Job tj = remus::worker::to_Job(response.data(),
+                                                response.dataSize());
 
   //first thing is we add the job id to the list of terminated job ids
+  {
+  boost::lock_guard<boost::mutex> lock(this->TerminatedMutex);
   this->TerminatedJobs.insert( tj.id() );
+  }
 
-  //next we go through the deque and remove any job with that id
-
+  //next we cancel any job with that id, both in the ring and in
+  //the overflow
   typedef std::deque< remus::worker::Job >::iterator iter;
   JobIdMatches pred( tj.id() );
 
-  iter new_end = std::remove_if(this->Queue.begin(),
-                                this->Queue.end(),
+  iter new_end = std::remove_if(this->Overflow.begin(),
+                                this->Overflow.end(),
                                 pred);
-  this->Queue.erase(new_end,this->Queue.end());
+  std::size_t dropped = static_cast<std::size_t>(this->Overflow.end() - new_end);
+  this->Overflow.erase(new_end,this->Overflow.end());
+  dropped += this->Ring.cancel(tj.id());
+
+  this->Pending.fetch_sub(dropped);
+  this->DroppedJobs.fetch_add(dropped);
 
-  this->QueueChanged.notify_all();
+  //let event loops know, so they can check the jobs they are running
+  this->Notifier.signal();
 }
 
 //------------------------------------------------------------------------------
 void clearJobs()
 {
-  boost::lock_guard<boost::mutex> lock(this->QueueMutex);
-  this->Queue.clear();
+  //the jobs that are dropped are counted the same as terminated ones
+  std::size_t dropped = this->Overflow.size();
+  this->Overflow.clear();
+  dropped += this->Ring.cancelAll();
 
-  remus::worker::Job j;
-  j.updateValidityReason(remus::worker::Job::TERMINATE_WORKER);
-  this->Queue.push_back(j);
+  this->Pending.fetch_sub(dropped);
+  this->DroppedJobs.fetch_add(dropped);
 
-  this->QueueChanged.notify_all();
+  this->WorkerTerminated.store(true);
+  this->push(terminateWorkerJob());
 }
 
 //------------------------------------------------------------------------------
 void addItem(remus::proto::Response& response )
 {
-  boost::lock_guard<boost::mutex> lock(this->QueueMutex);
-
   //required to use the char*, len constructor as response's data can
   //be binary data with lots of null terminators.
-  const std::string data(response.data(), response.dataSize());
-  remus::worker::Job j = remus::worker::to_Job(data);
-  this->Queue.push_back( j );
+  this->push( this->decode(
+      remus::worker::to_Job(response.data(), response.dataSize())) );
+}
+
+//------------------------------------------------------------------------------
+void addItems(remus::proto::Response& response )
+{
+  const std::vector<remus::worker::Job> jobs =
+          remus::proto::to_WorkerJobs(response.data(), response.dataSize());
 
-  this->QueueChanged.notify_all();
+  typedef std::vector<remus::worker::Job>::const_iterator iter;
+  for(iter i = jobs.begin(); i != jobs.end(); ++i)
+    {
+    this->push(this->decode(*i));
+    }
+}
+
+//------------------------------------------------------------------------------
+//the server sends the contents of a model session once, before the first
+//job of the session it gives us
+void openSession(remus::proto::Response& response)
+{
+  std::string id;
+  remus::proto::JobSubmission contents;
+  if(remus::proto::from_ModelSessionContents(response.data(),
+                                             response.dataSize(),
+                                             id, contents))
+    {
+    this->Sessions[id] = contents;
+    }
+}
+
+//------------------------------------------------------------------------------
+//replaces the cached content references of a job, and adds back the
+//contents of the model session the job belongs to
+remus::worker::Job decode(const remus::worker::Job& job)
+{
+  remus::worker::Job resolved = this->Cache.resolve(job);
+  if(this->Sessions.empty())
+    {
+    return resolved;
+    }
+
+  typedef std::map<std::string,
+                   remus::proto::JobSubmission>::const_iterator SessionIt;
+  SessionIt session = this->Sessions.find(
+                  remus::proto::to_ModelSessionId(resolved.submission()));
+  if(session == this->Sessions.end())
+    {
+    return resolved;
+    }
+
+  //insert doesn't replace keys, so the job's own contents win
+  remus::proto::JobSubmission submission = resolved.submission();
+  submission.insert(session->second.begin(), session->second.end());
+  return remus::worker::Job(resolved.id(), submission);
+}
+
+//------------------------------------------------------------------------------
+//called by the polling thread with a decoded job
+void push(const remus::worker::Job& job)
+{
+  //count the job before a consumer can take it, so the count never
+  //drops below zero
+  this->Pending.fetch_add(1);
+
+  //keep the order of the jobs, so nothing can skip past the overflow
+  if(!this->Overflow.empty() || !this->Ring.push(job))
+    {
+    this->Overflow.push_back(job);
+    }
+  this->wakeConsumers();
+}
+
+//------------------------------------------------------------------------------
+//called by the polling thread, moves jobs from the overflow as consumers
+//free up space in the ring
+void drainOverflow()
+{
+  bool moved = false;
+  while(!this->Overflow.empty() && this->Ring.push(this->Overflow.front()))
+    {
+    this->Overflow.pop_front();
+    moved = true;
+    }
+  if(moved)
+    {
+    this->wakeConsumers();
+    }
+}
+
+//------------------------------------------------------------------------------
+void wakeConsumers()
+{
+  //pairs with the fence in waitAndTakeJob, so that either we see the
+  //sleeper, or the sleeper sees the job we just pushed
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(this->Sleepers.load() > 0)
+    {
+    boost::lock_guard<boost::mutex> lock(this->WakeMutex);
+    this->WakeCondition.notify_all();
+    }
+  this->Notifier.signal();
+}
+
+//------------------------------------------------------------------------------
+int notificationFileDescriptor()
+{
+  const int fd = this->Notifier.fileDescriptor();
+  //jobs that arrived before the descriptor existed never signalled it
+  this->rearmNotification();
+  return fd;
+}
+
+//------------------------------------------------------------------------------
+//called by consumers that found the queue empty. The descriptor stays
+//readable while there is something left to take
+void rearmNotification()
+{
+  if(!this->Notifier.isOpen())
+    {
+    return;
+    }
+  this->Notifier.clear();
+  //pairs with the fence in wakeConsumers, so that either we see the
+  //job, or the producer sees the cleared descriptor
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(!this->Ring.empty() || this->WorkerTerminated.load())
+    {
+    this->Notifier.signal();
+    }
 }
 
 //------------------------------------------------------------------------------
 bool isATerminatedJob(const remus::worker::Job& job) const
 {
+  boost::lock_guard<boost::mutex> lock(this->TerminatedMutex);
   return this->TerminatedJobs.count( job.id() ) == 1;
 }
 
+//------------------------------------------------------------------------------
+static remus::worker::Job terminateWorkerJob()
+{
+  remus::worker::Job j;
+  j.updateValidityReason(remus::worker::Job::TERMINATE_WORKER);
+  return j;
+}
+
+//------------------------------------------------------------------------------
+bool tryTake(remus::worker::Job& job)
+{
+  if(this->Ring.pop(job))
+    {
+    this->Pending.fetch_sub(1);
+    return true;
+    }
+  else if(this->WorkerTerminated.load())
+    { //the queue is empty, and will stay that way
+    job = terminateWorkerJob();
+    return true;
+    }
+  return false;
+}
+
 //------------------------------------------------------------------------------
 remus::worker::Job take()
 {
   //the only jobs on the queue should be valid jobs or kill the worker
   remus::worker::Job job;
-  if(this->size() > 0)
-    {
-    boost::unique_lock<boost::mutex> lock(this->QueueMutex);
-    job = this->Queue[0];
-    this->Queue.pop_front();
-
-    //notify everyone that a job was taken from the queue
-    this->QueueChanged.notify_all();
-    }
+  this->tryTake(job);
   return job;
 }
 
 //------------------------------------------------------------------------------
-remus::worker::Job waitAndTakeJob()
+remus::worker::Job waitAndTakeJob(boost::int64_t timeoutInMillisec)
 {
-  boost::unique_lock<boost::mutex> lock(this->QueueMutex);
-  while(this->Queue.size() == 0)
+  const boost::system_time deadline = boost::get_system_time() +
+                      boost::posix_time::milliseconds(timeoutInMillisec);
+
+  remus::worker::Job job;
+  while(!this->tryTake(job))
     {
-    QueueChanged.wait(lock);
+    boost::unique_lock<boost::mutex> lock(this->WakeMutex);
+    this->Sleepers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool taken = this->tryTake(job);
+    bool timedOut = false;
+    if(!taken)
+      {
+      if(timeoutInMillisec < 0)
+        { this->WakeCondition.wait(lock); }
+      else
+        { timedOut = !this->WakeCondition.timed_wait(lock, deadline); }
+      }
+    this->Sleepers.fetch_sub(1);
+    if(taken)
+      {
+      break;
+      }
+    else if(timedOut)
+      { //one last look, so a job that arrived with the timeout isn't missed
+      lock.unlock();
+      this->tryTake(job);
+      break;
+      }
     }
-  lock.unlock();
-  return take();
+  return job;
 }
 
 //------------------------------------------------------------------------------
 std::size_t size()
 {
-  boost::lock_guard<boost::mutex> lock(this->QueueMutex);
-  return this->Queue.size();
+  return this->Pending.load();
+}
+
+//------------------------------------------------------------------------------
+std::size_t droppedJobCount()
+{
+  return this->DroppedJobs.load();
 }
 
 //------------------------------------------------------------------------------
@@ -282,11 +716,49 @@ JobQueue::JobQueue(zmq::context_t& context,
 {
 }
 
+//------------------------------------------------------------------------------
+JobQueue::JobQueue():
+  Implementation( new JobQueueImplementation() )
+{
+}
+
 JobQueue::~JobQueue()
 {
   this->Implementation->stop();
 }
 
+//------------------------------------------------------------------------------
+void JobQueue::handleResponse(remus::proto::Response& response)
+{
+  this->Implementation->drainOverflow();
+  this->Implementation->handleResponse(response);
+}
+
+//------------------------------------------------------------------------------
+void JobQueue::drainOverflow()
+{
+  this->Implementation->drainOverflow();
+}
+
+//------------------------------------------------------------------------------
+void JobQueue::terminateWorker()
+{
+  this->Implementation->clearJobs();
+  this->Implementation->stop();
+}
+
+//------------------------------------------------------------------------------
+int JobQueue::notificationFileDescriptor()
+{
+  return this->Implementation->notificationFileDescriptor();
+}
+
+//------------------------------------------------------------------------------
+void JobQueue::rearmNotification()
+{
+  this->Implementation->rearmNotification();
+}
+
 //------------------------------------------------------------------------------
 std::string JobQueue::endpoint() const
 {
@@ -308,7 +780,14 @@ remus::worker::Job JobQueue::take()
 //------------------------------------------------------------------------------
 remus::worker::Job JobQueue::waitAndTakeJob()
 {
-  return this->Implementation->waitAndTakeJob();
+  return this->Implementation->waitAndTakeJob(-1);
+}
+
+//------------------------------------------------------------------------------
+remus::worker::Job JobQueue::waitAndTakeJob(boost::int64_t timeoutInMillisec)
+{
+  return this->Implementation->waitAndTakeJob(
+                        std::max<boost::int64_t>(0, timeoutInMillisec));
 }
 
 //------------------------------------------------------------------------------
@@ -317,6 +796,12 @@ std::size_t JobQueue::size() const
   return this->Implementation->size();
 }
 
+//------------------------------------------------------------------------------
+std::size_t JobQueue::droppedJobCount() const
+{
+  return this->Implementation->droppedJobCount();
+}
+
 //------------------------------------------------------------------------------
 bool JobQueue::isReady() const
 {
@@ -16,6 +16,8 @@
 #include <remus/proto/zmqHelper.h>
 #include <remus/worker/Job.h>
 
+namespace remus { namespace proto { class Response; } }
+
 REMUS_THIRDPARTY_PRE_INCLUDE
 #include <boost/scoped_ptr.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
@@ -26,19 +28,52 @@ namespace detail{
 
 //A Simple JobQueue that holds onto a collection of jobs from the server.
 //If the TermianteWorker job is sent to the job queue, we will clear the
-//entire queue and only have a TerminateJob on the queue.
+//entire queue and only have a TerminateJob on the queue. After that every
+//take returns a TerminateJob, so that all threads taking jobs find out.
 //
 //Once a JobQueue is sent a TerminateWorker, it will not accept any new jobs
 //and will refuse to start back up looking for jobs
+//
+//Jobs are decoded by the polling thread and handed to the mesher threads
+//through a lock free ring, so any number of threads can take jobs at the
+//same time without contending on a lock. Threads that wait for a job
+//are only woken when a job arrives.
 class JobQueue
 {
 public:
   JobQueue(zmq::context_t& context,
            const zmq::socketInfo<zmq::proto::inproc>& queue_info);
+
+  //construct a JobQueue that has no polling thread or socket, and is
+  //instead fed responses by the WorkerHub thread
+  JobQueue();
+
   ~JobQueue();
 
+  //hand a response from the server to a JobQueue that has no polling
+  //thread. Must always be called from the same thread
+  void handleResponse(remus::proto::Response& response);
+
+  //move jobs that didn't fit into the ring when it was full. Needs to be
+  //called periodically by the thread that calls handleResponse
+  void drainOverflow();
+
+  //same as handing the queue a TERMINATE_WORKER response. Must be called
+  //from the thread that calls handleResponse
+  void terminateWorker();
+
   std::string endpoint() const;
 
+  //returns a file descriptor that is readable while there are jobs to
+  //take, or the worker has been told to terminate. It is also made
+  //readable when a job is terminated. Returns -1 when the platform
+  //has no support. See JobNotifier
+  int notificationFileDescriptor();
+
+  //needs to be called after take has returned an invalid job, so that
+  //the descriptor stops being readable once nothing is left to take
+  void rearmNotification();
+
   //Returns true if the job is part of the queue and job status
   //has been marked as terminate. This is allows people to peek at the queue
   //and check jobs without taking them off the queue
@@ -52,9 +87,17 @@ public:
   //job is present, it waits for a job to enter the queue
   remus::worker::Job waitAndTakeJob();
 
+  //same as waitAndTakeJob, but only waits for the given amount of time,
+  //after which an invalid job is returned
+  remus::worker::Job waitAndTakeJob(boost::int64_t timeoutInMillisec);
+
   //return the number of jobs waiting for work
   std::size_t size() const;
 
+  //return the number of jobs that were removed from the queue because
+  //they were terminated before being taken. This only ever increases
+  std::size_t droppedJobCount() const;
+
   //has finished setting up and is ready for jobs
   bool isReady() const;
 
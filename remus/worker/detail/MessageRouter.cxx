@@ -12,12 +12,14 @@
 
 #include <remus/worker/detail/MessageRouter.h>
 
+#include <remus/proto/Heartbeat.h>
 #include <remus/proto/Message.h>
 #include <remus/proto/Response.h>
 #include <remus/proto/zmqHelper.h>
 
 #include <remus/common/CompilerInformation.h>
 #include <remus/common/PollingMonitor.h>
+#include <remus/common/Timer.h>
 #include <remus/worker/Job.h>
 
 REMUS_THIRDPARTY_PRE_INCLUDE
@@ -41,6 +43,11 @@ class MessageRouter::MessageRouterImplementation
   //custom polling rates for workers
   remus::common::PollingMonitor PollMonitor;
 
+  //every message we send the server tells it we are alive, so we only need
+  //to send a heartbeat once we have been quiet for a while
+  remus::common::Timer SinceLastSentToServer;
+  bool HasSentToServer;
+
   //thread our polling method
   mutable boost::mutex ThreadMutex;
   boost::condition_variable ThreadStatusChanged;
@@ -65,6 +72,8 @@ MessageRouterImplementation(
   QueueEndpoint(queue_info.endpoint()),
   OutstandingResults(0),
   PollMonitor(boost::int64_t(250), boost::int64_t(60000)), //assign a low floor for faster testing
+  SinceLastSentToServer(),
+  HasSentToServer(false),
   ThreadMutex(),
   ThreadStatusChanged(),
   PollingThread(new boost::thread()),
@@ -247,6 +256,7 @@ void handleWorkerMessage(zmq::socket_t& workerComm,
     {
     //first we need to forward all message to the server
     remus::proto::forward_Message(message,&serverComm);
+    this->markAsSentToServer();
 
     //if the worker is telling use to submit a TERMINATE_WORKER
     //job that means it is in the process of shutting down.
@@ -278,6 +288,15 @@ void handleWorkerMessage(zmq::socket_t& workerComm,
       ++this->OutstandingResults;
       }
     }
+  else if(message.serviceType()==remus::RETRIEVE_RESULT)
+    {
+    //the server has already told us to terminate, so it will never
+    //acknowledge the result. We do it so the worker doesn't block
+    remus::proto::send_NonBlockingResponse(remus::RETRIEVE_RESULT,
+                                           remus::INVALID_MSG,
+                                           &workerComm,
+                                           (zmq::SocketIdentity()));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -321,7 +340,11 @@ void handleServerMessage( zmq::socket_t& workerComm,
       }
     else if(goodToForwardToQueue &&
             ( response.serviceType() == remus::TERMINATE_JOB ||
-              response.serviceType() == remus::MAKE_MESH ) )
+              response.serviceType() == remus::MAKE_MESH ||
+              response.serviceType() == remus::MAKE_MESH_BATCH ||
+              response.serviceType() == remus::CONTENT_CACHE ||
+              response.serviceType() == remus::OPEN_MODEL_SESSION ||
+              response.serviceType() == remus::CLOSE_MODEL_SESSION ) )
       {
       remus::proto::forward_Response(response,
                                      &queueComm,
@@ -337,10 +360,18 @@ void handleServerMessage( zmq::socket_t& workerComm,
       --this->OutstandingResults;
       }
       // do nothing if it isn't terminate_job, terminate_worker,
-      // make_mesh or retrieve result
+      // make_mesh, make_mesh_batch, content_cache, model sessions or
+      // retrieve result
     }
 }
 
+//------------------------------------------------------------------------------
+void markAsSentToServer()
+{
+  this->SinceLastSentToServer.reset();
+  this->HasSentToServer = true;
+}
+
 //------------------------------------------------------------------------------
 //handles sending heartbeat to the server
 void sendHeartBeat(zmq::socket_t& serverComm,
@@ -348,19 +379,38 @@ void sendHeartBeat(zmq::socket_t& serverComm,
 {
   //First we check if we should be talking to the server, if we aren't forwarding
   //messages to the server than sending heartbeats is pointless
-  if( this->ContinueForwardingToServer)
+  if( !this->ContinueForwardingToServer)
+    {
+    return;
+    }
+
+  //send the server how soon in seconds we will send our next heartbeat
+  //message. This way we are telling the server itself when it should
+  //expect a message, rather than it guessing. We always send the max
+  //time out since we don't know how long till we poll again. If a
+  //super large job comes in we could be blocking for a very long time
+  const boost::int64_t polldur = m.maxTimeOut();
+
+  //The server treats every message as a sign of life, so as long as the
+  //worker is busy talking to the server no heartbeats are needed. Once
+  //it has been quiet for half the promised interval we send one, so the
+  //server hears from us well before the interval runs out. The first
+  //heartbeat is sent right away to tell the server the interval
+  if(this->HasSentToServer &&
+     this->SinceLastSentToServer.elapsed() < polldur/2)
+    {
+    return;
+    }
+
+  //if the heartbeat can't be queued right now, we try again next poll
+  remus::proto::Message hb =
+    remus::proto::send_NonBlockingMessage(remus::common::MeshIOType(),
+                                          remus::HEARTBEAT,
+                                          remus::proto::to_HeartbeatPayload(polldur),
+                                          &serverComm);
+  if(hb.isValid())
     {
-    //send the server how soon in seconds we will send our next heartbeat
-    //message. This way we are telling the server itself when it should
-    //expect a message, rather than it guessing. We always send the max
-    //time out since we don't know how long till we poll again. If a
-    //super large job comes in we could be blocking for a very long time
-    const boost::int64_t polldur = m.maxTimeOut();
-    //send the heartbeat to the server
-    remus::proto::send_Message(remus::common::MeshIOType(),
-                               remus::HEARTBEAT,
-                               boost::lexical_cast<std::string>(polldur),
-                               &serverComm);
+    this->markAsSentToServer();
     }
 }
 
@@ -0,0 +1,143 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/StatusCoalescer.h>
+
+#include <algorithm>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//-----------------------------------------------------------------------------
+StatusCoalescer::StatusCoalescer():
+  Clock(),
+  Interval(0),
+  Coalesced(0),
+  Entries()
+{
+}
+
+//-----------------------------------------------------------------------------
+void StatusCoalescer::interval(boost::int64_t intervalInMillisec)
+{
+  this->Interval = std::max<boost::int64_t>(0, intervalInMillisec);
+}
+
+//-----------------------------------------------------------------------------
+bool StatusCoalescer::update(const remus::proto::JobStatus& status,
+                             boost::int64_t now)
+{
+  if(this->Interval == 0)
+    {
+    return true;
+    }
+
+  EntryMap::iterator entry = this->Entries.find(status.id());
+  if(entry == this->Entries.end())
+    { //the first status of a job is always sent
+    entry = this->Entries.insert(
+                  EntryMap::value_type(status.id(), JobEntry(status,now))).first;
+    this->markAsSent(entry, status, now);
+    return true;
+    }
+
+  JobEntry& job = entry->second;
+  if(job.HasPending)
+    { //whatever happens next, the held status will never be sent
+    ++this->Coalesced;
+    job.HasPending = false;
+    }
+
+  const bool transition = status.status() != job.LastSentType;
+  if(transition || (now - job.LastSentTime) >= this->Interval)
+    {
+    this->markAsSent(entry, status, now);
+    return true;
+    }
+
+  job.Pending = status;
+  job.HasPending = true;
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<remus::proto::JobStatus> StatusCoalescer::due(boost::int64_t now)
+{
+  std::vector<remus::proto::JobStatus> ready;
+  EntryMap::iterator i = this->Entries.begin();
+  while(i != this->Entries.end())
+    {
+    EntryMap::iterator entry = i++;
+    if(entry->second.HasPending &&
+       (now - entry->second.LastSentTime) >= this->Interval)
+      {
+      ready.push_back(entry->second.Pending);
+      this->markAsSent(entry, ready.back(), now);
+      }
+    }
+  return ready;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<remus::proto::JobStatus> StatusCoalescer::flush(boost::int64_t now)
+{
+  std::vector<remus::proto::JobStatus> ready;
+  EntryMap::iterator i = this->Entries.begin();
+  while(i != this->Entries.end())
+    {
+    EntryMap::iterator entry = i++;
+    if(entry->second.HasPending)
+      {
+      ready.push_back(entry->second.Pending);
+      this->markAsSent(entry, ready.back(), now);
+      }
+    }
+  return ready;
+}
+
+//-----------------------------------------------------------------------------
+void StatusCoalescer::finished(const boost::uuids::uuid& jobId)
+{
+  this->Entries.erase(jobId);
+}
+
+//-----------------------------------------------------------------------------
+std::size_t StatusCoalescer::pendingCount() const
+{
+  std::size_t count = 0;
+  for(EntryMap::const_iterator i = this->Entries.begin();
+      i != this->Entries.end(); ++i)
+    {
+    if(i->second.HasPending) { ++count; }
+    }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+void StatusCoalescer::markAsSent(EntryMap::iterator entry,
+                                 const remus::proto::JobStatus& status,
+                                 boost::int64_t now)
+{
+  if(!status.good())
+    {
+    this->Entries.erase(entry);
+    return;
+    }
+  entry->second.LastSentTime = now;
+  entry->second.LastSentType = status.status();
+  entry->second.HasPending = false;
+}
+
+}
+}
+}
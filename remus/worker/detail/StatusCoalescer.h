@@ -0,0 +1,111 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_detail_StatusCoalescer_h
+#define remus_worker_detail_StatusCoalescer_h
+
+#include <remus/common/Timer.h>
+#include <remus/proto/JobStatus.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/cstdint.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <map>
+#include <vector>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//Limits how often the status of a single job is sent to the server. Only
+//the latest status of a job matters, so a status that arrives within the
+//interval of the last one we sent is held, replacing any status that was
+//already being held. Changes of the status type, such as a job failing,
+//are always sent right away.
+//
+//All times are in milliseconds, as reported by now(). The coalescer isn't
+//thread safe, the worker guards it with the same lock as the server socket.
+class StatusCoalescer
+{
+public:
+  StatusCoalescer();
+
+  //the minimum time between two status messages of the same job. An
+  //interval of zero sends every status, which is the default
+  void interval(boost::int64_t intervalInMillisec);
+  boost::int64_t interval() const { return this->Interval; }
+
+  //returns the milliseconds since the coalescer was constructed
+  boost::int64_t now() const { return this->Clock.elapsed(); }
+
+  //returns true if the status needs to be sent now, otherwise the
+  //status is held until the interval of the job has passed
+  bool update(const remus::proto::JobStatus& status, boost::int64_t now);
+
+  //returns the held statuses whose interval has passed, these are
+  //considered sent
+  std::vector<remus::proto::JobStatus> due(boost::int64_t now);
+
+  //returns every held status, these are considered sent
+  std::vector<remus::proto::JobStatus> flush(boost::int64_t now);
+
+  //forget about a job, which drops any status that is held for it.
+  //Used when the result of a job is sent, as that supersedes the status
+  void finished(const boost::uuids::uuid& jobId);
+
+  //the number of statuses that are being held
+  std::size_t pendingCount() const;
+
+  //the number of statuses that were replaced by a newer status
+  //before they were sent. This only ever increases
+  std::size_t coalescedCount() const { return this->Coalesced; }
+
+private:
+  struct JobEntry
+  {
+    JobEntry(const remus::proto::JobStatus& status, boost::int64_t now):
+      LastSentTime(now),
+      LastSentType(status.status()),
+      HasPending(false),
+      Pending(status)
+    {}
+
+    boost::int64_t LastSentTime;
+    remus::STATUS_TYPE LastSentType;
+    bool HasPending;
+    remus::proto::JobStatus Pending;
+  };
+  typedef std::map<boost::uuids::uuid, JobEntry> EntryMap;
+
+  //records that a status of the job was sent. Jobs that have reached a
+  //final state are forgotten, as nothing can follow a final state
+  void markAsSent(EntryMap::iterator entry,
+                  const remus::proto::JobStatus& status,
+                  boost::int64_t now);
+
+  remus::common::Timer Clock;
+  boost::int64_t Interval;
+  std::size_t Coalesced;
+  EntryMap Entries;
+
+  //make copying not possible
+  StatusCoalescer(const StatusCoalescer&);
+  void operator=(const StatusCoalescer&);
+};
+
+}
+}
+}
+
+#endif
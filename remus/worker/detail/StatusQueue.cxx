@@ -0,0 +1,99 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/StatusQueue.h>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//-----------------------------------------------------------------------------
+StatusQueue::StatusQueue():
+  Head(&Stub),
+  Tail(&Stub),
+  Stub( remus::proto::JobStatus(boost::uuids::uuid(), remus::INVALID_STATUS) ),
+  Count(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+StatusQueue::~StatusQueue()
+{
+  remus::proto::JobStatus status(boost::uuids::uuid(), remus::INVALID_STATUS);
+  while(this->pop(status))
+    {
+    }
+}
+
+//-----------------------------------------------------------------------------
+void StatusQueue::push(const remus::proto::JobStatus& status)
+{
+  //count first, so that the queue is never seen as empty while
+  //a status is on its way in
+  this->Count.fetch_add(1);
+  this->pushNode(new Node(status));
+}
+
+//-----------------------------------------------------------------------------
+void StatusQueue::pushNode(Node* node)
+{
+  node->Next.store(NULL, std::memory_order_relaxed);
+  Node* prev = this->Head.exchange(node, std::memory_order_acq_rel);
+  //between the exchange and this store the consumer can't see the node,
+  //which is why pop can return false while the queue isn't empty
+  prev->Next.store(node, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+bool StatusQueue::pop(remus::proto::JobStatus& status)
+{
+  Node* tail = this->Tail;
+  Node* next = tail->Next.load(std::memory_order_acquire);
+  if(tail == &this->Stub)
+    {
+    if(next == NULL)
+      {
+      return false;
+      }
+    //skip over the stub
+    this->Tail = next;
+    tail = next;
+    next = next->Next.load(std::memory_order_acquire);
+    }
+
+  if(next == NULL)
+    {
+    //tail is the last node we can see. If a producer is linking a node
+    //after it we have to wait for them to finish
+    if(tail != this->Head.load(std::memory_order_acquire))
+      {
+      return false;
+      }
+    //put the stub back behind the last node, so that it can be taken
+    this->pushNode(&this->Stub);
+    next = tail->Next.load(std::memory_order_acquire);
+    if(next == NULL)
+      {
+      return false;
+      }
+    }
+
+  this->Tail = next;
+  status = tail->Status;
+  delete tail;
+  this->Count.fetch_sub(1);
+  return true;
+}
+
+}
+}
+}
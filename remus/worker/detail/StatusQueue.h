@@ -0,0 +1,76 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#ifndef remus_worker_detail_StatusQueue_h
+#define remus_worker_detail_StatusQueue_h
+
+#include <remus/proto/JobStatus.h>
+
+#include <atomic>
+#include <cstddef>
+
+namespace remus{
+namespace worker{
+namespace detail{
+
+//An unbounded lock free queue of job statuses with any number of producers,
+//the mesher threads, and a single consumer, which is whichever thread holds
+//the lock of the worker's server socket.
+//
+//Pushing never blocks or waits on other producers, so mesher threads can
+//report progress without serializing on the socket. Statuses are popped
+//in the order they were pushed, so the statuses of a job stay in order as
+//long as they are reported in order.
+class StatusQueue
+{
+public:
+  StatusQueue();
+  ~StatusQueue();
+
+  //can be called from any thread
+  void push(const remus::proto::JobStatus& status);
+
+  //can only be called by one thread at a time. Returns false when the
+  //queue is empty, or the next status is still being pushed
+  bool pop(remus::proto::JobStatus& status);
+
+  //returns true when there are no statuses to pop, and none are being
+  //pushed. Can be called from any thread
+  bool empty() const { return this->Count.load() == 0; }
+
+private:
+  struct Node
+  {
+    explicit Node(const remus::proto::JobStatus& s): Next(NULL), Status(s) {}
+    std::atomic<Node*> Next;
+    remus::proto::JobStatus Status;
+  };
+
+  //producers swap themselves in at the head, the consumer
+  //follows the links from the tail
+  std::atomic<Node*> Head;
+  Node* Tail;
+  Node Stub;
+  std::atomic<std::size_t> Count;
+
+  void pushNode(Node* node);
+
+  //make copying not possible
+  StatusQueue (const StatusQueue&);
+  void operator = (const StatusQueue&);
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,98 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/ContentCache.h>
+
+#include <remus/testing/Testing.h>
+
+#include <string>
+
+using namespace remus::worker::detail;
+
+namespace {
+
+using namespace remus::common;
+using namespace remus::meshtypes;
+
+const remus::proto::JobRequirements reqs2D(ContentFormat::User,
+                                           MeshIOType(Edges(),Mesh2D()),
+                                           "", "" );
+
+//------------------------------------------------------------------------------
+remus::worker::Job make_Job(const remus::proto::JobContent& model)
+{
+  remus::proto::JobSubmission sub(reqs2D);
+  sub["model"] = model;
+  sub["options"] = remus::proto::make_JobContent(std::string("fast"));
+  return remus::worker::Job(remus::testing::UUIDGenerator(), sub);
+}
+
+//------------------------------------------------------------------------------
+void verify_resolve()
+{
+  const std::string model = remus::testing::BinaryDataGenerator(2048);
+  const remus::proto::JobContent content = remus::proto::make_JobContent(model);
+
+  ContentCache cache;
+  REMUS_ASSERT( (!cache.enabled()) )
+  cache.reset(remus::proto::ContentCacheIndex(4096, 1024));
+  REMUS_ASSERT( (cache.enabled()) )
+
+  //the first job carries the content, which is cached
+  remus::worker::Job first = cache.resolve(make_Job(content));
+  REMUS_ASSERT( (first.valid()) )
+  REMUS_ASSERT( (cache.index().size() == 1) )
+
+  //later jobs refer to it, and get the content back
+  const remus::worker::Job referring = make_Job(content.reference());
+  remus::worker::Job resolved = cache.resolve(referring);
+  REMUS_ASSERT( (resolved.valid()) )
+  REMUS_ASSERT( (resolved.id() == referring.id()) )
+  REMUS_ASSERT( (resolved.details("model") == model) )
+  REMUS_ASSERT( (resolved.details("options") == "fast") )
+  REMUS_ASSERT( (cache.missCount() == 0) )
+}
+
+//------------------------------------------------------------------------------
+void verify_miss()
+{
+  const std::string model = remus::testing::BinaryDataGenerator(2048);
+  const remus::proto::JobContent content = remus::proto::make_JobContent(model);
+
+  ContentCache cache;
+  cache.reset(remus::proto::ContentCacheIndex(4096, 1024));
+
+  //a reference to content we never saw can't be run, so the job is
+  //marked invalid, but keeps its id so that it can be failed
+  const remus::worker::Job referring = make_Job(content.reference());
+  remus::worker::Job missed = cache.resolve(referring);
+  REMUS_ASSERT( (!missed.valid()) )
+  REMUS_ASSERT( (missed.validityReason() == remus::worker::Job::INVALID) )
+  REMUS_ASSERT( (missed.id() == referring.id()) )
+  REMUS_ASSERT( (cache.missCount() == 1) )
+
+  //the same happens once the content has been dropped
+  cache.resolve(make_Job(content));
+  cache.reset(remus::proto::ContentCacheIndex(4096, 1024));
+  missed = cache.resolve(make_Job(content.reference()));
+  REMUS_ASSERT( (!missed.valid()) )
+  REMUS_ASSERT( (cache.missCount() == 2) )
+}
+
+}
+
+int UnitTestContentCache(int, char *[])
+{
+  verify_resolve();
+  verify_miss();
+  return 0;
+}
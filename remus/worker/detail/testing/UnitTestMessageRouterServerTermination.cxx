@@ -15,6 +15,7 @@
 #include <remus/server/PortNumbers.h>
 #include <remus/common/SleepFor.h>
 
+#include <remus/proto/JobResult.h>
 #include <remus/proto/Message.h>
 #include <remus/proto/Response.h>
 #include <remus/proto/zmqHelper.h>
@@ -86,6 +87,30 @@ void test_server_terminate_routing_call(MessageRouter& mr,
                  remus::worker::Job::TERMINATE_WORKER) )
 }
 
+//------------------------------------------------------------------------------
+void test_result_after_termination(MessageRouter& mr,
+                                   zmq::socket_t& workerSocket)
+{
+  REMUS_ASSERT( (!mr.isForwardingToServer()) )
+
+  //the server will never acknowledge a result that is sent after it
+  //terminated the worker, so the router has to, or the worker will
+  //wait forever for the upload to finish
+  remus::proto::JobResult result(remus::testing::UUIDGenerator());
+  remus::proto::send_Message(remus::common::MeshIOType(),
+                             remus::RETRIEVE_RESULT,
+                             remus::proto::to_string(result),
+                             &workerSocket);
+
+  zmq::pollitem_t item = { workerSocket, 0, ZMQ_POLLIN, 0 };
+  zmq::poll_safely(&item, 1, 5000);
+  REMUS_ASSERT( (item.revents & ZMQ_POLLIN) )
+
+  remus::proto::Response response = remus::proto::receive_Response(&workerSocket);
+  REMUS_ASSERT( (response.isValid()) )
+  REMUS_ASSERT( (response.serviceType() == remus::RETRIEVE_RESULT) )
+}
+
 }
 
 int UnitTestMessageRouterServerTermination(int, char *[])
@@ -114,6 +139,7 @@ int UnitTestMessageRouterServerTermination(int, char *[])
   //verify that we can send a TERMINATE_WORKER call from the server properly
   MessageRouter mr(worker_channel, queue_channel);
   test_server_terminate_routing_call(mr, serverConn, serverSocket,jq);
+  test_result_after_termination(mr, worker_socket);
 
   return 0;
 }
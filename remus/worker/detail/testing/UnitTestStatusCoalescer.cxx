@@ -0,0 +1,150 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/StatusCoalescer.h>
+
+#include <remus/testing/Testing.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <vector>
+
+using namespace remus::worker::detail;
+
+namespace {
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus make_progress(const boost::uuids::uuid& id, int value)
+{
+  return remus::proto::JobStatus(id, remus::proto::JobProgress(value));
+}
+
+//------------------------------------------------------------------------------
+void verify_disabled()
+{
+  //by default every status is sent
+  StatusCoalescer coalescer;
+  REMUS_ASSERT( (coalescer.interval() == 0) )
+
+  const boost::uuids::uuid id = remus::testing::UUIDGenerator();
+  for(int i=1; i < 10; ++i)
+    {
+    REMUS_ASSERT( (coalescer.update(make_progress(id,i), 0) == true) )
+    }
+  REMUS_ASSERT( (coalescer.pendingCount() == 0) )
+  REMUS_ASSERT( (coalescer.coalescedCount() == 0) )
+
+  //negative intervals are clamped
+  coalescer.interval(-20);
+  REMUS_ASSERT( (coalescer.interval() == 0) )
+}
+
+//------------------------------------------------------------------------------
+void verify_coalescing()
+{
+  StatusCoalescer coalescer;
+  coalescer.interval(100);
+
+  const boost::uuids::uuid id = remus::testing::UUIDGenerator();
+
+  //the first status of a job is always sent
+  REMUS_ASSERT( (coalescer.update(make_progress(id,1), 0) == true) )
+
+  //everything inside of the interval is held, only keeping the latest
+  for(int i=2; i <= 50; ++i)
+    {
+    REMUS_ASSERT( (coalescer.update(make_progress(id,i), i) == false) )
+    }
+  REMUS_ASSERT( (coalescer.pendingCount() == 1) )
+  REMUS_ASSERT( (coalescer.coalescedCount() == 48) )
+
+  //nothing is due until the interval has passed
+  REMUS_ASSERT( (coalescer.due(99).empty()) )
+  std::vector<remus::proto::JobStatus> due = coalescer.due(100);
+  REMUS_ASSERT( (due.size() == 1) )
+  REMUS_ASSERT( (due[0] == make_progress(id,50)) )
+  REMUS_ASSERT( (coalescer.pendingCount() == 0) )
+
+  //the interval restarts from when the held status was sent
+  REMUS_ASSERT( (coalescer.update(make_progress(id,60), 150) == false) )
+  REMUS_ASSERT( (coalescer.update(make_progress(id,70), 200) == true) )
+  REMUS_ASSERT( (coalescer.pendingCount() == 0) )
+  REMUS_ASSERT( (coalescer.coalescedCount() == 49) )
+
+  //flush sends held statuses right away
+  REMUS_ASSERT( (coalescer.update(make_progress(id,80), 210) == false) )
+  std::vector<remus::proto::JobStatus> flushed = coalescer.flush(210);
+  REMUS_ASSERT( (flushed.size() == 1) )
+  REMUS_ASSERT( (flushed[0] == make_progress(id,80)) )
+}
+
+//------------------------------------------------------------------------------
+void verify_transitions()
+{
+  StatusCoalescer coalescer;
+  coalescer.interval(1000);
+
+  const boost::uuids::uuid id = remus::testing::UUIDGenerator();
+  REMUS_ASSERT( (coalescer.update(remus::proto::JobStatus(id,remus::QUEUED), 0) == true) )
+
+  //moving from queued to in progress is a transition
+  REMUS_ASSERT( (coalescer.update(make_progress(id,1), 1) == true) )
+  REMUS_ASSERT( (coalescer.update(make_progress(id,2), 2) == false) )
+
+  //failing is a transition, and replaces the held progress
+  remus::proto::JobStatus failed = make_progress(id,3);
+  failed.markAsFailed();
+  REMUS_ASSERT( (coalescer.update(failed, 3) == true) )
+  REMUS_ASSERT( (coalescer.pendingCount() == 0) )
+  REMUS_ASSERT( (coalescer.coalescedCount() == 1) )
+
+  //final states forget about the job
+  REMUS_ASSERT( (coalescer.update(make_progress(id,4), 4) == true) )
+}
+
+//------------------------------------------------------------------------------
+void verify_multiple_jobs()
+{
+  StatusCoalescer coalescer;
+  coalescer.interval(100);
+
+  const boost::uuids::uuid id1 = remus::testing::UUIDGenerator();
+  const boost::uuids::uuid id2 = remus::testing::UUIDGenerator();
+
+  //each job has an interval of its own
+  REMUS_ASSERT( (coalescer.update(make_progress(id1,1), 0) == true) )
+  REMUS_ASSERT( (coalescer.update(make_progress(id2,1), 50) == true) )
+  REMUS_ASSERT( (coalescer.update(make_progress(id1,2), 60) == false) )
+  REMUS_ASSERT( (coalescer.update(make_progress(id2,2), 70) == false) )
+
+  std::vector<remus::proto::JobStatus> due = coalescer.due(120);
+  REMUS_ASSERT( (due.size() == 1) )
+  REMUS_ASSERT( (due[0].id() == id1) )
+
+  //the result of a job drops whatever is held for it
+  coalescer.finished(id2);
+  REMUS_ASSERT( (coalescer.pendingCount() == 0) )
+  REMUS_ASSERT( (coalescer.due(1000).empty()) )
+}
+
+}
+
+int UnitTestStatusCoalescer(int, char *[])
+{
+  verify_disabled();
+  verify_coalescing();
+  verify_transitions();
+  verify_multiple_jobs();
+  return 0;
+}
@@ -0,0 +1,147 @@
+//=============================================================================
+//
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//
+//=============================================================================
+
+#include <remus/worker/detail/StatusQueue.h>
+
+#include <remus/testing/Testing.h>
+
+REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <boost/uuid/uuid.hpp>
+REMUS_THIRDPARTY_POST_INCLUDE
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+using namespace remus::worker::detail;
+
+namespace {
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus make_progress(const boost::uuids::uuid& id, int value)
+{
+  return remus::proto::JobStatus(id, remus::proto::JobProgress(value));
+}
+
+//------------------------------------------------------------------------------
+//progress values are clamped, so we count with the message
+remus::proto::JobStatus make_numbered(const boost::uuids::uuid& id, int number)
+{
+  return remus::proto::JobStatus(id, remus::proto::JobProgress(
+                                  boost::lexical_cast<std::string>(number)));
+}
+
+//------------------------------------------------------------------------------
+remus::proto::JobStatus empty_status()
+{
+  return remus::proto::JobStatus(boost::uuids::uuid(), remus::INVALID_STATUS);
+}
+
+//------------------------------------------------------------------------------
+void verify_fifo()
+{
+  StatusQueue queue;
+  REMUS_ASSERT( (queue.empty()) )
+
+  remus::proto::JobStatus status = empty_status();
+  REMUS_ASSERT( (!queue.pop(status)) )
+
+  const boost::uuids::uuid id = remus::testing::UUIDGenerator();
+  for(int i=1; i <= 10; ++i)
+    {
+    queue.push(make_progress(id,i));
+    }
+  REMUS_ASSERT( (!queue.empty()) )
+
+  for(int i=1; i <= 10; ++i)
+    {
+    REMUS_ASSERT( (queue.pop(status)) )
+    REMUS_ASSERT( (status.id() == id) )
+    REMUS_ASSERT( (status.progress().value() == i) )
+    }
+  REMUS_ASSERT( (queue.empty()) )
+  REMUS_ASSERT( (!queue.pop(status)) )
+
+  //the queue can be reused after being emptied
+  queue.push(make_progress(id,42));
+  REMUS_ASSERT( (queue.pop(status)) )
+  REMUS_ASSERT( (status.progress().value() == 42) )
+  REMUS_ASSERT( (queue.empty()) )
+
+  //statuses that are never popped are cleaned up by the queue
+  queue.push(make_progress(id,1));
+  queue.push(make_progress(id,2));
+}
+
+//------------------------------------------------------------------------------
+void push_progress(StatusQueue* queue, boost::uuids::uuid id, int count)
+{
+  for(int i=1; i <= count; ++i)
+    {
+    queue->push(make_numbered(id,i));
+    }
+}
+
+//------------------------------------------------------------------------------
+void verify_many_producers()
+{
+  //every producer reports the progress of its own job, and the consumer
+  //has to see the progress of each job in order
+  const int numProducers = 8;
+  const int perProducer = 5000;
+
+  StatusQueue queue;
+  std::map<boost::uuids::uuid, int> lastSeen;
+  std::vector<boost::uuids::uuid> ids;
+  for(int i=0; i < numProducers; ++i)
+    {
+    ids.push_back(remus::testing::UUIDGenerator());
+    lastSeen[ids.back()] = 0;
+    }
+
+  boost::thread_group producers;
+  for(int i=0; i < numProducers; ++i)
+    {
+    producers.create_thread(
+            boost::bind(push_progress, &queue, ids[i], perProducer));
+    }
+
+  int received = 0;
+  remus::proto::JobStatus status = empty_status();
+  while(received < numProducers * perProducer)
+    {
+    if(queue.pop(status))
+      {
+      int& last = lastSeen[status.id()];
+      const int number =
+          boost::lexical_cast<int>(status.progress().message());
+      REMUS_ASSERT( (number == last + 1) )
+      last = number;
+      ++received;
+      }
+    }
+  producers.join_all();
+
+  REMUS_ASSERT( (queue.empty()) )
+  REMUS_ASSERT( (!queue.pop(status)) )
+}
+
+}
+
+int UnitTestStatusQueue(int, char *[])
+{
+  verify_fifo();
+  verify_many_producers();
+  return 0;
+}
@@ -21,10 +21,19 @@
 
 #include <remus/testing/Testing.h>
 
+#include <vector>
+
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/thread.hpp>
 #include <boost/uuid/uuid.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
+#include <set>
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <poll.h>
+#endif
+
 using namespace remus::worker::detail;
 
 namespace {
@@ -124,6 +133,128 @@ void verify_basic_comms(zmq::context_t& context)
     }
 }
 
+//------------------------------------------------------------------------------
+void verify_batches(zmq::context_t& context)
+{
+  zmq::socketInfo<zmq::proto::inproc> queue_channel(
+                                                remus::testing::UniqueString());
+  JobQueue jq(context,queue_channel); //bind the jobqueue to the worker channel
+
+  while(!jq.isReady())
+    { remus::common::SleepForMillisec(10); }
+
+  zmq::socket_t jobSocket(context,ZMQ_PAIR);
+  jobSocket.connect(queue_channel.endpoint().c_str());
+
+  zmq::SocketIdentity sid;
+
+  //send three jobs in a single message
+  std::vector<remus::worker::Job> jobs;
+  for(int i=0; i < 3; ++i)
+    {
+    jobs.push_back( remus::worker::Job(remus::testing::UUIDGenerator(),
+                                       remus::proto::JobSubmission()) );
+    }
+
+  {
+  remus::proto::Response r =
+      remus::proto::send_NonBlockingResponse(remus::MAKE_MESH_BATCH,
+                                             remus::proto::to_string(jobs),
+                                             &jobSocket,
+                                             sid);
+  REMUS_ASSERT( (r.isValid()) );
+  }
+
+  while(jq.size()<3){}
+  REMUS_ASSERT( (jq.size()==3) );
+  REMUS_ASSERT( (jq.droppedJobCount()==0) );
+
+  //terminating a pending job drops it from the queue
+  {
+  remus::proto::Response r =
+      remus::proto::send_NonBlockingResponse(remus::TERMINATE_JOB,
+                                             remus::worker::to_string(jobs[1]),
+                                             &jobSocket,
+                                             sid);
+  REMUS_ASSERT( (r.isValid()) );
+  }
+
+  while(jq.size()>2){}
+  REMUS_ASSERT( (jq.droppedJobCount()==1) );
+
+  //the jobs keep the order they were sent in
+  REMUS_ASSERT( (jq.take().id() == jobs[0].id()) );
+  REMUS_ASSERT( (jq.take().id() == jobs[2].id()) );
+}
+
+//------------------------------------------------------------------------------
+void take_jobs(JobQueue* jq, std::size_t count,
+               std::vector<boost::uuids::uuid>* taken)
+{
+  for(std::size_t i=0; i < count; ++i)
+    {
+    taken->push_back( jq->waitAndTakeJob().id() );
+    }
+}
+
+//------------------------------------------------------------------------------
+void verify_many_consumers(zmq::context_t& context)
+{
+  zmq::socketInfo<zmq::proto::inproc> queue_channel(
+                                                remus::testing::UniqueString());
+  JobQueue jq(context,queue_channel); //bind the jobqueue to the worker channel
+
+  while(!jq.isReady())
+    { remus::common::SleepForMillisec(10); }
+
+  zmq::socket_t jobSocket(context,ZMQ_PAIR);
+  jobSocket.connect(queue_channel.endpoint().c_str());
+
+  zmq::SocketIdentity sid;
+
+  //start the consumers before any jobs arrive, so they have to be woken
+  const std::size_t numConsumers = 4;
+  const std::size_t jobsPerConsumer = 500;
+  std::vector< std::vector<boost::uuids::uuid> > taken(numConsumers);
+  boost::thread_group consumers;
+  for(std::size_t i=0; i < numConsumers; ++i)
+    {
+    consumers.create_thread( boost::bind(take_jobs, &jq, jobsPerConsumer,
+                                         &taken[i]) );
+    }
+
+  //send more jobs than fit in the queue at once
+  std::set<boost::uuids::uuid> sent;
+  for(std::size_t i=0; i < numConsumers; ++i)
+    {
+    std::vector<remus::worker::Job> jobs;
+    for(std::size_t j=0; j < jobsPerConsumer; ++j)
+      {
+      jobs.push_back( remus::worker::Job(remus::testing::UUIDGenerator(),
+                                         remus::proto::JobSubmission()) );
+      sent.insert(jobs.back().id());
+      }
+    remus::proto::Response r =
+        remus::proto::send_NonBlockingResponse(remus::MAKE_MESH_BATCH,
+                                               remus::proto::to_string(jobs),
+                                               &jobSocket,
+                                               sid);
+    REMUS_ASSERT( (r.isValid()) );
+    }
+
+  consumers.join_all();
+
+  //every job was taken exactly once
+  std::set<boost::uuids::uuid> received;
+  for(std::size_t i=0; i < numConsumers; ++i)
+    {
+    REMUS_ASSERT( (taken[i].size() == jobsPerConsumer) );
+    received.insert(taken[i].begin(), taken[i].end());
+    }
+  REMUS_ASSERT( (received == sent) );
+  REMUS_ASSERT( (jq.size() == 0) );
+}
+
 //------------------------------------------------------------------------------
 void verify_term(zmq::context_t& context)
 {
@@ -142,6 +273,13 @@ void verify_term(zmq::context_t& context)
 
   REMUS_ASSERT( (jq.size() == 0) );
 
+  //waiting on an empty queue gives up after the timeout
+  {
+  remus::worker::Job no_job = jq.waitAndTakeJob(50);
+  REMUS_ASSERT( (!no_job.valid()) )
+  REMUS_ASSERT( (no_job.validityReason() == remus::worker::Job::INVALID) )
+  }
+
   //now send it a terminate message over the worker channel
   remus::worker::Job terminateJob;
   remus::proto::Response r=
@@ -160,7 +298,126 @@ void verify_term(zmq::context_t& context)
   REMUS_ASSERT( (invalid_job.validityReason() ==
                  remus::worker::Job::TERMINATE_WORKER) )
 
+  //every thread that asks for a job after this has to find out
+  //that the worker is terminated, without blocking
+  REMUS_ASSERT( (jq.size() == 0) )
+  REMUS_ASSERT( (jq.take().validityReason() ==
+                 remus::worker::Job::TERMINATE_WORKER) )
+  REMUS_ASSERT( (jq.waitAndTakeJob().validityReason() ==
+                 remus::worker::Job::TERMINATE_WORKER) )
+}
+
+//------------------------------------------------------------------------------
+void verify_term_drops_pending(zmq::context_t& context)
+{
+  zmq::socketInfo<zmq::proto::inproc> queue_channel(
+                                                remus::testing::UniqueString());
+  JobQueue jq(context,queue_channel); //bind the jobqueue to the worker channel
+
+  while(!jq.isReady())
+    { remus::common::SleepForMillisec(10); }
+
+  zmq::socket_t jobSocket(context,ZMQ_PAIR);
+  jobSocket.connect(queue_channel.endpoint().c_str());
+
+  //send more jobs than the queue holds without spilling into its overflow
+  const std::size_t numJobs = 1100;
+  std::vector<remus::worker::Job> jobs;
+  for(std::size_t i=0; i < numJobs; ++i)
+    {
+    jobs.push_back( remus::worker::Job(remus::testing::UUIDGenerator(),
+                                       remus::proto::JobSubmission()) );
+    }
+  remus::proto::Response r =
+      remus::proto::send_NonBlockingResponse(remus::MAKE_MESH_BATCH,
+                                             remus::proto::to_string(jobs),
+                                             &jobSocket,
+                                             zmq::SocketIdentity());
+  REMUS_ASSERT( (r.isValid()) );
+  while(jq.size()<numJobs){}
+
+  //terminating the worker drops every pending job, including the
+  //overflow, and only leaves the terminate job
+  remus::worker::Job terminateJob;
+  r = remus::proto::send_NonBlockingResponse(remus::TERMINATE_WORKER,
+                                       remus::worker::to_string(terminateJob),
+                                       &jobSocket,
+                                       zmq::SocketIdentity());
+  REMUS_ASSERT( (r.isValid()) );
+  while(jq.droppedJobCount()<numJobs || jq.size()<1){}
+
+  REMUS_ASSERT( (jq.droppedJobCount() == numJobs) );
+  REMUS_ASSERT( (jq.size() == 1) );
+  REMUS_ASSERT( (jq.take().validityReason() ==
+                 remus::worker::Job::TERMINATE_WORKER) );
+}
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+//------------------------------------------------------------------------------
+bool is_readable(int fd, int timeoutInMillisec)
+{
+  struct pollfd item = { fd, POLLIN, 0 };
+  return poll(&item, 1, timeoutInMillisec) == 1 && (item.revents & POLLIN);
+}
+
+//------------------------------------------------------------------------------
+void verify_notification(zmq::context_t& context)
+{
+  zmq::socketInfo<zmq::proto::inproc> queue_channel(
+                                                remus::testing::UniqueString());
+  JobQueue jq(context,queue_channel);
+  while(!jq.isReady())
+    { remus::common::SleepForMillisec(10); }
+
+  zmq::socket_t jobSocket(context,ZMQ_PAIR);
+  jobSocket.connect(queue_channel.endpoint().c_str());
+
+  //a job that arrives before anybody asks for the descriptor still
+  //makes it readable
+  remus::worker::Job first(remus::testing::UUIDGenerator(),
+                           remus::proto::JobSubmission());
+  remus::proto::send_NonBlockingResponse(remus::MAKE_MESH,
+                                         remus::worker::to_string(first),
+                                         &jobSocket,
+                                         (zmq::SocketIdentity()));
+  while(jq.size()<1){}
+
+  const int fd = jq.notificationFileDescriptor();
+  REMUS_ASSERT( (fd >= 0) );
+  REMUS_ASSERT( (is_readable(fd, 0)) );
+
+  //stays readable till the queue is drained
+  REMUS_ASSERT( (jq.take().valid()) );
+  REMUS_ASSERT( (is_readable(fd, 0)) );
+  REMUS_ASSERT( (!jq.take().valid()) );
+  jq.rearmNotification();
+  REMUS_ASSERT( (!is_readable(fd, 0)) );
+
+  //a new job wakes up the event loop
+  remus::worker::Job second(remus::testing::UUIDGenerator(),
+                            remus::proto::JobSubmission());
+  remus::proto::send_NonBlockingResponse(remus::MAKE_MESH,
+                                         remus::worker::to_string(second),
+                                         &jobSocket,
+                                         (zmq::SocketIdentity()));
+  REMUS_ASSERT( (is_readable(fd, 2000)) );
+  REMUS_ASSERT( (jq.take().valid()) );
+  REMUS_ASSERT( (!jq.take().valid()) );
+  jq.rearmNotification();
+  REMUS_ASSERT( (!is_readable(fd, 0)) );
+
+  //terminating the worker keeps the descriptor readable for good
+  remus::proto::send_NonBlockingResponse(remus::TERMINATE_WORKER,
+                                         std::string(),
+                                         &jobSocket,
+                                         (zmq::SocketIdentity()));
+  REMUS_ASSERT( (is_readable(fd, 2000)) );
+  REMUS_ASSERT( (jq.take().validityReason() ==
+                 remus::worker::Job::TERMINATE_WORKER) );
+  jq.rearmNotification();
+  REMUS_ASSERT( (is_readable(fd, 0)) );
 }
+#endif
 
 }
 
@@ -169,7 +426,13 @@ int UnitTestWorkerJobQueue(int, char *[])
   zmq::context_t context(1);
 
   verify_basic_comms(context);
+  verify_batches(context);
+  verify_many_consumers(context);
   verify_term(context);
+  verify_term_drops_pending(context);
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  verify_notification(context);
+#endif
 
   return 0;
 }
@@ -12,19 +12,29 @@
 
 #include <remus/server/PortNumbers.h>
 #include <remus/common/SleepFor.h>
+#include <remus/proto/Message.h>
+#include <remus/proto/Response.h>
 #include <remus/proto/zmqHelper.h>
 #include <remus/worker/ServerConnection.h>
 #include <remus/worker/Worker.h>
+#include <remus/worker/WorkerHub.h>
+#include <remus/worker/WorkerPoolExecutor.h>
 
 #include <remus/testing/Testing.h>
 
 REMUS_THIRDPARTY_PRE_INCLUDE
+#include <boost/lexical_cast.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
+#include <boost/thread/locks.hpp>
 REMUS_THIRDPARTY_POST_INCLUDE
 
 
+#include <atomic>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -83,6 +93,181 @@ private:
   bool ContinuePolling;
 };
 
+//a fake server that hands a job to every worker that asks for one, or
+//for every credit a worker gives it, acknowledges results, and keeps track
+//of which workers have registered. Acknowledgements can be held back to
+//stand in for a slow upload. Statuses with a numbered message are checked
+//to arrive in order
+class job_server
+{
+public:
+  template<typename ProtoType>
+  job_server(zmq::socketInfo<ProtoType>& conn,
+             boost::shared_ptr<zmq::context_t> context):
+    WorkerComm((*context),ZMQ_ROUTER),
+    PollingThread( new boost::thread() ),
+    ContinuePolling(true),
+    HoldingAcks(false),
+    HeldAcks(),
+    Results(0),
+    Statuses(0),
+    StatusesOutOfOrder(0)
+  {
+    zmq::bindToAddress(this->WorkerComm, conn);
+
+    boost::scoped_ptr<boost::thread> pollingThread(
+                             new boost::thread( &job_server::poll, this) );
+    this->PollingThread.swap(pollingThread);
+  }
+
+  ~job_server()
+  {
+    this->ContinuePolling = false;
+    this->PollingThread->join();
+  }
+
+  std::size_t registeredWorkers() const
+  {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    return this->Workers.size();
+  }
+
+  std::size_t receivedResults() const
+  {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    return this->Results;
+  }
+
+  std::size_t receivedStatuses() const
+  {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    return this->Statuses;
+  }
+
+  std::size_t statusesOutOfOrder() const
+  {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    return this->StatusesOutOfOrder;
+  }
+
+  //while held, results are counted but not acknowledged. The held
+  //acknowledgements are sent once they are no longer held
+  void holdResultAcks(bool hold)
+  {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    this->HoldingAcks = hold;
+  }
+
+private:
+  void poll()
+  {
+    zmq::pollitem_t item  = { this->WorkerComm,  0, ZMQ_POLLIN, 0 };
+    while( this->ContinuePolling )
+      {
+      zmq::poll_safely(&item,1,50);
+      if(item.revents & ZMQ_POLLIN)
+        {
+        zmq::SocketIdentity route = zmq::address_recv(this->WorkerComm);
+        remus::proto::Message msg =
+                        remus::proto::receive_Message(&this->WorkerComm);
+        //same as the server, workers behind a hub are told apart by
+        //the request id they send
+        zmq::SocketIdentity worker = msg.requestId().empty() ? route :
+                              zmq::SocketIdentity(route, msg.requestId());
+        if(msg.serviceType() == remus::CAN_MESH_REQUIREMENTS)
+          {
+          boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+          this->Workers.insert(worker);
+          }
+        else if(msg.serviceType() == remus::MAKE_MESH)
+          {
+          remus::proto::JobSubmission sub(
+              remus::proto::to_JobRequirements(msg.data(),msg.dataSize()));
+          remus::worker::Job job(remus::testing::UUIDGenerator(), sub);
+          remus::proto::send_NonBlockingResponse(remus::MAKE_MESH,
+                                                 remus::worker::to_string(job),
+                                                 &this->WorkerComm,
+                                                 worker);
+          }
+        else if(msg.serviceType() == remus::JOB_CREDITS)
+          {
+          //the payload is the number of credits followed by the requirements
+          const std::string payload(msg.data(),msg.dataSize());
+          const std::size_t split = payload.find('\n');
+          const int credits =
+              boost::lexical_cast<int>(payload.substr(0,split));
+          remus::proto::JobSubmission sub(
+              remus::proto::to_JobRequirements(payload.substr(split+1)));
+          for(int i=0; i < credits; ++i)
+            {
+            remus::worker::Job job(remus::testing::UUIDGenerator(), sub);
+            remus::proto::send_NonBlockingResponse(remus::MAKE_MESH,
+                                                remus::worker::to_string(job),
+                                                &this->WorkerComm,
+                                                worker);
+            }
+          }
+        else if(msg.serviceType() == remus::MESH_STATUS)
+          {
+          remus::proto::JobStatus status =
+              remus::proto::to_JobStatus(msg.data(),msg.dataSize());
+          const int number =
+              boost::lexical_cast<int>(status.progress().message());
+          boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+          int& last = this->LastStatus[status.id()];
+          if(number != last + 1)
+            {
+            ++this->StatusesOutOfOrder;
+            }
+          last = number;
+          ++this->Statuses;
+          }
+        else if(msg.serviceType() == remus::RETRIEVE_RESULT)
+          {
+          boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+          ++this->Results;
+          this->HeldAcks.push_back(worker);
+          }
+        }
+      this->sendHeldAcks();
+      }
+  }
+
+  void sendHeldAcks()
+  {
+    std::vector<zmq::SocketIdentity> acks;
+    {
+    boost::lock_guard<boost::mutex> lock(this->WorkersMutex);
+    if(this->HoldingAcks)
+      {
+      return;
+      }
+    acks.swap(this->HeldAcks);
+    }
+    typedef std::vector<zmq::SocketIdentity>::const_iterator iter;
+    for(iter i = acks.begin(); i != acks.end(); ++i)
+      {
+      remus::proto::send_NonBlockingResponse(remus::RETRIEVE_RESULT,
+                                             remus::INVALID_MSG,
+                                             &this->WorkerComm,
+                                             *i);
+      }
+  }
+
+  zmq::socket_t WorkerComm;
+  boost::scoped_ptr<boost::thread> PollingThread;
+  bool ContinuePolling;
+
+  mutable boost::mutex WorkersMutex;
+  bool HoldingAcks;
+  std::vector<zmq::SocketIdentity> HeldAcks;
+  std::set<zmq::SocketIdentity> Workers;
+  std::size_t Results;
+  std::map<boost::uuids::uuid, int> LastStatus;
+  std::size_t Statuses;
+  std::size_t StatusesOutOfOrder;
+};
+
 void verify_server_connection_tcpip()
 {
   using namespace remus::meshtypes;
@@ -216,6 +401,251 @@ void verify_polling_rates()
   REMUS_ASSERT( (worker.pollingRates().maxRate() == 120 ) )
 }
 
+void mesh_nothing(const remus::worker::Job&, remus::worker::Worker&)
+{
+}
+
+void verify_pool_executor()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("executor_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  fake_server inproc_server(inproc_info, inproc_conn.context());
+
+  //an executor always has at least a single thread
+  {
+  remus::worker::WorkerPoolExecutor executor(mtype,inproc_conn,0);
+  REMUS_ASSERT( (executor.numberOfThreads() == 1) )
+  }
+
+  remus::worker::WorkerPoolExecutor executor(mtype,inproc_conn,4);
+  REMUS_ASSERT( (executor.numberOfThreads() == 4) )
+  REMUS_ASSERT( (executor.worker().jobPrefetch() == 4) )
+  REMUS_ASSERT( (executor.worker().connection().endpoint() ==
+                 make_inproc_socket("executor_inproc").endpoint()) );
+
+  REMUS_ASSERT( (executor.start(mesh_nothing) == true) )
+  REMUS_ASSERT( (executor.start(mesh_nothing) == false) )
+
+  //the fake server never sends a job, so stopping the threads
+  //has to wake them up while they wait for one
+  executor.stop();
+  executor.wait();
+  REMUS_ASSERT( (executor.activeJobCount() == 0) )
+  REMUS_ASSERT( (executor.completedJobCount() == 0) )
+}
+
+void verify_worker_hub()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("hub_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  job_server server(inproc_info, inproc_conn.context());
+  remus::worker::WorkerHub hub(inproc_conn);
+  REMUS_ASSERT( (hub.numberOfWorkers() == 0) )
+
+  {
+  remus::worker::Worker worker1(mtype,hub);
+  remus::worker::Worker worker2(mtype,hub);
+  REMUS_ASSERT( (hub.numberOfWorkers() == 2) )
+  REMUS_ASSERT( (worker1.connection().endpoint() ==
+                 make_inproc_socket("hub_inproc").endpoint()) );
+
+  //the polling rates are shared by every worker of the hub
+  worker1.pollingRates( remus::worker::PollingRates(30,120) );
+  REMUS_ASSERT( (worker2.pollingRates().minRate() == 30 ) )
+  REMUS_ASSERT( (hub.pollingRates().maxRate() == 120 ) )
+
+  //each worker needs to be handed the job it asked for, even though they
+  //share a single connection to the server
+  remus::worker::Job job1 = worker1.getJob(5000);
+  remus::worker::Job job2 = worker2.getJob(5000);
+  REMUS_ASSERT( (job1.valid() == true) )
+  REMUS_ASSERT( (job2.valid() == true) )
+  REMUS_ASSERT( (job1.id() != job2.id()) )
+  REMUS_ASSERT( (worker1.pendingJobCount() == 0) )
+  REMUS_ASSERT( (worker2.pendingJobCount() == 0) )
+
+  //the server sees each worker as a worker of its own
+  REMUS_ASSERT( (server.registeredWorkers() == 2) )
+  }
+
+  REMUS_ASSERT( (hub.numberOfWorkers() == 0) )
+}
+
+void verify_async_results()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("async_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  job_server server(inproc_info, inproc_conn.context());
+  {
+  remus::worker::Worker worker(mtype,inproc_conn);
+  REMUS_ASSERT( (worker.resultUploadWindow() == 4) )
+  worker.resultUploadWindow(0);
+  REMUS_ASSERT( (worker.resultUploadWindow() == 1) )
+  worker.resultUploadWindow(2);
+
+  //only the window of results can be in flight at once
+  for(int i=0; i < 10; ++i)
+    {
+    worker.returnResultAsync(
+        remus::proto::JobResult(remus::testing::UUIDGenerator()));
+    REMUS_ASSERT( (worker.pendingResultUploads() <= 2) )
+    }
+
+  worker.waitForResultUploads();
+  REMUS_ASSERT( (worker.pendingResultUploads() == 0) )
+  REMUS_ASSERT( (server.receivedResults() == 10) )
+
+  //the blocking version waits for the acknowledgement
+  worker.returnResult(remus::proto::JobResult(remus::testing::UUIDGenerator()));
+  REMUS_ASSERT( (worker.pendingResultUploads() == 0) )
+  REMUS_ASSERT( (server.receivedResults() == 11) )
+
+  //destroying the worker waits for the uploads that are in flight
+  worker.returnResultAsync(
+      remus::proto::JobResult(remus::testing::UUIDGenerator()));
+  }
+  REMUS_ASSERT( (server.receivedResults() == 12) )
+}
+
+void return_blocking_result(remus::worker::Worker* worker,
+                            std::atomic<bool>* returned)
+{
+  worker->returnResult(
+      remus::proto::JobResult(remus::testing::UUIDGenerator()));
+  returned->store(true);
+}
+
+void verify_get_job_while_returning_result()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("blocking_result_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  job_server server(inproc_info, inproc_conn.context());
+  remus::worker::Worker worker(mtype,inproc_conn);
+
+  //one thread waits on the acknowledgement of a slow upload
+  server.holdResultAcks(true);
+  std::atomic<bool> returned(false);
+  boost::thread returner(
+        boost::bind(return_blocking_result, &worker, &returned));
+  for(int i=0; i < 500 && server.receivedResults() == 0; ++i)
+    {
+    remus::common::SleepForMillisec(10);
+    }
+  REMUS_ASSERT( (server.receivedResults() == 1) )
+
+  //while the other still gets jobs and sends statuses
+  remus::worker::Job job = worker.getJob(5000);
+  REMUS_ASSERT( (job.valid() == true) )
+  worker.flushStatus();
+  REMUS_ASSERT( (worker.jobPrefetch() == 0) )
+  REMUS_ASSERT( (returned.load() == false) )
+
+  server.holdResultAcks(false);
+  returner.join();
+  REMUS_ASSERT( (returned.load() == true) )
+  REMUS_ASSERT( (worker.pendingResultUploads() == 0) )
+}
+
+void mesh_and_return_async(const remus::worker::Job& job,
+                           remus::worker::Worker& worker)
+{
+  worker.sendProgress(job, 50, "1");
+  worker.returnResultAsync(remus::proto::JobResult(job.id()));
+}
+
+void verify_pool_executor_results()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("executor_results_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  job_server server(inproc_info, inproc_conn.context());
+  {
+  //handlers return results without waiting for the acknowledgement, so
+  //the threads move on to the next job while the results upload
+  remus::worker::WorkerPoolExecutor executor(mtype,inproc_conn,4);
+  REMUS_ASSERT( (executor.start(mesh_and_return_async) == true) )
+  for(int i=0; i < 500 && executor.completedJobCount() < 20; ++i)
+    {
+    remus::common::SleepForMillisec(10);
+    }
+  REMUS_ASSERT( (executor.completedJobCount() >= 20) )
+  executor.stop();
+  executor.wait();
+  REMUS_ASSERT( (executor.activeJobCount() == 0) )
+  executor.worker().waitForResultUploads();
+  REMUS_ASSERT( (executor.worker().pendingResultUploads() == 0) )
+  REMUS_ASSERT( (server.receivedResults() == executor.completedJobCount()) )
+  }
+}
+
+void send_numbered_progress(remus::worker::Worker* worker, int count)
+{
+  remus::worker::Job job(remus::testing::UUIDGenerator(),
+                         remus::proto::JobSubmission());
+  for(int i=1; i <= count; ++i)
+    {
+    worker->sendProgress(job, 50, boost::lexical_cast<std::string>(i));
+    }
+}
+
+void verify_concurrent_status()
+{
+  using namespace remus::meshtypes;
+  const remus::common::MeshIOType mtype =
+                          remus::common::make_MeshIOType(Model(),Model());
+
+  zmq::socketInfo<zmq::proto::inproc> inproc_info("status_inproc");
+  remus::worker::ServerConnection inproc_conn(inproc_info);
+
+  job_server server(inproc_info, inproc_conn.context());
+  remus::worker::Worker worker(mtype,inproc_conn);
+
+  //every mesher thread reports the progress of its own job at the
+  //same time, and the server has to see each job's progress in order
+  const int numThreads = 8;
+  const int perThread = 100;
+  boost::thread_group meshers;
+  for(int i=0; i < numThreads; ++i)
+    {
+    meshers.create_thread(
+          boost::bind(send_numbered_progress, &worker, perThread));
+    }
+  meshers.join_all();
+  worker.flushStatus();
+
+  const std::size_t expected = numThreads * perThread;
+  for(int i=0; i < 500 && server.receivedStatuses() < expected; ++i)
+    {
+    remus::common::SleepForMillisec(10);
+    }
+  REMUS_ASSERT( (server.receivedStatuses() == expected) )
+  REMUS_ASSERT( (server.statusesOutOfOrder() == 0) )
+}
+
 } //namespace
 
 
@@ -229,6 +659,18 @@ int UnitTestWorker(int, char *[])
 
   verify_polling_rates();
 
+  verify_pool_executor();
+
+  verify_worker_hub();
+
+  verify_async_results();
+
+  verify_get_job_while_returning_result();
+
+  verify_pool_executor_results();
+
+  verify_concurrent_status();
+
   //Keep the test running while the OS has time to unbind the sockets, this
   //should help other tests from failing to bind to the now released socket
   remus::common::SleepForMillisec(1000);
@@ -14,6 +14,7 @@
 #include <remus/testing/Testing.h>
 
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -181,6 +182,36 @@ void verify_submission()
 
 }
 
+void verify_batches()
+{ //verify that multiple jobs can be serialized into a single message
+
+  std::vector<Job> jobs;
+  {
+  std::vector<Job> empty = remus::proto::to_WorkerJobs(
+                    remus::proto::to_string(jobs).c_str(),
+                    remus::proto::to_string(jobs).size());
+  REMUS_ASSERT( (empty.size() == 0) );
+  }
+
+  remus::proto::JobSubmission sub_with_data = make_empty_sub();
+  sub_with_data["non_default_key"] = remus::proto::make_JobContent("content");
+  jobs.push_back( Job(make_id(),make_empty_sub()) );
+  jobs.push_back( Job(make_id(),sub_with_data) );
+  jobs.push_back( Job(make_id(),make_empty_sub()) );
+
+  const std::string msg = remus::proto::to_string(jobs);
+  std::vector<Job> read = remus::proto::to_WorkerJobs(msg.c_str(), msg.size());
+
+  REMUS_ASSERT( (read.size() == jobs.size()) );
+  for(std::size_t i=0; i < jobs.size(); ++i)
+    {
+    REMUS_ASSERT( (read[i].valid() == true) );
+    REMUS_ASSERT( (read[i].id() == jobs[i].id()) );
+    REMUS_ASSERT( (read[i].type() == jobs[i].type()) );
+    }
+  REMUS_ASSERT( (read[1].details("non_default_key") == "content") );
+}
+
 } //namespace
 
 
@@ -190,5 +221,6 @@ int UnitTestWorkerJob(int, char *[])
   verify_validity();
   verify_meshTypes();
   verify_submission();
+  verify_batches();
   return 0;
 }